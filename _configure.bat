@@ -78,16 +78,21 @@ REM -- the name list of all supporting modules (excluding main) --
 SET SUPPORTING_MODULE_NAME_LIST=area banking codeoutput codesequence error file
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% globdefs
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% integermap
-SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% library list
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% layoutfile
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% library linkserver
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% linkstate
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% list
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% listingupdater
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% map mapfile
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% module multimap
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% noicemapfile
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% parser scanner
-SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% set string
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% set statistics
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% string
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% stringlist
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% stringtable
-SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% symbol target
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% symbol symbolindex
+SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% target
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% typedescriptor
 SET SUPPORTING_MODULE_NAME_LIST=%SUPPORTING_MODULE_NAME_LIST% platform\gameboy
 
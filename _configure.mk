@@ -78,10 +78,13 @@ METAPOST:=$(texPath)/mp
 
 #-- the name list of all supporting modules (excluding main) --
 SUPPORTING_MODULE_NAME_LIST:=area banking codeoutput codesequence error file \
-                             globdefs integermap library list listingupdater \
-                             map mapfile module multimap noicemapfile parser \
-                             scanner set string stringlist stringtable symbol \
-                             target typedescriptor platform/gameboy
+                             globdefs integermap layoutfile library \
+                             linkserver linkstate list listingupdater \
+                             map mapfile \
+                             module multimap noicemapfile parser scanner \
+                             set statistics string stringlist stringtable \
+                             symbol symbolindex target typedescriptor \
+                             platform/gameboy
 
 #-- the name list of all supporting modules (including main) --
 MODULE_NAME_LIST:=$(SUPPORTING_MODULE_NAME_LIST) main
@@ -12,10 +12,13 @@ IF DEFINED TARGET_INCLUDE_DIR GOTO :ELSE1
   ECHO ### SDCC linker: compiling ###
 
   SET fileNameList=main area banking codeoutput codesequence error file
-  SET fileNameList=%fileNameList% globdefs integermap library list
+  SET fileNameList=%fileNameList% globdefs integermap layoutfile library linkserver
+  SET fileNameList=%fileNameList% linkstate list
   SET fileNameList=%fileNameList% listingupdater module map multimap
-  SET fileNameList=%fileNameList% noicemapfile parser scanner set string
-  SET fileNameList=%fileNameList% stringlist stringtable symbol target
+  SET fileNameList=%fileNameList% noicemapfile parser scanner set statistics
+  SET fileNameList=%fileNameList% string
+  SET fileNameList=%fileNameList% stringlist stringtable symbol symbolindex
+  SET fileNameList=%fileNameList% target
   SET fileNameList=%fileNameList% typedescriptor
 
   FOR %%i IN (%fileNameList%) DO CALL :compile %%i
@@ -12,20 +12,47 @@
 
 #include "area.h"
 
+#include "codesequence.h"
 #include "error.h"
+#include "file.h"
 #include "globdefs.h"
+#include "integermap.h"
 #include "list.h"
+#include "map.h"
 #include "module.h"
+#include "multimap.h"
 #include "set.h"
 #include "string.h"
+#include "stringlist.h"
 #include "symbol.h"
 #include "target.h"
 
+#include <stdio.h>
+# define StdIO_sprintf sprintf
+#include <stdlib.h>
+# define StdLib_qsort qsort
+#include <string.h>
+# define STRING_memcmp memcmp
+# define STRING_memcpy memcpy
+
 /*========================================*/
 
 #define Area__segmentMagicNumber 0x11112222
 #define Area__magicNumber        0x22221111
 
+#define Area__maxEditLength 4
+  /** maximum number of bytes in a single code edit */
+
+#define Area__noMemoryRegion SizeType_max
+  /** region index for addresses outside of all target memory
+      regions */
+
+#define Area__pageSize 0x100
+  /** alignment of the start of areas with paged segments */
+
+#define Area__noOwner SizeType_max
+  /** owner index of local data not referenced by any code */
+
 typedef List_Type Area_SegmentList;
   /** list of Area_SegmentRecord */
 
@@ -44,6 +71,108 @@ typedef struct Area__Record {
       total size */
 
 
+typedef struct {
+  Target_Address offset;
+  UINT8 kind;
+  Object target;
+} Area__RelocationRecord;
+  /** type representing a relocation of the code of a segment at
+      <offset> with relocation <kind> by <target> (a symbol or a
+      segment) */
+
+
+typedef struct {
+  Target_Address offset;
+  UINT8 length;
+  UINT8 newLength;
+  UINT8 byteList[Area__maxEditLength];
+} Area__CodeEditRecord;
+  /** type representing the replacement of <length> code bytes at
+      original <offset> of a segment by the first <newLength> bytes in
+      <byteList> */
+
+
+typedef struct {
+  Target_Address offset;
+  UINT8 length;
+  Target_InstructionKind kind;
+  Area__RelocationRecord *relocation;
+  Area__CodeEditRecord *edit;
+} Area__JumpRecord;
+  /** type representing a jump instruction with <length> bytes at
+      <offset> of a segment: <kind> tells whether it is absolute or
+      relative, <relocation> is the relocation of the target address
+      (if any) and <edit> the code edit when the jump is relaxed */
+
+
+typedef struct {
+  SizeType regionIndex;
+  Target_Bank bank;
+  UINT32 startAddress;
+  UINT32 endAddress;
+} Area__MemoryRange;
+  /** type representing the addresses from <startAddress> up to (but
+      excluding) <endAddress> in the instance for <bank> of the memory
+      region with <regionIndex> in the target region list */
+
+
+typedef struct {
+  SizeType firstIndex;
+  SizeType count;
+  UINT32 size;
+  Target_Address linearAddress;
+  SizeType regionIndex;
+  Target_Bank bank;
+  Boolean isPaged;
+} Area__PlacementGroup;
+  /** type representing a run of <count> consecutive floating areas
+      starting at <firstIndex> in the list of floating areas which is
+      placed as a unit of <size> bytes: <linearAddress> is the address
+      the run gets by plain concatenation after the previous areas,
+      <regionIndex> and <bank> give the memory region instance it is
+      placed into and <isPaged> tells whether its start must be
+      aligned to a page */
+
+
+typedef struct {
+  SizeType caller;
+  SizeType callee;
+} Area__CallEdge;
+  /** type representing a call from the segment with index <caller>
+      to the segment with index <callee> in the call graph */
+
+
+typedef struct {
+  Area_Segment segment;
+  Boolean isAbsolute;
+  Boolean isSynchronous;
+  Boolean isAsynchronous;
+  SizeType callerCount;
+  Boolean isPlaced;
+  UINT32 frameOffset;
+  UINT32 frameSize;
+  UINT32 frameFill;
+} Area__CallNode;
+  /** type representing a code segment in the call graph: it is
+      <isSynchronous> when it is reached from the main program and
+      <isAsynchronous> when it may be activated at any time (by an
+      interrupt or via a code pointer); for static overlaying the
+      local data of a node <isPlaced> at <frameOffset> in the overlay
+      with <frameSize> bytes (of which <frameFill> are assigned so
+      far) after the frames of all its callers, where <callerCount>
+      counts the callers still to be placed */
+
+
+typedef struct {
+  Area_Segment segment;
+  SizeType owner;
+  Boolean isShared;
+} Area__LocalData;
+  /** type representing a segment of local data referenced only by
+      the node with index <owner> in the call graph unless it
+      <isShared> */
+
+
 typedef struct Area__SegmentRecord {
   long magicNumber;
   Area_Type parentArea;
@@ -51,12 +180,33 @@ typedef struct Area__SegmentRecord {
   Target_Address startAddress;
   Target_Address totalSize;
   Symbol_List symbolList;
+  Boolean isRemoved;
+  Symbol_List referencedSymbolList;
+  Area_SegmentList referencedSegmentList;
+  UINT8 *content;
+  Target_Address contentSize;
+  Boolean contentIsValid;
+  List_Type relocationList;
+  struct Area__SegmentRecord *replacingSegment;
+  List_Type jumpList;
+  List_Type codeEditList;
+  Boolean isOverlayedStatically;
+  Target_Address overlayOffset;
 } Area__SegmentRecord;
   /** type representing a segment of an area which is defined by every
       "A" directive in the linker files; there are back references to
       the respective code or data area and the header where this
       section belongs to; also a list of all symbols in this segment
-      is stored */
+      is stored; when references are tracked, the symbols and
+      segments referenced by the code of this segment are also
+      stored (possibly several times); when contents are tracked,
+      the code bytes (with <contentSize> bytes defined so far) and
+      the list of relocations (of type Area__RelocationRecord) are
+      stored; a folded segment points to its replacing segment; when
+      jumps are relaxed, the jumps (of type Area__JumpRecord) of a
+      segment and its code edits (of type Area__CodeEditRecord) are
+      stored; a segment of local data overlayed statically is located
+      at <overlayOffset> in the overlay part of its area */
 
 static List_Type Area__list;
   /** list containing all area definitions */
@@ -70,12 +220,71 @@ static Area_Type Area__absoluteArea;
 static Area_Segment Area__currentSegment;
   /** the currently processed segment */
 
+static Boolean Area__referencesAreTracked;
+  /** tells whether references of segments are collected */
+
+static Area_SegmentList Area__removedSegmentList;
+  /** list of segments removed because they are unreachable */
+
+static Boolean Area__contentsAreTracked;
+  /** tells whether code bytes and relocations of segments are
+      collected */
+
+static Area_SegmentList Area__foldedSegmentList;
+  /** list of segments removed because they are identical to some
+      other segment */
+
+static Boolean Area__placementIsBestFit;
+  /** tells whether floating relocatable areas are placed by best fit
+      into the memory regions of the target */
+
+static Area__MemoryRange *Area__occupiedRangeList;
+  /** address ranges of all areas located in memory regions by the
+      last best fit placement */
+
+static SizeType Area__occupiedRangeCount;
+  /** number of entries in <Area__occupiedRangeList> */
+
+static Area_Type Area__staticOverlayArea;
+  /** area whose local data segments have been overlayed statically
+      (or NULL) */
+
+static UINT32 Area__staticOverlayDataSize;
+  /** total size of all segments overlayed statically */
+
+static UINT32 Area__staticOverlaySize;
+  /** size of the overlay part of <Area__staticOverlayArea> */
+
 /*--------------------*/
 
 // static void Area__destroy (inout Object *object);
+static Area__CodeEditRecord *Area__addCodeEdit (inout Area_Segment segment,
+						in Target_Address offset,
+						in UINT8 length,
+						in UINT8 newLength,
+						in UINT8 *byteList);
+static Boolean Area__collectJumps (inout Area_Segment segment);
+static void Area__destroyRecordList (inout List_Type *list);
+static void Area__destroySegment (inout Area_Segment *segment);
+static void Area__destroySegmentList (inout Area_SegmentList *list);
+static void Area__discardJumps (inout Area_Segment segment);
 static Boolean Area__hasKey (in Object listElement, in Object key);
+static Boolean Area__hasSameContents (in Area_Segment segment,
+				      in Area_Segment otherSegment);
+static SizeType Area__hashContents (in Area_Segment segment);
+static Boolean Area__isFoldable (in Area_Segment segment);
 static Object Area__makeSegment (void);
+static Target_Address Area__makeWord (in UINT8 *byteList);
+static Target_Address Area__mapOffset (in Area_Segment segment,
+				       in Target_Address offset);
+static void Area__markAsReachable (in Area_Segment segment,
+				   inout Map_Type *reachableSegmentSet,
+				   inout Area_SegmentList *workList);
+static UINT8 Area__relaxJump (in Area_Segment segment,
+			      in Area__JumpRecord *jump,
+			      out UINT8 *byteList);
 static Boolean Area__segmentHasKey (in Object listElement, in Object key);
+static void Area__setRelativeSegmentAddresses (void);
 
 
 static TypeDescriptor_Record Area__tdRecord =
@@ -83,7 +292,7 @@ static TypeDescriptor_Record Area__tdRecord =
     /* .comparisonProc = */ NULL, 
     /* .constructionProc = */ NULL, /* .destructionProc = */ NULL,
     /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Area__hasKey };
+    /* .keyValidationProc = */ Area__hasKey, /* .name = */ "Area" };
 
 TypeDescriptor_Type Area_typeDescriptor = &Area__tdRecord;
 
@@ -93,7 +302,8 @@ static TypeDescriptor_Record Area__segmentTDRecord =
     /* .comparisonProc = */ NULL, 
     /* .constructionProc = */ NULL, /* .destructionProc = */ NULL,
     /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Area__segmentHasKey };
+    /* .keyValidationProc = */ Area__segmentHasKey,
+    /* .name = */ "Area segment" };
 
 TypeDescriptor_Type Area_segmentTypeDescriptor = &Area__segmentTDRecord;
 
@@ -103,7 +313,8 @@ static TypeDescriptor_Record Area__segmentRecordTDRecord =
     /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ Area__makeSegment,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Area__segmentHasKey };
+    /* .keyValidationProc = */ Area__segmentHasKey,
+    /* .name = */ "Area segment record" };
 
 static TypeDescriptor_Type Area__segmentRecordTypeDescriptor = 
   &Area__segmentRecordTDRecord;
@@ -115,6 +326,38 @@ static TypeDescriptor_Type Area__segmentRecordTypeDescriptor =
 /*            INTERNAL ROUTINES           */
 /*========================================*/
 
+static Area__CodeEditRecord *Area__addCodeEdit (inout Area_Segment segment,
+						in Target_Address offset,
+						in UINT8 length,
+						in UINT8 newLength,
+						in UINT8 *byteList)
+  /** adds a code edit to <segment> replacing the <length> bytes at
+      <offset> by the first <newLength> bytes of <byteList> and
+      returns it */
+{
+  Area__CodeEditRecord *edit = NEW(Area__CodeEditRecord);
+  Object *objectPtr;
+  UINT8 i;
+
+  edit->offset    = offset;
+  edit->length    = length;
+  edit->newLength = newLength;
+
+  for (i = 0;  i < newLength;  i++) {
+    edit->byteList[i] = byteList[i];
+  }
+
+  if (segment->codeEditList == NULL) {
+    segment->codeEditList = List_make(TypeDescriptor_plainDataTypeDescriptor);
+  }
+
+  objectPtr = List_append(&segment->codeEditList);
+  *objectPtr = edit;
+  return edit;
+}
+
+/*--------------------*/
+
 static Area_Type Area__attemptConversion (in Object area)
   /** verifies that <area> is really a pointer to an area descriptor;
       if not, the program stops with an error message */
@@ -166,6 +409,266 @@ static Boolean Area__checkValidityPRE (in Object area,
 }
 
 /*--------------------*/
+
+static Boolean Area__collectJumps (inout Area_Segment segment)
+  /** decodes the code of <segment> into instructions of the target
+      platform and collects its jumps in the jump list of <segment>;
+      returns whether the decoding is consistent with the relocations
+      of <segment>: all its code must be known, no relocation may
+      affect an opcode or cross an instruction boundary and no
+      unrelocated relative jump may leave the segment; segments
+      defining surrogate symbols for banking are never consistent
+      because their layout is fixed by the trampoline calls, neither
+      are segments with a computed jump because it may index a jump
+      table whose entries must keep their size */
+{
+  Target_Address size = segment->totalSize;
+  Boolean isConsistent = (size > 0 && segment->contentIsValid
+			  && segment->contentSize == size);
+  Area__RelocationRecord **relocationAtOffset = NULL;
+  List_Cursor cursor;
+  Target_Address offset = 0;
+
+  if (isConsistent) {
+    for (cursor = List_resetCursor(segment->symbolList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Symbol_Type symbol = List_getElementAtCursor(cursor);
+      isConsistent = (isConsistent && !Symbol_isSurrogate(symbol));
+    }
+  }
+
+  if (isConsistent) {
+    /* index the relocations by their offset */
+    relocationAtOffset = NEWARRAY(Area__RelocationRecord *, size);
+
+    for (cursor = List_resetCursor(segment->relocationList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area__RelocationRecord *relocation = List_getElementAtCursor(cursor);
+
+      if (relocation->offset >= size) {
+	isConsistent = false;
+      } else {
+	relocationAtOffset[relocation->offset] = relocation;
+      }
+    }
+
+    segment->jumpList = List_make(TypeDescriptor_plainDataTypeDescriptor);
+  }
+
+  while (isConsistent && offset < size) {
+    Target_InstructionKind kind;
+    UINT8 length = Target_info.decodeInstruction(&segment->content[offset],
+						 size - offset, &kind);
+
+    if (length == 0 || relocationAtOffset[offset] != NULL
+	|| kind == Target_InstructionKind_computedJump) {
+      isConsistent = false;
+    } else {
+      Area__RelocationRecord *relocation = NULL;
+      Boolean isWordRelocation = false;
+      Target_Address i;
+
+      /* check that relocations stay within the instruction */
+      for (i = offset + 1;  i < offset + length;  i++) {
+	Area__RelocationRecord *currentRelocation = relocationAtOffset[i];
+
+	if (currentRelocation != NULL) {
+	  CodeSequence_RelocationKind relocationKind;
+	  Boolean isWord;
+
+	  CodeSequence_makeKindFromInteger(&relocationKind,
+					   currentRelocation->kind);
+	  isWord = (!relocationKind.elementsAreBytes
+		    || relocationKind.slotWidthIsTwo);
+	  isConsistent = (isConsistent
+			  && i + (isWord ? 2 : 1) <= offset + length);
+
+	  if (i == offset + 1) {
+	    relocation = currentRelocation;
+	    isWordRelocation = (isWord && !relocationKind.elementsAreBytes
+				&& !relocationKind.isRelocatedPCRelative);
+	  }
+	}
+      }
+
+      if (kind == Target_InstructionKind_relativeJump && length == 2
+	  && relocation == NULL) {
+	long target = ((long) offset + length
+		       + (signed char) segment->content[offset + 1]);
+	isConsistent = (isConsistent && target >= 0 && target <= size);
+      }
+
+      if (isConsistent
+	  && ((kind == Target_InstructionKind_absoluteJump && length == 3
+	       && (relocation == NULL || isWordRelocation))
+	      || (kind == Target_InstructionKind_relativeJump && length == 2
+		  && relocation == NULL))) {
+	Area__JumpRecord *jump = NEW(Area__JumpRecord);
+	Object *objectPtr = List_append(&segment->jumpList);
+
+	jump->offset     = offset;
+	jump->length     = length;
+	jump->kind       = kind;
+	jump->relocation = relocation;
+	jump->edit       = NULL;
+	*objectPtr = jump;
+      }
+
+      offset += length;
+    }
+  }
+
+  if (relocationAtOffset != NULL) {
+    DESTROY(relocationAtOffset);
+  }
+
+  if (!isConsistent) {
+    Area__discardJumps(segment);
+  }
+
+  return isConsistent;
+}
+
+/*--------------------*/
+
+static int Area__compareCallEdges (in const void *a, in const void *b)
+  /** compares the call edges <a> and <b> by caller and callee and
+      returns -1, 0 or +1 for less, equal and greater */
+{
+  const Area__CallEdge *edgeA = a;
+  const Area__CallEdge *edgeB = b;
+  int result;
+
+  if (edgeA->caller != edgeB->caller) {
+    result = (edgeA->caller < edgeB->caller ? -1 : 1);
+  } else if (edgeA->callee != edgeB->callee) {
+    result = (edgeA->callee < edgeB->callee ? -1 : 1);
+  } else {
+    result = 0;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static int Area__compareMemoryRanges (in const void *a, in const void *b)
+  /** compares the memory ranges <a> and <b> by region, bank and start
+      address and returns -1, 0 or +1 for less, equal and greater */
+{
+  const Area__MemoryRange *rangeA = a;
+  const Area__MemoryRange *rangeB = b;
+  int result;
+
+  if (rangeA->regionIndex != rangeB->regionIndex) {
+    result = (rangeA->regionIndex < rangeB->regionIndex ? -1 : 1);
+  } else if (rangeA->bank != rangeB->bank) {
+    result = (rangeA->bank < rangeB->bank ? -1 : 1);
+  } else if (rangeA->startAddress != rangeB->startAddress) {
+    result = (rangeA->startAddress < rangeB->startAddress ? -1 : 1);
+  } else {
+    result = 0;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static int Area__comparePlacementGroups (in const void *a, in const void *b)
+  /** compares the placement groups <a> and <b> by decreasing size and
+      returns -1, 0 or +1 for less, equal and greater; groups of equal
+      size keep their order in the area list */
+{
+  const Area__PlacementGroup *groupA = a;
+  const Area__PlacementGroup *groupB = b;
+  int result;
+
+  if (groupA->size != groupB->size) {
+    result = (groupA->size > groupB->size ? -1 : 1);
+  } else if (groupA->firstIndex != groupB->firstIndex) {
+    result = (groupA->firstIndex < groupB->firstIndex ? -1 : 1);
+  } else {
+    result = 0;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void Area__destroyRecordList (inout List_Type *list)
+  /** destroys <list> (if any) together with the plain data records
+      referenced by its elements and sets it to NULL */
+{
+  if (*list != NULL) {
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(*list);  cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      DESTROY(List_getElementAtCursor(cursor));
+    }
+
+    List_destroy(list);
+  }
+}
+
+/*--------------------*/
+
+static void Area__destroySegment (inout Area_Segment *segment)
+  /** destroys <segment> together with its code bytes, relocations,
+      jumps and code edits; the symbols and segments in its lists are
+      only referenced */
+{
+  Area_Segment currentSegment = *segment;
+
+  List_destroy(&currentSegment->symbolList);
+
+  if (currentSegment->referencedSymbolList != NULL) {
+    List_destroy(&currentSegment->referencedSymbolList);
+  }
+
+  if (currentSegment->referencedSegmentList != NULL) {
+    List_destroy(&currentSegment->referencedSegmentList);
+  }
+
+  if (currentSegment->content != NULL) {
+    DESTROY(currentSegment->content);
+  }
+
+  Area__destroyRecordList(&currentSegment->relocationList);
+  Area__destroyRecordList(&currentSegment->jumpList);
+  Area__destroyRecordList(&currentSegment->codeEditList);
+  DESTROY(currentSegment);
+  *segment = NULL;
+}
+
+/*--------------------*/
+
+static void Area__destroySegmentList (inout Area_SegmentList *list)
+  /** destroys <list> together with the segments in it */
+{
+  List_Cursor cursor;
+
+  for (cursor = List_resetCursor(*list);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Segment segment = List_getElementAtCursor(cursor);
+    Area__destroySegment(&segment);
+  }
+
+  List_destroy(list);
+}
+
+/*--------------------*/
+
+static void Area__discardJumps (inout Area_Segment segment)
+  /** removes the jump list collected for <segment> (if any) */
+{
+  Area__destroyRecordList(&segment->jumpList);
+}
+
 /*--------------------*/
 
 static void Area__destroy (inout Area_Type *area)
@@ -176,7 +679,7 @@ static void Area__destroy (inout Area_Type *area)
 
   if (precondition) {
     String_destroy(&currentArea->name);
-    List_destroy(&currentArea->segmentList);
+    Area__destroySegmentList(&currentArea->segmentList);
     DESTROY(currentArea);
     *area = NULL;
   }
@@ -184,6 +687,140 @@ static void Area__destroy (inout Area_Type *area)
 
 /*--------------------*/
 
+static SizeType Area__findMemoryRegion (in UINT32 address)
+  /** returns the index of the target memory region containing
+      <address> or <Area__noMemoryRegion> when there is none */
+{
+  Target_MemoryRegion *regionList = Target_info.memoryRegionList;
+  SizeType result = Area__noMemoryRegion;
+  SizeType i;
+
+  if (regionList != NULL) {
+    for (i = 0;
+	 result == Area__noMemoryRegion && regionList[i].name != NULL;
+	 i++) {
+      Target_MemoryRegion *region = &regionList[i];
+
+      if (address >= region->startAddress
+	  && address < region->startAddress + region->size) {
+	result = i;
+      }
+    }
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static SizeType Area__getFreeGaps (in Area__MemoryRange *occupiedRangeList,
+				   in SizeType occupiedRangeCount,
+				   in SizeType regionIndex,
+				   in Target_Bank bank,
+				   out Area__MemoryRange *gapList)
+  /** fills <gapList> (with room for <occupiedRangeCount> + 1 entries)
+      with the ranges of the instance for <bank> of the memory region
+      with <regionIndex> not covered by any range in
+      <occupiedRangeList> ordered by address and returns their
+      number */
+{
+  Target_MemoryRegion *region = &Target_info.memoryRegionList[regionIndex];
+  UINT32 regionEndAddress = region->startAddress + region->size;
+  UINT32 address = region->startAddress;
+  SizeType count = 0;
+  SizeType gapCount = 0;
+  SizeType i;
+
+  /* collect the occupied ranges of the region instance sorted by
+     address */
+  for (i = 0;  i < occupiedRangeCount;  i++) {
+    Area__MemoryRange *range = &occupiedRangeList[i];
+
+    if (range->regionIndex == regionIndex && range->bank == bank) {
+      gapList[count++] = *range;
+    }
+  }
+
+  StdLib_qsort(gapList, count, sizeof(Area__MemoryRange),
+	       Area__compareMemoryRanges);
+
+  /* replace them by the gaps in between; there is at most one gap
+     before each range, hence no gap overwrites an unvisited range */
+  for (i = 0;  i <= count;  i++) {
+    UINT32 gapEndAddress = regionEndAddress;
+    UINT32 rangeEndAddress = regionEndAddress;
+
+    if (i < count) {
+      rangeEndAddress = gapList[i].endAddress;
+
+      if (gapList[i].startAddress < regionEndAddress) {
+	gapEndAddress = gapList[i].startAddress;
+      }
+    }
+
+    if (address < gapEndAddress) {
+      Area__MemoryRange *gap = &gapList[gapCount++];
+      gap->regionIndex  = regionIndex;
+      gap->bank         = bank;
+      gap->startAddress = address;
+      gap->endAddress   = gapEndAddress;
+    }
+
+    if (rangeEndAddress > address) {
+      address = rangeEndAddress;
+    }
+  }
+
+  return gapCount;
+}
+
+/*--------------------*/
+
+static Target_Bank Area__getRegionBank (in Area_Type area,
+					in SizeType regionIndex)
+  /** returns the bank of the instance of the memory region with
+      <regionIndex> used by <area>: the bank in the area name for a
+      banked region and 0 otherwise */
+{
+  Target_Bank result = 0;
+
+  if (regionIndex != Area__noMemoryRegion
+      && Target_info.memoryRegionList[regionIndex].isBanked
+      && Target_info.getBankFromSegmentName != NULL) {
+    result = Target_info.getBankFromSegmentName(area->name);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static Area_Segment Area__getRelocationTarget
+			 (in Area__RelocationRecord *relocation)
+  /** returns the segment referenced by <relocation> directly or via a
+      symbol; for a folded segment its replacing segment is returned,
+      for a reference to an absolute or undefined symbol NULL */
+{
+  CodeSequence_RelocationKind relocationKind;
+  Area_Segment result = NULL;
+
+  CodeSequence_makeKindFromInteger(&relocationKind, relocation->kind);
+
+  if (!relocationKind.isSymbol) {
+    result = relocation->target;
+  } else if (Symbol_isDefined(relocation->target)) {
+    result = Symbol_getSegment(relocation->target);
+  }
+
+  if (result != NULL && result->replacingSegment != NULL) {
+    result = result->replacingSegment;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
 static Boolean Area__hasKey (in Object object, in Object key)
   /** checks whether <object> has <key> as identification */
 {
@@ -194,6 +831,76 @@ static Boolean Area__hasKey (in Object object, in Object key)
 
 /*--------------------*/
 
+static Boolean Area__hasSameContents (in Area_Segment segment,
+				      in Area_Segment otherSegment)
+  /** tells whether <segment> and <otherSegment> are in the same area
+      and have the same code bytes and relocations; a relocation by
+      the segment itself matches the corresponding relocation by the
+      other segment itself */
+{
+  Boolean isEqual = (segment->parentArea == otherSegment->parentArea
+		     && segment->totalSize == otherSegment->totalSize
+		     && (List_length(segment->relocationList)
+			 == List_length(otherSegment->relocationList)));
+
+  if (isEqual) {
+    isEqual = (STRING_memcmp(segment->content, otherSegment->content,
+			     segment->totalSize) == 0);
+  }
+
+  if (isEqual) {
+    List_Cursor cursor = List_resetCursor(segment->relocationList);
+    List_Cursor otherCursor = List_resetCursor(otherSegment->relocationList);
+
+    while (isEqual && cursor != NULL) {
+      Area__RelocationRecord *relocation = List_getElementAtCursor(cursor);
+      Area__RelocationRecord *otherRelocation =
+	List_getElementAtCursor(otherCursor);
+      Boolean isSelfReference = (relocation->target == segment);
+      Boolean otherIsSelfReference = (otherRelocation->target
+				      == otherSegment);
+
+      isEqual = (relocation->offset == otherRelocation->offset
+		 && relocation->kind == otherRelocation->kind
+		 && isSelfReference == otherIsSelfReference
+		 && (isSelfReference
+		     || relocation->target == otherRelocation->target));
+      List_advanceCursor(&cursor);
+      List_advanceCursor(&otherCursor);
+    }
+  }
+
+  return isEqual;
+}
+
+/*--------------------*/
+
+static SizeType Area__hashContents (in Area_Segment segment)
+  /** calculates a (non-zero) hash code from the code bytes and the
+      relocation offsets and kinds of <segment> */
+{
+  UINT32 hashCode = 2166136261UL;
+  List_Cursor cursor;
+  Target_Address i;
+
+  for (i = 0;  i < segment->totalSize;  i++) {
+    hashCode = (hashCode ^ segment->content[i]) * 16777619UL;
+  }
+
+  for (cursor = List_resetCursor(segment->relocationList);
+       cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area__RelocationRecord *relocation = List_getElementAtCursor(cursor);
+    hashCode = (hashCode ^ (relocation->offset & 0xFF)) * 16777619UL;
+    hashCode = (hashCode ^ (relocation->offset >> 8)) * 16777619UL;
+    hashCode = (hashCode ^ relocation->kind) * 16777619UL;
+  }
+
+  return (hashCode == 0 ? 1 : (SizeType) hashCode);
+}
+
+/*--------------------*/
+
 static Area_Type Area__init (in String_Type areaName,
 			     in Area_AttributeSet attributeSet)
   /** creates and links in a new area with <areaName> and attributes
@@ -216,6 +923,26 @@ static Area_Type Area__init (in String_Type areaName,
 
 /*--------------------*/
 
+static Boolean Area__isFoldable (in Area_Segment segment)
+  /** tells whether <segment> may be folded into an identical segment
+      or replace other segments: it must be a non-empty relocatable
+      segment in a concatenated area, all its code bytes must be known
+      and it must define at least one symbol; then also its list of
+      relocations exists */
+{
+  Area_AttributeSet attributes = segment->parentArea->attributes;
+
+  return (!segment->isRemoved
+	  && !Set_isElement(attributes, Area_Attribute_isAbsolute)
+	  && !Set_isElement(attributes, Area_Attribute_hasOverlayedSegments)
+	  && segment->totalSize > 0
+	  && segment->contentIsValid
+	  && segment->contentSize == segment->totalSize
+	  && List_length(segment->symbolList) > 0);
+}
+
+/*--------------------*/
+
 static Object Area__makeSegment (void)
   /** private construction of segment used when a new entry is
       created in segment record list */
@@ -234,6 +961,18 @@ static Object Area__makeSegment (void)
     segment->startAddress = 0;
     segment->totalSize    = 0;
     segment->symbolList   = List_make(Symbol_typeDescriptor);
+    segment->isRemoved    = false;
+    segment->referencedSymbolList  = NULL;
+    segment->referencedSegmentList = NULL;
+    segment->content          = NULL;
+    segment->contentSize      = 0;
+    segment->contentIsValid   = true;
+    segment->relocationList   = NULL;
+    segment->replacingSegment = NULL;
+    segment->jumpList         = NULL;
+    segment->codeEditList     = NULL;
+    segment->isOverlayedStatically = false;
+    segment->overlayOffset    = 0;
   }
 
   return segment;
@@ -241,6 +980,52 @@ static Object Area__makeSegment (void)
 
 /*--------------------*/
 
+static Target_Address Area__makeWord (in UINT8 *byteList)
+  /** builds word from two consecutive code bytes in <byteList>
+      respecting the endianness of the target */
+{
+  Target_Address result;
+
+  if (Target_info.isBigEndian) {
+    result = byteList[0] * 256 + byteList[1];
+  } else {
+    result = byteList[1] * 256 + byteList[0];
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static Target_Address Area__mapOffset (in Area_Segment segment,
+				       in Target_Address offset)
+  /** returns the offset of the code byte originally at <offset> in
+      <segment> after all code edits; a folded segment uses the code
+      edits of its replacing segment */
+{
+  Area_Segment editedSegment = (segment->replacingSegment == NULL
+				? segment : segment->replacingSegment);
+  Target_Address result = offset;
+
+  if (editedSegment->codeEditList != NULL) {
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(editedSegment->codeEditList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area__CodeEditRecord *edit = List_getElementAtCursor(cursor);
+
+      if (edit->offset < offset) {
+	result -= edit->length - edit->newLength;
+      }
+    }
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
 static void Area__linkSegments (inout Area_Type area)
  /** resolves the segment addresses for <area> and reports any paging
      boundary and length errors */
@@ -253,6 +1038,7 @@ static void Area__linkSegments (inout Area_Type area)
                                     Area_Attribute_hasOverlayedSegments);
   Boolean hasPagedSegments = Set_isElement(area->attributes,
                                            Area_Attribute_hasPagedSegments);
+  UINT32 overlaySize = 0;
   List_Cursor segmentCursor;
 
   if (hasPagedSegments && ((address & 0xFF) != 0)) {
@@ -268,7 +1054,12 @@ static void Area__linkSegments (inout Area_Type area)
 
     segment->startAddress = address;
 
-    if (!hasOverlayedSegments) {
+    if (segment->isOverlayedStatically) {
+      /* located after the concatenated segments */
+      if (segment->overlayOffset + segment->totalSize > overlaySize) {
+	overlaySize = segment->overlayOffset + segment->totalSize;
+      }
+    } else if (!hasOverlayedSegments) {
       /* concatenated segments */
       address += segment->totalSize;
       size += segment->totalSize;
@@ -277,6 +1068,22 @@ static void Area__linkSegments (inout Area_Type area)
     }
   }
 
+  if (overlaySize > 0) {
+    /* local data overlayed statically follows the other segments */
+    for (segmentCursor = List_resetCursor(area->segmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Object object = List_getElementAtCursor(segmentCursor);
+      Area_Segment segment = Area__attemptConversionToSegment(object);
+
+      if (segment->isOverlayedStatically) {
+	segment->startAddress = address + segment->overlayOffset;
+      }
+    }
+
+    size += overlaySize;
+  }
+
   area->totalSize = size;
 
   if (hasPagedSegments && size > 256) {
@@ -287,45 +1094,719 @@ static void Area__linkSegments (inout Area_Type area)
 
 /*--------------------*/
 
-static Boolean Area__segmentHasKey (in Object object, in Object key)
-  /** checks whether <object> has <key> as identification */
+static void Area__markAsReachable (in Area_Segment segment,
+				   inout Map_Type *reachableSegmentSet,
+				   inout Area_SegmentList *workList)
+  /** adds <segment> to <reachableSegmentSet> and appends it to
+      <workList> for traversing its references unless it is already
+      known as reachable */
 {
-  Area_Segment segment = Area__attemptConversionToSegment(object);
-  String_Type otherSegmentName = key;
-  String_Type segmentName = segment->parentArea->name;
-
-  return String_isEqual(segmentName, otherSegmentName);
+  if (segment != NULL && Map_lookup(*reachableSegmentSet, segment) == NULL) {
+    Object *objectPtr = List_append(workList);
+    *objectPtr = segment;
+    Map_set(reachableSegmentSet, segment, segment);
+  }
 }
 
-
-/*========================================*/
-/*           EXPORTED ROUTINES            */
-/*========================================*/
-
-/*--------------------*/
-/* MODULE SETUP/CLOSE */ 
 /*--------------------*/
 
-void Area_initialize (void)
+static void Area__markCallees (inout Area__CallNode *nodeList,
+			       in SizeType nodeCount,
+			       in Area__CallEdge *edgeList,
+			       in SizeType *firstEdgeList,
+			       in Boolean isAsynchronous,
+			       out SizeType *workList)
+  /** extends the synchronous (or when <isAsynchronous> the
+      asynchronous) activation of the nodes in <nodeList> with
+      <nodeCount> entries to all nodes called by them; the calls of
+      node i are the entries of <edgeList> from <firstEdgeList>[i] up
+      to <firstEdgeList>[i+1]; <workList> must have room for
+      <nodeCount> entries */
 {
-  Area_AttributeSet attributes;
+  SizeType count = 0;
+  SizeType position = 0;
+  SizeType i;
+
+  for (i = 0;  i < nodeCount;  i++) {
+    if (isAsynchronous ? nodeList[i].isAsynchronous
+	: nodeList[i].isSynchronous) {
+      workList[count++] = i;
+    }
+  }
 
-  /* construct the list of all known areas */
-  Area__list = List_make(Area_typeDescriptor);
+  while (position < count) {
+    SizeType caller = workList[position++];
 
-  /* there is a special area called "ABS" */
-  Set_clear(&attributes);
-  Set_include(&attributes, Area_Attribute_isAbsolute);
-  Set_include(&attributes, Area_Attribute_hasOverlayedSegments);
-  Area__absoluteAreaName = String_makeFromCharArray(".ABS.");
-  Area__absoluteArea = Area__init(Area__absoluteAreaName, attributes);
+    for (i = firstEdgeList[caller];  i < firstEdgeList[caller + 1];  i++) {
+      SizeType calleeIndex = edgeList[i].callee;
+      Area__CallNode *callee = &nodeList[calleeIndex];
+      Boolean *isMarked = (isAsynchronous ? &callee->isAsynchronous
+			   : &callee->isSynchronous);
+
+      if (!*isMarked) {
+	*isMarked = true;
+	workList[count++] = calleeIndex;
+      }
+    }
+  }
+}
+
+/*--------------------*/
+
+static void Area__moveTo (inout Area_Type area, in Target_Address address)
+  /** sets the start address of the linked <area> to <address> and
+      shifts its segments accordingly */
+{
+  List_Cursor segmentCursor;
+
+  for (segmentCursor = List_resetCursor(area->segmentList);
+       segmentCursor != NULL;
+       List_advanceCursor(&segmentCursor)) {
+    Object object = List_getElementAtCursor(segmentCursor);
+    Area_Segment segment = Area__attemptConversionToSegment(object);
+    segment->startAddress = (segment->startAddress - area->startAddress
+			     + address);
+  }
+
+  area->startAddress = address;
+}
+
+/*--------------------*/
+
+static void Area__overlayStatically (inout Area_Type dataArea)
+  /** builds the call graph of all code segments from their
+      relocations and overlays those segments of <dataArea> which are
+      each referenced by a single code segment such that local data
+      of code segments on a common call path never shares addresses */
+{
+  char *procName = "Area__overlayStatically";
+  IntegerMap_Type segmentToIndexMap =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  Map_Type callRelocationSet =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  Target_MemoryRegion *vectorRegion = Target_info.interruptVectorRegion;
+  SizeType segmentCount = 0;
+  SizeType nodeCount = 0;
+  SizeType dataCount = 0;
+  SizeType edgeCount = 0;
+  SizeType edgeCapacity = 0;
+  Area__CallNode *nodeList;
+  Area__LocalData *dataList;
+  Area__CallEdge *edgeList = NULL;
+  SizeType *firstEdgeList;
+  SizeType *workList;
+  SizeType position;
+  SizeType count;
+  List_Cursor areaCursor;
+  List_Cursor cursor;
+  SizeType i;
+
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+    segmentCount += List_length(area->segmentList);
+  }
+
+  nodeList      = NEWARRAY(Area__CallNode, segmentCount + 1);
+  dataList      = NEWARRAY(Area__LocalData, segmentCount + 1);
+  firstEdgeList = NEWARRAY(SizeType, segmentCount + 2);
+  workList      = NEWARRAY(SizeType, segmentCount + 1);
+  ASSERTION(nodeList != NULL && dataList != NULL && firstEdgeList != NULL
+	    && workList != NULL, procName, "out of memory");
+
+  /* the located segments of the data area are local data, all other
+     located segments are nodes of the call graph */
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+    for (cursor = List_resetCursor(area->segmentList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area_Segment segment = List_getElementAtCursor(cursor);
+
+      if (!segment->isRemoved && segment->replacingSegment == NULL) {
+	if (area == dataArea) {
+	  Area__LocalData *data = &dataList[dataCount];
+	  data->segment  = segment;
+	  data->owner    = Area__noOwner;
+	  data->isShared = false;
+	  segment->isOverlayedStatically = false;
+	  IntegerMap_set(&segmentToIndexMap, segment, -(long) dataCount - 1);
+	  dataCount++;
+	} else {
+	  Area__CallNode *node = &nodeList[nodeCount];
+	  node->segment    = segment;
+	  node->isAbsolute = Set_isElement(area->attributes,
+					   Area_Attribute_isAbsolute);
+	  IntegerMap_set(&segmentToIndexMap, segment, (long) nodeCount);
+	  nodeCount++;
+	}
+      }
+    }
+  }
+
+  /* classify the references of all segments: a reference by a
+     decoded call or jump instruction is a call, a reference from an
+     interrupt vector or any other reference to code makes the target
+     asynchronous and a reference from other absolute code makes it a
+     root of the main program; local data is owned by the segments
+     referencing it */
+  for (i = 0;  i < nodeCount + dataCount;  i++) {
+    Boolean isNode = (i < nodeCount);
+    Area_Segment segment = (isNode ? nodeList[i].segment
+			    : dataList[i - nodeCount].segment);
+    Boolean isAbsolute = (isNode && nodeList[i].isAbsolute);
+    Boolean isDecoded = false;
+
+    if (isNode && !isAbsolute && Target_info.decodeInstruction != NULL
+	&& segment->relocationList != NULL) {
+      isDecoded = Area__collectJumps(segment);
+      Map_clear(&callRelocationSet);
+
+      if (isDecoded) {
+	for (cursor = List_resetCursor(segment->jumpList);
+	     cursor != NULL;
+	     List_advanceCursor(&cursor)) {
+	  Area__JumpRecord *jump = List_getElementAtCursor(cursor);
+
+	  if (jump->relocation != NULL) {
+	    Map_set(&callRelocationSet, jump->relocation, jump->relocation);
+	  }
+	}
+
+	Area__discardJumps(segment);
+      }
+    }
+
+    if (segment->relocationList != NULL) {
+      for (cursor = List_resetCursor(segment->relocationList);
+	   cursor != NULL;
+	   List_advanceCursor(&cursor)) {
+	Area__RelocationRecord *relocation = List_getElementAtCursor(cursor);
+	Area_Segment target = Area__getRelocationTarget(relocation);
+	long index = IntegerMap_notFound;
+
+	if (target != NULL && target != segment) {
+	  index = IntegerMap_lookup(segmentToIndexMap, target);
+	}
+
+	if (index == IntegerMap_notFound) {
+	  /* absolute target, removed segment or self reference */
+	} else if (index < 0) {
+	  Area__LocalData *data = &dataList[-index - 1];
+
+	  if (!isNode) {
+	    data->isShared = true;
+	  } else if (data->owner == Area__noOwner) {
+	    data->owner = i;
+	  } else if (data->owner != i) {
+	    data->isShared = true;
+	  }
+	} else if (isAbsolute) {
+	  /* offsets in absolute segments are addresses */
+	  UINT32 address = relocation->offset;
+
+	  if (vectorRegion != NULL && address >= vectorRegion->startAddress
+	      && address < vectorRegion->startAddress + vectorRegion->size) {
+	    nodeList[index].isAsynchronous = true;
+	  } else {
+	    nodeList[index].isSynchronous = true;
+	  }
+	} else if (isDecoded
+		   && Map_lookup(callRelocationSet, relocation) != NULL) {
+	  if (edgeCount == edgeCapacity) {
+	    edgeCapacity = 2 * edgeCapacity + 16;
+	    edgeList = reallocateMemory(edgeList,
+					edgeCapacity * sizeof(Area__CallEdge),
+					__FILE__);
+	  }
+
+	  edgeList[edgeCount].caller = i;
+	  edgeList[edgeCount].callee = (SizeType) index;
+	  edgeCount++;
+	} else {
+	  /* the address of the target is taken, so it may be called at
+	     any time */
+	  nodeList[index].isAsynchronous = true;
+	}
+      }
+    }
+  }
+
+  /* index the calls by caller and propagate the activation kinds */
+  if (edgeCount > 0) {
+    StdLib_qsort(edgeList, edgeCount, sizeof(Area__CallEdge),
+		 Area__compareCallEdges);
+  }
+
+  for (i = 0, position = 0;  i <= nodeCount;  i++) {
+    while (position < edgeCount && edgeList[position].caller < i) {
+      position++;
+    }
+
+    firstEdgeList[i] = position;
+  }
+
+  Area__markCallees(nodeList, nodeCount, edgeList, firstEdgeList, true,
+		    workList);
+  Area__markCallees(nodeList, nodeCount, edgeList, firstEdgeList, false,
+		    workList);
+
+  /* the frame of a node holds the local data owned only by it */
+  for (i = 0;  i < dataCount;  i++) {
+    Area__LocalData *data = &dataList[i];
+
+    if (data->owner != Area__noOwner && !data->isShared) {
+      nodeList[data->owner].frameSize += data->segment->totalSize;
+    }
+  }
+
+  /* place the frames of the synchronous nodes in topological order of
+     the calls each behind the frames of all its callers; nodes on or
+     below a recursion are never placed */
+  for (i = 0;  i < edgeCount;  i++) {
+    Area__CallNode *caller = &nodeList[edgeList[i].caller];
+    Area__CallNode *callee = &nodeList[edgeList[i].callee];
+
+    if (caller->isSynchronous && !caller->isAsynchronous
+	&& !caller->isAbsolute) {
+      callee->callerCount++;
+    }
+  }
+
+  count = 0;
+
+  for (i = 0;  i < nodeCount;  i++) {
+    Area__CallNode *node = &nodeList[i];
+
+    if (node->isSynchronous && !node->isAsynchronous && !node->isAbsolute
+	&& node->callerCount == 0) {
+      workList[count++] = i;
+    }
+  }
+
+  for (position = 0;  position < count;  position++) {
+    SizeType callerIndex = workList[position];
+    Area__CallNode *caller = &nodeList[callerIndex];
+    UINT32 frameEnd = caller->frameOffset + caller->frameSize;
+
+    caller->isPlaced = true;
+
+    for (i = firstEdgeList[callerIndex];  i < firstEdgeList[callerIndex + 1];
+	 i++) {
+      SizeType calleeIndex = edgeList[i].callee;
+      Area__CallNode *callee = &nodeList[calleeIndex];
+
+      if (callee->frameOffset < frameEnd) {
+	callee->frameOffset = frameEnd;
+      }
+
+      callee->callerCount--;
+
+      if (callee->callerCount == 0 && !callee->isAsynchronous
+	  && !callee->isAbsolute) {
+	workList[count++] = calleeIndex;
+      }
+    }
+  }
+
+  /* assign the offsets of the overlayed local data */
+  Area__staticOverlayArea     = dataArea;
+  Area__staticOverlayDataSize = 0;
+  Area__staticOverlaySize     = 0;
+
+  for (i = 0;  i < dataCount;  i++) {
+    Area__LocalData *data = &dataList[i];
+
+    if (data->owner != Area__noOwner && !data->isShared
+	&& nodeList[data->owner].isPlaced) {
+      Area__CallNode *owner = &nodeList[data->owner];
+      Area_Segment segment = data->segment;
+
+      segment->isOverlayedStatically = true;
+      segment->overlayOffset = (Target_Address) (owner->frameOffset
+						 + owner->frameFill);
+      owner->frameFill += segment->totalSize;
+      Area__staticOverlayDataSize += segment->totalSize;
+
+      if (owner->frameOffset + owner->frameFill > Area__staticOverlaySize) {
+	Area__staticOverlaySize = owner->frameOffset + owner->frameFill;
+      }
+    }
+  }
+
+  if (edgeList != NULL) {
+    DESTROY(edgeList);
+  }
+
+  DESTROY(workList);
+  DESTROY(firstEdgeList);
+  DESTROY(dataList);
+  DESTROY(nodeList);
+  Map_destroy(&callRelocationSet);
+  Map_destroy(&segmentToIndexMap);
+}
+
+/*--------------------*/
+
+static void Area__placeInMemoryRegions (void)
+  /** links all areas and places each run of floating relocatable
+      areas (those without a base address) by best fit into a free gap
+      of the memory region instance of the preceding relocatable area
+      with a base address; absolute areas and areas with a base
+      address stay where they are */
+{
+  char *procName = "Area__placeInMemoryRegions";
+  SizeType areaCount = List_length(Area__list);
+  Area_Type *floatingAreaList = NEWARRAY(Area_Type, areaCount + 1);
+  Area__PlacementGroup *groupList = NEWARRAY(Area__PlacementGroup,
+					     areaCount + 1);
+  Area__MemoryRange *gapList = NEWARRAY(Area__MemoryRange, areaCount + 2);
+  Area__PlacementGroup *currentGroup = NULL;
+  SizeType floatingAreaCount = 0;
+  SizeType groupCount = 0;
+  Target_Address relativeBaseAddress = 0;
+  SizeType anchorRegionIndex = Area__findMemoryRegion(0);
+  Target_Bank anchorBank = 0;
+  List_Cursor areaCursor;
+  SizeType i;
+
+  if (Area__occupiedRangeList != NULL) {
+    DESTROY(Area__occupiedRangeList);
+  }
+
+  Area__occupiedRangeList = NEWARRAY(Area__MemoryRange, areaCount + 2);
+  Area__occupiedRangeCount = 0;
+  ASSERTION(floatingAreaList != NULL && groupList != NULL && gapList != NULL
+	    && Area__occupiedRangeList != NULL, procName, "out of memory");
+
+  if (Target_info.reservedRegion != NULL) {
+    /* the platform writes into that range on its own (e.g. the
+       cartridge header), hence it is always occupied */
+    Target_MemoryRegion *reservedRegion = Target_info.reservedRegion;
+    SizeType regionIndex =
+      Area__findMemoryRegion(reservedRegion->startAddress);
+
+    if (regionIndex != Area__noMemoryRegion) {
+      Area__MemoryRange *range =
+	&Area__occupiedRangeList[Area__occupiedRangeCount++];
+      range->regionIndex  = regionIndex;
+      range->bank         = 0;
+      range->startAddress = reservedRegion->startAddress;
+      range->endAddress   = (reservedRegion->startAddress
+			     + reservedRegion->size);
+    }
+  }
+
+  /* link all areas (the floating ones at address zero), occupy the
+     ranges of the fixed ones and group the floating ones into runs
+     which must stay consecutive */
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+    Boolean isAbsolute = Set_isElement(area->attributes,
+				       Area_Attribute_isAbsolute);
+
+    Area__linkSegments(area);
+
+    if (isAbsolute || area->startAddress != 0) {
+      SizeType regionIndex = Area__findMemoryRegion(area->startAddress);
+      Target_Bank bank = Area__getRegionBank(area, regionIndex);
+
+      if (area->totalSize > 0 && regionIndex != Area__noMemoryRegion) {
+	Area__MemoryRange *range =
+	  &Area__occupiedRangeList[Area__occupiedRangeCount++];
+	range->regionIndex  = regionIndex;
+	range->bank         = bank;
+	range->startAddress = area->startAddress;
+	range->endAddress   = area->startAddress + area->totalSize;
+      }
+
+      if (!isAbsolute) {
+	/* following floating areas go to the region of this area */
+	relativeBaseAddress = area->startAddress + area->totalSize;
+	anchorRegionIndex = regionIndex;
+	anchorBank = bank;
+	currentGroup = NULL;
+      }
+    } else {
+      Boolean isPaged = Set_isElement(area->attributes,
+				      Area_Attribute_hasPagedSegments);
+
+      if (currentGroup == NULL || isPaged) {
+	currentGroup = &groupList[groupCount++];
+	currentGroup->firstIndex    = floatingAreaCount;
+	currentGroup->count         = 0;
+	currentGroup->size          = 0;
+	currentGroup->linearAddress = relativeBaseAddress;
+	currentGroup->regionIndex   = anchorRegionIndex;
+	currentGroup->bank          = anchorBank;
+	currentGroup->isPaged       = isPaged;
+      }
+
+      floatingAreaList[floatingAreaCount++] = area;
+      currentGroup->count++;
+      currentGroup->size += area->totalSize;
+      relativeBaseAddress += area->totalSize;
+    }
+  }
+
+  /* place the groups by decreasing size each into the smallest gap
+     it fits into; a group not fitting anywhere keeps its address from
+     plain concatenation */
+  StdLib_qsort(groupList, groupCount, sizeof(Area__PlacementGroup),
+	       Area__comparePlacementGroups);
+
+  for (i = 0;  i < groupCount;  i++) {
+    Area__PlacementGroup *group = &groupList[i];
+    Area_Type firstArea = floatingAreaList[group->firstIndex];
+    UINT32 address = group->linearAddress;
+    SizeType j;
+
+    if (group->size > 0 && group->regionIndex != Area__noMemoryRegion) {
+      UINT32 alignment = (group->isPaged ? Area__pageSize : 1);
+      SizeType gapCount = Area__getFreeGaps(Area__occupiedRangeList,
+					    Area__occupiedRangeCount,
+					    group->regionIndex, group->bank,
+					    gapList);
+      Boolean gapIsFound = false;
+      UINT32 bestSlack = 0;
+      Area__MemoryRange *range;
+
+      for (j = 0;  j < gapCount;  j++) {
+	Area__MemoryRange *gap = &gapList[j];
+	UINT32 startAddress = ((gap->startAddress + alignment - 1)
+			       / alignment * alignment);
+
+	if (startAddress + group->size <= gap->endAddress) {
+	  UINT32 slack = gap->endAddress - gap->startAddress - group->size;
+
+	  if (!gapIsFound || slack < bestSlack) {
+	    gapIsFound = true;
+	    bestSlack  = slack;
+	    address    = startAddress;
+	  }
+	}
+      }
+
+      if (!gapIsFound) {
+	Error_raise(Error_Criticality_warning,
+		    "Area %s does not fit into memory region %s",
+		    String_asCharPointer(firstArea->name),
+		    Target_info.memoryRegionList[group->regionIndex].name);
+      }
+
+      range = &Area__occupiedRangeList[Area__occupiedRangeCount++];
+      range->regionIndex  = group->regionIndex;
+      range->bank         = group->bank;
+      range->startAddress = address;
+      range->endAddress   = address + group->size;
+    }
+
+    if (group->isPaged && (address % Area__pageSize) != 0) {
+      Error_raise(Error_Criticality_warning, "Paged Area %s Boundary Error",
+		  String_asCharPointer(firstArea->name));
+    }
+
+    for (j = 0;  j < group->count;  j++) {
+      Area_Type area = floatingAreaList[group->firstIndex + j];
+      Area__moveTo(area, (Target_Address) address);
+      address += area->totalSize;
+    }
+  }
+
+  DESTROY(gapList);
+  DESTROY(groupList);
+  DESTROY(floatingAreaList);
+}
+
+/*--------------------*/
+
+static UINT8 Area__relaxJump (in Area_Segment segment,
+			      in Area__JumpRecord *jump,
+			      out UINT8 *byteList)
+  /** determines the target of absolute <jump> in <segment> and asks
+      the target platform for a shorter encoding in <byteList>;
+      returns the length of that encoding or 0 when there is none; a
+      distance to the target is only known within the same area
+      (where the segments must have their area relative addresses) */
+{
+  UINT8 *instruction = &segment->content[jump->offset];
+  Area__RelocationRecord *relocation = jump->relocation;
+  Target_Address targetOffset = Area__makeWord(&instruction[1]);
+  Area_Segment targetSegment = NULL;
+  Boolean isResolved = true;
+  Boolean distanceIsKnown = false;
+  Boolean addressIsKnown = false;
+  long distance = 0;
+  Target_Address address = 0;
+  UINT8 result = 0;
+
+  if (relocation == NULL) {
+    /* constant target address */
+    address = targetOffset;
+    addressIsKnown = true;
+  } else {
+    CodeSequence_RelocationKind relocationKind;
+    CodeSequence_makeKindFromInteger(&relocationKind, relocation->kind);
+
+    if (!relocationKind.isSymbol) {
+      targetSegment = relocation->target;
+    } else {
+      Symbol_Type symbol = relocation->target;
+
+      if (!Symbol_isDefined(symbol)) {
+	isResolved = false;
+      } else {
+	targetSegment = Symbol_getSegment(symbol);
+	targetOffset += Symbol_relativeAddress(symbol);
+
+	if (targetSegment == NULL) {
+	  address = targetOffset;
+	  addressIsKnown = true;
+	}
+      }
+    }
+  }
+
+  if (targetSegment != NULL && targetSegment->replacingSegment != NULL) {
+    /* folded segments are located at their replacing segment */
+    targetSegment = targetSegment->replacingSegment;
+  }
+
+  if (targetSegment != NULL && !targetSegment->isRemoved) {
+    Area_Type targetArea = targetSegment->parentArea;
+
+    if (Set_isElement(targetArea->attributes, Area_Attribute_isAbsolute)) {
+      address = targetArea->startAddress + targetOffset;
+      addressIsKnown = true;
+    } else if (targetArea == segment->parentArea) {
+      distance = (((long) targetSegment->startAddress
+		   + Area__mapOffset(targetSegment, targetOffset))
+		  - ((long) segment->startAddress
+		     + Area__mapOffset(segment, jump->offset)));
+      distanceIsKnown = true;
+    }
+  }
+
+  if (isResolved && (distanceIsKnown || addressIsKnown)) {
+    result = Target_info.relaxJump(instruction, distanceIsKnown, distance,
+				   addressIsKnown, address, byteList);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static Boolean Area__segmentHasKey (in Object object, in Object key)
+  /** checks whether <object> has <key> as identification */
+{
+  Area_Segment segment = Area__attemptConversionToSegment(object);
+  String_Type otherSegmentName = key;
+  String_Type segmentName = segment->parentArea->name;
+
+  return String_isEqual(segmentName, otherSegmentName);
+}
+
+/*--------------------*/
+
+static void Area__setRelativeSegmentAddresses (void)
+  /** sets the start address of each segment in a concatenated
+      relocatable area to its offset from the start of the area
+      taking into account all code edits so far */
+{
+  List_Cursor areaCursor;
+
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+    if (!Set_isElement(area->attributes, Area_Attribute_isAbsolute)
+	&& !Set_isElement(area->attributes,
+			  Area_Attribute_hasOverlayedSegments)) {
+      Target_Address address = 0;
+      List_Cursor cursor;
+
+      for (cursor = List_resetCursor(area->segmentList);
+	   cursor != NULL;
+	   List_advanceCursor(&cursor)) {
+	Area_Segment segment = List_getElementAtCursor(cursor);
+	segment->startAddress = address;
+	address += Area__mapOffset(segment, segment->totalSize);
+      }
+    }
+  }
+}
+
+
+/*========================================*/
+/*           EXPORTED ROUTINES            */
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */ 
+/*--------------------*/
+
+void Area_initialize (void)
+{
+  Area_AttributeSet attributes;
+
+  /* construct the list of all known areas */
+  Area__list = List_make(Area_typeDescriptor);
+
+  /* there is a special area called "ABS" */
+  Set_clear(&attributes);
+  Set_include(&attributes, Area_Attribute_isAbsolute);
+  Set_include(&attributes, Area_Attribute_hasOverlayedSegments);
+  Area__absoluteAreaName = String_makeFromCharArray(".ABS.");
+  Area__absoluteArea = Area__init(Area__absoluteAreaName, attributes);
+
+  Area__referencesAreTracked = false;
+  Area__removedSegmentList = List_make(Area_segmentTypeDescriptor);
+  Area__contentsAreTracked = false;
+  Area__foldedSegmentList = List_make(Area_segmentTypeDescriptor);
+  Area__placementIsBestFit = false;
+  Area__occupiedRangeList = NULL;
+  Area__occupiedRangeCount = 0;
+  Area__staticOverlayArea = NULL;
+  Area__staticOverlayDataSize = 0;
+  Area__staticOverlaySize = 0;
 }
 
 /*--------------------*/
 
 void Area_finalize (void)
 {
+  List_Cursor cursor;
+
   String_destroy(&Area__absoluteAreaName);
+
+  /* folded and removed segments are no longer in their areas */
+  Area__destroySegmentList(&Area__foldedSegmentList);
+
+  if (Area__occupiedRangeList != NULL) {
+    DESTROY(Area__occupiedRangeList);
+  }
+
+  Area__destroySegmentList(&Area__removedSegmentList);
+
+  /* the area list only holds references to the areas */
+  for (cursor = List_resetCursor(Area__list);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Type area = List_getElementAtCursor(cursor);
+    Area__destroy(&area);
+  }
+
   List_destroy(&Area__list);
 }
 
@@ -433,6 +1914,20 @@ Area_Segment Area_currentSegment (void)
   return Area__currentSegment;
 }
 
+/*--------------------*/
+
+Boolean Area_isTrackingContents (void)
+{
+  return Area__contentsAreTracked;
+}
+
+/*--------------------*/
+
+Boolean Area_isTrackingReferences (void)
+{
+  return Area__referencesAreTracked;
+}
+
 
 /*--------------------*/
 /* ACCESS             */
@@ -487,6 +1982,32 @@ Target_Address Area_getAddress (in Area_Type area)
 
 /*--------------------*/
 
+void Area_getListOfFoldedSegments (in Area_Type area,
+				   out Area_SegmentList *segmentList)
+{
+  char *procName = "Area_getListOfFoldedSegments";
+  Boolean precondition = Area__checkValidityPRE(area, procName);
+
+  List_clear(segmentList);
+
+  if (precondition) {
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(Area__foldedSegmentList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area_Segment segment = List_getElementAtCursor(cursor);
+
+      if (segment->parentArea == area) {
+	Object *objectPtr = List_append(segmentList);
+	*objectPtr = segment;
+      }
+    }
+  }
+}
+
+/*--------------------*/
+
 void Area_getListOfSegments (in Area_Type area, 
 			     out Area_SegmentList *segmentList)
 {
@@ -532,6 +2053,25 @@ UINT8 Area_getMemoryPage (in Area_Type area)
 
 /*--------------------*/
 
+Boolean Area_getMemoryRegion (in Area_Type area, out SizeType *regionIndex,
+			      out Target_Bank *bank)
+{
+  char *procName = "Area_getMemoryRegion";
+  Boolean precondition = Area__checkValidityPRE(area, procName);
+
+  *regionIndex = Area__noMemoryRegion;
+  *bank        = 0;
+
+  if (precondition) {
+    *regionIndex = Area__findMemoryRegion(area->startAddress);
+    *bank        = Area__getRegionBank(area, *regionIndex);
+  }
+
+  return (*regionIndex != Area__noMemoryRegion);
+}
+
+/*--------------------*/
+
 Target_Address Area_getSegmentAddress (in Area_Segment segment)
 {
   char *procName = "Area_getSegmentAddress";
@@ -589,40 +2129,101 @@ void Area_getSegmentName (in Area_Segment segment, out String_Type *name)
 
 /*--------------------*/
 
-void Area_getSegmentSymbols (in Area_Segment segment, 
-			     out Symbol_List *symbolList)
+Target_Address Area_getSegmentSize (in Area_Segment segment)
 {
-  char *procName = "Area_getSegmentSymbols";
+  char *procName = "Area_getSegmentSize";
   Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+  Target_Address result = 0;
 
   if (precondition) {
-    List_copy(symbolList, segment->symbolList);
+    result = segment->totalSize;
   }
+
+  return result;
 }
 
 /*--------------------*/
 
-Target_Address Area_getSize (in Area_Type area)
+Target_Address Area_mapSegmentOffset (in Area_Segment segment,
+				      in Target_Address offset)
 {
-  char *procName = "Area_getSize";
-  Boolean precondition = Area__checkValidityPRE(area, procName);
-  Target_Address result = 0;
+  char *procName = "Area_mapSegmentOffset";
+  Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+  Target_Address result = offset;
 
   if (precondition) {
-    result = area->totalSize;
+    result = Area__mapOffset(segment, offset);
   }
 
   return result;
 }
 
-
-/*--------------------*/
-/* SELECTION          */
 /*--------------------*/
 
-void Area_setCurrent (in Area_Segment segment)
+void Area_getSegmentSymbols (in Area_Segment segment, 
+			     out Symbol_List *symbolList)
 {
-  char *procName = "Area_setCurrent";
+  char *procName = "Area_getSegmentSymbols";
+  Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+
+  if (precondition) {
+    List_copy(symbolList, segment->symbolList);
+  }
+}
+
+/*--------------------*/
+
+Boolean Area_segmentIsRemoved (in Area_Segment segment)
+{
+  char *procName = "Area_segmentIsRemoved";
+  Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+  Boolean result = false;
+
+  if (precondition) {
+    result = segment->isRemoved;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+Boolean Area_segmentIsUnreachable (in Area_Segment segment)
+{
+  char *procName = "Area_segmentIsUnreachable";
+  Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+  Boolean result = false;
+
+  if (precondition) {
+    result = (segment->isRemoved && segment->replacingSegment == NULL);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+Target_Address Area_getSize (in Area_Type area)
+{
+  char *procName = "Area_getSize";
+  Boolean precondition = Area__checkValidityPRE(area, procName);
+  Target_Address result = 0;
+
+  if (precondition) {
+    result = area->totalSize;
+  }
+
+  return result;
+}
+
+
+/*--------------------*/
+/* SELECTION          */
+/*--------------------*/
+
+void Area_setCurrent (in Area_Segment segment)
+{
+  char *procName = "Area_setCurrent";
   Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
 
   if (precondition) {
@@ -658,6 +2259,147 @@ void Area_addSymbolToSegment (inout Area_Segment *segment,
 
 /*--------------------*/
 
+void Area_addContentToSegment (inout Area_Segment *segment,
+			       in Target_Address offset,
+			       in UINT8 *byteList, in SizeType count)
+{
+  char *procName = "Area_addContentToSegment";
+  Area_Segment currentSegment = *segment;
+  Boolean precondition = Area__checkSegmentValidityPRE(currentSegment,
+						       procName);
+
+  if (precondition && Area__contentsAreTracked && count > 0) {
+    if ((SizeType) offset + count > currentSegment->totalSize) {
+      /* code outside of segment: never fold this segment */
+      currentSegment->contentIsValid = false;
+    } else {
+      if (currentSegment->content == NULL) {
+	currentSegment->content = NEWARRAY(UINT8,
+					   currentSegment->totalSize);
+      }
+
+      if (currentSegment->relocationList == NULL) {
+	currentSegment->relocationList =
+	  List_make(TypeDescriptor_plainDataTypeDescriptor);
+      }
+
+      STRING_memcpy(&currentSegment->content[offset], byteList, count);
+      currentSegment->contentSize += (Target_Address) count;
+    }
+  }
+}
+
+/*--------------------*/
+
+void Area_addReferenceToSegment (inout Area_Segment *segment,
+				 in Area_Segment referencedSegment)
+{
+  char *procName = "Area_addReferenceToSegment";
+  Area_Segment currentSegment = *segment;
+  Boolean precondition = Area__checkSegmentValidityPRE(currentSegment,
+						       procName);
+
+  if (precondition && Area__referencesAreTracked
+      && referencedSegment != NULL && referencedSegment != currentSegment) {
+    Object *objectPtr;
+
+    if (currentSegment->referencedSegmentList == NULL) {
+      currentSegment->referencedSegmentList =
+	List_make(Area_segmentTypeDescriptor);
+    }
+
+    objectPtr = List_append(&currentSegment->referencedSegmentList);
+    *objectPtr = referencedSegment;
+  }
+}
+
+/*--------------------*/
+
+void Area_addReferenceToSymbol (inout Area_Segment *segment,
+				in Symbol_Type symbol)
+{
+  char *procName = "Area_addReferenceToSymbol";
+  Area_Segment currentSegment = *segment;
+  Boolean precondition = Area__checkSegmentValidityPRE(currentSegment,
+						       procName);
+
+  if (precondition && Area__referencesAreTracked && symbol != NULL) {
+    Object *objectPtr;
+
+    if (currentSegment->referencedSymbolList == NULL) {
+      currentSegment->referencedSymbolList =
+	List_make(Symbol_typeDescriptor);
+    }
+
+    objectPtr = List_append(&currentSegment->referencedSymbolList);
+    *objectPtr = symbol;
+  }
+}
+
+/*--------------------*/
+
+void Area_addRelocationToSegment (inout Area_Segment *segment,
+				  in Target_Address offset,
+				  in UINT8 kind, in Object target)
+{
+  char *procName = "Area_addRelocationToSegment";
+  Area_Segment currentSegment = *segment;
+  Boolean precondition = Area__checkSegmentValidityPRE(currentSegment,
+						       procName);
+
+  if (precondition && Area__contentsAreTracked) {
+    Area__RelocationRecord *relocation = NEW(Area__RelocationRecord);
+    Object *objectPtr;
+
+    relocation->offset = offset;
+    relocation->kind   = kind;
+    relocation->target = target;
+
+    if (currentSegment->relocationList == NULL) {
+      currentSegment->relocationList =
+	List_make(TypeDescriptor_plainDataTypeDescriptor);
+    }
+
+    objectPtr = List_append(&currentSegment->relocationList);
+    *objectPtr = relocation;
+  }
+}
+
+/*--------------------*/
+
+void Area_applyCodeEdits (in Area_Segment segment, in Target_Address offset,
+			  in SizeType length, inout UINT8 *byteList,
+			  inout Boolean *isSignificantList)
+{
+  char *procName = "Area_applyCodeEdits";
+  Boolean precondition = Area__checkSegmentValidityPRE(segment, procName);
+
+  if (precondition && segment->codeEditList != NULL) {
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(segment->codeEditList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area__CodeEditRecord *edit = List_getElementAtCursor(cursor);
+
+      if (edit->offset >= offset && edit->offset < offset + length) {
+	SizeType i = edit->offset - offset;
+	SizeType j;
+
+	for (j = 0;  j < edit->length && i + j < length;  j++) {
+	  if (j < edit->newLength) {
+	    byteList[i + j] = edit->byteList[j];
+	  } else {
+	    isSignificantList[i + j] = false;
+	  }
+	}
+      }
+    }
+  }
+}
+
+/*--------------------*/
+
 void Area_clearListOfSegments (inout Area_Type *area)
 {
   char *procName = "Area_clearListOfSegments";
@@ -671,6 +2413,73 @@ void Area_clearListOfSegments (inout Area_Type *area)
 
 /*--------------------*/
 
+void Area_foldIdenticalSegments (void)
+{
+  Area_SegmentList keptSegmentList = List_make(Area_segmentTypeDescriptor);
+  List_Cursor areaCursor;
+
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+    Multimap_Type hashCodeToSegmentsMap =
+      Multimap_make(TypeDescriptor_plainDataTypeDescriptor);
+    List_Cursor cursor;
+
+    List_clear(&keptSegmentList);
+
+    for (cursor = List_resetCursor(area->segmentList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area_Segment segment = List_getElementAtCursor(cursor);
+      Area_Segment replacingSegment = NULL;
+      Object *objectPtr;
+
+      if (Area__isFoldable(segment)) {
+	Object hashCode = (Object) Area__hashContents(segment);
+	List_Type candidateList = Multimap_lookup(hashCodeToSegmentsMap,
+						  hashCode);
+
+	if (candidateList != NULL) {
+	  List_Cursor candidateCursor;
+
+	  for (candidateCursor = List_resetCursor(candidateList);
+	       candidateCursor != NULL && replacingSegment == NULL;
+	       List_advanceCursor(&candidateCursor)) {
+	    Area_Segment candidate = List_getElementAtCursor(candidateCursor);
+
+	    if (Area__hasSameContents(segment, candidate)) {
+	      replacingSegment = candidate;
+	    }
+	  }
+	}
+
+	if (replacingSegment == NULL) {
+	  Multimap_add(&hashCodeToSegmentsMap, hashCode, segment);
+	}
+      }
+
+      if (replacingSegment == NULL) {
+	objectPtr = List_append(&keptSegmentList);
+      } else {
+	segment->isRemoved = true;
+	segment->replacingSegment = replacingSegment;
+	objectPtr = List_append(&Area__foldedSegmentList);
+      }
+
+      *objectPtr = segment;
+    }
+
+    List_copy(&area->segmentList, keptSegmentList);
+    Multimap_destroy(&hashCodeToSegmentsMap);
+  }
+
+  List_destroy(&keptSegmentList);
+}
+
+/*--------------------*/
+
 void Area_link (void)
 {
   /* TODO: check lkarea::lnkarea for revised allocation strategy */
@@ -681,25 +2490,37 @@ void Area_link (void)
   /* make an absolute segment for the special label definitions */
   Area_makeAbsoluteSegment();
 
+  if (Area__placementIsBestFit && Target_info.memoryRegionList != NULL) {
+    Area__placeInMemoryRegions();
+  } else {
+    for (areaCursor = List_resetCursor(Area__list);
+	 areaCursor != NULL;
+	 List_advanceCursor(&areaCursor)) {
+      Area_Type currentArea = 
+	Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+      if (Set_isElement(currentArea->attributes, Area_Attribute_isAbsolute)) {
+	/* area has absolute segments */
+	Area__linkSegments(currentArea);
+      } else {
+	/* area has relocatable segments */
+	if (currentArea->startAddress == 0) {
+	  currentArea->startAddress = relativeBaseAddress;
+	}
+
+	Area__linkSegments(currentArea);
+	relativeBaseAddress = (currentArea->startAddress
+			       + currentArea->totalSize);
+      }
+    }
+  }
+
   for (areaCursor = List_resetCursor(Area__list);
        areaCursor != NULL;
        List_advanceCursor(&areaCursor)) {
     Area_Type currentArea = 
       Area__attemptConversion(List_getElementAtCursor(areaCursor));
 
-    if (Set_isElement(currentArea->attributes, Area_Attribute_isAbsolute)) {
-	/* area has absolute segments */
-      Area__linkSegments(currentArea);
-    } else {
-      /* area has relocatable segments */
-      if (currentArea->startAddress == 0) {
-        currentArea->startAddress = relativeBaseAddress;
-      }
-
-      Area__linkSegments(currentArea);
-      relativeBaseAddress = currentArea->startAddress + currentArea->totalSize;
-    }
-
     /* create special symbols for the start address and the length of the
        area */
     if (!String_isEqual(currentArea->name, Area__absoluteAreaName)) {
@@ -718,6 +2539,318 @@ void Area_link (void)
       String_destroy(&specialSymbolName);
     }
   }
+
+  /* folded segments share the address of their replacing segment */
+  for (areaCursor = List_resetCursor(Area__foldedSegmentList);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Segment segment = List_getElementAtCursor(areaCursor);
+    segment->startAddress = segment->replacingSegment->startAddress;
+  }
+}
+
+/*--------------------*/
+
+void Area_overlayLocalData (in String_Type areaName)
+{
+  Area_Type area;
+
+  Area_lookup(&area, areaName);
+
+  if (area == NULL) {
+    /* no local data to overlay */
+  } else if (Set_isElement(area->attributes, Area_Attribute_isAbsolute)
+	     || Set_isElement(area->attributes,
+			      Area_Attribute_hasOverlayedSegments)) {
+    Error_raise(Error_Criticality_warning,
+		"area %s cannot be overlayed statically",
+		String_asCharPointer(areaName));
+  } else {
+    Area__overlayStatically(area);
+  }
+}
+
+/*--------------------*/
+
+void Area_relaxJumps (void)
+{
+  Area_SegmentList relaxableSegmentList =
+    List_make(Area_segmentTypeDescriptor);
+  Area_SegmentList editedSegmentList = List_make(Area_segmentTypeDescriptor);
+  UINT8 byteList[Area__maxEditLength];
+  Boolean isChanged;
+  List_Cursor areaCursor;
+  List_Cursor cursor;
+  List_Cursor jumpCursor;
+
+  /* collect the jumps of all segments which may be relaxed */
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+    /* only areas declared as code by the target are decoded as
+       instructions, because bytes in data areas may look like jumps */
+    if (!Set_isElement(area->attributes, Area_Attribute_isAbsolute)
+	&& !Set_isElement(area->attributes,
+			  Area_Attribute_hasOverlayedSegments)
+	&& Target_info.isCodeArea != NULL
+	&& Target_info.isCodeArea(area->name)) {
+      for (cursor = List_resetCursor(area->segmentList);
+	   cursor != NULL;
+	   List_advanceCursor(&cursor)) {
+	Area_Segment segment = List_getElementAtCursor(cursor);
+
+	if (Area__collectJumps(segment)) {
+	  Object *objectPtr = List_append(&relaxableSegmentList);
+	  *objectPtr = segment;
+	}
+      }
+    }
+  }
+
+  /* relax jumps until the layout is stable; because relaxation only
+     shrinks code, distances within an area never grow and a relaxed
+     jump stays valid */
+  do {
+    isChanged = false;
+    Area__setRelativeSegmentAddresses();
+
+    for (cursor = List_resetCursor(relaxableSegmentList);
+	 cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area_Segment segment = List_getElementAtCursor(cursor);
+
+      for (jumpCursor = List_resetCursor(segment->jumpList);
+	   jumpCursor != NULL;
+	   List_advanceCursor(&jumpCursor)) {
+	Area__JumpRecord *jump = List_getElementAtCursor(jumpCursor);
+
+	if (jump->kind == Target_InstructionKind_absoluteJump
+	    && jump->edit == NULL) {
+	  UINT8 newLength = Area__relaxJump(segment, jump, byteList);
+
+	  if (newLength > 0 && newLength < jump->length) {
+	    jump->edit = Area__addCodeEdit(segment, jump->offset,
+					   jump->length, newLength, byteList);
+	    isChanged = true;
+	  }
+	}
+      }
+    }
+  } while (isChanged);
+
+  /* encode the relaxed jumps for the final layout and adapt the
+     displacements of unrelocated relative jumps in edited segments */
+  Area__setRelativeSegmentAddresses();
+
+  for (cursor = List_resetCursor(relaxableSegmentList);
+       cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Segment segment = List_getElementAtCursor(cursor);
+
+    if (segment->codeEditList != NULL) {
+      Object *objectPtr = List_append(&editedSegmentList);
+      *objectPtr = segment;
+
+      for (jumpCursor = List_resetCursor(segment->jumpList);
+	   jumpCursor != NULL;
+	   List_advanceCursor(&jumpCursor)) {
+	Area__JumpRecord *jump = List_getElementAtCursor(jumpCursor);
+	Area__CodeEditRecord *edit = jump->edit;
+
+	if (edit != NULL) {
+	  if (Area__relaxJump(segment, jump, edit->byteList)
+	      != edit->newLength) {
+	    Error_raise(Error_Criticality_fatalError,
+			"inconsistent jump relaxation at offset %04X",
+			jump->offset);
+	  }
+	} else if (jump->kind == Target_InstructionKind_relativeJump) {
+	  UINT8 *instruction = &segment->content[jump->offset];
+	  Target_Address endOffset = jump->offset + jump->length;
+	  Target_Address target = (Target_Address)
+	    (endOffset + (signed char) instruction[1]);
+	  long displacement = ((long) Area__mapOffset(segment, target)
+			       - Area__mapOffset(segment, endOffset));
+
+	  if (displacement != (signed char) instruction[1]) {
+	    byteList[0] = instruction[0];
+	    byteList[1] = (UINT8) displacement;
+	    jump->edit = Area__addCodeEdit(segment, jump->offset,
+					   jump->length, jump->length,
+					   byteList);
+	  }
+	}
+      }
+    }
+  }
+
+  /* shrink the edited segments and move their symbols (also those of
+     segments folded into them) */
+  List_concatenate(&editedSegmentList, Area__foldedSegmentList);
+
+  for (cursor = List_resetCursor(editedSegmentList);
+       cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Segment segment = List_getElementAtCursor(cursor);
+    Area_Segment editedSegment = (segment->replacingSegment == NULL
+				  ? segment : segment->replacingSegment);
+
+    if (editedSegment->codeEditList != NULL) {
+      List_Cursor symbolCursor;
+
+      for (symbolCursor = List_resetCursor(segment->symbolList);
+	   symbolCursor != NULL;
+	   List_advanceCursor(&symbolCursor)) {
+	Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
+	Target_Address address = Symbol_relativeAddress(symbol);
+	Symbol_setRelativeAddress(&symbol,
+				  Area__mapOffset(segment, address));
+      }
+
+      segment->totalSize = Area__mapOffset(segment, segment->totalSize);
+    }
+  }
+
+  List_destroy(&editedSegmentList);
+  List_destroy(&relaxableSegmentList);
+}
+
+/*--------------------*/
+
+void Area_removeUnreferencedSegments (in StringList_Type rootSymbolNameList)
+{
+  Map_Type reachableSegmentSet =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  Map_Type reachableModuleSet =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  Area_SegmentList workList = List_make(Area_segmentTypeDescriptor);
+  Area_SegmentList keptSegmentList = List_make(Area_segmentTypeDescriptor);
+  List_Cursor areaCursor;
+  List_Cursor cursor;
+
+  /* the entry points are the absolute segments with code... */
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+    if (Set_isElement(area->attributes, Area_Attribute_isAbsolute)) {
+      for (cursor = List_resetCursor(area->segmentList);
+	   cursor != NULL;
+	   List_advanceCursor(&cursor)) {
+	Area_Segment segment = List_getElementAtCursor(cursor);
+
+	if (segment->totalSize > 0) {
+	  Area__markAsReachable(segment, &reachableSegmentSet, &workList);
+	}
+      }
+    }
+  }
+
+  /* ...and the segments defining the root symbols */
+  for (cursor = List_resetCursor(rootSymbolNameList);
+       cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type symbolName = List_getElementAtCursor(cursor);
+    Symbol_Type symbol = Symbol_lookup(symbolName);
+
+    if (symbol != NULL) {
+      Area__markAsReachable(Symbol_getSegment(symbol),
+			    &reachableSegmentSet, &workList);
+    }
+  }
+
+  /* traverse the references; the work list grows while it is
+     traversed */
+  for (cursor = List_resetCursor(workList);
+       cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Segment segment = List_getElementAtCursor(cursor);
+    Module_Type module = segment->parentModule;
+    List_Cursor referenceCursor;
+
+    if (segment->totalSize > 0 && Map_lookup(reachableModuleSet,
+					     module) == NULL) {
+      /* the module becomes reachable: keep all its segments without
+	 global symbols */
+      Area_SegmentList moduleSegmentList =
+	List_make(Area_segmentTypeDescriptor);
+
+      Map_set(&reachableModuleSet, module, module);
+      Module_getSegmentList(module, &moduleSegmentList);
+
+      for (referenceCursor = List_resetCursor(moduleSegmentList);
+	   referenceCursor != NULL;
+	   List_advanceCursor(&referenceCursor)) {
+	Area_Segment otherSegment = List_getElementAtCursor(referenceCursor);
+
+	if (List_length(otherSegment->symbolList) == 0) {
+	  Area__markAsReachable(otherSegment, &reachableSegmentSet,
+				&workList);
+	}
+      }
+
+      List_destroy(&moduleSegmentList);
+    }
+
+    if (segment->referencedSegmentList != NULL) {
+      for (referenceCursor = List_resetCursor(segment->referencedSegmentList);
+	   referenceCursor != NULL;
+	   List_advanceCursor(&referenceCursor)) {
+	Area__markAsReachable(List_getElementAtCursor(referenceCursor),
+			      &reachableSegmentSet, &workList);
+      }
+    }
+
+    if (segment->referencedSymbolList != NULL) {
+      for (referenceCursor = List_resetCursor(segment->referencedSymbolList);
+	   referenceCursor != NULL;
+	   List_advanceCursor(&referenceCursor)) {
+	Symbol_Type symbol = List_getElementAtCursor(referenceCursor);
+	Area__markAsReachable(Symbol_getSegment(symbol),
+			      &reachableSegmentSet, &workList);
+      }
+    }
+  }
+
+  /* remove all unreachable relocatable segments from their areas */
+  for (areaCursor = List_resetCursor(Area__list);
+       areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area =
+      Area__attemptConversion(List_getElementAtCursor(areaCursor));
+
+    if (!Set_isElement(area->attributes, Area_Attribute_isAbsolute)) {
+      List_clear(&keptSegmentList);
+
+      for (cursor = List_resetCursor(area->segmentList);
+	   cursor != NULL;
+	   List_advanceCursor(&cursor)) {
+	Area_Segment segment = List_getElementAtCursor(cursor);
+	Object *objectPtr;
+
+	if (Map_lookup(reachableSegmentSet, segment) != NULL) {
+	  objectPtr = List_append(&keptSegmentList);
+	} else {
+	  segment->isRemoved = true;
+	  objectPtr = List_append(&Area__removedSegmentList);
+	}
+
+	*objectPtr = segment;
+      }
+
+      List_copy(&area->segmentList, keptSegmentList);
+    }
+  }
+
+  List_destroy(&keptSegmentList);
+  List_destroy(&workList);
+  Map_destroy(&reachableModuleSet);
+  Map_destroy(&reachableSegmentSet);
 }
 
 /*--------------------*/
@@ -768,6 +2901,27 @@ void Area_setBaseAddresses (in String_Type segmentName,
 
 /*--------------------*/
 
+void Area_setBestFitPlacement (in Boolean isActive)
+{
+  Area__placementIsBestFit = isActive;
+}
+
+/*--------------------*/
+
+void Area_setContentTracking (in Boolean isTracked)
+{
+  Area__contentsAreTracked = isTracked;
+}
+
+/*--------------------*/
+
+void Area_setReferenceTracking (in Boolean isTracked)
+{
+  Area__referencesAreTracked = isTracked;
+}
+
+/*--------------------*/
+
 void Area_setSegmentArea (inout Area_Segment *segment, in Area_Type area)
 {
   char *procName = "Area_addSymbolToSegment";
@@ -842,3 +2996,269 @@ void Area_segmentToString (in Area_Segment segment,
     String_appendCharArray(representation, ")");
   }
 }
+
+/*--------------------*/
+
+void Area_writeFoldedSegmentReport (inout File_Type *file)
+{
+  if (List_length(Area__foldedSegmentList) > 0) {
+    String_Type moduleName = String_make();
+    String_Type replacingModuleName = String_make();
+    List_Cursor segmentCursor;
+    UINT32 totalSize = 0;
+    char line[80];
+
+    File_writeCharArray(file, "\nFolded Identical Segments\n\n");
+    File_writeCharArray(file, "Module                Area                    "
+			"  Size  Replaced by\n");
+    File_writeCharArray(file, "--------------------  --------------------  "
+			"--------  --------------------\n");
+
+    for (segmentCursor = List_resetCursor(Area__foldedSegmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      Module_getName(segment->parentModule, &moduleName);
+      Module_getName(segment->replacingSegment->parentModule,
+		     &replacingModuleName);
+      StdIO_sprintf(line, "%-20.20s  %-20.20s  %8lu  %-20.20s\n",
+		    String_asCharPointer(moduleName),
+		    String_asCharPointer(segment->parentArea->name),
+		    (unsigned long) segment->totalSize,
+		    String_asCharPointer(replacingModuleName));
+      File_writeCharArray(file, line);
+      totalSize += segment->totalSize;
+    }
+
+    StdIO_sprintf(line, "\n%lu segments with %lu bytes folded\n",
+		  (unsigned long) List_length(Area__foldedSegmentList),
+		  (unsigned long) totalSize);
+    File_writeCharArray(file, line);
+    String_destroy(&replacingModuleName);
+    String_destroy(&moduleName);
+  }
+}
+
+/*--------------------*/
+
+void Area_writeFreeMemoryReport (inout File_Type *file)
+{
+  if (Area__occupiedRangeCount > 0) {
+    Area__MemoryRange *rangeList = NEWARRAY(Area__MemoryRange,
+					    Area__occupiedRangeCount + 1);
+    Area__MemoryRange *gapList = NEWARRAY(Area__MemoryRange,
+					  Area__occupiedRangeCount + 1);
+    UINT32 totalSize = 0;
+    SizeType totalGapCount = 0;
+    SizeType i;
+    char line[80];
+
+    ASSERTION(rangeList != NULL && gapList != NULL,
+	      "Area_writeFreeMemoryReport", "out of memory");
+    File_writeCharArray(file, "\nFree Memory\n\n");
+    File_writeCharArray(file, "Region  Bank   Start     End    Size\n");
+    File_writeCharArray(file, "------  ----  ------  ------  ------\n");
+
+    /* report the gaps of each used region instance in order of the
+       target region list and of the banks */
+    for (i = 0;  i < Area__occupiedRangeCount;  i++) {
+      rangeList[i] = Area__occupiedRangeList[i];
+    }
+
+    StdLib_qsort(rangeList, Area__occupiedRangeCount,
+		 sizeof(Area__MemoryRange), Area__compareMemoryRanges);
+
+    for (i = 0;  i < Area__occupiedRangeCount;  i++) {
+      Area__MemoryRange *range = &rangeList[i];
+
+      if (i == 0 || range->regionIndex != rangeList[i - 1].regionIndex
+	  || range->bank != rangeList[i - 1].bank) {
+	Target_MemoryRegion *region =
+	  &Target_info.memoryRegionList[range->regionIndex];
+	SizeType gapCount = Area__getFreeGaps(Area__occupiedRangeList,
+					      Area__occupiedRangeCount,
+					      range->regionIndex, range->bank,
+					      gapList);
+	SizeType j;
+
+	for (j = 0;  j < gapCount;  j++) {
+	  Area__MemoryRange *gap = &gapList[j];
+	  UINT32 size = gap->endAddress - gap->startAddress;
+
+	  StdIO_sprintf(line, "%-6.6s  %4d  0x%04lX  0x%04lX  %6lu\n",
+			region->name, (int) range->bank,
+			(unsigned long) gap->startAddress,
+			(unsigned long) gap->endAddress - 1,
+			(unsigned long) size);
+	  File_writeCharArray(file, line);
+	  totalSize += size;
+	}
+
+	totalGapCount += gapCount;
+      }
+    }
+
+    StdIO_sprintf(line, "\n%lu bytes free in %lu gaps\n",
+		  (unsigned long) totalSize, (unsigned long) totalGapCount);
+    File_writeCharArray(file, line);
+    DESTROY(gapList);
+    DESTROY(rangeList);
+  }
+}
+
+/*--------------------*/
+
+void Area_writeRelaxationReport (inout File_Type *file)
+{
+  List_Type moduleList = List_make(Module_typeDescriptor);
+  Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+  UINT32 totalJumpCount = 0;
+  UINT32 totalSize = 0;
+  List_Cursor moduleCursor;
+  char line[80];
+
+  Module_getModuleList(&moduleList);
+
+  for (moduleCursor = List_resetCursor(moduleList);
+       moduleCursor != NULL;
+       List_advanceCursor(&moduleCursor)) {
+    Module_Type module = List_getElementAtCursor(moduleCursor);
+    UINT32 jumpCount = 0;
+    UINT32 size = 0;
+    List_Cursor segmentCursor;
+
+    Module_getSegmentList(module, &segmentList);
+
+    for (segmentCursor = List_resetCursor(segmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      if (segment->codeEditList != NULL && !segment->isRemoved) {
+	List_Cursor cursor;
+
+	for (cursor = List_resetCursor(segment->codeEditList);
+	     cursor != NULL;
+	     List_advanceCursor(&cursor)) {
+	  Area__CodeEditRecord *edit = List_getElementAtCursor(cursor);
+
+	  if (edit->newLength < edit->length) {
+	    jumpCount++;
+	    size += edit->length - edit->newLength;
+	  }
+	}
+      }
+    }
+
+    if (jumpCount > 0) {
+      String_Type moduleName = String_make();
+
+      if (totalJumpCount == 0) {
+	File_writeCharArray(file, "\nRelaxed Jumps\n\n");
+	File_writeCharArray(file, "Module                   Jumps  "
+			    "Bytes saved\n");
+	File_writeCharArray(file, "--------------------  --------  "
+			    "-----------\n");
+      }
+
+      Module_getName(module, &moduleName);
+      StdIO_sprintf(line, "%-20.20s  %8lu  %11lu\n",
+		    String_asCharPointer(moduleName),
+		    (unsigned long) jumpCount, (unsigned long) size);
+      File_writeCharArray(file, line);
+      String_destroy(&moduleName);
+      totalJumpCount += jumpCount;
+      totalSize += size;
+    }
+  }
+
+  if (totalJumpCount > 0) {
+    StdIO_sprintf(line, "\n%lu jumps relaxed with %lu bytes saved\n",
+		  (unsigned long) totalJumpCount, (unsigned long) totalSize);
+    File_writeCharArray(file, line);
+  }
+
+  List_destroy(&segmentList);
+  List_destroy(&moduleList);
+}
+
+/*--------------------*/
+
+void Area_writeRemovedSegmentReport (inout File_Type *file)
+{
+  if (List_length(Area__removedSegmentList) > 0) {
+    String_Type moduleName = String_make();
+    List_Cursor segmentCursor;
+    UINT32 totalSize = 0;
+    char line[80];
+
+    File_writeCharArray(file, "\nRemoved Unreferenced Segments\n\n");
+    File_writeCharArray(file, "Module                Area                    "
+			"  Size\n");
+    File_writeCharArray(file, "--------------------  --------------------  "
+			"--------\n");
+
+    for (segmentCursor = List_resetCursor(Area__removedSegmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      Module_getName(segment->parentModule, &moduleName);
+      StdIO_sprintf(line, "%-20.20s  %-20.20s  %8lu\n",
+		    String_asCharPointer(moduleName),
+		    String_asCharPointer(segment->parentArea->name),
+		    (unsigned long) segment->totalSize);
+      File_writeCharArray(file, line);
+      totalSize += segment->totalSize;
+    }
+
+    StdIO_sprintf(line, "\n%lu segments with %lu bytes removed\n",
+		  (unsigned long) List_length(Area__removedSegmentList),
+		  (unsigned long) totalSize);
+    File_writeCharArray(file, line);
+    String_destroy(&moduleName);
+  }
+}
+
+/*--------------------*/
+
+void Area_writeStaticOverlayReport (inout File_Type *file)
+{
+  if (Area__staticOverlayDataSize > 0) {
+    String_Type moduleName = String_make();
+    Area_SegmentList segmentList = Area__staticOverlayArea->segmentList;
+    List_Cursor segmentCursor;
+    char line[80];
+
+    File_writeCharArray(file, "\nStatically Overlayed Local Data\n\n");
+    File_writeCharArray(file, "Module                Area                    "
+			"Offset      Size\n");
+    File_writeCharArray(file, "--------------------  --------------------  "
+			"--------  --------\n");
+
+    for (segmentCursor = List_resetCursor(segmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      if (segment->isOverlayedStatically) {
+	Module_getName(segment->parentModule, &moduleName);
+	StdIO_sprintf(line, "%-20.20s  %-20.20s  %8lu  %8lu\n",
+		      String_asCharPointer(moduleName),
+		      String_asCharPointer(Area__staticOverlayArea->name),
+		      (unsigned long) segment->overlayOffset,
+		      (unsigned long) segment->totalSize);
+	File_writeCharArray(file, line);
+      }
+    }
+
+    StdIO_sprintf(line, "\n%lu bytes overlayed into %lu bytes with %lu "
+		  "bytes saved\n", (unsigned long) Area__staticOverlayDataSize,
+		  (unsigned long) Area__staticOverlaySize,
+		  (unsigned long) (Area__staticOverlayDataSize
+				   - Area__staticOverlaySize));
+    File_writeCharArray(file, line);
+    String_destroy(&moduleName);
+  }
+}
@@ -19,7 +19,29 @@
 
     Finally an area may be linked: all addresses of segments within
     that area are resolved (depending on whether they are overlayed or
-    concatenated).
+    concatenated).  Relocatable areas without a base address either
+    follow the previous area or are placed by best fit into the free
+    gaps of the memory regions of the target platform, which may be
+    reported afterwards.
+
+    Before linking, segments not reachable from the entry points of
+    the program may be removed from their areas.  For that the
+    references of each segment to symbols and other segments are
+    tracked during the first pass.
+
+    Segments of local data in some area may also be overlayed
+    statically when the call graph shows that the code using them can
+    never be active at the same time.
+
+    Also segments with identical contents within the same area may be
+    folded: only one of them is located and the others get its
+    address.  For that the code bytes and relocations of each segment
+    are collected during the first pass.
+
+    Based on the same information absolute jumps may be relaxed into
+    shorter instructions when their target is close enough.  The
+    resulting code edits shrink the segments and are applied to the
+    code when it is relocated in the second pass.
 
     Original version by Thomas Tensi, 2006-07
     based on the module lkarea.c by Alan R. Baldwin
@@ -31,9 +53,11 @@
 /*========================================*/
 
 #include "globdefs.h"
+#include "file.h"
 #include "list.h"
 #include "set.h"
 #include "string.h"
+#include "stringlist.h"
 #include "target.h"
 #include "typedescriptor.h"
 
@@ -143,6 +167,19 @@ void Area_destroy (inout Area_Type *area);
 Area_Segment Area_currentSegment (void);
   /** returns currently active segment */
 
+/*--------------------*/
+
+Boolean Area_isTrackingContents (void);
+  /** tells whether the code bytes and relocations of segments have
+      to be collected in the first pass (for folding identical
+      segments) */
+
+/*--------------------*/
+
+Boolean Area_isTrackingReferences (void);
+  /** tells whether the references of segments have to be collected
+      in the first pass (for removing unreferenced segments) */
+
 /*--------------------*/
 /* ACCESS             */
 /*--------------------*/
@@ -167,6 +204,15 @@ Target_Address Area_getAddress (in Area_Type area);
 
 /*--------------------*/
 
+void Area_getListOfFoldedSegments (in Area_Type area,
+				   out Area_SegmentList *segmentList);
+  /** returns the segments taken out of <area> by
+      <Area_foldIdenticalSegments> in <segmentList>; after linking
+      they (and their symbols) are located at the address of their
+      replacing segment */
+
+/*--------------------*/
+
 void Area_getListOfSegments (in Area_Type area, 
 			     out Area_SegmentList *segmentList);
   /** returns segments of <area> in <segmentList> */
@@ -179,6 +225,16 @@ UINT8 Area_getMemoryPage (in Area_Type area);
 
 /*--------------------*/
 
+Boolean Area_getMemoryRegion (in Area_Type area, out SizeType *regionIndex,
+			      out Target_Bank *bank);
+  /** tells whether the address of <area> lies in one of the memory
+      regions of the target platform and returns the index of that
+      region in <Target_info.memoryRegionList> in <regionIndex> and the
+      bank of the region instance used (0 when the region is not
+      banked) in <bank> */
+
+/*--------------------*/
+
 Target_Address Area_getSegmentAddress (in Area_Segment segment);
   /** returns address of <segment> */
 
@@ -199,12 +255,41 @@ Module_Type Area_getSegmentModule (in Area_Segment segment);
 
 /*--------------------*/
 
+Target_Address Area_getSegmentSize (in Area_Segment segment);
+  /** returns size of <segment> (as given in its object file or
+      reduced by jump relaxation) */
+
+/*--------------------*/
+
+Target_Address Area_mapSegmentOffset (in Area_Segment segment,
+				      in Target_Address offset);
+  /** returns the offset of the code byte originally at <offset> in
+      <segment> after the code edits by jump relaxation */
+
+/*--------------------*/
+
 void Area_getSegmentSymbols (in Area_Segment segment, 
 			     out Symbol_List *symbolList);
   /** returns all symbols in <segment> in <symbolList> */
 
 /*--------------------*/
 
+Boolean Area_segmentIsRemoved (in Area_Segment segment);
+  /** tells whether <segment> has been removed from its area because
+      it is not reachable from the entry points of the program or
+      because it has been folded into an identical segment; its code
+      must not be put out */
+
+/*--------------------*/
+
+Boolean Area_segmentIsUnreachable (in Area_Segment segment);
+  /** tells whether <segment> has been removed from its area because
+      it is not reachable from the entry points of the program; in
+      contrast to a folded segment neither it nor its symbols have a
+      valid address */
+
+/*--------------------*/
+
 Target_Address Area_getSize (in Area_Type area);
   /** returns size of <area> */
 
@@ -231,11 +316,66 @@ void Area_addSymbolToSegment (inout Area_Segment *segment,
 
 /*--------------------*/
 
+void Area_addContentToSegment (inout Area_Segment *segment,
+			       in Target_Address offset,
+			       in UINT8 *byteList, in SizeType count);
+  /** records that <segment> contains the <count> code bytes in
+      <byteList> at <offset>; does nothing when contents are not
+      tracked */
+
+/*--------------------*/
+
+void Area_addReferenceToSegment (inout Area_Segment *segment,
+				 in Area_Segment referencedSegment);
+  /** records that code in <segment> references <referencedSegment>
+      (when references are tracked) */
+
+/*--------------------*/
+
+void Area_addReferenceToSymbol (inout Area_Segment *segment,
+				in Symbol_Type symbol);
+  /** records that code in <segment> references <symbol> (when
+      references are tracked) */
+
+/*--------------------*/
+
+void Area_addRelocationToSegment (inout Area_Segment *segment,
+				  in Target_Address offset,
+				  in UINT8 kind, in Object target);
+  /** records that the code bytes of <segment> at <offset> are
+      relocated with relocation <kind> (in external representation)
+      by <target> which is either a symbol or a segment; does nothing
+      when contents are not tracked */
+
+/*--------------------*/
+
+void Area_applyCodeEdits (in Area_Segment segment, in Target_Address offset,
+			  in SizeType length, inout UINT8 *byteList,
+			  inout Boolean *isSignificantList);
+  /** applies all code edits by jump relaxation of <segment> to the
+      <length> (already relocated) code bytes in <byteList> starting
+      at original <offset>: relaxed instructions are put into
+      <byteList> and the flags in <isSignificantList> of bytes
+      dropped are cleared */
+
+/*--------------------*/
+
 void Area_clearListOfSegments (inout Area_Type *area);
   /** removes all segments of <area> */
 
 /*--------------------*/
 
+void Area_foldIdenticalSegments (void);
+  /** removes all segments from their areas having the same size,
+      code bytes and relocations as some other segment in the same
+      area; relocations by the segment itself are considered equal;
+      only relocatable segments completely defined by code bytes and
+      having at least one symbol are folded (because other segments
+      might be reached by falling through); must be called before
+      <Area_link> */
+
+/*--------------------*/
+
 void Area_link (void);
   /** resolves all area addresses by traversing all the areas and the
       associated segments; the address allocation is done depending on
@@ -251,9 +391,58 @@ void Area_link (void);
       areas defined subsequently will be concatenated to the
       previous relocatable area if it does not have a base
       address specified;
+      when best fit placement is active, each run of such
+      concatenated areas is instead put as a unit into the smallest
+      free gap of the memory region (and bank) of the preceding area
+      with a base address; runs are placed by decreasing size, avoid
+      absolute areas and areas with a base address and start on a page
+      boundary when their first area has paged segments;
       additionally the symbols named s_<areaName> and l_<areaName> are
       created to define the starting address and length of each
-      area */
+      area; segments folded by <Area_foldIdenticalSegments> get the
+      address of their replacing segment */
+
+/*--------------------*/
+
+void Area_overlayLocalData (in String_Type areaName);
+  /** overlays the segments of area <areaName> holding local data of
+      code segments which can never be active at the same time; the
+      call graph of the code segments is built from the relocations
+      collected in the first pass (so content tracking must be
+      active): a relocation of a decoded call or jump is a call, a
+      relocation in the interrupt vectors of the platform or any other
+      relocation targeting code makes that code asynchronous (together
+      with all code called by it) and a relocation in other absolute
+      code makes it a root of the main program; each segment of local
+      data referenced by a single synchronous code segment not
+      involved in recursion is placed after the data of all code
+      segments calling it, all other segments keep their own
+      addresses; must be called before <Area_link> */
+
+/*--------------------*/
+
+void Area_relaxJumps (void);
+  /** replaces absolute jumps in relocatable segments by shorter
+      instructions provided by the target platform whenever their
+      target is close enough (in the same area) or at a suitable
+      absolute address; because each relaxation shrinks the code the
+      layout of the areas is recalculated until no more jumps can be
+      relaxed; afterwards the segment sizes, the symbol addresses and
+      the displacements of unrelocated relative jumps are adjusted;
+      only segments completely defined by code bytes which can be
+      decoded as instructions consistent with their relocations are
+      relaxed; must be called before <Area_link> */
+
+/*--------------------*/
+
+void Area_removeUnreferencedSegments (in StringList_Type rootSymbolNameList);
+  /** removes all segments from their areas which are not reachable
+      via the tracked references from the entry points: segments of
+      absolute areas with code and segments defining a symbol in
+      <rootSymbolNameList>; a segment without global symbols is kept
+      whenever some other segment of its module is reachable (because
+      it may only be reached by falling through like initialization
+      code); must be called before <Area_link> */
 
 /*--------------------*/
 
@@ -271,6 +460,25 @@ void Area_setBaseAddresses (in String_Type segmentName,
 
 /*--------------------*/
 
+void Area_setBestFitPlacement (in Boolean isActive);
+  /** sets whether <Area_link> places floating relocatable areas by
+      best fit into the memory regions of the target platform instead
+      of concatenating them */
+
+/*--------------------*/
+
+void Area_setContentTracking (in Boolean isTracked);
+  /** sets whether the code bytes and relocations of segments are
+      collected in the first pass */
+
+/*--------------------*/
+
+void Area_setReferenceTracking (in Boolean isTracked);
+  /** sets whether the references of segments are collected in the
+      first pass */
+
+/*--------------------*/
+
 void Area_setSegmentArea (inout Area_Segment *segment, in Area_Type area);
   /** sets area of <segment> to <area> */
 
@@ -293,5 +501,38 @@ void Area_segmentToString (in Area_Segment segment,
       internal data (for debugging purposes) and concatenates it to
       <representation> */
 
+/*--------------------*/
+
+void Area_writeFoldedSegmentReport (inout File_Type *file);
+  /** writes module, area and size of all segments folded by
+      <Area_foldIdenticalSegments> together with the module of the
+      replacing segment to <file> */
+
+/*--------------------*/
+
+void Area_writeFreeMemoryReport (inout File_Type *file);
+  /** writes the free gaps of all memory region instances used by the
+      best fit placement of <Area_link> to <file>; writes nothing when
+      that placement is not active */
+
+/*--------------------*/
+
+void Area_writeRelaxationReport (inout File_Type *file);
+  /** writes the number of jumps relaxed and of bytes saved by
+      <Area_relaxJumps> per module to <file> */
+
+/*--------------------*/
+
+void Area_writeRemovedSegmentReport (inout File_Type *file);
+  /** writes module, area and size of all segments removed by
+      <Area_removeUnreferencedSegments> to <file> */
+
+/*--------------------*/
+
+void Area_writeStaticOverlayReport (inout File_Type *file);
+  /** writes module, offset and size of all segments overlayed by
+      <Area_overlayLocalData> and the number of bytes saved to
+      <file> */
+
 
 #endif /* __AREA_H */
@@ -23,17 +23,431 @@
 #include "target.h"
 #include "typedescriptor.h"
 
+#include <ctype.h>
+# define CType_isspace isspace
+
+#include <stdio.h>
+# define StdIO_sprintf sprintf
+
+#include <stdlib.h>
+# define StdLib_qsort qsort
+
 /*========================================*/
 
 static Map_Type Banking__moduleNameToBankMap;
   /** map from module name to associated bank (filled from banking
       configuration file) */
 
+static Banking_PlacementKind Banking__placementKind;
+  /** strategy for placing modules without bank assignment in the
+      configuration file */
+
+
+#define Banking__referenceMagicNumber 0x20080401
+
+typedef struct {
+  long magicNumber;
+  Module_Type module;
+  Symbol_Type symbol;
+  UINT32 count;
+} Banking__ReferenceRecord;
+  /** type representing <count> relocations in <module> referencing
+      <symbol> */
+
+typedef Banking__ReferenceRecord *Banking__Reference;
+
+static Object Banking__makeReference (void);
+
+static TypeDescriptor_Record Banking__referenceRecordTDRecord =
+  { /* .objectSize = */ sizeof(Banking__ReferenceRecord),
+    /* .assignmentProc = */ NULL, /* .comparisonProc = */ NULL,
+    /* .constructionProc = */ Banking__makeReference,
+    /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
+    /* .keyValidationProc = */ NULL, /* .name = */ "Banking reference" };
+
+static TypeDescriptor_Type Banking__referenceRecordTypeDescriptor =
+  &Banking__referenceRecordTDRecord;
+  /** variable used for describing the type properties when reference
+      records occur in generic types like lists */
+
+static List_Type Banking__referenceList;
+  /** list of symbol references of all modules (collected from the
+      relocation lines in pass 1 when the placement uses the call
+      graph) */
+
+static Map_Type Banking__symbolToReferenceMap;
+  /** map from symbol to its latest entry in <referenceList> */
+
+
+typedef struct {
+  Target_Bank firstBank;
+  SizeType bankCount;
+  UINT32 bankSize;
+  UINT32 *usedSpaceList;
+  SizeType segmentCount;
+  Area_Segment *segmentArray;
+  IntegerMap_Type moduleToIndexMap;
+} Banking__PlacementProblem;
+  /** type describing the assignment of <segmentCount> unassigned
+      segments in <segmentArray> to <bankCount> banks starting at
+      <firstBank> with <bankSize> bytes each, where <usedSpaceList>
+      tells the bytes already used in each bank by explicitly
+      assigned modules and <moduleToIndexMap> maps a module to the
+      index of its segment */
+
+
+typedef struct {
+  SizeType trampolineCount;
+  UINT32 switchCount;
+  UINT32 profiledSwitchCount;
+} Banking__PlacementCost;
+  /** estimated cost of some placement with the number of symbols
+      needing a trampoline call, the number of references going
+      through a trampoline (each being a bank switch at runtime) and
+      the number of profiled calls going through a trampoline */
+
+static Banking__PlacementCost Banking__packingCost;
+  /** estimated cost of the placement by size only */
+
+static Banking__PlacementCost Banking__callGraphCost;
+  /** estimated cost of the placement by call graph */
+
+static SizeType Banking__trampolineCount;
+  /** number of trampoline calls really generated */
+
+static UINT16 Banking__dispatcherSize;
+  /** number of bytes of the generated dispatcher in the nonbanked
+      code area (zero when there is none) */
+
+static StringList_Type Banking__profileLineList;
+  /** lines of the call count profile file */
+
+static List_Type Banking__profileReferenceList;
+  /** profiled calls as reference records where <module> is the module
+      of the calling symbol, <symbol> the called symbol and <count>
+      the number of calls */
+
+static UINT32 Banking__profileFrameCount;
+  /** number of frames covered by the profile */
+
+static StringList_Type Banking__promotedModuleNameList;
+  /** names of modules moved into the nonbanked area because of the
+      profile */
+
+#define Banking__promotionSizeDivisor 16
+  /** only segments up to a bank size divided by this value are moved
+      into the nonbanked area */
+
+
+typedef struct {
+  SizeType nodeA;
+  SizeType nodeB;
+  UINT32 weight;
+} Banking__Edge;
+  /** undirected edge with <weight> between nodes <nodeA> and <nodeB>
+      (where <nodeA> < <nodeB>) in the module reference graph */
+
+#define Banking__noNode SizeType_max
+  /** node index used for modules not in the reference graph */
+
 /*========================================*/
 /*            INTERNAL ROUTINES           */
 /*========================================*/
 
+static Boolean Banking__clusterSegments (
+				   in Banking__PlacementProblem *problem,
+				   out Target_Bank *bankList);
+static void Banking__destroyProblem (
+				   inout Banking__PlacementProblem *problem);
+static void Banking__evaluatePlacement (
+				   in Banking__PlacementProblem *problem,
+				   in Target_Bank *bankList,
+				   out Banking__PlacementCost *cost);
+static SizeType Banking__findRoot (inout SizeType *parentList,
+				   in SizeType node);
+static UINT32 Banking__getAreaSize (in String_Type areaName);
 static Target_Bank Banking__getBank (in Module_Type module);
+static SizeType Banking__getNode (in Banking__PlacementProblem *problem,
+				  in Module_Type module);
+static Target_Bank Banking__getPlannedBank (
+			       in Banking__PlacementProblem *problem,
+			       in Target_Bank *bankList,
+			       in Module_Type module);
+static UINT32 Banking__getTrampolineCallSize (void);
+static Boolean Banking__isCallTarget (in Symbol_Type symbol,
+				      in Area_Segment segment);
+static Boolean Banking__isInterbankReference (
+			       in Banking__PlacementProblem *problem,
+			       in Target_Bank *bankList,
+			       in Banking__Reference reference);
+static Boolean Banking__isLiveModule (in Module_Type module);
+static void Banking__makeEdgeList (in Banking__PlacementProblem *problem,
+				   out Banking__Edge **edgeList,
+				   out SizeType *edgeCount);
+static void Banking__makeProblem (out Banking__PlacementProblem *problem,
+				  in Area_SegmentList segmentList,
+				  in Map_Type excludedModuleSet);
+static void Banking__makeProfileReferences (void);
+static void Banking__packSegments (in Banking__PlacementProblem *problem,
+				   out Target_Bank *bankList);
+static void Banking__selectPromotedModules (
+			       in Banking__PlacementProblem *problem,
+			       inout Map_Type *promotedModuleSet,
+			       inout StringList_Type *promotedModuleNameList);
+static void Banking__setBankForModuleName (in String_Type moduleName,
+					   in long bank);
+static void Banking__splitIntoWords (in String_Type line,
+				     out StringList_Type *wordList);
+
+/*--------------------*/
+
+static void Banking__assignBanks (void)
+  /** assigns a bank to each module having a segment in the generic
+      banked code area without a bank assignment in the configuration
+      file; the banks are prefilled by the modules with explicit
+      assignment (which are never moved or promoted) and the placement
+      is done by size only, by the module reference graph or
+      additionally by a call count profile depending on the placement
+      kind */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  Area_Type genericBankedArea;
+
+  Area_lookup(&genericBankedArea,
+	      bankingConfiguration->genericBankedCodeAreaName);
+
+  if (genericBankedArea != NULL) {
+    Boolean isProfiled =
+      (Banking__placementKind == Banking_PlacementKind_profile);
+    Boolean usesCallGraph =
+      (isProfiled || Banking__placementKind == Banking_PlacementKind_callGraph);
+    Banking__PlacementProblem packingProblem;
+    Banking__PlacementProblem problem;
+    Banking__PlacementProblem *chosenProblem = &packingProblem;
+    Target_Bank *chosenBankList;
+    Target_Bank *clusteredBankList = NULL;
+    Target_Bank *packedBankList;
+    Map_Type promotedModuleSet =
+      Map_make(TypeDescriptor_plainDataTypeDescriptor);
+    StringList_Type promotedModuleNameList = StringList_make();
+    String_Type moduleName = String_make();
+    Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+    SizeType i;
+
+    Area_getListOfSegments(genericBankedArea, &segmentList);
+    Banking__makeProblem(&packingProblem, segmentList, promotedModuleSet);
+    packedBankList = NEWARRAY(Target_Bank, packingProblem.segmentCount + 1);
+    Banking__packSegments(&packingProblem, packedBankList);
+    chosenBankList = packedBankList;
+
+    if (usesCallGraph) {
+      /* cluster by call graph and take that placement unless it
+	 increases the bank switches */
+      Boolean isClustered;
+      UINT32 packedSwitchCount;
+      UINT32 clusteredSwitchCount;
+
+      if (isProfiled) {
+	Banking__makeProfileReferences();
+      }
+
+      Banking__evaluatePlacement(&packingProblem, packedBankList,
+				 &Banking__packingCost);
+
+      if (isProfiled) {
+	/* move the hottest small modules into the nonbanked area */
+	Banking__selectPromotedModules(&packingProblem, &promotedModuleSet,
+				       &promotedModuleNameList);
+      }
+
+      Banking__makeProblem(&problem, segmentList, promotedModuleSet);
+      clusteredBankList = NEWARRAY(Target_Bank, problem.segmentCount + 1);
+      isClustered = Banking__clusterSegments(&problem, clusteredBankList);
+
+      if (!isClustered) {
+	Banking__packSegments(&problem, clusteredBankList);
+      }
+
+      Banking__evaluatePlacement(&problem, clusteredBankList,
+				 &Banking__callGraphCost);
+
+      if (isProfiled) {
+	packedSwitchCount    = Banking__packingCost.profiledSwitchCount;
+	clusteredSwitchCount = Banking__callGraphCost.profiledSwitchCount;
+      } else {
+	packedSwitchCount    = Banking__packingCost.switchCount;
+	clusteredSwitchCount = Banking__callGraphCost.switchCount;
+      }
+
+      if (clusteredSwitchCount <= packedSwitchCount) {
+	chosenProblem  = &problem;
+	chosenBankList = clusteredBankList;
+	List_copy(&Banking__promotedModuleNameList, promotedModuleNameList);
+      } else {
+	Banking__callGraphCost = Banking__packingCost;
+      }
+    }
+
+    for (i = 0;  i < chosenProblem->segmentCount;  i++) {
+      Module_getName(Area_getSegmentModule(chosenProblem->segmentArray[i]),
+		     &moduleName);
+      Banking__setBankForModuleName(moduleName, chosenBankList[i]);
+    }
+
+    if (usesCallGraph) {
+      Banking__destroyProblem(&problem);
+    }
+
+    Banking__destroyProblem(&packingProblem);
+    DESTROY(clusteredBankList);
+    DESTROY(packedBankList);
+    List_destroy(&segmentList);
+    String_destroy(&moduleName);
+    List_destroy(&promotedModuleNameList);
+    Map_destroy(&promotedModuleSet);
+  }
+}
+
+/*--------------------*/
+
+static Banking__Reference Banking__attemptConversionToReference (
+							 in Object reference)
+  /** verifies that <reference> is really a pointer to a reference
+      record; if not, the program stops with an error message  */
+{
+  return (Banking__Reference) attemptConversion("Banking__Reference",
+						reference,
+						Banking__referenceMagicNumber);
+}
+
+/*--------------------*/
+
+static void Banking__checkNonbankedAreaSize (void)
+  /** checks whether the nonbanked code area (including the generated
+      trampoline calls and dispatcher) fits into its available space
+      and warns if not */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  String_Type nonbankedCodeAreaName =
+    bankingConfiguration->nonbankedCodeAreaName;
+  UINT32 availableSize = bankingConfiguration->nonbankedCodeAreaSize;
+  UINT32 size = Banking__getAreaSize(nonbankedCodeAreaName);
+
+  if (size > availableSize) {
+    Error_raise(Error_Criticality_warning,
+		"nonbanked area %s too large (%lu > %lu bytes)",
+		String_asCharPointer(nonbankedCodeAreaName),
+		size, availableSize);
+  }
+}
+
+/*--------------------*/
+
+static Boolean Banking__clusterSegments (
+				   in Banking__PlacementProblem *problem,
+				   out Target_Bank *bankList)
+  /** assigns a bank to each unassigned segment in <problem> and
+      returns it in <bankList> such that heavily connected modules
+      share a bank: the nodes of the module reference graph are the
+      banks followed by the segments; edges are processed by
+      decreasing weight and the clusters at both ends are merged when
+      they fit into a single bank; remaining clusters without a bank
+      are put by decreasing size into the first bank with enough
+      room; returns false when some cluster does not fit anywhere */
+{
+  SizeType bankCount = problem->bankCount;
+  UINT32 bankSize = problem->bankSize;
+  SizeType nodeCount = bankCount + problem->segmentCount;
+  SizeType *parentList = NEWARRAY(SizeType, nodeCount + 1);
+  UINT32 *usedSpaceList = NEWARRAY(UINT32, nodeCount + 1);
+  SizeType *clusterList = NEWARRAY(SizeType, nodeCount + 1);
+  SizeType clusterCount = 0;
+  Banking__Edge *edgeList;
+  SizeType edgeCount;
+  Boolean isSuccessful = true;
+  SizeType i;
+
+  /* each bank and each segment starts as a cluster of its own */
+  for (i = 0;  i < nodeCount;  i++) {
+    parentList[i] = i;
+
+    if (i < bankCount) {
+      usedSpaceList[i] = problem->usedSpaceList[i];
+    } else {
+      usedSpaceList[i] =
+	Area_getSegmentSize(problem->segmentArray[i - bankCount]);
+    }
+  }
+
+  /* merge clusters along the heaviest edges; the smaller node becomes
+     the root, hence a cluster containing a bank always has this bank
+     as its root and two banks are never merged */
+  Banking__makeEdgeList(problem, &edgeList, &edgeCount);
+
+  for (i = 0;  i < edgeCount;  i++) {
+    SizeType rootA = Banking__findRoot(parentList, edgeList[i].nodeA);
+    SizeType rootB = Banking__findRoot(parentList, edgeList[i].nodeB);
+
+    if (rootA > rootB) {
+      SizeType temp = rootA;
+      rootA = rootB;
+      rootB = temp;
+    }
+
+    if (rootA != rootB && rootB >= bankCount
+	&& usedSpaceList[rootA] + usedSpaceList[rootB] <= bankSize) {
+      parentList[rootB] = rootA;
+      usedSpaceList[rootA] += usedSpaceList[rootB];
+    }
+  }
+
+  /* sort the clusters without bank by decreasing size */
+  for (i = bankCount;  i < nodeCount;  i++) {
+    if (parentList[i] == i) {
+      SizeType j = clusterCount++;
+
+      while (j > 0 && usedSpaceList[clusterList[j - 1]] < usedSpaceList[i]) {
+	clusterList[j] = clusterList[j - 1];
+	j--;
+      }
+
+      clusterList[j] = i;
+    }
+  }
+
+  /* put each of them into the first bank with enough room */
+  for (i = 0;  i < clusterCount;  i++) {
+    SizeType root = clusterList[i];
+    SizeType j = 0;
+
+    while (j < bankCount
+	   && usedSpaceList[j] + usedSpaceList[root] > bankSize) {
+      j++;
+    }
+
+    if (j == bankCount) {
+      isSuccessful = false;
+    } else {
+      parentList[root] = j;
+      usedSpaceList[j] += usedSpaceList[root];
+    }
+  }
+
+  if (isSuccessful) {
+    for (i = 0;  i < problem->segmentCount;  i++) {
+      SizeType root = Banking__findRoot(parentList, bankCount + i);
+      bankList[i] = problem->firstBank + (Target_Bank) root;
+    }
+  }
+
+  DESTROY(edgeList);
+  DESTROY(clusterList);
+  DESTROY(usedSpaceList);
+  DESTROY(parentList);
+  return isSuccessful;
+}
 
 /*--------------------*/
 
@@ -42,6 +456,7 @@ static void Banking__collectInterbankReferences (
 			 out StringList_Type *surrogateNameList,
 			 out StringList_Type *symbolNameList,
 			 out Map_Type *symbolIndexToLabelIndexMap,
+			 out Map_Type *symbolIndexToBankMap,
 			 inout Boolean *interbankReferenceIsFound)
   /** traverses all symbols and checks whether they are used in
       interbank references; each such symbol is split in the symbol
@@ -51,18 +466,19 @@ static void Banking__collectInterbankReferences (
       the surrogates in <surrogateNameList> and the names of the jump
       labels for bank switching in <jumpLabelNameList>;
       <symbolIndexToLabelIndexMap> maps a symbol index to the index of
-      the jump label list where its target bank label occurs;
+      the jump label list where its target bank label occurs,
+      <symbolIndexToBankMap> maps it to its target bank;
       <interbankReferenceIsFound> tells whether some interbank
       reference exists at all */
 {
   Banking_Configuration *bankingConfiguration =
     Target_info.bankingConfiguration;
-  IntegerMap_Type bankToLabelIndexMap =
-    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  IntegerMap_Type labelNameToLabelIndexMap =
+    Map_make(String_typeDescriptor);
   List_Cursor moduleCursor;
   List_Type moduleList = List_make(Module_typeDescriptor);
 
-  Map_clear(&bankToLabelIndexMap);
+  Map_clear(&labelNameToLabelIndexMap);
 
   /* traverse all modules to find interbank references */
   Module_getModuleList(&moduleList);
@@ -76,7 +492,11 @@ static void Banking__collectInterbankReferences (
     List_Cursor symbolCursor;
 
     currentBank = Banking__getBank(module);
-    Module_getSymbolList(module, &moduleSymbolList);
+
+    if (Banking__isLiveModule(module)) {
+      /* references from removed code need no trampoline calls */
+      Module_getSymbolList(module, &moduleSymbolList);
+    }
 
     /* traverse all symbols in the symbol list of module and check
        them for interbank references */
@@ -121,11 +541,11 @@ static void Banking__collectInterbankReferences (
 
 	if (isRelevant) {
 	  /* this is an interbank reference */
+	  String_Type jumpLabelName = String_make();
 	  SizeType labelIndex;
 	  Symbol_Type surrogateSymbol;
 	  String_Type surrogateSymbolName = String_make();
 	  SizeType symbolIndex;
-	  Object targetBankAsObject = (Object) targetBank;
 
 	  *interbankReferenceIsFound = true;
 
@@ -141,28 +561,28 @@ static void Banking__collectInterbankReferences (
 	  StringList_append(symbolNameList, symbolName);
 	  StringList_append(surrogateNameList, surrogateSymbolName);
 	  symbolIndex = List_length(*symbolNameList);
-	  labelIndex = IntegerMap_lookup(bankToLabelIndexMap,
-					 targetBankAsObject);
 
-	  if (labelIndex == IntegerMap_notFound) {
-	    /* there is not yet a jump label for this target bank ==>
-	       make it */
-	    String_Type jumpLabelName = String_make();
+	  /* make the jump label of the target bank unless some
+	     earlier interbank reference has already done so */
+	  bankingConfiguration->makeJumpLabelName(&jumpLabelName, targetBank);
+	  labelIndex = IntegerMap_lookup(labelNameToLabelIndexMap,
+					 jumpLabelName);
 
+	  if (labelIndex == IntegerMap_notFound) {
+	    /* there is not yet such a jump label ==> make it */
 	    labelIndex = List_length(*jumpLabelNameList);
-	    bankingConfiguration->makeJumpLabelName(&jumpLabelName,
-						    targetBank);
 	    StringList_append(jumpLabelNameList, jumpLabelName);
-	    IntegerMap_set(&bankToLabelIndexMap, targetBankAsObject,
+	    IntegerMap_set(&labelNameToLabelIndexMap, jumpLabelName,
 			   labelIndex);
-	    String_destroy(&jumpLabelName);
 	  }
 
-
 	  IntegerMap_set(symbolIndexToLabelIndexMap, (Object) symbolIndex,
 			 labelIndex);
+	  IntegerMap_set(symbolIndexToBankMap, (Object) symbolIndex,
+			 targetBank);
 
 	  String_destroy(&surrogateSymbolName);
+	  String_destroy(&jumpLabelName);
 	}
 
 	String_destroy(&symbolName);
@@ -172,12 +592,164 @@ static void Banking__collectInterbankReferences (
     List_destroy(&moduleSymbolList);
   }
 
-  Map_destroy(&bankToLabelIndexMap);
+  Map_destroy(&labelNameToLabelIndexMap);
   List_destroy(&moduleList);
 }
 
 /*--------------------*/
 
+static int Banking__compareEdgesByNodes (in const void *objectA,
+					 in const void *objectB)
+  /** compares edges <objectA> and <objectB> by their nodes for
+      sorting */
+{
+  const Banking__Edge *edgeA = objectA;
+  const Banking__Edge *edgeB = objectB;
+  int result;
+
+  if (edgeA->nodeA != edgeB->nodeA) {
+    result = (edgeA->nodeA < edgeB->nodeA ? -1 : 1);
+  } else if (edgeA->nodeB != edgeB->nodeB) {
+    result = (edgeA->nodeB < edgeB->nodeB ? -1 : 1);
+  } else {
+    result = 0;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static int Banking__compareEdgesByWeight (in const void *objectA,
+					  in const void *objectB)
+  /** compares edges <objectA> and <objectB> by decreasing weight and
+      then by their nodes for sorting */
+{
+  const Banking__Edge *edgeA = objectA;
+  const Banking__Edge *edgeB = objectB;
+  int result;
+
+  if (edgeA->weight != edgeB->weight) {
+    result = (edgeA->weight > edgeB->weight ? -1 : 1);
+  } else {
+    result = Banking__compareEdgesByNodes(objectA, objectB);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void Banking__destroyProblem (
+				   inout Banking__PlacementProblem *problem)
+  /** frees all data allocated for <problem> */
+{
+  Map_destroy(&problem->moduleToIndexMap);
+  DESTROY(problem->segmentArray);
+  DESTROY(problem->usedSpaceList);
+}
+
+/*--------------------*/
+
+static void Banking__evaluatePlacement (
+				   in Banking__PlacementProblem *problem,
+				   in Target_Bank *bankList,
+				   out Banking__PlacementCost *cost)
+  /** estimates the <cost> of assigning the unassigned segments in
+      <problem> to the banks in <bankList> from the symbol references
+      collected in pass 1 and the profiled calls */
+{
+  Map_Type trampolineSymbolSet =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  List_Cursor referenceCursor;
+
+  cost->trampolineCount = 0;
+  cost->switchCount = 0;
+  cost->profiledSwitchCount = 0;
+
+  for (referenceCursor = List_resetCursor(Banking__referenceList);
+       referenceCursor != NULL;
+       List_advanceCursor(&referenceCursor)) {
+    Banking__Reference reference =
+      Banking__attemptConversionToReference(
+			       List_getElementAtCursor(referenceCursor));
+    Symbol_Type symbol = reference->symbol;
+
+    if (Banking__isInterbankReference(problem, bankList, reference)) {
+      cost->switchCount += reference->count;
+
+      if (Map_lookup(trampolineSymbolSet, symbol) == NULL) {
+	Map_set(&trampolineSymbolSet, symbol, symbol);
+	cost->trampolineCount++;
+      }
+    }
+  }
+
+  for (referenceCursor = List_resetCursor(Banking__profileReferenceList);
+       referenceCursor != NULL;
+       List_advanceCursor(&referenceCursor)) {
+    Banking__Reference reference =
+      Banking__attemptConversionToReference(
+			       List_getElementAtCursor(referenceCursor));
+
+    if (Banking__isInterbankReference(problem, bankList, reference)) {
+      cost->profiledSwitchCount += reference->count;
+    }
+  }
+
+  Map_destroy(&trampolineSymbolSet);
+}
+
+/*--------------------*/
+
+static SizeType Banking__findRoot (inout SizeType *parentList,
+				   in SizeType node)
+  /** returns the root of the cluster containing <node> where
+      <parentList> tells the parent of each node; the paths are
+      shortened on the way */
+{
+  SizeType result = node;
+
+  while (parentList[result] != result) {
+    parentList[result] = parentList[parentList[result]];
+    result = parentList[result];
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static UINT32 Banking__getAreaSize (in String_Type areaName)
+  /** returns the sum of all segment sizes in area with <areaName> or
+      0 when there is no such area; in contrast to <Area_getSize> this
+      also works before linking */
+{
+  Area_Type area;
+  UINT32 result = 0;
+
+  Area_lookup(&area, areaName);
+
+  if (area != NULL) {
+    List_Cursor segmentCursor;
+    Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+
+    Area_getListOfSegments(area, &segmentList);
+
+    for (segmentCursor = List_resetCursor(segmentList);  segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+      result += Area_getSegmentSize(segment);
+    }
+
+    List_destroy(&segmentList);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
 static Target_Bank Banking__getBank (in Module_Type module)
   /** returns associated bank for <module> or <undefinedBank> if none
       exists */
@@ -198,6 +770,435 @@ static Target_Bank Banking__getBank (in Module_Type module)
 
 /*--------------------*/
 
+static SizeType Banking__getNode (in Banking__PlacementProblem *problem,
+				  in Module_Type module)
+  /** returns the node of <module> in the reference graph of
+      <problem>: either its segment offset by the bank count, its
+      explicitly assigned bank or <noNode> when it is not banked */
+{
+  SizeType segmentIndex = IntegerMap_lookup(problem->moduleToIndexMap,
+					    module);
+  SizeType result = Banking__noNode;
+
+  if (segmentIndex != IntegerMap_notFound) {
+    result = problem->bankCount + segmentIndex;
+  } else {
+    Target_Bank bank = Banking__getBank(module);
+
+    if (bank >= problem->firstBank
+	&& bank < problem->firstBank + (Target_Bank) problem->bankCount) {
+      result = (SizeType) (bank - problem->firstBank);
+    }
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static Target_Bank Banking__getPlannedBank (
+			       in Banking__PlacementProblem *problem,
+			       in Target_Bank *bankList,
+			       in Module_Type module)
+  /** returns bank of <module> when the unassigned segments of
+      <problem> are placed according to <bankList> */
+{
+  SizeType segmentIndex = IntegerMap_lookup(problem->moduleToIndexMap,
+					    module);
+  Target_Bank result;
+
+  if (segmentIndex != IntegerMap_notFound) {
+    result = bankList[segmentIndex];
+  } else {
+    result = Banking__getBank(module);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static UINT32 Banking__getTrampolineCallSize (void)
+  /** returns the number of bytes in the nonbanked area needed for a
+      single trampoline call (including its table entry if any) */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+
+  return (bankingConfiguration->offsetPerTrampolineCall
+	  + bankingConfiguration->tableOffsetPerTrampolineCall);
+}
+
+/*--------------------*/
+
+static Boolean Banking__isCallTarget (in Symbol_Type symbol,
+				      in Area_Segment segment)
+  /** tells whether <symbol> in <segment> is a possible target for an
+      interbank call */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  String_Type moduleName = String_make();
+  String_Type segmentName = String_make();
+  String_Type symbolName = String_make();
+  Boolean result;
+
+  Module_getName(Area_getSegmentModule(segment), &moduleName);
+  Area_getSegmentName(segment, &segmentName);
+  Symbol_getName(symbol, &symbolName);
+  result = bankingConfiguration->ensureAsCallTarget(moduleName, segmentName,
+						    symbolName);
+  String_destroy(&symbolName);
+  String_destroy(&segmentName);
+  String_destroy(&moduleName);
+  return result;
+}
+
+/*--------------------*/
+
+static Boolean Banking__isInterbankReference (
+			       in Banking__PlacementProblem *problem,
+			       in Target_Bank *bankList,
+			       in Banking__Reference reference)
+  /** tells whether <reference> needs a trampoline call when the
+      unassigned segments of <problem> are placed according to
+      <bankList> */
+{
+  Symbol_Type symbol = reference->symbol;
+  Area_Segment segment = Symbol_getSegment(symbol);
+  Boolean result = false;
+
+  if (segment != NULL && Banking__isCallTarget(symbol, segment)) {
+    Module_Type targetModule = Area_getSegmentModule(segment);
+    Target_Bank sourceBank =
+      Banking__getPlannedBank(problem, bankList, reference->module);
+    Target_Bank targetBank =
+      Banking__getPlannedBank(problem, bankList, targetModule);
+
+    result = (sourceBank != targetBank
+	      && targetBank != Target_undefinedBank);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static Boolean Banking__isLiveModule (in Module_Type module)
+  /** tells whether <module> still has some nonempty segment which
+      has not been removed as unreferenced */
+{
+  Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+  List_Cursor segmentCursor;
+  Boolean result = false;
+
+  Module_getSegmentList(module, &segmentList);
+
+  for (segmentCursor = List_resetCursor(segmentList);
+       segmentCursor != NULL && !result;
+       List_advanceCursor(&segmentCursor)) {
+    Area_Segment segment = List_getElementAtCursor(segmentCursor);
+    result = (!Area_segmentIsRemoved(segment)
+	      && Area_getSegmentSize(segment) > 0);
+  }
+
+  List_destroy(&segmentList);
+  return result;
+}
+
+/*--------------------*/
+
+static void Banking__makeEdgeList (in Banking__PlacementProblem *problem,
+				   out Banking__Edge **edgeList,
+				   out SizeType *edgeCount)
+  /** returns the edges of the module reference graph of <problem> in
+      <edgeList> with <edgeCount> entries sorted by decreasing weight;
+      the weight of an edge is the number of symbol references plus
+      the number of profiled calls between both nodes in either
+      direction */
+{
+  List_Type referenceListList[2];
+  Banking__Edge *edgeArray;
+  SizeType count = 0;
+  SizeType i;
+
+  referenceListList[0] = Banking__referenceList;
+  referenceListList[1] = Banking__profileReferenceList;
+  edgeArray = NEWARRAY(Banking__Edge,
+		       (List_length(Banking__referenceList)
+			+ List_length(Banking__profileReferenceList) + 1));
+
+  for (i = 0;  i < 2;  i++) {
+    List_Cursor referenceCursor;
+
+    for (referenceCursor = List_resetCursor(referenceListList[i]);
+	 referenceCursor != NULL;
+	 List_advanceCursor(&referenceCursor)) {
+      Banking__Reference reference =
+	Banking__attemptConversionToReference(
+				List_getElementAtCursor(referenceCursor));
+      Area_Segment segment = Symbol_getSegment(reference->symbol);
+
+      if (segment != NULL && Banking__isCallTarget(reference->symbol,
+						   segment)) {
+	SizeType nodeA = Banking__getNode(problem, reference->module);
+	SizeType nodeB = Banking__getNode(problem,
+					  Area_getSegmentModule(segment));
+
+	if (nodeA != Banking__noNode && nodeB != Banking__noNode
+	    && nodeA != nodeB) {
+	  Banking__Edge *edge = &edgeArray[count++];
+	  edge->nodeA  = (nodeA < nodeB ? nodeA : nodeB);
+	  edge->nodeB  = (nodeA < nodeB ? nodeB : nodeA);
+	  edge->weight = reference->count;
+	}
+      }
+    }
+  }
+
+  /* combine parallel edges by adding their weights */
+  StdLib_qsort(edgeArray, count, sizeof(Banking__Edge),
+	       Banking__compareEdgesByNodes);
+
+  if (count > 0) {
+    SizeType j = 0;
+
+    for (i = 1;  i < count;  i++) {
+      if (Banking__compareEdgesByNodes(&edgeArray[i], &edgeArray[j]) == 0) {
+	edgeArray[j].weight += edgeArray[i].weight;
+      } else {
+	edgeArray[++j] = edgeArray[i];
+      }
+    }
+
+    count = j + 1;
+  }
+
+  StdLib_qsort(edgeArray, count, sizeof(Banking__Edge),
+	       Banking__compareEdgesByWeight);
+  *edgeList = edgeArray;
+  *edgeCount = count;
+}
+
+/*--------------------*/
+
+static void Banking__makeProblem (out Banking__PlacementProblem *problem,
+				  in Area_SegmentList segmentList,
+				  in Map_Type excludedModuleSet)
+  /** sets up <problem> for placing all segments in <segmentList>
+      (except for those of modules in <excludedModuleSet>) into the
+      code banks; segments of modules with a bank assignment in the
+      configuration file are not part of the problem but count as
+      used space in their bank */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  Target_Bank firstBank = bankingConfiguration->firstCodeBank;
+  Target_Bank lastBank  = bankingConfiguration->lastCodeBank;
+  String_Type areaName = String_make();
+  List_Cursor segmentCursor;
+  SizeType i;
+
+  problem->firstBank = firstBank;
+  problem->bankCount = (lastBank < firstBank ? 0
+			: (SizeType) (lastBank - firstBank + 1));
+  problem->bankSize = bankingConfiguration->codeBankSize;
+  problem->usedSpaceList = NEWARRAY(UINT32, problem->bankCount + 1);
+  problem->segmentArray = NEWARRAY(Area_Segment, List_length(segmentList) + 1);
+  problem->segmentCount = 0;
+  problem->moduleToIndexMap = Map_make(TypeDescriptor_plainDataTypeDescriptor);
+
+  /* find used space in each bank after the explicit assignments */
+  for (i = 0;  i < problem->bankCount;  i++) {
+    bankingConfiguration->makeBankedCodeAreaName(&areaName,
+						 firstBank + (Target_Bank) i);
+    problem->usedSpaceList[i] = Banking__getAreaSize(areaName);
+  }
+
+  /* collect the unassigned segments in link order */
+  for (segmentCursor = List_resetCursor(segmentList);  segmentCursor != NULL;
+       List_advanceCursor(&segmentCursor)) {
+    Area_Segment segment = List_getElementAtCursor(segmentCursor);
+    Module_Type module = Area_getSegmentModule(segment);
+    Target_Bank bank = Banking__getBank(module);
+
+    if (bank != Target_undefinedBank) {
+      if (bank >= firstBank && bank <= lastBank) {
+	problem->usedSpaceList[bank - firstBank] +=
+	  Area_getSegmentSize(segment);
+      }
+    } else if (Map_lookup(excludedModuleSet, module) == NULL) {
+      IntegerMap_set(&problem->moduleToIndexMap, module,
+		     (long) problem->segmentCount);
+      problem->segmentArray[problem->segmentCount++] = segment;
+    }
+  }
+
+  String_destroy(&areaName);
+}
+
+/*--------------------*/
+
+static void Banking__makeProfileReferences (void)
+  /** converts the lines of the profile file into reference records
+      in <profileReferenceList>; a line either has the form "frames
+      count" or "caller [->] callee count" with symbol names <caller>
+      and <callee>; lines with unknown symbols are ignored */
+{
+  List_Cursor lineCursor;
+  StringList_Type wordList = StringList_make();
+  String_Type framesKeyword = String_makeFromCharArray("FRAMES");
+  String_Type arrow = String_makeFromCharArray("->");
+  String_Type word = String_make();
+  SizeType ignoredLineCount = 0;
+
+  for (lineCursor = List_resetCursor(Banking__profileLineList);
+       lineCursor != NULL;
+       List_advanceCursor(&lineCursor)) {
+    String_Type line = List_getElementAtCursor(lineCursor);
+    SizeType wordCount;
+    long count;
+    Boolean isOkay;
+
+    Banking__splitIntoWords(line, &wordList);
+    wordCount = List_length(wordList);
+    isOkay = (wordCount >= 2
+	      && String_convertToLong(List_getElement(wordList, wordCount),
+				      10, &count)
+	      && count >= 0);
+
+    if (isOkay && wordCount == 4) {
+      isOkay = String_isEqual(List_getElement(wordList, 2), arrow);
+    }
+
+    if (isOkay && wordCount == 2) {
+      String_convertToUpperCase(List_getElement(wordList, 1), &word);
+      isOkay = (String_isEqual(word, framesKeyword) && count > 0);
+
+      if (isOkay) {
+	Banking__profileFrameCount = (UINT32) count;
+      }
+    } else if (isOkay && (wordCount == 3 || wordCount == 4)) {
+      Symbol_Type caller = Symbol_lookup(List_getElement(wordList, 1));
+      Symbol_Type callee = Symbol_lookup(List_getElement(wordList,
+							 wordCount - 1));
+      Area_Segment callerSegment =
+	(caller == NULL ? NULL : Symbol_getSegment(caller));
+
+      isOkay = (callerSegment != NULL && callee != NULL);
+
+      if (isOkay) {
+	Object *objectPtr = List_append(&Banking__profileReferenceList);
+	Banking__Reference reference =
+	  Banking__attemptConversionToReference(*objectPtr);
+	reference->module = Area_getSegmentModule(callerSegment);
+	reference->symbol = callee;
+	reference->count  = (UINT32) count;
+      }
+    } else {
+      isOkay = false;
+    }
+
+    if (!isOkay) {
+      ignoredLineCount++;
+    }
+  }
+
+  if (ignoredLineCount > 0) {
+    Error_raise(Error_Criticality_warning,
+		"%lu lines in profile file ignored (syntax or unknown symbol)",
+		(unsigned long) ignoredLineCount);
+  }
+
+  String_destroy(&word);
+  String_destroy(&arrow);
+  String_destroy(&framesKeyword);
+  List_destroy(&wordList);
+}
+
+/*--------------------*/
+
+static Object Banking__makeReference (void)
+  /** private construction of reference record used when a new entry
+      is created in reference list */
+{
+  Banking__Reference reference = NEW(Banking__ReferenceRecord);
+  reference->magicNumber = Banking__referenceMagicNumber;
+  reference->module = NULL;
+  reference->symbol = NULL;
+  reference->count  = 0;
+  return reference;
+}
+
+/*--------------------*/
+
+static void Banking__packSegments (in Banking__PlacementProblem *problem,
+				   out Target_Bank *bankList)
+  /** assigns a bank to each unassigned segment in <problem> and
+      returns it in <bankList>: the segments are taken by decreasing
+      size and put into the first bank with enough room (first fit
+      decreasing) */
+{
+  SizeType bankCount = problem->bankCount;
+  UINT32 bankSize = problem->bankSize;
+  SizeType segmentCount = problem->segmentCount;
+  UINT32 *freeSpaceList = NEWARRAY(UINT32, bankCount + 1);
+  SizeType *orderList = NEWARRAY(SizeType, segmentCount + 1);
+  SizeType i;
+
+  for (i = 0;  i < bankCount;  i++) {
+    UINT32 usedSpace = problem->usedSpaceList[i];
+    freeSpaceList[i] = (usedSpace >= bankSize ? 0 : bankSize - usedSpace);
+  }
+
+  /* sort the segments by decreasing size; insertion sort is stable
+     and keeps the link order for equal sizes */
+  for (i = 0;  i < segmentCount;  i++) {
+    UINT32 size = Area_getSegmentSize(problem->segmentArray[i]);
+    SizeType j = i;
+
+    while (j > 0
+	   && Area_getSegmentSize(problem->segmentArray[orderList[j - 1]])
+	      < size) {
+      orderList[j] = orderList[j - 1];
+      j--;
+    }
+
+    orderList[j] = i;
+  }
+
+  /* first fit: put each segment into the first bank with enough
+     room */
+  for (i = 0;  i < segmentCount;  i++) {
+    SizeType segmentIndex = orderList[i];
+    Area_Segment segment = problem->segmentArray[segmentIndex];
+    UINT32 size = Area_getSegmentSize(segment);
+    SizeType j = 0;
+
+    while (j < bankCount && freeSpaceList[j] < size) {
+      j++;
+    }
+
+    if (j == bankCount) {
+      String_Type moduleName = String_make();
+
+      Module_getName(Area_getSegmentModule(segment), &moduleName);
+      Error_raise(Error_Criticality_fatalError,
+		  "module %s (%lu bytes) does not fit into any code bank",
+		  String_asCharPointer(moduleName), size);
+      String_destroy(&moduleName);
+    } else {
+      freeSpaceList[j] -= size;
+      bankList[segmentIndex] = problem->firstBank + (Target_Bank) j;
+    }
+  }
+
+  DESTROY(orderList);
+  DESTROY(freeSpaceList);
+}
+
+/*--------------------*/
+
 static void Banking__relocateBankedSegments (void)
   /* loops over all segments in <genericBankedCodeAreaName> and
      relocates them to the correct banked area */
@@ -245,6 +1246,101 @@ static void Banking__relocateBankedSegments (void)
 
 /*--------------------*/
 
+static void Banking__selectPromotedModules (
+			       in Banking__PlacementProblem *problem,
+			       inout Map_Type *promotedModuleSet,
+			       inout StringList_Type *promotedModuleNameList)
+  /** selects modules of unassigned segments in <problem> to be moved
+      into the nonbanked area and adds them to <promotedModuleSet> and
+      their names to <promotedModuleNameList>: small segments called
+      from other modules in the profile are taken by decreasing
+      calls per byte as long as the nonbanked area (including room
+      for the trampoline calls estimated for the placement by size)
+      has space left */
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  SizeType segmentCount = problem->segmentCount;
+  UINT32 maximumSize = (problem->bankSize / Banking__promotionSizeDivisor);
+  UINT32 availableSize = bankingConfiguration->nonbankedCodeAreaSize;
+  UINT32 usedSize =
+    (Banking__getAreaSize(bankingConfiguration->nonbankedCodeAreaName)
+     + Banking__packingCost.trampolineCount
+       * Banking__getTrampolineCallSize());
+  UINT32 freeSize = (usedSize >= availableSize ? 0 : availableSize - usedSize);
+  UINT32 *callCountList = NEWARRAY(UINT32, segmentCount + 1);
+  SizeType *candidateList = NEWARRAY(SizeType, segmentCount + 1);
+  SizeType candidateCount = 0;
+  String_Type moduleName = String_make();
+  List_Cursor referenceCursor;
+  SizeType i;
+
+  /* sum up the calls into each segment from other modules */
+  for (referenceCursor = List_resetCursor(Banking__profileReferenceList);
+       referenceCursor != NULL;
+       List_advanceCursor(&referenceCursor)) {
+    Banking__Reference reference =
+      Banking__attemptConversionToReference(
+			       List_getElementAtCursor(referenceCursor));
+    Area_Segment segment = Symbol_getSegment(reference->symbol);
+
+    if (segment != NULL) {
+      Module_Type targetModule = Area_getSegmentModule(segment);
+      SizeType segmentIndex =
+	IntegerMap_lookup(problem->moduleToIndexMap, targetModule);
+
+      if (segmentIndex != IntegerMap_notFound
+	  && targetModule != reference->module) {
+	callCountList[segmentIndex] += reference->count;
+      }
+    }
+  }
+
+  /* sort the candidates by decreasing calls per byte */
+  for (i = 0;  i < segmentCount;  i++) {
+    UINT32 size = Area_getSegmentSize(problem->segmentArray[i]);
+
+    if (callCountList[i] > 0 && size > 0 && size <= maximumSize) {
+      SizeType j = candidateCount++;
+
+      while (j > 0) {
+	SizeType other = candidateList[j - 1];
+	UINT32 otherSize = Area_getSegmentSize(problem->segmentArray[other]);
+
+	if ((double) callCountList[other] * size
+	    >= (double) callCountList[i] * otherSize) {
+	  break;
+	}
+
+	candidateList[j] = other;
+	j--;
+      }
+
+      candidateList[j] = i;
+    }
+  }
+
+  for (i = 0;  i < candidateCount;  i++) {
+    Area_Segment segment = problem->segmentArray[candidateList[i]];
+    UINT32 size = Area_getSegmentSize(segment);
+
+    if (size <= freeSize) {
+      Module_Type module = Area_getSegmentModule(segment);
+
+      freeSize -= size;
+      Map_set(promotedModuleSet, module, module);
+      Module_getName(module, &moduleName);
+      StringList_append(promotedModuleNameList, moduleName);
+    }
+  }
+
+  String_destroy(&moduleName);
+  DESTROY(candidateList);
+  DESTROY(callCountList);
+}
+
+/*--------------------*/
+
 static void Banking__setBankForModuleName (in String_Type moduleName,
 					   in long bank)
   /** sets bank for module with <moduleName> to <bank> */
@@ -258,18 +1354,51 @@ static void Banking__setBankForModuleName (in String_Type moduleName,
 
 /*--------------------*/
 
+static void Banking__splitIntoWords (in String_Type line,
+				     out StringList_Type *wordList)
+  /** splits <line> at white space and returns the nonempty parts in
+      <wordList> */
+{
+  SizeType length = String_length(line);
+  String_Type word = String_make();
+  SizeType i;
+
+  List_clear(wordList);
+
+  for (i = 1;  i <= length + 1;  i++) {
+    char ch = (i > length ? ' ' : String_getCharacter(line, i));
+
+    if (!CType_isspace(ch)) {
+      String_appendChar(&word, ch);
+    } else if (String_length(word) > 0) {
+      StringList_append(wordList, word);
+      String_clear(&word);
+    }
+  }
+
+  String_destroy(&word);
+}
+
+/*--------------------*/
+
 static void Banking__writeStubFile (in String_Type stubFileName,
 				    in StringList_Type jumpLabelNameList,
 				    in StringList_Type surrogateNameList,
 				    in StringList_Type symbolNameList,
-				    in Map_Type symbolIndexToLabelIndexMap)
+				    in Map_Type symbolIndexToLabelIndexMap,
+				    in Map_Type symbolIndexToBankMap)
   /** generates a temporary object file with all the banking
       definitions; the names of all external symbols are given as
       <symbolNameList>, the name of the surrogates as
       <surrogateNameList> and the names of the jump labels for bank
       switching as <jumpLabelNameList>; <symbolIndexToLabelIndexMap>
       is a map from symbol index to the index of the jump label list
-      where its target bank label occurs */
+      where its target bank label occurs, <symbolIndexToBankMap> a
+      map from symbol index to its target bank; when the platform
+      needs a trampoline table, it follows the trampoline calls and
+      when it needs a dispatcher, this follows the table while the
+      jump from the restart vector to the dispatcher goes into a
+      second (absolute) area */
 {
   char *procName = "Banking__writeStubFile";
   Boolean precondition;
@@ -299,13 +1428,64 @@ static void Banking__writeStubFile (in String_Type stubFileName,
 	= Target_info.bankingConfiguration;
       UINT8 offsetPerTrampolineCall =
 	bankingConfiguration->offsetPerTrampolineCall;
+      Banking_CallTemplateProc makeTrampolineTableCode =
+	bankingConfiguration->makeTrampolineTableCode;
+      Banking_DispatcherTemplateProc makeDispatcherCode =
+	bankingConfiguration->makeDispatcherCode;
+      Boolean hasTable = (makeTrampolineTableCode != NULL);
+      Boolean hasDispatcher = (makeDispatcherCode != NULL);
+      UINT16 tableAddress = (List_length(surrogateNameList)
+			     * offsetPerTrampolineCall);
+      UINT16 dispatcherAddress = (List_length(surrogateNameList)
+				  * Banking__getTrampolineCallSize());
+      String_Type dispatcherCode = String_make();
       List_Cursor stringCursor;
       SizeType totalSymbolCount = (List_length(jumpLabelNameList)
-		  		   + 2 * List_length(surrogateNameList));
+		  		   + 2 * List_length(surrogateNameList)
+				   + (hasTable ? 1 : 0)
+				   + (hasDispatcher ? 1 : 0));
+
+      if (hasDispatcher) {
+	/* make the dispatcher first, because its size is needed for
+	   the area line */
+	UINT16 tableSymbolIndex = (List_length(jumpLabelNameList)
+				   + 2 * List_length(surrogateNameList));
+	SizeType callCount = List_length(symbolNameList);
+	Target_Bank lastBank = 0;
+	UINT16 *jumpLabelSymbolIndexList;
+	SizeType i;
+
+	for (i = 1;  i <= callCount;  i++) {
+	  Target_Bank bank = IntegerMap_lookup(symbolIndexToBankMap,
+					       (Object) (long) i);
+	  lastBank = (bank > lastBank ? bank : lastBank);
+	}
+
+	jumpLabelSymbolIndexList = NEWARRAY(UINT16, lastBank + 1);
+
+	for (i = 0;  i <= (SizeType) lastBank;  i++) {
+	  jumpLabelSymbolIndexList[i] = Banking_noSymbolIndex;
+	}
+
+	/* the jump labels are the first external symbols */
+	for (i = 1;  i <= callCount;  i++) {
+	  Target_Bank bank = IntegerMap_lookup(symbolIndexToBankMap,
+					       (Object) (long) i);
+	  jumpLabelSymbolIndexList[bank] =
+	    (UINT16) IntegerMap_lookup(symbolIndexToLabelIndexMap,
+				       (Object) (long) i);
+	}
+
+	makeDispatcherCode(dispatcherAddress, 0, 1, tableSymbolIndex,
+			   jumpLabelSymbolIndexList, lastBank,
+			   &Banking__dispatcherSize, &dispatcherCode);
+	DESTROY(jumpLabelSymbolIndexList);
+      }
 
       /* write radix and header line */
       File_writeCharArray(&stubCodeFile, "X\nH ");
-      File_writeCharArray(&stubCodeFile, "1 areas ");
+      File_writeCharArray(&stubCodeFile, (hasDispatcher ? "2 areas "
+					  : "1 areas "));
       File_writeHex(&stubCodeFile, totalSymbolCount, 4);
       File_writeCharArray(&stubCodeFile, " global symbols\n");
 
@@ -334,8 +1514,7 @@ static void Banking__writeStubFile (in String_Type stubFileName,
       /* write information about nonbanked code area containing the
 	 definitions of the surrogate symbols */
       {
-	UINT16 jumpTableSize = (List_length(surrogateNameList)
-				* offsetPerTrampolineCall);
+	UINT16 jumpTableSize = dispatcherAddress + Banking__dispatcherSize;
 
 	File_writeCharArray(&stubCodeFile, "A ");
 	File_writeString(&stubCodeFile,
@@ -363,6 +1542,35 @@ static void Banking__writeStubFile (in String_Type stubFileName,
 	  File_writeChar(&stubCodeFile, '\n');
 	  offsetInSegment += offsetPerTrampolineCall;
 	}
+
+	if (hasTable) {
+	  File_writeCharArray(&stubCodeFile, "S ");
+	  File_writeString(&stubCodeFile,
+			   bankingConfiguration->trampolineTableName);
+	  File_writeCharArray(&stubCodeFile, " Def");
+	  File_writeHex(&stubCodeFile, tableAddress, 4);
+	  File_writeChar(&stubCodeFile, '\n');
+	}
+
+	if (hasDispatcher) {
+	  File_writeCharArray(&stubCodeFile, "S ");
+	  File_writeString(&stubCodeFile,
+			   bankingConfiguration->dispatcherName);
+	  File_writeCharArray(&stubCodeFile, " Def");
+	  File_writeHex(&stubCodeFile, dispatcherAddress, 4);
+	  File_writeChar(&stubCodeFile, '\n');
+	}
+      }
+
+      if (hasDispatcher) {
+	/* write the absolute area for the restart vector */
+	File_writeCharArray(&stubCodeFile, "A ");
+	File_writeString(&stubCodeFile,
+			 bankingConfiguration->dispatcherVectorAreaName);
+	File_writeCharArray(&stubCodeFile, " size ");
+	File_writeHex(&stubCodeFile,
+		      bankingConfiguration->dispatcherVectorSize, 4);
+	File_writeCharArray(&stubCodeFile, " flags 8\n");
       }
 
       /* finally write the trampoline call code sequences */
@@ -380,16 +1588,29 @@ static void Banking__writeStubFile (in String_Type stubFileName,
 	  /* all external symbols are in area 0 */
 	  UINT16 referencedAreaIndex = 0;
 	  UINT16 jumpLabelSymbolIndex = 
-	    IntegerMap_lookup(symbolIndexToLabelIndexMap, (Object) i);
+	    IntegerMap_lookup(symbolIndexToLabelIndexMap, (Object) (long) i);
+	  Target_Bank targetBank =
+	    IntegerMap_lookup(symbolIndexToBankMap, (Object) (long) i);
 
 	  bankingConfiguration->makeTrampolineCallCode(offsetInSegment,
 						       referencedAreaIndex,
 						       targetSymbolIndex,
 						       jumpLabelSymbolIndex,
+						       targetBank,
 						       &codeSequence);
-
 	  File_writeString(&stubCodeFile, codeSequence);
 
+	  if (hasTable) {
+	    /* the table entries follow all trampoline calls */
+	    UINT16 entryAddress = (tableAddress
+				   + (i - 1) * bankingConfiguration
+				                ->tableOffsetPerTrampolineCall);
+	    makeTrampolineTableCode(entryAddress, referencedAreaIndex,
+				    targetSymbolIndex, jumpLabelSymbolIndex,
+				    targetBank, &codeSequence);
+	    File_writeString(&stubCodeFile, codeSequence);
+	  }
+
 	  targetSymbolIndex++;
 	  surrogateSymbolIndex++;
 	  offsetInSegment += offsetPerTrampolineCall;
@@ -398,6 +1619,9 @@ static void Banking__writeStubFile (in String_Type stubFileName,
 	String_destroy(&codeSequence);
       }
 
+      File_writeString(&stubCodeFile, dispatcherCode);
+      String_destroy(&dispatcherCode);
+
       /* we're done */
       File_close(&stubCodeFile);
     }
@@ -415,12 +1639,28 @@ static void Banking__writeStubFile (in String_Type stubFileName,
 void Banking_initialize (void)
 {
   Banking__moduleNameToBankMap = Map_make(String_typeDescriptor);
+  Banking__placementKind = Banking_PlacementKind_manual;
+  Banking__referenceList = List_make(Banking__referenceRecordTypeDescriptor);
+  Banking__symbolToReferenceMap =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  Banking__trampolineCount = 0;
+  Banking__dispatcherSize = 0;
+  Banking__profileLineList = StringList_make();
+  Banking__profileReferenceList =
+    List_make(Banking__referenceRecordTypeDescriptor);
+  Banking__profileFrameCount = 1;
+  Banking__promotedModuleNameList = StringList_make();
 }
 
 /*--------------------*/
 
 void Banking_finalize (void)
 {
+  List_destroy(&Banking__promotedModuleNameList);
+  List_destroy(&Banking__profileReferenceList);
+  List_destroy(&Banking__profileLineList);
+  Map_destroy(&Banking__symbolToReferenceMap);
+  List_destroy(&Banking__referenceList);
   Map_destroy(&Banking__moduleNameToBankMap);
 }
 
@@ -456,6 +1696,15 @@ Boolean Banking_isActive (void)
 
 /*--------------------*/
 
+Boolean Banking_isTrackingReferences (void)
+{
+  return (Banking_isActive()
+	  && (Banking__placementKind == Banking_PlacementKind_callGraph
+	      || Banking__placementKind == Banking_PlacementKind_profile));
+}
+
+/*--------------------*/
+
 Target_Bank Banking_getModuleBank (in String_Type moduleName)
 {
   Object bankPtr = Map_lookup(Banking__moduleNameToBankMap, moduleName);
@@ -468,10 +1717,54 @@ Target_Bank Banking_getModuleBank (in String_Type moduleName)
   return result;
 }
 
+/*--------------------*/
+
+void Banking_getJumpLabelNames (out StringList_Type *labelNameList)
+{
+  Banking_Configuration *bankingConfiguration =
+    Target_info.bankingConfiguration;
+  String_Type labelName = String_make();
+  Target_Bank bank;
+
+  List_clear(labelNameList);
+
+  for (bank = bankingConfiguration->firstCodeBank;
+       bank <= bankingConfiguration->lastCodeBank;  bank++) {
+    bankingConfiguration->makeJumpLabelName(&labelName, bank);
+    StringList_append(labelNameList, labelName);
+  }
+
+  String_destroy(&labelName);
+}
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+void Banking_addSymbolReference (in Module_Type module,
+				 in Symbol_Type symbol)
+{
+  if (symbol != NULL) {
+    Banking__Reference reference =
+      Map_lookup(Banking__symbolToReferenceMap, symbol);
+
+    if (reference == NULL || reference->module != module) {
+      /* modules are parsed one after the other, hence the latest
+	 reference record for symbol is the one for this module (if
+	 any) */
+      Object *objectPtr = List_append(&Banking__referenceList);
+      reference = Banking__attemptConversionToReference(*objectPtr);
+      reference->module = module;
+      reference->symbol = symbol;
+      Map_set(&Banking__symbolToReferenceMap, symbol, reference);
+    }
+
+    reference->count++;
+  }
+}
+
+/*--------------------*/
+
 void Banking_readConfigurationFile (in String_Type fileName)
 {
   Boolean fileIsOpen;
@@ -515,6 +1808,46 @@ void Banking_readConfigurationFile (in String_Type fileName)
 
 /*--------------------*/
 
+void Banking_readProfileFile (in String_Type fileName)
+{
+  Boolean fileIsOpen;
+  File_Type profileFile;
+  char commentChar = ';';
+
+  fileIsOpen = File_open(&profileFile, fileName, File_Mode_read);
+
+  if (!fileIsOpen) {
+    Error_raise(Error_Criticality_fatalError,
+		"cannot open profile file %s", String_asCharPointer(fileName));
+  } else {
+    /* keep the lines, they are interpreted when the symbols are
+       known */
+    String_Type currentLine = String_make();
+    Boolean isDone = false;
+
+    while (!isDone) {
+      File_readLine(&profileFile, &currentLine);
+
+      if (String_length(currentLine) == 0) {
+	isDone = true;
+      } else if (String_getCharacter(currentLine, 1) == commentChar) {
+	/* ignore comment line */
+      } else {
+	String_removeTrailingCrLf(&currentLine);
+
+	if (String_length(currentLine) > 0) {
+	  StringList_append(&Banking__profileLineList, currentLine);
+	}
+      }
+    }
+
+    String_destroy(&currentLine);
+    File_close(&profileFile);
+  }
+}
+
+/*--------------------*/
+
 Boolean Banking_resolveInterbankReferences (inout StringList_Type *fileList)
 {
   Boolean interbankReferenceIsFound = false;
@@ -522,10 +1855,20 @@ Boolean Banking_resolveInterbankReferences (inout StringList_Type *fileList)
   if (Banking_isActive()) {
     Map_Type symbolIndexToLabelIndexMap =
       Map_make(TypeDescriptor_plainDataTypeDescriptor);
+    Map_Type symbolIndexToBankMap =
+      Map_make(TypeDescriptor_plainDataTypeDescriptor);
     StringList_Type jumpLabelNameList = StringList_make();
     StringList_Type surrogateNameList = StringList_make();
     StringList_Type symbolNameList = StringList_make();
-    
+    Boolean placementIsAutomatic =
+      (Banking__placementKind != Banking_PlacementKind_manual);
+
+    if (placementIsAutomatic) {
+      /* assign banks to all modules not assigned in the configuration
+	 file */
+      Banking__assignBanks();
+    }
+
     /* loop over all segments belonging to <genericBankedCodeAreaName>
        and relocate them to the correct banked area */
     Banking__relocateBankedSegments();
@@ -535,26 +1878,164 @@ Boolean Banking_resolveInterbankReferences (inout StringList_Type *fileList)
     Banking__collectInterbankReferences(&jumpLabelNameList, &surrogateNameList,
 					&symbolNameList,
 					&symbolIndexToLabelIndexMap,
+					&symbolIndexToBankMap,
 					&interbankReferenceIsFound);
 
+    Banking__trampolineCount = List_length(surrogateNameList);
+    Banking__dispatcherSize = 0;
+
     if (interbankReferenceIsFound) {
       /* generate a temporary object file with all the banking
 	 definitions */
       String_Type stubFileName = String_makeFromCharArray("c:/tmp/xxx.o");
       Banking__writeStubFile(stubFileName, jumpLabelNameList,
 			     surrogateNameList, symbolNameList,
-			     symbolIndexToLabelIndexMap);
+			     symbolIndexToLabelIndexMap, symbolIndexToBankMap);
 
       Parser_parseObjectFile(true, stubFileName);
       StringList_append(fileList, stubFileName);
       String_destroy(&stubFileName);
     }
 
+    if (placementIsAutomatic) {
+      Banking__checkNonbankedAreaSize();
+    }
+
     List_destroy(&symbolNameList);
     List_destroy(&surrogateNameList);
     List_destroy(&jumpLabelNameList);
+    Map_destroy(&symbolIndexToBankMap);
     Map_destroy(&symbolIndexToLabelIndexMap);
   }
 
   return interbankReferenceIsFound;
 }
+
+/*--------------------*/
+
+void Banking_setPlacementKind (in Banking_PlacementKind kind)
+{
+  Banking__placementKind = kind;
+}
+
+/*--------------------*/
+/* CONVERSION         */
+/*--------------------*/
+
+void Banking_writePlacementReport (inout File_Type *file)
+{
+  if (Banking_isActive()
+      && Banking__placementKind != Banking_PlacementKind_manual) {
+    Banking_Configuration *bankingConfiguration =
+      Target_info.bankingConfiguration;
+    UINT32 bankSize = bankingConfiguration->codeBankSize;
+    String_Type areaName = String_make();
+    Target_Bank bank;
+    char line[80];
+
+    File_writeCharArray(file, "\nCode Bank Fill Ratios\n\n");
+    File_writeCharArray(file, "Bank      Used      Free  Fill\n");
+    File_writeCharArray(file, "-----  --------  --------  ----\n");
+
+    for (bank = bankingConfiguration->firstCodeBank;
+	 bank <= bankingConfiguration->lastCodeBank;  bank++) {
+      Area_Type area;
+      UINT32 usedSize = 0;
+      UINT32 freeSize;
+
+      bankingConfiguration->makeBankedCodeAreaName(&areaName, bank);
+      Area_lookup(&area, areaName);
+
+      if (area != NULL) {
+	usedSize = Area_getSize(area);
+      }
+
+      freeSize = (usedSize >= bankSize ? 0 : bankSize - usedSize);
+      StdIO_sprintf(line, "%5d  %8lu  %8lu  %3lu%%\n", bank, usedSize,
+		    freeSize, (usedSize * 100UL) / bankSize);
+      File_writeCharArray(file, line);
+    }
+
+    if (Banking__placementKind != Banking_PlacementKind_packing) {
+      File_writeCharArray(file, "\nInterbank References\n\n");
+      File_writeCharArray(file,
+			  "Placement      Trampolines  Switches\n");
+      File_writeCharArray(file,
+			  "-------------  -----------  --------\n");
+      StdIO_sprintf(line, "size only      %11lu  %8lu\n",
+		    (unsigned long) Banking__packingCost.trampolineCount,
+		    Banking__packingCost.switchCount);
+      File_writeCharArray(file, line);
+      StdIO_sprintf(line, "%-13s  %11lu  %8lu\n",
+		    (Banking__placementKind == Banking_PlacementKind_profile
+		     ? "profile" : "call graph"),
+		    (unsigned long) Banking__callGraphCost.trampolineCount,
+		    Banking__callGraphCost.switchCount);
+      File_writeCharArray(file, line);
+      StdIO_sprintf(line, "\n%lu trampoline calls generated; switches"
+		    " count static references\n",
+		    (unsigned long) Banking__trampolineCount);
+      File_writeCharArray(file, line);
+    }
+
+    if (Banking__placementKind == Banking_PlacementKind_profile) {
+      UINT32 frameCount = Banking__profileFrameCount;
+      List_Cursor nameCursor;
+
+      File_writeCharArray(file, "\nProfiled Bank Switches per Frame\n\n");
+      StdIO_sprintf(line, "size only      %8lu.%02lu\n",
+		    Banking__packingCost.profiledSwitchCount / frameCount,
+		    ((Banking__packingCost.profiledSwitchCount % frameCount)
+		     * 100UL / frameCount));
+      File_writeCharArray(file, line);
+      StdIO_sprintf(line, "profile        %8lu.%02lu\n",
+		    Banking__callGraphCost.profiledSwitchCount / frameCount,
+		    ((Banking__callGraphCost.profiledSwitchCount % frameCount)
+		     * 100UL / frameCount));
+      File_writeCharArray(file, line);
+
+      if (List_length(Banking__promotedModuleNameList) > 0) {
+	File_writeCharArray(file, "\nModules Moved to Nonbanked Area\n\n");
+
+	for (nameCursor = List_resetCursor(Banking__promotedModuleNameList);
+	     nameCursor != NULL;
+	     List_advanceCursor(&nameCursor)) {
+	  String_Type moduleName = List_getElementAtCursor(nameCursor);
+	  File_writeString(file, moduleName);
+	  File_writeChar(file, '\n');
+	}
+      }
+    }
+
+    String_destroy(&areaName);
+  }
+
+  if (Banking_isActive() && Banking__trampolineCount > 0) {
+    Banking_Configuration *bankingConfiguration =
+      Target_info.bankingConfiguration;
+    unsigned long callCount = (unsigned long) Banking__trampolineCount;
+    long standardCycles =
+      bankingConfiguration->standardCyclesPerTrampolineCall;
+    long cycles = bankingConfiguration->cyclesPerTrampolineCall;
+    long standardSize =
+      callCount * bankingConfiguration->standardOffsetPerTrampolineCall;
+    long size = (callCount * Banking__getTrampolineCallSize()
+		 + Banking__dispatcherSize);
+    char line[80];
+
+    File_writeCharArray(file, "\nTrampoline Calls\n\n");
+    File_writeCharArray(file, "Variant     Calls     Bytes  Cycles/Call\n");
+    File_writeCharArray(file, "--------  -------  --------  -----------\n");
+    StdIO_sprintf(line, "%-8s  %7lu  %8ld  %11ld\n", "standard",
+		  callCount, standardSize, standardCycles);
+    File_writeCharArray(file, line);
+    StdIO_sprintf(line, "%-8s  %7lu  %8ld  %11ld\n",
+		  bankingConfiguration->trampolineStrategyName,
+		  callCount, size, cycles);
+    File_writeCharArray(file, line);
+    StdIO_sprintf(line, "\n%ld bytes of ROM and %ld cycles per call saved"
+		  " (negative values are costs)\n",
+		  standardSize - size, standardCycles - cycles);
+    File_writeCharArray(file, line);
+  }
+}
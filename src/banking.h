@@ -49,6 +49,26 @@
     The variable is set when the target platform plugin is
     initialized.  When banking is not used, the variable is null.
 
+    Modules not assigned to a bank by the configuration file normally
+    go to the nonbanked area.  Alternatively an automatic placement
+    may be selected: then after the first pass those modules are
+    distributed over the available code banks by the sizes of their
+    generic banked segments; the resulting fill ratio of the banks can
+    be written to the map file.  The placement may also take the
+    module reference graph into account (built from the relocations
+    in pass 1), such that modules calling each other often share a
+    bank and need no trampoline calls.  Finally a call count profile
+    (e.g. from an emulator) may weight those references and tell
+    which small modules should go to the nonbanked area.
+
+    The platform may offer several variants of trampoline calls
+    (e.g. smaller ones sharing a common dispatcher); the configuration
+    variable then describes the selected one and the map file tells
+    the code bytes and cycles compared to the standard variant.  A
+    common dispatcher is generated into the temporary object file
+    together with its entry from a restart vector; it hands over to
+    the same bank switch glue code as the standard trampoline calls.
+
     Original version by Thomas Tensi, 2008-04
 */
 
@@ -58,6 +78,7 @@
 /*========================================*/
 
 #include "globdefs.h"
+#include "file.h"
 #include "string.h"
 #include "stringlist.h"
 
@@ -68,22 +89,27 @@ typedef int Target_Bank;
   typedef struct Module__Record *Module_Type;
 #endif
 
+#ifndef Symbol_Type
+  typedef struct Symbol__Record *Symbol_Type;
+#endif
+
 /*========================================*/
 
 typedef void (*Banking_CallTemplateProc) (in UINT16 startAddress,
 					  in UINT16 referencedAreaIndex,
 					  in UINT16 targetSymbolIndex,
 					  in UINT16 jumpLabelSymbolIndex,
+					  in Target_Bank targetBank,
 					  out String_Type *codeSequence);
   /** routine type for constructing the code for a trampoline call in
       the nonbanked code area; the start address of the code within
       the segment is given as <startAddress>, the target symbol is
       given by <targetSymbolIndex> in area with index
       <referencedAreaIndex> and the jump label symbol as index
-      <jumpLabelSymbolIndex> in the same area; the routine returns
-      several code lines in <codeSequence>: a T line with the call and
-      a relocation line referencing the target symbol and the bank
-      switch label
+      <jumpLabelSymbolIndex> in the same area; <targetBank> is the
+      bank of the target symbol; the routine returns several code
+      lines in <codeSequence>: a T line with the call and a relocation
+      line referencing the target symbol and the bank switch label
 
       e.g. in the GBZ80 implementation for a call to routine XYZ in
       bank 23 the following trampoline call code (in assembler
@@ -95,7 +121,37 @@ typedef void (*Banking_CallTemplateProc) (in UINT16 startAddress,
       is used and a reference to "Banking_switchTo_23" in banked area
       23; the code sequence effectively consists of six bytes (a 16
       bit load and an absolute jump) represented by a pair of a T and
-      R line */
+      R line
+
+      the same routine type is used for constructing the entry of a
+      trampoline call in a table following all trampoline calls; then
+      <startAddress> is the address of the entry */
+
+
+#define Banking_noSymbolIndex 0xFFFF
+  /** symbol index telling that there is no symbol */
+
+
+typedef void (*Banking_DispatcherTemplateProc) (
+				  in UINT16 startAddress,
+				  in UINT16 referencedAreaIndex,
+				  in UINT16 vectorAreaIndex,
+				  in UINT16 tableSymbolIndex,
+				  in UINT16 *jumpLabelSymbolIndexList,
+				  in Target_Bank lastBank,
+				  out UINT16 *codeSize,
+				  out String_Type *codeSequence);
+  /** routine type for constructing the dispatcher shared by all
+      trampoline calls at <startAddress> in the nonbanked code area
+      with index <referencedAreaIndex> and the jump to it from a
+      restart vector in the absolute area with index
+      <vectorAreaIndex>; <tableSymbolIndex> is the symbol index of the
+      trampoline table (if any) and <jumpLabelSymbolIndexList> tells
+      for each bank up to <lastBank> the symbol index of its jump
+      label (or <Banking_noSymbolIndex> when no trampoline call goes
+      to that bank); the routine returns the number of bytes in the
+      nonbanked code area in <codeSize> and the T and R lines in
+      <codeSequence> */
 
 
 typedef void (*Banking_NameConstructionProc) (out String_Type *name,
@@ -147,8 +203,68 @@ typedef struct {
   UINT8 offsetPerTrampolineCall;
     /** number of code bytes used for the trampoline call (which is
         fixed, because no code relaxation will occur) */
+  Banking_CallTemplateProc makeTrampolineTableCode;
+    /** template routine for constructing the entry of a trampoline
+        call in a table following all trampoline calls (NULL when the
+        trampoline calls need no table) */
+  String_Type trampolineTableName;
+    /** name of the symbol defined at the start of the trampoline
+        table (only used when there is a table) */
+  UINT8 tableOffsetPerTrampolineCall;
+    /** number of table bytes used per trampoline call (zero when
+        there is no table) */
+  Banking_DispatcherTemplateProc makeDispatcherCode;
+    /** template routine for constructing the dispatcher shared by
+        all trampoline calls (NULL when the trampoline calls jump to
+        the jump labels directly) */
+  String_Type dispatcherName;
+    /** name of the symbol defined at the start of the dispatcher
+        (only used when there is a dispatcher) */
+  String_Type dispatcherVectorAreaName;
+    /** name of the absolute area with the jump from the restart
+        vector to the dispatcher (only used when there is a
+        dispatcher) */
+  UINT8 dispatcherVectorSize;
+    /** number of bytes in the dispatcher vector area */
+  char *trampolineStrategyName;
+    /** name of the trampoline call variant for the map file */
+  UINT8 cyclesPerTrampolineCall;
+    /** number of processor cycles spent per call from the start of
+        the trampoline call until the jump label of the target bank
+        is reached (including a dispatcher, excluding the glue code
+        for the bank switch common to all variants) */
+  UINT8 standardOffsetPerTrampolineCall;
+    /** number of code bytes of the standard trampoline call of the
+        platform (as a reference for the map file) */
+  UINT8 standardCyclesPerTrampolineCall;
+    /** number of processor cycles of the standard trampoline call of
+        the platform counted like <cyclesPerTrampolineCall> (as a
+        reference for the map file) */
+  Target_Bank firstCodeBank;
+    /** lowest bank available for banked code */
+  Target_Bank lastCodeBank;
+    /** highest bank available for banked code */
+  UINT32 codeBankSize;
+    /** number of code bytes available in a single code bank */
+  UINT32 nonbankedCodeAreaSize;
+    /** number of code bytes available in the nonbanked code area
+        (including the trampoline calls) */
 } Banking_Configuration;
 
+
+typedef enum {
+  Banking_PlacementKind_manual, Banking_PlacementKind_packing,
+  Banking_PlacementKind_callGraph, Banking_PlacementKind_profile
+} Banking_PlacementKind;
+  /** strategy for modules not assigned to a bank by the configuration
+      file: <manual> puts them into the nonbanked area, <packing>
+      distributes them over the code banks by decreasing segment size
+      into the first bank with enough room, <callGraph> puts modules
+      referencing each other often into the same bank (based on the
+      relocations found in pass 1), <profile> additionally weights
+      the references by a call count profile and moves frequently
+      called small modules into the nonbanked area */
+
 /*========================================*/
 
 /*--------------------*/
@@ -180,14 +296,34 @@ Boolean Banking_isActive (void);
 
 /*--------------------*/
 
+Boolean Banking_isTrackingReferences (void);
+  /** tells whether symbol references must be reported via
+      <addSymbolReference> during pass 1 */
+
+/*--------------------*/
+
 Target_Bank Banking_getModuleBank (in String_Type moduleName);
   /** returns associated bank for module given by <moduleName> or
       <undefinedBank> if none exists */
 
+/*--------------------*/
+
+void Banking_getJumpLabelNames (out StringList_Type *labelNameList);
+  /** returns the jump labels for bank switching of all code banks in
+      <labelNameList>; the trampoline calls referencing them are only
+      generated when the interbank references are resolved */
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+void Banking_addSymbolReference (in Module_Type module,
+				 in Symbol_Type symbol);
+  /** records that a relocation in <module> references <symbol> (used
+      for building the module reference graph) */
+
+/*--------------------*/
+
 void Banking_readConfigurationFile (in String_Type fileName);
   /** reads assignments of module to bank from file given by
       <fileName>; the file consists of lines of assignments
@@ -195,10 +331,40 @@ void Banking_readConfigurationFile (in String_Type fileName);
 
 /*--------------------*/
 
+void Banking_readProfileFile (in String_Type fileName);
+  /** reads call counts from file given by <fileName>; the file
+      consists of lines "caller -> callee count" with symbol names
+      (the arrow is optional) and an optional line "frames count"
+      telling the number of frames covered by the profile */
+
+/*--------------------*/
+
 Boolean Banking_resolveInterbankReferences (inout StringList_Type *fileList);
   /** traverses symbol list for interbank references; if such are
       found, a temporary object file is generated containing the
       trampoline code and its name is added to <fileList>; returns
-      false when no interbank reference has occured */
+      false when no interbank reference has occured; when automatic
+      placement is active, the unassigned modules are assigned to
+      banks before */
+
+/*--------------------*/
+
+void Banking_setPlacementKind (in Banking_PlacementKind kind);
+  /** sets strategy for placing modules not assigned to a bank by the
+      configuration file to <kind> */
+
+/*--------------------*/
+/* CONVERSION         */
+/*--------------------*/
+
+void Banking_writePlacementReport (inout File_Type *file);
+  /** writes the used and free bytes of all code banks to <file> when
+      automatic placement is active (after linking); for a placement
+      by call graph also the estimated trampolines and bank switches
+      with and without using the call graph are written, for a
+      placement by profile also the projected bank switches per frame
+      and the modules moved into the nonbanked area; whenever
+      trampoline calls have been generated, their code bytes and
+      cycles are compared with the standard trampoline call */
     
 #endif /* __BANKING_H */
@@ -23,6 +23,10 @@
 #include "list.h"
 #include "stringlist.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 /*========================================*/
 
 typedef struct {
@@ -45,6 +49,16 @@ static CodeOutput__StreamDescriptor
 static Boolean CodeOutput__targetIsBigEndian;
   /** tells whether target platform is big endian */
 
+static Boolean CodeOutput__isActive;
+  /** tells whether code output streams are created */
+
+static Boolean CodeOutput__isPatching;
+  /** tells whether the files of code output streams are patched in
+      place instead of being rewritten */
+
+#define CodeOutput__maxErasureLength 128
+  /** maximum number of bytes reset by a single erasure sequence */
+
 /*========================================*/
 /*            INTERNAL ROUTINES           */
 /*========================================*/
@@ -70,9 +84,10 @@ void CodeOutput__writeToAllStreams (in CodeOutput_State state,
   /** depending on <state> either puts out code sequence <sequence>
       processed by linker (when <state> is <isCode>) or the beginning
       or terminating sequence (when <state> is <atBegin> or <atEnd>)
-      to all currently open code output streams; when <state> is
-      <atEnd> also the streams are closed and all descriptors are set
-      to unused */
+      to all currently open code output streams (or resets the range of
+      <sequence> when <state> is <atErase>); when <state> is <atEnd>
+      also the streams are closed and all descriptors are set to
+      unused */
 {
   UINT8 i;
 
@@ -109,6 +124,8 @@ void CodeOutput_initialize (in Boolean targetIsBigEndian)
   UINT8 i;
 
   CodeOutput__targetIsBigEndian = targetIsBigEndian;
+  CodeOutput__isActive = true;
+  CodeOutput__isPatching = false;
 
   for (i = 0;  i < CodeOutput__maxStreamCount;  i++) {
     CodeOutput__StreamDescriptor *currentDescriptor;
@@ -163,12 +180,14 @@ Boolean CodeOutput_create (in String_Type fileName,
     }
   }
 
-  if (isOkay) {
+  if (isOkay && CodeOutput__isActive) {
     /* try to open the file for writing */
-    isOkay = File_open(&file, fileName, File_Mode_writeBinary);
+    isOkay = File_open(&file, fileName,
+		       (CodeOutput__isPatching ? File_Mode_updateBinary
+			: File_Mode_writeBinary));
   }
 
-  if (isOkay) {
+  if (isOkay && CodeOutput__isActive) {
     CodeSequence_Type junk;
 
     junk.length = 0;
@@ -216,11 +235,102 @@ void CodeOutput_getFileNames (out StringList_Type *fileNameList)
   }
 }
 
+/*--------------------*/
+
+Boolean CodeOutput_isActive (void)
+{
+  return CodeOutput__isActive;
+}
+
+/*--------------------*/
+
+Boolean CodeOutput_isPatching (void)
+{
+  return CodeOutput__isPatching;
+}
+
+
+/*--------------------*/
+/* MEASUREMENT        */
+/*--------------------*/
+
+UINT32 CodeOutput_byteSum (in UINT8 *data, in SizeType length)
+{
+  UINT32 result = 0;
+  SizeType i = 0;
+
+#ifdef __AVX2__
+  {
+    /* sum up 32 bytes at once: the sum of absolute differences
+       against zero yields four 64 bit partial sums per block */
+    __m256i zero = _mm256_setzero_si256();
+    __m256i partialSums = zero;
+    unsigned long long laneList[4];
+
+    for (;  i + 32 <= length;  i += 32) {
+      __m256i block = _mm256_loadu_si256((const __m256i *) &data[i]);
+      partialSums = _mm256_add_epi64(partialSums,
+				     _mm256_sad_epu8(block, zero));
+    }
+
+    _mm256_storeu_si256((__m256i *) laneList, partialSums);
+    result = (UINT32) (laneList[0] + laneList[1]
+		       + laneList[2] + laneList[3]);
+  }
+#endif
+
+  for (;  i + 4 <= length;  i += 4) {
+    result += (UINT32) data[i] + data[i + 1] + data[i + 2] + data[i + 3];
+  }
+
+  for (;  i < length;  i++) {
+    result += data[i];
+  }
+
+  return result;
+}
+
 
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+void CodeOutput_eraseRange (in Target_Bank romBank, in UINT32 address,
+			    in UINT32 length)
+{
+  CodeSequence_Type sequence;
+
+  sequence.segment = NULL;
+  sequence.romBank = romBank;
+
+  while (length > 0) {
+    UINT32 count = (length > CodeOutput__maxErasureLength
+		    ? CodeOutput__maxErasureLength : length);
+
+    sequence.offsetAddress = address;
+    sequence.length = (UINT8) count;
+    CodeOutput__writeToAllStreams(CodeOutput_State_atErase, sequence);
+    address += count;
+    length  -= count;
+  }
+}
+
+/*--------------------*/
+
+void CodeOutput_setActive (in Boolean isActive)
+{
+  CodeOutput__isActive = isActive;
+}
+
+/*--------------------*/
+
+void CodeOutput_setPatching (in Boolean isPatching)
+{
+  CodeOutput__isPatching = isPatching;
+}
+
+/*--------------------*/
+
 void CodeOutput_writeLine (in CodeSequence_Type sequence)
 {
   CodeOutput__writeToAllStreams(CodeOutput_State_inCode, sequence);
@@ -274,11 +384,8 @@ void CodeOutput_writeIHXLine (inout File_Type *file, in CodeOutput_State state,
       /* finally output checksum */
       checkSum = sequence.length;
       checkSum = checkSum + CodeOutput__checkSum(sequence.offsetAddress);
-      
-      for (i = 0;  i < sequence.length;  i++) {
-	checkSum = checkSum + sequence.byteList[i];
-      }
-      
+      checkSum = checkSum + (UINT8) CodeOutput_byteSum(sequence.byteList,
+						       sequence.length);
       checkSum = ((0 - checkSum) & 0xFF);
       File_writeHex(file, checkSum, 2);
       File_writeChar(file, '\n');
@@ -336,14 +443,12 @@ void CodeOutput_writeS19Line (inout File_Type *file, in CodeOutput_State state,
 	File_writeHex(file, sequence.byteList[i], 2);
       }
 
-      /* finally output checksum */
-      checkSum = sequence.length;
+      /* finally output checksum; the record length field also counts
+	 the two address bytes and the checksum byte */
+      checkSum = sequence.length + 3;
       checkSum = checkSum + CodeOutput__checkSum(sequence.offsetAddress);
-
-      for (i = 0;  i < sequence.length;  i++) {
-	checkSum = checkSum + sequence.byteList[i];
-      }
-
+      checkSum = checkSum + (UINT8) CodeOutput_byteSum(sequence.byteList,
+						       sequence.length);
       checkSum = ~checkSum;
       File_writeHex(file, checkSum, 2);
       File_writeChar(file, '\n');
@@ -34,12 +34,15 @@
 /*========================================*/
 
 typedef enum {
-  CodeOutput_State_atBegin, CodeOutput_State_inCode, CodeOutput_State_atEnd
+  CodeOutput_State_atBegin, CodeOutput_State_inCode, CodeOutput_State_atEnd,
+  CodeOutput_State_atErase
 } CodeOutput_State;
    /** state where an output proc may be called: <atBegin> is for any
        processing before output of the first code sequence, <inCode>
-       is when putting out some intermediate code line and <atEnd> is
-       for putting out the final record */
+       is when putting out some intermediate code line, <atEnd> is
+       for putting out the final record and <atErase> is for resetting
+       the range given by address, bank and length of a code sequence
+       to its initial contents in a file patched in place */
 
 
 typedef void (*CodeOutput_Proc)(inout File_Type *file,
@@ -78,7 +81,9 @@ Boolean CodeOutput_create (in String_Type fileName,
 			   in CodeOutput_Proc outputProc);
   /** creates another code output stream on file with <filename> with
       a routine formatting the code sequences <outputProc>; when
-      opening the file for writing fails, the routine returns false */
+      opening the file for writing fails, the routine returns false;
+      when code output is not active, no stream is created and the
+      routine returns true */
 
 
 /*--------------------*/
@@ -97,11 +102,57 @@ void CodeOutput_closeStreams (void);
 void CodeOutput_getFileNames (out StringList_Type *fileNameList);
   /** returns list of file names for all registered output streams */
 
+/*--------------------*/
+
+Boolean CodeOutput_isActive (void);
+  /** tells whether <CodeOutput_create> creates code output streams
+      and hence whether code files are written at all */
+
+/*--------------------*/
+
+Boolean CodeOutput_isPatching (void);
+  /** tells whether the code output streams patch their existing
+      files in place */
+
+
+/*--------------------*/
+/* MEASUREMENT        */
+/*--------------------*/
+
+UINT32 CodeOutput_byteSum (in UINT8 *data, in SizeType length);
+  /** returns the sum of the <length> bytes in <data> modulo 2^32;
+      this is the kernel for record and image checksums and uses
+      vector instructions when available */
+
 
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+void CodeOutput_setActive (in Boolean isActive);
+  /** sets whether <CodeOutput_create> creates code output streams;
+      when a link only determines the memory layout, no code files
+      are written */
+
+/*--------------------*/
+
+void CodeOutput_eraseRange (in Target_Bank romBank, in UINT32 address,
+			    in UINT32 length);
+  /** resets <length> bytes starting at <address> in <romBank> to
+      their initial contents in all open code output streams; this is
+      only meaningful when the streams are patched in place */
+
+/*--------------------*/
+
+void CodeOutput_setPatching (in Boolean isPatching);
+  /** sets whether <CodeOutput_create> opens the files of the code
+      output streams for update such that their output routines can
+      start from the previous contents; only output routines building
+      a binary image (like the one for the Gameboy) support this, so
+      it must not be set when Intel Hex or S19 files are written */
+
+/*--------------------*/
+
 void CodeOutput_writeLine (in CodeSequence_Type sequence);
   /** puts the representation of code sequence <sequence> to all open
       code output streams */
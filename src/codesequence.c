@@ -17,6 +17,7 @@
 #include "globdefs.h"
 #include "mapfile.h"
 #include "module.h"
+#include "statistics.h"
 #include "string.h"
 #include "symbol.h"
 #include "target.h"
@@ -180,6 +181,7 @@ static UINT8 CodeSequence__mostSignificantByte (in UINT16 value)
 static void CodeSequence__processOneRelocation (
 				 in Target_Address codeSequenceBaseAddress,
 				 in UINT16 *offsetByRelaxation,
+				 in UINT16 editedByteCount,
 				 in CodeSequence_Relocation relocation,
 				 inout UINT8 *byteList, 
 				 inout Boolean *isSignificantList,
@@ -189,8 +191,10 @@ static void CodeSequence__processOneRelocation (
       <codeSequenceBaseAddress> gives the initial address of the code
       sequence in the current segment, <offsetByRelaxation> the
       accumulated correction offset by removals of superfluous bytes
-      in the code sequence; <errorRecord> is set whenever an error
-      occurs (flagged by <errorKind> != ErrorKind_none) */
+      in the code sequence and <editedByteCount> the number of bytes
+      removed by relaxed jumps before the relocated bytes;
+      <errorRecord> is set whenever an error occurs (flagged by
+      <errorKind> != ErrorKind_none) */
 {
   UINT8 infoIndex = relocation.index;
   CodeSequence_RelocationKind kind = relocation.kind;
@@ -204,13 +208,26 @@ static void CodeSequence__processOneRelocation (
 
   UINT8 *affectedCodeByte = &(byteList[infoIndex]);
 
+  Statistics_count(Statistics_CounterKind_relocation, 1);
+
   /* process symbol or area reference */
   if (kind.isSymbol) {
     /* add 1 to take care that indexing starts with 1 */
     referencedSymbol = Module_getSymbol(module, relocation.value + 1);
 
     if (referencedSymbol != NULL) {
+      Area_Segment definingSegment = Symbol_getSegment(referencedSymbol);
       relocatedAddress = Symbol_absoluteAddress(referencedSymbol);
+
+      if (definingSegment != NULL
+	  && Area_segmentIsUnreachable(definingSegment)) {
+	String_Type symbolName = String_make();
+	Symbol_getName(referencedSymbol, &symbolName);
+	Error_raise(Error_Criticality_error,
+		    "reference to %s in a removed segment",
+		    String_asCharPointer(symbolName));
+	String_destroy(&symbolName);
+      }
     } else {
       Error_raise(Error_Criticality_warning, "R symbol error");
       return;
@@ -222,6 +239,21 @@ static void CodeSequence__processOneRelocation (
 
     if (referencedSegment != NULL) {
       relocatedAddress = Area_getSegmentAddress(referencedSegment);
+
+      if (Area_segmentIsUnreachable(referencedSegment)) {
+	Error_raise(Error_Criticality_error,
+		    "reference to a removed segment");
+      }
+
+      if (!kind.elementsAreBytes || kind.slotWidthIsTwo) {
+	/* the code contains an offset into the referenced segment
+	   which may have been moved by jump relaxation */
+	UINT16 segmentOffset = CodeSequence__makeWord(affectedCodeByte);
+	UINT16 mappedOffset = Area_mapSegmentOffset(referencedSegment,
+						    segmentOffset);
+	CodeSequence__addWordToWord((UINT16) (mappedOffset - segmentOffset),
+				    affectedCodeByte);
+      }
     } else {
       Error_raise(Error_Criticality_warning, "R area error");
       return;
@@ -230,11 +262,10 @@ static void CodeSequence__processOneRelocation (
 
   /* process PC relative addressing */
   if (kind.isRelocatedPCRelative) {
-    /* TODO: pc relative addressing here*/
-    Target_Address currentAddress = 0;
-    /* pc = adw_w(a[aindex]->a_addr, 0); */
+    Target_Address currentAddress = codeSequenceBaseAddress;
 
-    relocatedAddress -= currentAddress + (infoIndex - *offsetByRelaxation);
+    relocatedAddress -= currentAddress + (infoIndex - *offsetByRelaxation
+					  - editedByteCount);
 
     if (kind.elementsAreBytes) {
       relocatedAddress -= 1;
@@ -324,7 +355,8 @@ static void CodeSequence__processOneRelocation (
       errorRecord->referencedSegment = referencedSegment;
       errorRecord->referencedSymbol  = referencedSymbol;
       errorRecord->codeAddress       =
-	codeSequenceBaseAddress + (infoIndex - *offsetByRelaxation) - 1;
+	codeSequenceBaseAddress + (infoIndex - *offsetByRelaxation
+				   - editedByteCount) - 1;
       errorRecord->relocationValue   = relocation.value;
     }
   }
@@ -475,6 +507,8 @@ void CodeSequence_relocate (inout CodeSequence_Type *sequence,
 			    in CodeSequence_RelocationList *relocationList)
 {
   Target_Address currentAddress;
+  Target_Address lineOffset;
+  Target_Address mappedLineOffset;
   UINT16 i;
   Boolean isSignificantList[CodeSequence_maxLength];
   UINT16 offsetByRelaxation;  /* number of code bytes saved because
@@ -497,7 +531,10 @@ void CodeSequence_relocate (inout CodeSequence_Type *sequence,
   currentAddress = Area_getSegmentAddress(segment);
   Area_getSegmentName(segment, &segmentName);
 
-  sequence->offsetAddress += currentAddress;
+  /* the code line offset may be moved by relaxed jumps */
+  lineOffset = (Target_Address) sequence->offsetAddress;
+  mappedLineOffset = Area_mapSegmentOffset(segment, lineOffset);
+  sequence->offsetAddress = currentAddress + mappedLineOffset;
   offsetByRelaxation = 0;
 
   if (Target_info.getBankFromSegmentName == NULL) {
@@ -515,9 +552,14 @@ void CodeSequence_relocate (inout CodeSequence_Type *sequence,
   for (i = 0;  i < relocationList->count;  i++) {
     CodeSequence__RelocError errorKind;
     CodeSequence__ErrorRecord errorRecord;
+    UINT8 index = relocationList->list[i].index;
+    UINT16 editedByteCount = (UINT16)
+      (index - (Area_mapSegmentOffset(segment, lineOffset + index)
+		- mappedLineOffset));
     
     CodeSequence__processOneRelocation(sequence->offsetAddress,
 				       &offsetByRelaxation,
+				       editedByteCount,
 				       relocationList->list[i],
 				       sequence->byteList,
 				       isSignificantList,
@@ -528,6 +570,10 @@ void CodeSequence_relocate (inout CodeSequence_Type *sequence,
     }
   }
 
+  /* put in relaxed jumps */
+  Area_applyCodeEdits(segment, lineOffset, sequence->length,
+		      sequence->byteList, isSignificantList);
+
   /* condense code sequence by relaxation i.e. throwing out all
      insignificant code bytes  */
   {
@@ -548,6 +594,8 @@ void CodeSequence_relocate (inout CodeSequence_Type *sequence,
     
     sequence->length = newSequenceLength;
   }
+
+  String_destroy(&segmentName);
 }
 
 
@@ -28,6 +28,9 @@
 File_Type Error__reportingTarget;
   /** file where the error messages go to */
 
+static Boolean Error__isRaisedList[Error_Criticality_fatalError + 1];
+  /** tells for each criticality whether some error has been raised */
+
 /*========================================*/
 /*           EXPORTED ROUTINES            */
 /*========================================*/
@@ -39,6 +42,9 @@ File_Type Error__reportingTarget;
 void Error_initialize (void)
 {
   Error_setReportingTarget(File_stderr);
+  Error__isRaisedList[Error_Criticality_warning]    = false;
+  Error__isRaisedList[Error_Criticality_error]      = false;
+  Error__isRaisedList[Error_Criticality_fatalError] = false;
 }
 
 /*--------------------*/
@@ -48,6 +54,15 @@ void Error_finalize (void)
 }
 
 
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+Boolean Error_isRaised (in Error_Criticality criticality)
+{
+  return Error__isRaisedList[criticality];
+}
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
@@ -65,6 +80,7 @@ void Error_raise (in Error_Criticality criticality, in char *message, ...)
   StdArg_VarArgList argumentList;
 
   StdArg_startArgList(argumentList, message);
+  Error__isRaisedList[criticality] = true;
 
   switch (criticality) {
     case Error_Criticality_warning:
@@ -39,6 +39,14 @@ void Error_initialize (void);
 void Error_finalize (void);
   /** cleans up internal data structures */
 
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+Boolean Error_isRaised (in Error_Criticality criticality);
+  /** tells whether some error with <criticality> has been raised so
+      far */
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
@@ -17,9 +17,12 @@ typedef FILE *StdIO_File;
 # define StdIO_endOfFile EOF
 # define StdIO_fclose    fclose
 # define StdIO_fopen     fopen
+# define StdIO_fread     fread
 # define StdIO_fprintf   fprintf
 # define StdIO_fseek     fseek
 # define StdIO_fwrite    fwrite
+# define StdIO_fullyBuffered _IOFBF
+# define StdIO_setvbuf   setvbuf
 # define StdIO_stderr    stderr
 # define StdIO_seekSet   SEEK_SET
 # define StdIO_vfprintf  vfprintf
@@ -29,8 +32,32 @@ typedef FILE *StdIO_File;
 # define STRING_isEqual(a,b) (strcmp(a,b) == 0)
 # define STRING_length       strlen
 
+#if defined(unix) || defined(__unix__) || defined(__APPLE__)
+# define File__mappingIsSupported
+# define File__separator "/"
+#include <fcntl.h>
+# define FCntl_open       open
+# define FCntl_createMode (O_RDWR | O_CREAT | O_TRUNC)
+# define FCntl_readMode   O_RDONLY
+# define FCntl_updateMode O_RDWR
+#include <sys/mman.h>
+# define MMan_map         mmap
+# define MMan_mapFailed   MAP_FAILED
+# define MMan_sync        msync
+# define MMan_unmap       munmap
+#include <unistd.h>
+# define UniStd_close     close
+# define UniStd_seek      lseek
+# define UniStd_truncate  ftruncate
+#else
+# define File__separator "\\"
+#endif
+
 #include "globdefs.h"
+#include "list.h"
+#include "statistics.h"
 #include "string.h"
+#include "stringlist.h"
 
 /*========================================*/
 
@@ -41,9 +68,17 @@ typedef FILE *StdIO_File;
 typedef struct File__Record {
   UINT32 magicNumber;
   StdIO_File filePointer;
+  String_Type name;
+  Boolean isForWriting;
+  UINT32 byteCount;
+  UINT32 lineCount;
+  char *buffer;
 } File__Record;
-  /** file type with a pointer to a Standard IO file (this type
-      information should only be used internally!) */
+  /** file type with a pointer to a Standard IO file and the number of
+      bytes and lines transferred; <name> is only set when those are
+      recorded for the link statistics; <buffer> is only set when the
+      file has a buffer of its own (this type information should only
+      be used internally!) */
 
 /*--------------------*/
 
@@ -54,6 +89,15 @@ String_Type File_directorySeparator;
   /** string to separate parts of a directory specification; "/" in
       Unix, "\" in Windows */
 
+static Boolean File__usageIsTracked;
+  /** tells whether the names of opened files are recorded */
+
+static StringList_Type File__inputFileNameList;
+  /** names of files opened for reading while usage is tracked */
+
+static StringList_Type File__outputFileNameList;
+  /** names of files opened for writing while usage is tracked */
+
 /*========================================*/
 /*            INTERNAL ROUTINES           */
 /*========================================*/
@@ -65,6 +109,17 @@ static Boolean File__isValid (in Object file)
 
 /*--------------------*/
 
+static void File__countWrite (inout File_Type file, in int byteCount)
+  /** adds <byteCount> bytes (as returned by a write operation) to the
+      bytes transferred for <file> */
+{
+  if (byteCount > 0) {
+    file->byteCount += (UINT32) byteCount;
+  }
+}
+
+/*--------------------*/
+
 static Boolean File__checkValidityPRE (in Object file,
 				       in char *procName)
   /** checks as a precondition of routine <procName> whether <file> is
@@ -104,14 +159,83 @@ void File__findOffset (inout char *name, out SizeType *offset)
 
 /*--------------------*/
 
+static void File__recordUsage (in char *name, in Boolean isForWriting)
+  /** adds file name <name> to the list of input or output files
+      depending on <isForWriting> unless it is already there */
+{
+  if (File__usageIsTracked) {
+    StringList_Type *nameList = (isForWriting ? &File__outputFileNameList
+				 : &File__inputFileNameList);
+    String_Type fileName = String_makeFromCharArray(name);
+
+    if (List_lookup(*nameList, fileName) == NULL) {
+      StringList_append(nameList, fileName);
+    }
+
+    String_destroy(&fileName);
+  }
+}
+
+/*--------------------*/
+
 static File_Type File__make (in StdIO_File filePointer)
 {
   File_Type file = NEW(File__Record);
-  file->magicNumber = File__magicNumber;
-  file->filePointer = filePointer;
+  file->magicNumber  = File__magicNumber;
+  file->filePointer  = filePointer;
+  file->name         = NULL;
+  file->isForWriting = false;
+  file->byteCount    = 0;
+  file->lineCount    = 0;
+  file->buffer       = NULL;
   return file;
 }
 
+/*--------------------*/
+
+static Boolean File__mapForWriting (in String_Type fileName,
+				    in SizeType size,
+				    in Boolean contentsAreKept,
+				    out UINT8 **data)
+  /** maps file given by <fileName> with exactly <size> bytes into
+      memory for writing; when <contentsAreKept> is set, the file must
+      exist and its contents are kept, otherwise it is created empty;
+      the start of the mapped region is returned in <data> */
+{
+  Boolean isOkay = false;
+
+  *data = NULL;
+
+#ifdef File__mappingIsSupported
+  {
+    int fileDescriptor =
+      (contentsAreKept
+       ? FCntl_open(String_asCharPointer(fileName), FCntl_updateMode)
+       : FCntl_open(String_asCharPointer(fileName), FCntl_createMode,
+		    0666));
+
+    if (fileDescriptor >= 0) {
+      if (UniStd_truncate(fileDescriptor, (off_t) size) == 0) {
+	void *region = MMan_map(NULL, size, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fileDescriptor, 0);
+
+	if (region != MMan_mapFailed) {
+	  *data = (UINT8 *) region;
+	  isOkay = true;
+	  File__recordUsage(String_asCharPointer(fileName), true);
+	  Statistics_recordFileTransfer(fileName, true, (UINT32) size, 0);
+	}
+      }
+
+      /* the mapping stays valid after the descriptor is closed */
+      UniStd_close(fileDescriptor);
+    }
+  }
+#endif
+
+  return isOkay;
+}
+
 /*========================================*/
 /*            EXPORTED ROUTINES           */
 /*========================================*/
@@ -123,7 +247,10 @@ static File_Type File__make (in StdIO_File filePointer)
 void File_initialize (void)
 {
   File_stderr = File__make(StdIO_stderr);
-  File_directorySeparator = String_makeFromCharArray("\\");
+  File_directorySeparator = String_makeFromCharArray(File__separator);
+  File__usageIsTracked = false;
+  File__inputFileNameList = NULL;
+  File__outputFileNameList = NULL;
 }
 
 /*--------------------*/
@@ -132,6 +259,11 @@ void File_finalize (void)
 {
   File_close(&File_stderr);
   String_destroy(&File_directorySeparator);
+
+  if (File__inputFileNameList != NULL) {
+    List_destroy(&File__inputFileNameList);
+    List_destroy(&File__outputFileNameList);
+  }
 }
 
 /*--------------------*/
@@ -159,13 +291,24 @@ Boolean File_open (out File_Type *result,
       openMode = "w";
     } else if (mode == File_Mode_writeBinary) {
       openMode = "wb";
+    } else if (mode == File_Mode_updateBinary) {
+      openMode = "r+b";
     }
 
     File__findOffset(name, &offset);
     filePointer = StdIO_fopen(name, openMode);
 
     if (filePointer != NULL) {
+      Boolean isForWriting = (mode == File_Mode_write
+			      || mode == File_Mode_writeBinary
+			      || mode == File_Mode_updateBinary);
       *result = File__make(filePointer);
+      File__recordUsage(name, isForWriting);
+
+      if (Statistics_isActive()) {
+	(*result)->name = String_makeFromCharArray(name);
+	(*result)->isForWriting = isForWriting;
+      }
 
       if (offset != 0) {
 	StdIO_fseek(filePointer, offset, StdIO_seekSet);
@@ -188,6 +331,19 @@ void File_close (inout File_Type *file)
 
   if (precondition) {  
     StdIO_fclose(currentFile->filePointer);
+
+    if (currentFile->name != NULL) {
+      Statistics_recordFileTransfer(currentFile->name,
+				    currentFile->isForWriting,
+				    currentFile->byteCount,
+				    currentFile->lineCount);
+      String_destroy(&currentFile->name);
+    }
+
+    if (currentFile->buffer != NULL) {
+      DESTROY(currentFile->buffer);
+    }
+
     DESTROY(currentFile);
     *file = NULL;
   }
@@ -209,10 +365,53 @@ Boolean File_exists (in String_Type fileName)
   return isFound;
 }
 
+/*--------------------*/
+
+void File_getUsedFileNames (inout List_Type *inputFileNameList,
+			    inout List_Type *outputFileNameList)
+{
+  if (File__inputFileNameList != NULL) {
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(File__inputFileNameList);
+	 cursor != NULL;  List_advanceCursor(&cursor)) {
+      String_Type fileName = List_getElementAtCursor(cursor);
+
+      if (List_lookup(File__outputFileNameList, fileName) == NULL) {
+	StringList_append(inputFileNameList, fileName);
+      }
+    }
+
+    for (cursor = List_resetCursor(File__outputFileNameList);
+	 cursor != NULL;  List_advanceCursor(&cursor)) {
+      String_Type fileName = List_getElementAtCursor(cursor);
+      StringList_append(outputFileNameList, fileName);
+    }
+  }
+}
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+SizeType File_readBytes (inout File_Type *file, out UINT8 *data,
+			 in SizeType size)
+{
+  char *procName = "File_readBytes";
+  File_Type currentFile = *file;
+  Boolean precondition = File__checkValidityPRE(currentFile, procName);
+  SizeType result = 0;
+
+  if (precondition) {
+    result = StdIO_fread(data, 1, size, currentFile->filePointer);
+    currentFile->byteCount += (UINT32) result;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
 void File_readLine (inout File_Type *file, out String_Type *st)
 {
   char *procName = "File_readLine";
@@ -231,6 +430,110 @@ void File_readLine (inout File_Type *file, out String_Type *st)
 	String_appendChar(st, (char) ch);
       }
     } while (ch != StdIO_endOfFile && ch != '\n');
+
+    currentFile->byteCount += (UINT32) String_length(*st);
+    currentFile->lineCount += (String_length(*st) > 0);
+  }
+}
+
+/*--------------------*/
+
+Boolean File_mapForReading (in String_Type fileName,
+			    out UINT8 **data, out SizeType *size)
+{
+  Boolean isOkay = false;
+
+  *data = NULL;
+  *size = 0;
+
+#ifdef File__mappingIsSupported
+  {
+    int fileDescriptor = FCntl_open(String_asCharPointer(fileName),
+				    FCntl_readMode);
+
+    if (fileDescriptor >= 0) {
+      off_t fileSize = UniStd_seek(fileDescriptor, 0, SEEK_END);
+
+      if (fileSize > 0) {
+	void *region = MMan_map(NULL, (SizeType) fileSize, PROT_READ,
+				MAP_PRIVATE, fileDescriptor, 0);
+
+	if (region != MMan_mapFailed) {
+	  *data = (UINT8 *) region;
+	  *size = (SizeType) fileSize;
+	  isOkay = true;
+	  File__recordUsage(String_asCharPointer(fileName), false);
+	  Statistics_recordFileTransfer(fileName, false, (UINT32) fileSize,
+					0);
+	}
+      }
+
+      /* the mapping stays valid after the descriptor is closed */
+      UniStd_close(fileDescriptor);
+    }
+  }
+#endif
+
+  return isOkay;
+}
+
+/*--------------------*/
+
+Boolean File_mapForUpdate (in String_Type fileName, in SizeType size,
+			   out UINT8 **data)
+{
+  return File__mapForWriting(fileName, size, true, data);
+}
+
+/*--------------------*/
+
+Boolean File_mapIntoMemory (in String_Type fileName, in SizeType size,
+			    out UINT8 **data)
+{
+  return File__mapForWriting(fileName, size, false, data);
+}
+
+/*--------------------*/
+
+void File_setBufferSize (inout File_Type *file, in SizeType size)
+{
+  char *procName = "File_setBufferSize";
+  File_Type currentFile = *file;
+  Boolean precondition = File__checkValidityPRE(currentFile, procName);
+
+  if (precondition && currentFile->buffer == NULL) {
+    currentFile->buffer = NEWARRAY(char, size);
+    ASSERTION(currentFile->buffer != NULL, procName, "out of memory");
+    StdIO_setvbuf(currentFile->filePointer, currentFile->buffer,
+		  StdIO_fullyBuffered, size);
+  }
+}
+
+/*--------------------*/
+
+void File_setUsageTracking (in Boolean isTracked)
+{
+  if (isTracked && File__inputFileNameList == NULL) {
+    File__inputFileNameList = StringList_make();
+    File__outputFileNameList = StringList_make();
+  }
+
+  File__usageIsTracked = isTracked;
+}
+
+/*--------------------*/
+
+void File_unmapFromMemory (inout UINT8 **data, in SizeType size)
+{
+  char *procName = "File_unmapFromMemory";
+  Boolean precondition = PRE(*data != NULL, procName, "no mapped region");
+
+  if (precondition) {
+#ifdef File__mappingIsSupported
+    MMan_sync(*data, size, MS_SYNC);
+    MMan_unmap(*data, size);
+#endif
+    *data = NULL;
   }
 }
 
@@ -244,6 +547,7 @@ void File_writeBytes (inout File_Type *file, in UINT8 *data, in SizeType size)
 
   if (precondition) {
     StdIO_fwrite(data, size, 1, currentFile->filePointer);
+    currentFile->byteCount += (UINT32) size;
   }
 }
 
@@ -256,7 +560,8 @@ void File_writeChar (inout File_Type *file, in char ch)
   Boolean precondition = File__checkValidityPRE(currentFile, procName);
 
   if (precondition) {
-    StdIO_fprintf(currentFile->filePointer, "%c", ch);
+    File__countWrite(currentFile,
+		     StdIO_fprintf(currentFile->filePointer, "%c", ch));
   }
 }
 
@@ -269,7 +574,8 @@ void File_writeCharArray (inout File_Type *file, in char *st)
   Boolean precondition = File__checkValidityPRE(currentFile, procName);
 
   if (precondition) {
-    StdIO_fprintf(currentFile->filePointer, "%s", st);
+    File__countWrite(currentFile,
+		     StdIO_fprintf(currentFile->filePointer, "%s", st));
   }
 }
 
@@ -283,7 +589,9 @@ void File_writeHex (inout File_Type *file,
   Boolean precondition = File__checkValidityPRE(currentFile, procName);
 
   if (precondition) {
-    StdIO_fprintf(currentFile->filePointer, "%.*x", digitCount, value);
+    File__countWrite(currentFile,
+		     StdIO_fprintf(currentFile->filePointer, "%.*x",
+				   digitCount, value));
   }
 }
 
@@ -297,7 +605,9 @@ void File_writePrintfArguments (inout File_Type *file, in char *format,
   Boolean precondition = File__checkValidityPRE(currentFile, procName);
 
   if (precondition) {
-    StdIO_vfprintf(currentFile->filePointer, format, argumentList);
+    File__countWrite(currentFile,
+		     StdIO_vfprintf(currentFile->filePointer, format,
+				    argumentList));
   }
 }
 
@@ -310,6 +620,8 @@ void File_writeString (inout File_Type *file, in String_Type st)
   Boolean precondition = File__checkValidityPRE(currentFile, procName);
 
   if (precondition) {
-    StdIO_fprintf(currentFile->filePointer, "%s", String_asCharPointer(st));
+    File__countWrite(currentFile,
+		     StdIO_fprintf(currentFile->filePointer, "%s",
+				   String_asCharPointer(st)));
   }
 }
@@ -25,6 +25,17 @@
 
     After processing a file must be explicitely closed.
 
+    Where the platform supports it, a binary file may also be created
+    with a fixed size and mapped into memory for writing.  This allows
+    producers of large binary images to fill the file contents
+    directly without an intermediate copy.  In the same way an
+    existing file may be mapped for reading or for patching it in
+    place.
+
+    On request the names of all files opened are recorded separately
+    for reading and writing.  This allows a client to find out which
+    files a run of the linker depends on and which it produces.
+
     Original version by Thomas Tensi, 2006-08
     based on the module lkfile.c by Alan R. Baldwin
 */
@@ -38,6 +49,7 @@
 #  define StdArg_VarArgList va_list
 
 #include "globdefs.h"
+#include "list.h"
 #include "string.h"
 
 /*========================================*/
@@ -48,9 +60,12 @@ typedef struct File__Record *File_Type;
 
 
 typedef enum {
-  File_Mode_read, File_Mode_write, File_Mode_readBinary, File_Mode_writeBinary
+  File_Mode_read, File_Mode_write, File_Mode_readBinary, File_Mode_writeBinary,
+  File_Mode_updateBinary
 } File_Mode;
-  /** open mode for a file; binary and text modes are distinguished */
+  /** open mode for a file; binary and text modes are distinguished;
+      <updateBinary> opens an existing file for reading and writing
+      and keeps its contents */
 
 /*--------------------*/
 
@@ -93,7 +108,8 @@ Boolean File_open (out File_Type *file,
       special file names "stdin", "stdout" and "stderr" which access
       the appropriate terminal streams; when a file is opened for
       writing, its previous contents are discarded (possibly in
-      between when the file name contains an offset separator) */
+      between when the file name contains an offset separator) unless
+      it is opened for update */
 
 /*--------------------*/
 /* DESTRUCTION        */
@@ -109,16 +125,84 @@ void File_close (inout File_Type *file);
 Boolean File_exists (in String_Type fileName);
   /** tells whether file given by <fileName> exists */
 
+/*--------------------*/
+
+void File_getUsedFileNames (inout List_Type *inputFileNameList,
+			    inout List_Type *outputFileNameList);
+  /** appends the names of all files opened for reading while usage
+      tracking was active to string list <inputFileNameList> and
+      those opened for writing to string list <outputFileNameList>;
+      each name is only given once and files opened for writing are
+      not reported as input files */
+
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
 
+SizeType File_readBytes (inout File_Type *file, out UINT8 *data,
+			 in SizeType size);
+  /** reads at most <size> bytes from <file> into byte array <data>
+      and returns the number of bytes read; when file is exhausted,
+      0 is returned */
+
+/*--------------------*/
+
 void File_readLine (inout File_Type *file,  out String_Type *st);
   /** returns next line on <file> in <st> including a final newline
       character; when file is exhausted, <st> is empty */
 
 /*--------------------*/
 
+Boolean File_mapForReading (in String_Type fileName,
+			    out UINT8 **data, out SizeType *size);
+  /** maps existing file given by <fileName> into memory for reading;
+      the start of the mapped region is returned in <data> and its
+      length in <size>; when the file is empty, cannot be mapped or
+      the mapping is not supported on this platform, false is returned
+      and <data> is NULL; the region must be released by
+      <File_unmapFromMemory> */
+
+/*--------------------*/
+
+Boolean File_mapForUpdate (in String_Type fileName, in SizeType size,
+			   out UINT8 **data);
+  /** maps existing file given by <fileName> into memory for reading
+      and writing keeping its contents; the file is resized to <size>
+      bytes and the start of the mapped region is returned in <data>;
+      when the mapping fails or is not supported on this platform,
+      false is returned and <data> is NULL */
+
+/*--------------------*/
+
+Boolean File_mapIntoMemory (in String_Type fileName, in SizeType size,
+			    out UINT8 **data);
+  /** creates file given by <fileName> with exactly <size> bytes and
+      maps it into memory for writing; the start of the mapped region
+      is returned in <data>; when the mapping fails or is not
+      supported on this platform, false is returned and <data> is
+      NULL */
+
+/*--------------------*/
+
+void File_setBufferSize (inout File_Type *file, in SizeType size);
+  /** makes <file> collect output in a buffer of <size> bytes before
+      passing it to the system; must be called before any transfer on
+      <file> */
+
+/*--------------------*/
+
+void File_setUsageTracking (in Boolean isTracked);
+  /** sets whether names of files opened from now on are recorded
+      (see <File_getUsedFileNames>) */
+
+/*--------------------*/
+
+void File_unmapFromMemory (inout UINT8 **data, in SizeType size);
+  /** writes back the mapped region <data> with <size> bytes to its
+      file and releases the mapping; <data> is NULL afterwards */
+
+/*--------------------*/
+
 void File_writeBytes (inout File_Type *file, in UINT8 *data, in SizeType size);
   /** puts byte array <data> with length <size> to <file> */
 
@@ -10,12 +10,31 @@
 /*========================================*/
 
 #include "error.h"
+#include "statistics.h"
 
 #include <stdio.h>
 #  define StdIO_stderr stderr
 #  define StdIO_fprintf fprintf
 #include <stdlib.h>
-#  define StdLib_exit exit
+#  define StdLib_calloc calloc
+#  define StdLib_exit   exit
+#  define StdLib_free   free
+#  define StdLib_malloc malloc
+#  define StdLib_realloc realloc
+
+/*========================================*/
+
+#ifdef ASLINK_HEAP_ACCOUNTING
+
+typedef union {
+  Statistics_AllocationTag tag;
+  long double alignment;
+} BlockHeader;
+  /** header in front of each allocated block with its accounting
+      information; the union ensures that the block following it is
+      aligned for all types */
+
+#endif
 
 /*========================================*/
 /*            INTERNAL ROUTINES           */
@@ -36,6 +55,38 @@ static void checkCondition (in Boolean condition, in char *format,
 /*            EXPORTED ROUTINES           */
 /*========================================*/
 
+#ifndef ASLINK_HEAP_ACCOUNTING
+
+Object allocateMemory (in SizeType size, in Boolean isCleared,
+		       in char *ownerName)
+{
+  Statistics_count(Statistics_CounterKind_allocation, 1);
+  Statistics_count(Statistics_CounterKind_allocatedByte, (UINT32) size);
+  return (isCleared ? StdLib_calloc(size, 1) : StdLib_malloc(size));
+}
+
+#else
+
+Object allocateMemory (in SizeType size, in Boolean isCleared,
+		       in char *ownerName)
+{
+  SizeType blockSize = sizeof(BlockHeader) + size;
+  BlockHeader *header = (isCleared ? StdLib_calloc(blockSize, 1)
+			 : StdLib_malloc(blockSize));
+  Object result = NULL;
+
+  if (header != NULL) {
+    Statistics_recordAllocation(ownerName, size, &header->tag);
+    result = header + 1;
+  }
+
+  return result;
+}
+
+#endif
+
+/*--------------------*/
+
 void ASSERTION (in Boolean condition, in char *procName, in char *message)
 {
   checkCondition(condition, "assertion violation in %s: %s",
@@ -58,6 +109,21 @@ Object attemptConversion (in char *opaqueTypeName, in Object object,
 
 /*--------------------*/
 
+void deallocateMemory (inout Object object)
+{
+#ifndef ASLINK_HEAP_ACCOUNTING
+  StdLib_free(object);
+#else
+  if (object != NULL) {
+    BlockHeader *header = (BlockHeader *) object - 1;
+    Statistics_recordRelease(&header->tag);
+    StdLib_free(header);
+  }
+#endif
+}
+
+/*--------------------*/
+
 Boolean isValidObject (in Object object, in long magicNumber)
 {
   long *x = (long *) object;
@@ -73,3 +139,40 @@ Boolean PRE (in Boolean condition, in char *procName, in char *message)
   return condition;
 }
 
+/*--------------------*/
+
+#ifndef ASLINK_HEAP_ACCOUNTING
+
+Object reallocateMemory (inout Object object, in SizeType size,
+			 in char *ownerName)
+{
+  return StdLib_realloc(object, size);
+}
+
+#else
+
+Object reallocateMemory (inout Object object, in SizeType size,
+			 in char *ownerName)
+{
+  Object result = NULL;
+
+  if (object == NULL) {
+    result = allocateMemory(size, false, ownerName);
+  } else {
+    BlockHeader *header = (BlockHeader *) object - 1;
+    Statistics_AllocationTag tag = header->tag;
+
+    header = StdLib_realloc(header, sizeof(BlockHeader) + size);
+
+    if (header != NULL) {
+      /* the block is accounted anew with its changed size */
+      Statistics_recordRelease(&tag);
+      Statistics_recordAllocation(ownerName, size, &header->tag);
+      result = header + 1;
+    }
+  }
+
+  return result;
+}
+
+#endif
@@ -58,17 +58,49 @@ typedef void *Object;
 /* utility routines           */
 /*----------------------------*/
 
-#define NEW(elementType) malloc(sizeof(elementType))
-  /** allocation routine for an object of some element type */
+#define NEW(elementType) \
+  allocateMemory(sizeof(elementType), false, __FILE__)
+  /** allocation routine for an object of some element type; the
+      block is accounted to the module allocating it */
 
 /*--------------------*/
 
-#define NEWARRAY(elementType, count) calloc((count), sizeof(elementType))
-  /** allocation routine for an array of elements */
+#define NEWARRAY(elementType, count) \
+  allocateMemory((count) * sizeof(elementType), true, __FILE__)
+  /** allocation routine for an array of elements (set to zero) */
 
 /*--------------------*/
 
-#define DESTROY(pointer)  free(pointer)
+Object allocateMemory (in SizeType size, in Boolean isCleared,
+		       in char *ownerName);
+  /** allocates <size> bytes (set to zero when <isCleared> is set) and
+      counts the allocation for the link statistics; when built with
+      ASLINK_HEAP_ACCOUNTING, the block is also accounted to the
+      module with source file <ownerName>; returns NULL when no memory
+      is available */
+
+/*--------------------*/
+
+Object reallocateMemory (inout Object object, in SizeType size,
+			 in char *ownerName);
+  /** changes size of block <object> allocated by <allocateMemory> to
+      <size> bytes and returns the possibly moved block; when <object>
+      is NULL, a new block is allocated for the module with source
+      file <ownerName>; returns NULL when no memory is available */
+
+/*--------------------*/
+
+void deallocateMemory (inout Object object);
+  /** frees block <object> allocated by <allocateMemory> (if not
+      NULL) */
+
+/*--------------------*/
+
+#ifdef ASLINK_HEAP_ACCOUNTING
+#  define DESTROY(pointer)  deallocateMemory(pointer)
+#else
+#  define DESTROY(pointer)  free(pointer)
+#endif
   /** deallocation routine for a pointer */
 
 /*--------------------*/
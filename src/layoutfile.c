@@ -0,0 +1,292 @@
+/** LayoutFile module --
+    Implementation of module providing the layout report of a link
+    with the areas, segments, memory region fill levels and symbol
+    addresses as a JSON object.
+
+    NOTE: as a naming convention all file scope names have the module
+    name as a prefix with a single underscore for externally visible
+    names and two underscores for internal names
+*/
+
+#include "layoutfile.h"
+
+/*========================================*/
+
+#include "area.h"
+#include "error.h"
+#include "file.h"
+#include "globdefs.h"
+#include "list.h"
+#include "module.h"
+#include "set.h"
+#include "string.h"
+#include "symbol.h"
+#include "symbolindex.h"
+#include "target.h"
+
+#include <stdio.h>
+# define StdIO_sprintf  sprintf
+#include <stdlib.h>
+# define StdLib_qsort   qsort
+
+/*========================================*/
+
+typedef struct {
+  SizeType regionIndex;
+  Target_Bank bank;
+  UINT32 usedSize;
+} LayoutFile__RegionUsage;
+  /** number of bytes <usedSize> occupied by areas in the instance for
+      <bank> of the target memory region with <regionIndex> */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static int LayoutFile__compareRegionUsages (in const void *a,
+					    in const void *b)
+  /** compares the region usages <a> and <b> by region index and bank
+      and returns -1, 0 or +1 for less, equal and greater */
+{
+  const LayoutFile__RegionUsage *usageA = a;
+  const LayoutFile__RegionUsage *usageB = b;
+  int result = 0;
+
+  if (usageA->regionIndex != usageB->regionIndex) {
+    result = (usageA->regionIndex < usageB->regionIndex ? -1 : 1);
+  } else if (usageA->bank != usageB->bank) {
+    result = (usageA->bank < usageB->bank ? -1 : 1);
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void LayoutFile__writeJSONString (inout File_Type *file,
+					 in String_Type st)
+  /** writes <st> as a quoted JSON string to <file> */
+{
+  char *ch;
+
+  File_writeChar(file, '"');
+
+  for (ch = String_asCharPointer(st);  *ch != String_terminator;  ch++) {
+    if (*ch == '"' || *ch == '\\') {
+      File_writeChar(file, '\\');
+    }
+
+    File_writeChar(file, *ch);
+  }
+
+  File_writeChar(file, '"');
+}
+
+/*--------------------*/
+
+static void LayoutFile__writeAreas (inout File_Type *file,
+				    in Area_List areaList)
+  /** writes name, address, size and kind of all areas in <areaList>
+      together with module, address and size of their segments as a
+      JSON array to <file>; removed and folded segments are skipped,
+      because they occupy no memory */
+{
+  Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+  String_Type name = String_make();
+  char *separator = "";
+  List_Cursor cursor;
+  char buffer[100];
+
+  File_writeCharArray(file, "  \"areas\": [");
+
+  for (cursor = List_resetCursor(areaList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Type area = List_getElementAtCursor(cursor);
+    Area_AttributeSet attributes = Area_getAttributes(area);
+    char *segmentSeparator = "";
+    List_Cursor segmentCursor;
+
+    Area_getName(area, &name);
+    StdIO_sprintf(buffer, "%s\n    { \"name\": ", separator);
+    File_writeCharArray(file, buffer);
+    LayoutFile__writeJSONString(file, name);
+    StdIO_sprintf(buffer, ", \"address\": %lu, \"size\": %lu,"
+		  " \"isAbsolute\": %s,\n      \"segments\": [",
+		  (unsigned long) Area_getAddress(area),
+		  (unsigned long) Area_getSize(area),
+		  (Set_isElement(attributes, Area_Attribute_isAbsolute)
+		   ? "true" : "false"));
+    File_writeCharArray(file, buffer);
+    Area_getListOfSegments(area, &segmentList);
+
+    for (segmentCursor = List_resetCursor(segmentList);
+	 segmentCursor != NULL;
+	 List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      if (!Area_segmentIsRemoved(segment)) {
+	Module_Type module = Area_getSegmentModule(segment);
+	String_clear(&name);
+
+	if (module != NULL) {
+	  Module_getName(module, &name);
+	}
+
+	StdIO_sprintf(buffer, "%s\n        { \"module\": ",
+		      segmentSeparator);
+	File_writeCharArray(file, buffer);
+	LayoutFile__writeJSONString(file, name);
+	StdIO_sprintf(buffer, ", \"address\": %lu, \"size\": %lu }",
+		      (unsigned long) Area_getSegmentAddress(segment),
+		      (unsigned long) Area_getSegmentSize(segment));
+	File_writeCharArray(file, buffer);
+	segmentSeparator = ",";
+      }
+    }
+
+    File_writeCharArray(file, " ] }");
+    separator = ",";
+  }
+
+  File_writeCharArray(file, "\n  ]");
+  String_destroy(&name);
+  List_destroy(&segmentList);
+}
+
+/*--------------------*/
+
+static void LayoutFile__writeRegions (inout File_Type *file,
+				      in Area_List areaList)
+  /** writes start, size and fill level of all instances of target
+      memory regions occupied by areas in <areaList> as a JSON array
+      to <file>; a region instance is overfull when its free size is
+      negative */
+{
+  char *procName = "LayoutFile__writeRegions";
+  LayoutFile__RegionUsage *usageList =
+    NEWARRAY(LayoutFile__RegionUsage, List_length(areaList) + 1);
+  SizeType usageCount = 0;
+  char *separator = "";
+  List_Cursor cursor;
+  SizeType i;
+  char buffer[200];
+
+  ASSERTION(usageList != NULL, procName, "out of memory");
+
+  /* sum up the sizes of the areas per region instance */
+  for (cursor = List_resetCursor(areaList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Area_Type area = List_getElementAtCursor(cursor);
+    Target_Address size = Area_getSize(area);
+    SizeType regionIndex;
+    Target_Bank bank;
+
+    if (size > 0 && Area_getMemoryRegion(area, &regionIndex, &bank)) {
+      for (i = 0;  i < usageCount;  i++) {
+	if (usageList[i].regionIndex == regionIndex
+	    && usageList[i].bank == bank) {
+	  break;
+	}
+      }
+
+      if (i == usageCount) {
+	usageList[i].regionIndex = regionIndex;
+	usageList[i].bank        = bank;
+	usageList[i].usedSize    = 0;
+	usageCount++;
+      }
+
+      usageList[i].usedSize += size;
+    }
+  }
+
+  StdLib_qsort(usageList, usageCount, sizeof(LayoutFile__RegionUsage),
+	       LayoutFile__compareRegionUsages);
+  File_writeCharArray(file, "  \"regions\": [");
+
+  for (i = 0;  i < usageCount;  i++) {
+    LayoutFile__RegionUsage *usage = &usageList[i];
+    Target_MemoryRegion *region =
+      &Target_info.memoryRegionList[usage->regionIndex];
+
+    StdIO_sprintf(buffer, "%s\n    { \"name\": \"%s\", \"bank\": %d,"
+		  " \"start\": %lu, \"size\": %lu, \"used\": %lu,"
+		  " \"free\": %ld, \"fillPercent\": %.1f }",
+		  separator, region->name, (int) usage->bank,
+		  (unsigned long) region->startAddress,
+		  (unsigned long) region->size,
+		  (unsigned long) usage->usedSize,
+		  (long) region->size - (long) usage->usedSize,
+		  100.0 * usage->usedSize / region->size);
+    File_writeCharArray(file, buffer);
+    separator = ",";
+  }
+
+  File_writeCharArray(file, "\n  ]");
+  DESTROY(usageList);
+}
+
+/*--------------------*/
+
+static void LayoutFile__writeSymbols (inout File_Type *file)
+  /** writes name, area and address of all symbols in the symbol index
+      sorted by name as a JSON array to <file> */
+{
+  SizeType entryCount;
+  SymbolIndex_Entry **entryList = SymbolIndex_getEntriesByName(&entryCount);
+  String_Type areaName = String_make();
+  SizeType i;
+  char buffer[50];
+
+  File_writeCharArray(file, "  \"symbols\": [");
+
+  for (i = 0;  i < entryCount;  i++) {
+    SymbolIndex_Entry *entry = entryList[i];
+    Area_Segment segment = Symbol_getSegment(entry->symbol);
+
+    String_clear(&areaName);
+
+    if (segment != NULL) {
+      Area_getName(Area_getSegmentArea(segment), &areaName);
+    }
+
+    File_writeCharArray(file, (i == 0 ? "\n    { \"name\": "
+			       : ",\n    { \"name\": "));
+    LayoutFile__writeJSONString(file, entry->name);
+    File_writeCharArray(file, ", \"area\": ");
+    LayoutFile__writeJSONString(file, areaName);
+    StdIO_sprintf(buffer, ", \"address\": %lu }",
+		  (unsigned long) entry->address);
+    File_writeCharArray(file, buffer);
+  }
+
+  File_writeCharArray(file, "\n  ]");
+  String_destroy(&areaName);
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void LayoutFile_write (inout File_Type *file)
+{
+  Area_List areaList = List_make(Area_typeDescriptor);
+
+  Area_getList(&areaList);
+  File_writeCharArray(file, "{\n");
+  LayoutFile__writeAreas(file, areaList);
+  File_writeCharArray(file, ",\n");
+
+  if (Target_info.memoryRegionList != NULL) {
+    LayoutFile__writeRegions(file, areaList);
+    File_writeCharArray(file, ",\n");
+  }
+
+  LayoutFile__writeSymbols(file);
+  File_writeCharArray(file, "\n}\n");
+  List_destroy(&areaList);
+}
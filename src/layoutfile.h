@@ -0,0 +1,34 @@
+/** LayoutFile module --
+    This module provides the layout report of a link: a compact JSON
+    object with the addresses and sizes of all areas and their
+    segments, the fill levels of the used instances of the memory
+    regions of the target platform (one instance per bank for banked
+    regions) and the addresses of all symbols sorted by name.
+
+    The report only needs the data available after the areas have been
+    linked and the symbol index has been built.  Hence it is written
+    in the layout mode of the linker, which stops before the second
+    pass and writes neither code nor map files; this is much faster
+    than a full link and suffices for checking size budgets.
+*/
+
+#ifndef __LAYOUTFILE_H
+#define __LAYOUTFILE_H
+
+/*========================================*/
+
+#include "file.h"
+#include "globdefs.h"
+
+/*========================================*/
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void LayoutFile_write (inout File_Type *file);
+  /** writes the layout report of all linked areas, memory regions and
+      symbols as a JSON object to <file>; requires that <Area_link> has
+      been done and the symbol index has been built */
+
+#endif /* __LAYOUTFILE_H */
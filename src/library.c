@@ -21,6 +21,7 @@
 #include "list.h"
 #include "multimap.h"
 #include "parser.h"
+#include "statistics.h"
 #include "string.h"
 #include "stringlist.h"
 #include "symbol.h"
@@ -40,6 +41,7 @@ typedef enum { Library__LoadStatus_notLoaded, Library__LoadStatus_marked,
 typedef struct {
   UINT32 magicNumber;
   Boolean isObjectFile;
+  Boolean isIndexed;
   Library__LoadStatus loadStatus;
   String_Type path;
   SizeType offset;
@@ -47,8 +49,9 @@ typedef struct {
   StringList_Type symbolNameList;
 } Library__Record;
   /** record containing the information about some library: whether it
-      is an plain object file (without further structure), is loaded,
-      its full path name, its directory path and the list of symbol
+      is an plain object file (without further structure), whether its
+      symbols are already in the symbol index, is loaded, its full
+      path name, its directory path and the list of symbol
       names contained in that library; when <offset> is not zero, this
       means that the information starts in file at given offset */
 
@@ -60,7 +63,8 @@ static List_Type Library__list;
   /** list of all libraries encountered so far */
 
 static Multimap_Type Library__symbolIndex;
-  /** mapping from symbol name to libraries containing that symbol */
+  /** mapping from symbol name to libraries containing that symbol;
+      it is built incrementally for new library files only */
 
 static StringList_Type Library__pathList;
   /** list of all paths used for library search */
@@ -100,7 +104,7 @@ static TypeDescriptor_Record Library__tdRecord =
   { /* .objectSize = */ sizeof(Library__Record), /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ Library__make,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Library__hasPath };
+    /* .keyValidationProc = */ Library__hasPath, /* .name = */ "Library" };
 
 static TypeDescriptor_Type Library__typeDescriptor = &Library__tdRecord;
   /** variable used for describing the type properties when library
@@ -151,8 +155,8 @@ static Library__Type Library__addFile (in String_Type path,
     library = NULL;
   } else {
     // TODO: this lookup does currently not work for embedded
-    //       libraries...
-    library = List_lookup(Library__list, path);
+    //       libraries, because they all have the same path...
+    library = (offset > 0 ? NULL : List_lookup(Library__list, fileName));
 
     if (library != NULL) {
       /* there is already an entry ==> skip */
@@ -173,69 +177,6 @@ static Library__Type Library__addFile (in String_Type path,
 
 /*--------------------*/
 
-static void Library__buildIndex (void)
- /** build an in-memory cache of all the symbols contained in all
-     libraries */
-{
-  List_Cursor libraryCursor;
-
-  Library__symbolIndex = Multimap_make(String_typeDescriptor);
-
-  /* iterate through all library files */
-  for (libraryCursor = List_resetCursor(Library__list);
-       libraryCursor != NULL;
-       List_advanceCursor(&libraryCursor)) {
-
-    Library__Type library =
-      Library__attemptConversion(List_getElementAtCursor(libraryCursor));
-
-    if (!library->isObjectFile) {
-      String_Type filePath = String_make();
-      File_Type libraryFile;
-      Library__ParseState state = Library__ParseState_atFileSpecification;
-
-      String_copy(&filePath, library->path);
-
-      if (!File_open(&libraryFile, filePath, File_Mode_read)) {
-	Error_raise(Error_Criticality_fatalError,
-		    "cannot open library file %s", 
-		    String_asCharPointer(filePath));
-      } else {
-	/* read lines from the library file specifying some object file
-	   or some embedded index information */
-	String_Type libraryFileLine = String_make();
-
-	while (state != Library__ParseState_done) {
-	  File_readLine(&libraryFile, &libraryFileLine);
-
-	  if (String_length(libraryFileLine) == 0) {
-	    /* end of file */
-	    state = Library__ParseState_done;
-	  } else {
-	    String_removeTrailingCrLf(&libraryFileLine);
-	    Library__handleFileLine(&library, libraryFileLine, &state);
-
-	    if (state == Library__ParseState_inError) {
-	      Error_raise(Error_Criticality_fatalError,
-			  "bad line in library file %s: %s",
-			  String_asCharPointer(filePath), 
-			  String_asCharPointer(libraryFileLine));
-	      state = Library__ParseState_done;
-	    }
-	  }
-	}
-
-	String_destroy(&libraryFileLine);
-      }
-
-      File_close(&libraryFile);
-      String_destroy(&filePath);
-    }
-  }
-}
-
-/*--------------------*/
-
 static void Library__ensureSuffix (inout String_Type *st,
 				   in String_Type suffix)
   /** ensures that <st> has <suffix> */
@@ -438,7 +379,10 @@ static void Library__load (inout Library__Type *library)
 		"embedded library not supported");
   }
 
+  Statistics_beginSpan("library member",
+		       String_asCharPointer(currentLibrary->path));
   Parser_parseObjectFile(true, currentLibrary->path);
+  Statistics_endSpan();
   currentLibrary->loadStatus = Library__LoadStatus_loaded;
 }
 
@@ -450,6 +394,7 @@ static Object Library__make (void)
   Library__Type library = NEW(Library__Record);
 
   library->magicNumber    = Library__magicNumber;
+  library->isIndexed      = false;
   library->loadStatus     = Library__LoadStatus_notLoaded;
   library->path           = String_make();
   library->symbolNameList = StringList_make();
@@ -510,6 +455,7 @@ void Library_initialize (void)
 {
   Library__list = List_make(Library__typeDescriptor);
   Library__pathList = StringList_make();
+  Library__symbolIndex = NULL;
 
   Library__fileExtension       = String_makeFromCharArray(".lib");
   Library__objectFileExtension = String_makeFromCharArray(".o");
@@ -527,6 +473,10 @@ void Library_finalize (void)
 {
   List_destroy(&Library__list);
   List_destroy(&Library__pathList);
+
+  if (Library__symbolIndex != NULL) {
+    Multimap_destroy(&Library__symbolIndex);
+  }
   String_destroy(&Library__fileExtension);
   String_destroy(&Library__objectFileExtension);
   String_destroy(&Library__indexStartKeyword);
@@ -619,13 +569,79 @@ void Library_addFilePathName (in String_Type path, out Boolean *isFound)
 /* TRANSFORMATION     */
 /*--------------------*/
 
+void Library_buildSymbolIndex (void)
+{
+  List_Cursor libraryCursor;
+
+  if (Library__symbolIndex == NULL) {
+    Library__symbolIndex = Multimap_make(String_typeDescriptor);
+  }
+
+  /* iterate through all library files */
+  for (libraryCursor = List_resetCursor(Library__list);
+       libraryCursor != NULL;
+       List_advanceCursor(&libraryCursor)) {
+
+    Library__Type library =
+      Library__attemptConversion(List_getElementAtCursor(libraryCursor));
+
+    if (!library->isObjectFile && !library->isIndexed) {
+      String_Type filePath = String_make();
+      File_Type libraryFile;
+      Library__ParseState state = Library__ParseState_atFileSpecification;
+
+      String_copy(&filePath, library->path);
+      Statistics_beginSpan("library", String_asCharPointer(filePath));
+
+      if (!File_open(&libraryFile, filePath, File_Mode_read)) {
+	Error_raise(Error_Criticality_fatalError,
+		    "cannot open library file %s", 
+		    String_asCharPointer(filePath));
+      } else {
+	/* read lines from the library file specifying some object file
+	   or some embedded index information */
+	String_Type libraryFileLine = String_make();
+
+	while (state != Library__ParseState_done) {
+	  File_readLine(&libraryFile, &libraryFileLine);
+
+	  if (String_length(libraryFileLine) == 0) {
+	    /* end of file */
+	    state = Library__ParseState_done;
+	  } else {
+	    String_removeTrailingCrLf(&libraryFileLine);
+	    Library__handleFileLine(&library, libraryFileLine, &state);
+
+	    if (state == Library__ParseState_inError) {
+	      Error_raise(Error_Criticality_fatalError,
+			  "bad line in library file %s: %s",
+			  String_asCharPointer(filePath), 
+			  String_asCharPointer(libraryFileLine));
+	      state = Library__ParseState_done;
+	    }
+	  }
+	}
+
+	String_destroy(&libraryFileLine);
+      }
+
+      File_close(&libraryFile);
+      Statistics_endSpan();
+      String_destroy(&filePath);
+      library->isIndexed = true;
+    }
+  }
+}
+
+/*--------------------*/
+
 void Library_resolveUndefinedSymbols (void)
 {
   Boolean someSymbolWasResolved = true;
   Boolean allSymbolsAreResolved = false;
   Symbol_List undefinedSymbolList = List_make(Symbol_typeDescriptor);
 
-  Library__buildIndex();
+  Library_buildSymbolIndex();
 
   while (someSymbolWasResolved) {
     List_Cursor libraryCursor;
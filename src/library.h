@@ -79,6 +79,14 @@ void Library_addFilePathName (in String_Type path, out Boolean *isFound);
 /* TRANSFORMATION     */
 /*--------------------*/
 
+void Library_buildSymbolIndex (void);
+  /** reads all library files added so far and records the symbols
+      defined by their object files in an index; library files
+      already indexed are skipped, so this may be called repeatedly
+      (it is also done implicitly by <resolveUndefinedSymbols>) */
+
+/*--------------------*/
+
 void Library_resolveUndefinedSymbols (void);
   /** searches all specified library files and library directories for
       undefined symbols until no more resolutions can be done; adds
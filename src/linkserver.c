@@ -0,0 +1,433 @@
+/** LinkServer module --
+    Implementation of module providing services for running the
+    linker as a resident server handling link requests over a local
+    socket.
+
+    NOTE: as a naming convention all file scope names have the module
+    name as a prefix with a single underscore for externally visible
+    names and two underscores for internal names
+*/
+
+#include "linkserver.h"
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "error.h"
+#include "file.h"
+#include "list.h"
+#include "string.h"
+#include "stringlist.h"
+
+#include <stdio.h>
+# define StdIO_fflush  fflush
+# define StdIO_sprintf sprintf
+#include <stdlib.h>
+# define StdLib_exit   exit
+#include <string.h>
+# define STRING_copy   strcpy
+# define STRING_fill   memset
+# define STRING_length strlen
+
+#if defined(unix) || defined(__unix__) || defined(__APPLE__)
+# define LinkServer__isSupported
+#include <signal.h>
+# define Signal_default   SIG_DFL
+# define Signal_ignore    SIG_IGN
+# define Signal_set       signal
+#include <sys/socket.h>
+# define Socket_accept    accept
+# define Socket_bind      bind
+# define Socket_connect   connect
+# define Socket_listen    listen
+# define Socket_make      socket
+#include <sys/un.h>
+typedef struct sockaddr_un LinkServer__SocketAddress;
+#include <unistd.h>
+# define UniStd_changeDirectory     chdir
+# define UniStd_close               close
+# define UniStd_duplicate           dup2
+# define UniStd_fork                fork
+# define UniStd_getCurrentDirectory getcwd
+# define UniStd_read                read
+# define UniStd_removeFile          unlink
+# define UniStd_systemConfiguration sysconf
+# define UniStd_write               write
+#include <sys/wait.h>
+# define Wait_exitStatus            WEXITSTATUS
+# define Wait_hasExited             WIFEXITED
+# define Wait_waitForProcess        waitpid
+#endif
+
+/*========================================*/
+
+#define LinkServer__bufferSize 1024
+  /** size of buffers for directory names and transferred data */
+
+#define LinkServer__maxPendingRequestCount 16
+  /** number of requests which may wait for being accepted */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+#ifdef LinkServer__isSupported
+
+static Boolean LinkServer__readString (in int socket, out String_Type *st)
+  /** reads characters from <socket> into <st> up to a terminating NUL
+      character; returns false when the data ends prematurely */
+{
+  Boolean isDone = false;
+  Boolean isOkay = true;
+
+  String_clear(st);
+
+  while (!isDone) {
+    char ch;
+
+    isOkay = (UniStd_read(socket, &ch, 1) == 1);
+    isDone = (!isOkay || ch == String_terminator);
+
+    if (!isDone) {
+      String_appendChar(st, ch);
+    }
+  }
+
+  return isOkay;
+}
+
+/*--------------------*/
+
+static Boolean LinkServer__writeData (in int socket, in char *data,
+				      in SizeType size)
+  /** writes <size> bytes in <data> to <socket>; returns false when
+      the data cannot be transferred */
+{
+  Boolean isOkay = true;
+
+  while (isOkay && size > 0) {
+    long byteCount = (long) UniStd_write(socket, data, size);
+    isOkay = (byteCount > 0);
+
+    if (isOkay) {
+      data += byteCount;
+      size -= (SizeType) byteCount;
+    }
+  }
+
+  return isOkay;
+}
+
+/*--------------------*/
+
+static void LinkServer__handleRequest (in int connection,
+				       in LinkServer_RequestProc requestProc)
+  /** reads a link request from <connection> and handles it by
+      <requestProc> with standard output and error directed to
+      <connection>; terminates the current process afterwards */
+{
+  String_Type directory = String_make();
+  StringList_Type argumentList = StringList_make();
+  String_Type st = String_make();
+  long argumentCount = 0;
+  Boolean isOkay;
+
+  isOkay = (LinkServer__readString(connection, &directory)
+	    && LinkServer__readString(connection, &st)
+	    && String_convertToLong(st, 10, &argumentCount)
+	    && argumentCount >= 0);
+
+  while (isOkay && (long) List_length(argumentList) < argumentCount) {
+    isOkay = LinkServer__readString(connection, &st);
+    StringList_append(&argumentList, st);
+  }
+
+  isOkay = (isOkay
+	    && UniStd_changeDirectory(String_asCharPointer(directory)) == 0);
+
+  /* the link itself may wait for processes of its own */
+  Signal_set(SIGCHLD, Signal_default);
+
+  if (isOkay) {
+    char **argv = NEWARRAY(char *, argumentCount + 2);
+    char trailer[2];
+    long i;
+
+    UniStd_duplicate(connection, 1);
+    UniStd_duplicate(connection, 2);
+
+    /* the strings stay valid, because the process ends afterwards */
+    argv[0] = "aslink";
+
+    for (i = 1;  i <= argumentCount;  i++) {
+      String_Type argument = List_getElement(argumentList, i);
+      argv[i] = String_asCharPointer(argument);
+    }
+
+    requestProc((int) argumentCount + 1, argv);
+
+    StdIO_fflush(NULL);
+    trailer[0] = String_terminator;
+    trailer[1] = 0;
+    LinkServer__writeData(connection, trailer, 2);
+  }
+
+  UniStd_close(connection);
+  StdLib_exit(isOkay ? 0 : 1);
+}
+
+#endif
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void LinkServer_initialize (void)
+{
+}
+
+/*--------------------*/
+
+void LinkServer_finalize (void)
+{
+}
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+SizeType LinkServer_getProcessorCount (void)
+{
+  SizeType result = 1;
+
+#if defined(LinkServer__isSupported) && defined(_SC_NPROCESSORS_ONLN)
+  long processorCount = UniStd_systemConfiguration(_SC_NPROCESSORS_ONLN);
+
+  if (processorCount > 1) {
+    result = (SizeType) processorCount;
+  }
+#endif
+
+  return result;
+}
+
+/*--------------------*/
+/* TRANSFORMATION     */
+/*--------------------*/
+
+Boolean LinkServer_runConcurrently (in LinkServer_SubprocessProc proc,
+				    inout Object dataList[],
+				    in SizeType count)
+{
+  Boolean isOkay = true;
+  SizeType i;
+
+#ifndef LinkServer__isSupported
+  for (i = 0;  i < count;  i++) {
+    proc(dataList[i]);
+  }
+#else
+  char *procName = "LinkServer_runConcurrently";
+  int *processIdList = NEWARRAY(int, count + 1);
+
+  ASSERTION(processIdList != NULL, procName, "out of memory");
+
+  for (i = 0;  i < count;  i++) {
+    int processId;
+
+    /* flush all pending output so that it is not duplicated (this
+       also covers output of a run in this process) */
+    StdIO_fflush(NULL);
+    processId = UniStd_fork();
+
+    if (processId == 0) {
+      proc(dataList[i]);
+      StdIO_fflush(NULL);
+      StdLib_exit(0);
+    } else if (processId < 0) {
+      proc(dataList[i]);
+    }
+
+    processIdList[i] = processId;
+  }
+
+  for (i = 0;  i < count;  i++) {
+    int processId = processIdList[i];
+
+    if (processId > 0) {
+      int status;
+      isOkay = (Wait_waitForProcess(processId, &status, 0) == processId
+		&& Wait_hasExited(status) && Wait_exitStatus(status) == 0
+		&& isOkay);
+    }
+  }
+
+  DESTROY(processIdList);
+#endif
+
+  return isOkay;
+}
+
+/*--------------------*/
+
+Boolean LinkServer_runInSubprocess (in LinkServer_SubprocessProc proc,
+				    inout Object data)
+{
+  Boolean isOkay = false;
+
+#ifndef LinkServer__isSupported
+  Error_raise(Error_Criticality_error,
+	      "forked processes not supported on this platform");
+#else
+  int processId;
+
+  /* flush all pending output so that it is not duplicated */
+  StdIO_fflush(NULL);
+  processId = UniStd_fork();
+
+  if (processId == 0) {
+    proc(data);
+    StdIO_fflush(NULL);
+    StdLib_exit(0);
+  } else if (processId > 0) {
+    int status;
+
+    isOkay = (Wait_waitForProcess(processId, &status, 0) == processId
+	      && Wait_hasExited(status) && Wait_exitStatus(status) == 0);
+  }
+#endif
+
+  return isOkay;
+}
+
+/*--------------------*/
+
+int LinkServer_sendRequest (in String_Type socketName,
+			    in int argc, in char *argv[])
+{
+  int status = 1;
+
+#ifndef LinkServer__isSupported
+  Error_raise(Error_Criticality_error,
+	      "link server not supported on this platform");
+#else
+  char *name = String_asCharPointer(socketName);
+  LinkServer__SocketAddress address;
+  int connection = Socket_make(AF_UNIX, SOCK_STREAM, 0);
+  Boolean isOkay = (connection >= 0
+		    && STRING_length(name) < sizeof(address.sun_path));
+
+  if (isOkay) {
+    STRING_fill(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    STRING_copy(address.sun_path, name);
+    isOkay = (Socket_connect(connection, (struct sockaddr *) &address,
+			     sizeof(address)) == 0);
+  }
+
+  if (!isOkay) {
+    Error_raise(Error_Criticality_error,
+		"could not connect to link server at %s", name);
+  } else {
+    char buffer[LinkServer__bufferSize];
+    Boolean trailerIsFound = false;
+    Boolean statusIsFound = false;
+    long byteCount;
+    int i;
+
+    /* send directory, argument count and arguments */
+    isOkay = (UniStd_getCurrentDirectory(buffer, sizeof(buffer)) != NULL
+	      && LinkServer__writeData(connection, buffer,
+				       STRING_length(buffer) + 1));
+    StdIO_sprintf(buffer, "%d", argc);
+    isOkay = (isOkay
+	      && LinkServer__writeData(connection, buffer,
+				       STRING_length(buffer) + 1));
+
+    for (i = 0;  isOkay && i < argc;  i++) {
+      isOkay = LinkServer__writeData(connection, argv[i],
+				     STRING_length(argv[i]) + 1);
+    }
+
+    /* copy diagnostics up to the trailer with the exit status */
+    while (isOkay && !statusIsFound) {
+      byteCount = (long) UniStd_read(connection, buffer, sizeof(buffer));
+      isOkay = (byteCount > 0);
+
+      for (i = 0;  isOkay && i < byteCount && !statusIsFound;  i++) {
+	if (trailerIsFound) {
+	  status = buffer[i];
+	  statusIsFound = true;
+	} else if (buffer[i] == String_terminator) {
+	  trailerIsFound = true;
+	} else {
+	  File_writeChar(&File_stderr, buffer[i]);
+	}
+      }
+    }
+  }
+
+  if (connection >= 0) {
+    UniStd_close(connection);
+  }
+#endif
+
+  return status;
+}
+
+/*--------------------*/
+
+void LinkServer_serve (in String_Type socketName,
+		       in LinkServer_RequestProc requestProc)
+{
+#ifndef LinkServer__isSupported
+  Error_raise(Error_Criticality_error,
+	      "link server not supported on this platform");
+#else
+  char *name = String_asCharPointer(socketName);
+  LinkServer__SocketAddress address;
+  int serverSocket = Socket_make(AF_UNIX, SOCK_STREAM, 0);
+  Boolean isOkay = (serverSocket >= 0
+		    && STRING_length(name) < sizeof(address.sun_path));
+
+  if (isOkay) {
+    STRING_fill(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    STRING_copy(address.sun_path, name);
+    UniStd_removeFile(name);
+    isOkay = (Socket_bind(serverSocket, (struct sockaddr *) &address,
+			  sizeof(address)) == 0
+	      && Socket_listen(serverSocket,
+			       LinkServer__maxPendingRequestCount) == 0);
+  }
+
+  if (!isOkay) {
+    Error_raise(Error_Criticality_error,
+		"could not set up link server at %s", name);
+  } else {
+    /* finished link processes are cleaned up automatically */
+    Signal_set(SIGCHLD, Signal_ignore);
+
+    for (;;) {
+      int connection = Socket_accept(serverSocket, NULL, NULL);
+
+      if (connection >= 0) {
+	if (UniStd_fork() == 0) {
+	  UniStd_close(serverSocket);
+	  LinkServer__handleRequest(connection, requestProc);
+	}
+
+	UniStd_close(connection);
+      }
+    }
+  }
+
+  if (serverSocket >= 0) {
+    UniStd_close(serverSocket);
+  }
+#endif
+}
@@ -0,0 +1,113 @@
+/** LinkServer module --
+    This module provides services for running the linker as a resident
+    server which handles link requests sent by clients over a local
+    socket.
+
+    The server is prepared once (e.g. by indexing the libraries) and
+    then waits for requests on a Unix-domain socket.  A request
+    consists of the current directory of the client and a list of
+    command line arguments.  Each request is handled in a process of
+    its own forked from the server.  This process inherits all data
+    prepared by the server and needs no reset afterwards, because it
+    terminates after the link.  Its standard output and standard
+    error are directed to the client, so the client shows the same
+    diagnostics as a linker run directly.
+
+    The protocol is simple: the client sends its directory, the
+    number of arguments and the arguments, each terminated by a
+    NUL character.  The server sends back the diagnostic text
+    followed by a NUL character and a byte with the exit status.  When
+    the link process stops prematurely (e.g. by a fatal error), the
+    connection is closed without that trailer and the client reports
+    a failure.
+
+    The same mechanism is also available for parts of a single link:
+    a routine may be run in a process forked from the current one
+    which gets a copy of all data prepared so far and cannot change
+    the data of the current process.  Several independent runs of a
+    routine (e.g. the writers of different output files) may also be
+    done concurrently in processes of their own.
+
+    The server and the forked processes are only available on
+    platforms supporting Unix-domain sockets and process forking.
+*/
+
+#ifndef __LINKSERVER_H
+#define __LINKSERVER_H
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "string.h"
+
+/*========================================*/
+
+typedef void (*LinkServer_RequestProc)(in int argc, in char *argv[]);
+  /** routine handling a link request with command line arguments
+      given by <argc> and <argv> where the first argument is the
+      program name */
+
+typedef void (*LinkServer_SubprocessProc)(inout Object data);
+  /** routine to be run with <data> in a forked process */
+
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void LinkServer_initialize (void);
+  /** sets up internal data structures for this module */
+
+/*--------------------*/
+
+void LinkServer_finalize (void);
+  /** cleans up internal data structures for this module */
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+SizeType LinkServer_getProcessorCount (void);
+  /** returns the number of processors available for concurrent
+      processes (at least 1) */
+
+/*--------------------*/
+/* TRANSFORMATION     */
+/*--------------------*/
+
+Boolean LinkServer_runConcurrently (in LinkServer_SubprocessProc proc,
+				    inout Object dataList[],
+				    in SizeType count);
+  /** runs <proc> for each of the <count> objects in <dataList>, each
+      in a process forked from the current one, and waits for the end
+      of all those processes; when forking is not supported or fails,
+      <proc> is run in the current process instead; returns false when
+      some process does not end with exit status 0 */
+
+/*--------------------*/
+
+Boolean LinkServer_runInSubprocess (in LinkServer_SubprocessProc proc,
+				    inout Object data);
+  /** runs <proc> with <data> in a process forked from the current
+      one and waits for its end; returns false when the process
+      cannot be created or does not end with exit status 0 */
+
+/*--------------------*/
+
+int LinkServer_sendRequest (in String_Type socketName,
+			    in int argc, in char *argv[]);
+  /** sends a link request with command line arguments given by
+      <argc> and <argv> to the server listening on socket
+      <socketName>, copies all diagnostics to standard error and
+      returns the exit status of the link */
+
+/*--------------------*/
+
+void LinkServer_serve (in String_Type socketName,
+		       in LinkServer_RequestProc requestProc);
+  /** waits for link requests on socket <socketName> and handles each
+      request by <requestProc> in a process forked from the current
+      one; only returns when the socket cannot be set up */
+
+#endif /* __LINKSERVER_H */
@@ -0,0 +1,595 @@
+/** LinkState module --
+    Implementation of module providing services for incremental
+    linking by keeping the state of the previous link in a file.
+
+    NOTE: as a naming convention all file scope names have the module
+    name as a prefix with a single underscore for externally visible
+    names and two underscores for internal names
+*/
+
+#include "linkstate.h"
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "area.h"
+#include "codeoutput.h"
+#include "error.h"
+#include "file.h"
+#include "list.h"
+#include "module.h"
+#include "string.h"
+#include "stringlist.h"
+#include "symbol.h"
+#include "target.h"
+
+#include <stdio.h>
+# define StdIO_sprintf sprintf
+# define StdIO_sscanf  sscanf
+
+/*========================================*/
+
+#define LinkState__bufferSize 4096
+  /** number of bytes read at once when computing a file digest */
+
+#define LinkState__initialDigest 0x811C9DC5UL
+  /** start value of a 32 bit FNV-1a digest */
+
+#define LinkState__argumentKind 'A'
+#define LinkState__commentKind  ';'
+#define LinkState__inputKind    'I'
+#define LinkState__layoutKind   'L'
+#define LinkState__moduleKind   'M'
+#define LinkState__outputKind   'O'
+  /** leading characters of the entries in a link state file */
+
+#define LinkState__fileFieldIndex       3
+#define LinkState__layoutFileFieldIndex 6
+#define LinkState__moduleFileFieldIndex 3
+  /** number of fields before the file name in input and output
+      entries, in layout entries and in module entries */
+
+/*========================================*/
+
+static StringList_Type LinkState__changedFileNameList;
+  /** names of the input files changed since the previous link */
+
+static StringList_Type LinkState__layoutEntryList;
+  /** layout entries of the previous link */
+
+static StringList_Type LinkState__moduleEntryList;
+  /** module entries of the previous link */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static void LinkState__addToDigest (inout UINT32 *digest,
+				    in UINT8 *data, in SizeType length)
+  /** combines the 32 bit FNV-1a <digest> with the <length> bytes in
+      <data> */
+{
+  SizeType i;
+
+  for (i = 0;  i < length;  i++) {
+    *digest = ((*digest ^ data[i]) * 0x01000193UL) & 0xFFFFFFFFUL;
+  }
+}
+
+/*--------------------*/
+
+static SizeType LinkState__fieldPosition (in String_Type entry,
+					  in UINT8 fieldIndex)
+  /** returns the position in <entry> of the field following the first
+      <fieldIndex> fields (each terminated by a blank) or zero when
+      <entry> has too few fields */
+{
+  SizeType lineLength = String_length(entry);
+  SizeType position = 1;
+  UINT8 blankCount = 0;
+
+  while (position < lineLength && blankCount < fieldIndex) {
+    position++;
+    blankCount += (String_getCharacter(entry, position) == ' ');
+  }
+
+  return (blankCount < fieldIndex ? 0 : position + 1);
+}
+
+/*--------------------*/
+
+static void LinkState__getFileName (out String_Type *fileName,
+				    in String_Type entry,
+				    in UINT8 fieldIndex)
+  /** returns the file name at the end of <entry> following the first
+      <fieldIndex> fields in <fileName>; when <entry> has too few
+      fields, <fileName> is empty */
+{
+  SizeType position = LinkState__fieldPosition(entry, fieldIndex);
+
+  String_clear(fileName);
+
+  if (position > 0) {
+    String_getSubstring(fileName, entry, position,
+			String_length(entry) - position + 1);
+  }
+}
+
+/*--------------------*/
+
+static void LinkState__appendModuleNames (inout String_Type *entry,
+					  in Module_Type module)
+  /** appends the name of <module> and the name of its file separated
+      by blanks to <entry>; a missing module is given as "-" */
+{
+  if (module == NULL) {
+    String_appendCharArray(entry, " - -");
+  } else {
+    String_Type st = String_make();
+
+    Module_getName(module, &st);
+    String_appendChar(entry, ' ');
+    String_append(entry, st);
+    Module_getFileName(module, &st);
+    String_appendChar(entry, ' ');
+    String_append(entry, st);
+    String_destroy(&st);
+  }
+}
+
+/*--------------------*/
+
+static void LinkState__eraseCode (in Boolean isComplete,
+				  in StringList_Type fileNameList)
+  /** erases the code of the segments in the previous layout in all
+      code output streams; when <isComplete> is not set, only the
+      segments from files in <fileNameList> are erased */
+{
+  String_Type fileName = String_make();
+  List_Cursor cursor;
+
+  for (cursor = List_resetCursor(LinkState__layoutEntryList);
+       cursor != NULL;  List_advanceCursor(&cursor)) {
+    String_Type entry = List_getElementAtCursor(cursor);
+    int bank;
+    unsigned long address;
+    unsigned long size;
+
+    LinkState__getFileName(&fileName, entry,
+			   LinkState__layoutFileFieldIndex);
+
+    if ((isComplete || List_lookup(fileNameList, fileName) != NULL)
+	&& StdIO_sscanf(String_asCharPointer(entry), "%*c %d %lX %lX",
+			&bank, &address, &size) == 3) {
+      CodeOutput_eraseRange((Target_Bank) bank, (UINT32) address,
+			    (UINT32) size);
+    }
+  }
+
+  String_destroy(&fileName);
+}
+
+/*--------------------*/
+
+static void LinkState__makeFileEntry (out String_Type *entry,
+				      in char kind,
+				      in String_Type fileName)
+  /** builds the state entry of <kind> for file with <fileName> in
+      <entry> consisting of the kind, the file size, a 32 bit FNV-1a
+      digest of its contents and the file name; when the file cannot
+      be read, size and digest are given as "-" */
+{
+  File_Type file;
+  Boolean isOpen = File_open(&file, fileName, File_Mode_readBinary);
+  char line[40];
+
+  if (!isOpen) {
+    StdIO_sprintf(line, "%c - - ", kind);
+  } else {
+    UINT8 *buffer = NEWARRAY(UINT8, LinkState__bufferSize);
+    UINT32 digest = LinkState__initialDigest;
+    UINT32 size = 0;
+    SizeType byteCount;
+
+    do {
+      byteCount = File_readBytes(&file, buffer, LinkState__bufferSize);
+      size += (UINT32) byteCount;
+      LinkState__addToDigest(&digest, buffer, byteCount);
+    } while (byteCount > 0);
+
+    StdIO_sprintf(line, "%c %lu %08lX ", kind, size, digest);
+    DESTROY(buffer);
+    File_close(&file);
+  }
+
+  String_copyCharArray(entry, line);
+  String_append(entry, fileName);
+}
+
+/*--------------------*/
+
+static void LinkState__makeLayoutEntryList (out StringList_Type *entryList)
+  /** returns in <entryList> the layout entries of the current link
+      consisting of bank, address and size, area name, module name
+      and file name for each segment placed */
+{
+  Area_List areaList = List_make(Area_typeDescriptor);
+  Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+  String_Type entry = String_make();
+  String_Type segmentName = String_make();
+  List_Cursor areaCursor;
+
+  List_clear(entryList);
+  Area_getList(&areaList);
+
+  for (areaCursor = List_resetCursor(areaList);  areaCursor != NULL;
+       List_advanceCursor(&areaCursor)) {
+    Area_Type area = List_getElementAtCursor(areaCursor);
+    List_Cursor segmentCursor;
+
+    Area_getListOfSegments(area, &segmentList);
+
+    for (segmentCursor = List_resetCursor(segmentList);
+	 segmentCursor != NULL;  List_advanceCursor(&segmentCursor)) {
+      Area_Segment segment = List_getElementAtCursor(segmentCursor);
+
+      if (!Area_segmentIsRemoved(segment)) {
+	Target_Bank bank = 0;
+	char line[40];
+
+	Area_getSegmentName(segment, &segmentName);
+
+	if (Target_info.getBankFromSegmentName != NULL) {
+	  bank = Target_info.getBankFromSegmentName(segmentName);
+	}
+
+	StdIO_sprintf(line, "%c %d %lX %lX ", LinkState__layoutKind,
+		      (int) bank,
+		      (unsigned long) Area_getSegmentAddress(segment),
+		      (unsigned long) Area_getSegmentSize(segment));
+	String_copyCharArray(&entry, line);
+	String_append(&entry, segmentName);
+	LinkState__appendModuleNames(&entry,
+				     Area_getSegmentModule(segment));
+	StringList_append(entryList, entry);
+      }
+    }
+  }
+
+  String_destroy(&segmentName);
+  String_destroy(&entry);
+  List_destroy(&segmentList);
+  List_destroy(&areaList);
+}
+
+/*--------------------*/
+
+static void LinkState__makeModuleEntryList (out StringList_Type *entryList)
+  /** returns in <entryList> the module entries of the current link
+      consisting of a digest of the names and addresses of all symbols
+      defined or referenced, the module name and the file name for
+      each module */
+{
+  List_Type moduleList = List_make(Module_typeDescriptor);
+  Symbol_List symbolList = List_make(Symbol_typeDescriptor);
+  String_Type entry = String_make();
+  String_Type symbolName = String_make();
+  List_Cursor moduleCursor;
+
+  List_clear(entryList);
+  Module_getModuleList(&moduleList);
+
+  for (moduleCursor = List_resetCursor(moduleList);  moduleCursor != NULL;
+       List_advanceCursor(&moduleCursor)) {
+    Module_Type module = List_getElementAtCursor(moduleCursor);
+    UINT32 digest = LinkState__initialDigest;
+    List_Cursor symbolCursor;
+    char line[20];
+
+    Module_getSymbolList(module, &symbolList);
+
+    for (symbolCursor = List_resetCursor(symbolList);
+	 symbolCursor != NULL;  List_advanceCursor(&symbolCursor)) {
+      Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
+      Target_Address address = Symbol_absoluteAddress(symbol);
+      UINT8 addressBytes[2];
+
+      addressBytes[0] = (UINT8) (address & 0xFF);
+      addressBytes[1] = (UINT8) ((address >> 8) & 0xFF);
+      Symbol_getName(symbol, &symbolName);
+      LinkState__addToDigest(&digest,
+			     (UINT8 *) String_asCharPointer(symbolName),
+			     String_length(symbolName) + 1);
+      LinkState__addToDigest(&digest, addressBytes, 2);
+    }
+
+    StdIO_sprintf(line, "%c %08lX", LinkState__moduleKind, digest);
+    String_copyCharArray(&entry, line);
+    LinkState__appendModuleNames(&entry, module);
+    StringList_append(entryList, entry);
+  }
+
+  String_destroy(&symbolName);
+  String_destroy(&entry);
+  List_destroy(&symbolList);
+  List_destroy(&moduleList);
+}
+
+/*--------------------*/
+
+static void LinkState__writeEntries (inout File_Type *stateFile,
+				     in StringList_Type entryList)
+  /** writes all entries in <entryList> as lines to <stateFile> */
+{
+  List_Cursor cursor;
+
+  for (cursor = List_resetCursor(entryList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type entry = List_getElementAtCursor(cursor);
+    File_writeString(stateFile, entry);
+    File_writeChar(stateFile, '\n');
+  }
+}
+
+/*--------------------*/
+
+static void LinkState__writeFileEntries (inout File_Type *stateFile,
+					 in char kind,
+					 in StringList_Type fileNameList)
+  /** writes state entries of <kind> for all files in <fileNameList>
+      to <stateFile> */
+{
+  String_Type entry = String_make();
+  List_Cursor cursor;
+
+  for (cursor = List_resetCursor(fileNameList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type fileName = List_getElementAtCursor(cursor);
+    LinkState__makeFileEntry(&entry, kind, fileName);
+    File_writeString(stateFile, entry);
+    File_writeChar(stateFile, '\n');
+  }
+
+  String_destroy(&entry);
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void LinkState_initialize (void)
+{
+  LinkState__changedFileNameList = StringList_make();
+  LinkState__layoutEntryList     = StringList_make();
+  LinkState__moduleEntryList     = StringList_make();
+}
+
+/*--------------------*/
+
+void LinkState_finalize (void)
+{
+  List_destroy(&LinkState__moduleEntryList);
+  List_destroy(&LinkState__layoutEntryList);
+  List_destroy(&LinkState__changedFileNameList);
+}
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+LinkState_Status LinkState_check (in String_Type stateFileName,
+				  in StringList_Type argumentList)
+{
+  SizeType argumentCount = List_length(argumentList);
+  SizeType argumentIndex = 0;
+  File_Type stateFile;
+  Boolean isPatchable = true;
+  Boolean isValid = File_open(&stateFile, stateFileName, File_Mode_read);
+  LinkState_Status result = LinkState_Status_outdated;
+
+  List_clear(&LinkState__changedFileNameList);
+  List_clear(&LinkState__layoutEntryList);
+  List_clear(&LinkState__moduleEntryList);
+
+  if (isValid) {
+    String_Type entry = String_make();
+    String_Type line = String_make();
+    String_Type text = String_make();
+
+    for (;;) {
+      SizeType lineLength;
+      char kind;
+
+      File_readLine(&stateFile, &line);
+      String_removeTrailingCrLf(&line);
+      lineLength = String_length(line);
+
+      if (lineLength == 0 || !isValid) {
+	break;
+      }
+
+      kind = String_getCharacter(line, 1);
+
+      if (kind == LinkState__commentKind) {
+	/* ignore comment line */
+      } else if (kind == LinkState__argumentKind && lineLength >= 2
+		 && String_getCharacter(line, 2) == ' ') {
+	argumentIndex++;
+	String_getSubstring(&text, line, 3, lineLength - 2);
+	isValid = (argumentIndex <= argumentCount
+		   && String_isEqual(text,
+				List_getElement(argumentList, argumentIndex)));
+      } else if (kind == LinkState__inputKind
+		 || kind == LinkState__outputKind) {
+	LinkState__getFileName(&text, line, LinkState__fileFieldIndex);
+
+	if (String_length(text) == 0) {
+	  isValid = false;
+	} else {
+	  LinkState__makeFileEntry(&entry, kind, text);
+
+	  if (String_isEqual(entry, line)) {
+	    /* an output file which has not been written cannot be
+	       patched */
+	    isPatchable = (isPatchable && (kind == LinkState__inputKind
+			   || String_getCharacter(line, 3) != '-'));
+	  } else if (kind == LinkState__inputKind) {
+	    StringList_append(&LinkState__changedFileNameList, text);
+	  } else {
+	    isValid = false;
+	  }
+	}
+      } else if (kind == LinkState__layoutKind) {
+	StringList_append(&LinkState__layoutEntryList, line);
+      } else if (kind == LinkState__moduleKind) {
+	StringList_append(&LinkState__moduleEntryList, line);
+      } else {
+	Error_raise(Error_Criticality_warning,
+		    "bad entry in link state file %s",
+		    String_asCharPointer(stateFileName));
+	isValid = false;
+      }
+    }
+
+    isValid = (isValid && argumentIndex == argumentCount);
+    File_close(&stateFile);
+    String_destroy(&text);
+    String_destroy(&line);
+    String_destroy(&entry);
+  }
+
+  if (!isValid) {
+    result = LinkState_Status_outdated;
+  } else if (List_length(LinkState__changedFileNameList) == 0) {
+    result = LinkState_Status_upToDate;
+  } else if (isPatchable) {
+    result = LinkState_Status_patchable;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+Boolean LinkState_preparePatching (in StringList_Type linkFileNameList,
+				   out StringList_Type *fileNameList)
+{
+  StringList_Type entryList = StringList_make();
+  StringList_Type changedFileNameList = StringList_make();
+  String_Type fileName = String_make();
+  Boolean isPartial;
+  List_Cursor cursor;
+  List_Cursor previousCursor;
+
+  List_clear(fileNameList);
+
+  /* the layout must have the same entries in the same order */
+  LinkState__makeLayoutEntryList(&entryList);
+  isPartial = (List_length(entryList)
+	       == List_length(LinkState__layoutEntryList));
+  previousCursor = List_resetCursor(LinkState__layoutEntryList);
+
+  for (cursor = List_resetCursor(entryList);  isPartial && cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    isPartial = String_isEqual(List_getElementAtCursor(cursor),
+			       List_getElementAtCursor(previousCursor));
+    List_advanceCursor(&previousCursor);
+  }
+
+  /* the changed input files and the files of all modules with
+     changed symbol addresses must be object files */
+  List_copy(&changedFileNameList, LinkState__changedFileNameList);
+  LinkState__makeModuleEntryList(&entryList);
+
+  for (cursor = List_resetCursor(entryList);  isPartial && cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type entry = List_getElementAtCursor(cursor);
+
+    if (List_lookup(LinkState__moduleEntryList, entry) == NULL) {
+      LinkState__getFileName(&fileName, entry,
+			     LinkState__moduleFileFieldIndex);
+      StringList_append(&changedFileNameList, fileName);
+    }
+  }
+
+  for (cursor = List_resetCursor(changedFileNameList);
+       isPartial && cursor != NULL;  List_advanceCursor(&cursor)) {
+    String_Type changedFileName = List_getElementAtCursor(cursor);
+    isPartial = (List_lookup(linkFileNameList, changedFileName) != NULL);
+  }
+
+  if (isPartial) {
+    /* keep the order of the link files */
+    for (cursor = List_resetCursor(linkFileNameList);  cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      String_Type linkFileName = List_getElementAtCursor(cursor);
+
+      if (List_lookup(changedFileNameList, linkFileName) != NULL) {
+	StringList_append(fileNameList, linkFileName);
+      }
+    }
+  }
+
+  LinkState__eraseCode(!isPartial, *fileNameList);
+  String_destroy(&fileName);
+  List_destroy(&changedFileNameList);
+  List_destroy(&entryList);
+  return isPartial;
+}
+
+/*--------------------*/
+
+void LinkState_write (in String_Type stateFileName,
+		      in StringList_Type argumentList)
+{
+  StringList_Type inputFileNameList = StringList_make();
+  StringList_Type outputFileNameList = StringList_make();
+  StringList_Type entryList = StringList_make();
+  File_Type stateFile;
+  Boolean isOpen;
+
+  /* the state file itself and the files read for the digests must
+     not be recorded */
+  File_getUsedFileNames(&inputFileNameList, &outputFileNameList);
+  File_setUsageTracking(false);
+  isOpen = File_open(&stateFile, stateFileName, File_Mode_write);
+
+  if (!isOpen) {
+    Error_raise(Error_Criticality_warning,
+		"could not write link state file %s",
+		String_asCharPointer(stateFileName));
+  } else {
+    List_Cursor cursor;
+
+    File_writeCharArray(&stateFile, "; ASxxxx Linker link state\n");
+
+    for (cursor = List_resetCursor(argumentList);  cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      String_Type argument = List_getElementAtCursor(cursor);
+      File_writeChar(&stateFile, LinkState__argumentKind);
+      File_writeChar(&stateFile, ' ');
+      File_writeString(&stateFile, argument);
+      File_writeChar(&stateFile, '\n');
+    }
+
+    LinkState__writeFileEntries(&stateFile, LinkState__inputKind,
+				inputFileNameList);
+    LinkState__writeFileEntries(&stateFile, LinkState__outputKind,
+				outputFileNameList);
+    LinkState__makeLayoutEntryList(&entryList);
+    LinkState__writeEntries(&stateFile, entryList);
+    LinkState__makeModuleEntryList(&entryList);
+    LinkState__writeEntries(&stateFile, entryList);
+    File_close(&stateFile);
+  }
+
+  List_destroy(&entryList);
+  List_destroy(&outputFileNameList);
+  List_destroy(&inputFileNameList);
+}
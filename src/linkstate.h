@@ -0,0 +1,110 @@
+/** LinkState module --
+    This module provides services for incremental linking by keeping
+    the state of the previous link in a file.
+
+    A link state file records the linker arguments, all input files
+    read and all output files written.  Each file is given with its
+    size and a digest of its contents.  Before a link is done, the
+    state file of the previous link is checked: when the arguments are
+    the same, no input file has changed and all output files are still
+    as they have been written, the results of the previous link are
+    still valid and the link may be skipped.
+
+    The state file additionally records the memory layout (the bank,
+    address and size of each segment placed) and for each module a
+    digest of the addresses of all symbols it defines or references.
+    When only some object files have changed, the code output files
+    may be patched in place: after the first pass the layout is
+    compared with the previous one and when it is the same, only the
+    object files with changed contents or with changed addresses of
+    their symbols are relocated again; their previous code is erased
+    before.  Otherwise all previous code is erased and all object
+    files are relocated.
+
+    The state file is a text file with one entry per line.  The first
+    character of a line tells the kind of entry: 'A' is followed by a
+    linker argument, 'I' and 'O' are followed by size, digest and name
+    of an input or an output file, 'L' is followed by bank, address,
+    size, area name, module name and file name of a segment and 'M'
+    by symbol digest, module name and file name of a module.  Lines
+    starting with a semicolon are comments.
+*/
+
+#ifndef __LINKSTATE_H
+#define __LINKSTATE_H
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "string.h"
+#include "stringlist.h"
+
+/*========================================*/
+
+typedef enum {
+  LinkState_Status_outdated, LinkState_Status_patchable,
+  LinkState_Status_upToDate
+} LinkState_Status;
+  /** result of the comparison of a link with the previous one:
+      <upToDate> tells that the previous results are still valid,
+      <patchable> tells that only some input files have changed and
+      the previous output files may be patched, <outdated> tells that
+      a complete link must be done */
+
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void LinkState_initialize (void);
+  /** sets up internal data structures for this module */
+
+/*--------------------*/
+
+void LinkState_finalize (void);
+  /** cleans up internal data structures for this module */
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+LinkState_Status LinkState_check (in String_Type stateFileName,
+				  in StringList_Type argumentList);
+  /** compares the link recorded in the link state file with
+      <stateFileName> with a link with the linker arguments in
+      <argumentList>: the result is <upToDate> when no input file has
+      changed and all output files are unchanged, <patchable> when
+      only some input files have changed and all output files exist
+      unchanged and <outdated> otherwise (also when the state file
+      does not exist); the changed input files and the layout and
+      module entries of the previous link are kept for
+      <LinkState_preparePatching> */
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+Boolean LinkState_preparePatching (in StringList_Type linkFileNameList,
+				   out StringList_Type *fileNameList);
+  /** prepares the second pass of a link where the code output files
+      are patched in place; must be called after all segments have
+      been placed and all symbols have been resolved: when the layout
+      is the same as in the previous link and all modules with changed
+      contents or changed symbol addresses come from the object files
+      in <linkFileNameList>, those object files are returned in
+      <fileNameList>, their previous code is erased and true is
+      returned; otherwise all previous code is erased and false is
+      returned, so that all object files and library modules must be
+      relocated again */
+
+/*--------------------*/
+
+void LinkState_write (in String_Type stateFileName,
+		      in StringList_Type argumentList);
+  /** writes the state of the current link with linker arguments
+      <argumentList> to file with <stateFileName>; the input and
+      output files are those recorded by the usage tracking of the
+      File module, which is switched off by this routine */
+
+#endif /* __LINKSTATE_H */
@@ -41,7 +41,8 @@ static TypeDescriptor_Record List__tdRecord =
     /* .assignmentProc = */ (TypeDescriptor_AssignmentProc) List_copy,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ NULL,
     /* .destructionProc = */ (TypeDescriptor_DestructionProc) List_destroy,
-    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL };
+    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL,
+    /* .name = */ "List" };
 
 TypeDescriptor_Type List_typeDescriptor = &List__tdRecord;
 
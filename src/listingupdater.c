@@ -20,9 +20,10 @@
 #include "error.h"
 #include "file.h"
 #include "integermap.h"
+#include "linkserver.h"
 #include "map.h"
 #include "module.h"
-#include "scanner.h"
+#include "statistics.h"
 #include "string.h"
 
 #include <ctype.h>
@@ -35,12 +36,55 @@
 # define StdLib_stringToLong strtol
 
 #include <string.h>
-# define STRING_copyNChars strncpy
+# define STRING_compareNChars strncmp
+# define STRING_copyNChars    strncpy
+# define STRING_findCharacterInBlock memchr
 /*========================================*/
 
+#define ListingUpdater__prefixLength 25
+  /** length of the prefix with address and code bytes in a listing
+      line */
+
+#define ListingUpdater__lineNumberLength 6
+  /** length of the line number following the prefix */
+
+#define ListingUpdater__minimumLength \
+  (ListingUpdater__prefixLength + ListingUpdater__lineNumberLength + 1)
+  /** minimum length of a listing line with line number; shorter
+      lines are continuations of the previous line */
+
+#define ListingUpdater__areaKeyword ".area"
+  /** keyword for an area declaration in the assembler source */
+
+#define ListingUpdater__bufferSize 0x10000
+  /** size of the output buffer of a revised listing file and initial
+      size of the block for reading a listing when it cannot be
+      mapped */
+
+typedef struct {
+  String_Type linkFileName;
+  String_Type fileName;
+} ListingUpdater__Job;
+  /** a listing to be updated given by the name of the link file
+      <linkFileName> and the common name <fileName> of listing and
+      revised listing without extension */
+
+typedef struct {
+  SizeType firstIndex;
+  SizeType step;
+} ListingUpdater__Worker;
+  /** a worker updating the jobs with indices <firstIndex>,
+      <firstIndex> + <step>, ... */
+
 static UINT8 ListingUpdater__base = 16;
   /** base used for bytes in listing file and revised listing file */
 
+static ListingUpdater__Job *ListingUpdater__jobList;
+  /** all listings to be updated */
+
+static SizeType ListingUpdater__jobCount;
+  /** number of entries in <jobList> */
+
 static IntegerMap_Type ListingUpdater__segmentToAddressMap;
   /** mapping from segment name to first address in some module
       file */
@@ -50,12 +94,14 @@ static IntegerMap_Type ListingUpdater__segmentToAddressMap;
 /*            INTERNAL ROUTINES           */
 /*========================================*/
 
-static void ListingUpdater__checkForAreaDecl (inout String_Type *codeLine,
+static void ListingUpdater__checkForAreaDecl (in char *codeLine,
+				      in SizeType length,
 				      inout Target_Bank *segmentBank,
 				      inout Target_Address *segmentAddress,
+				      out String_Type *adaptedCodeLine,
 				      out Boolean *isOkay);
 
-static void ListingUpdater__relocateData (inout String_Type *dataLine,
+static void ListingUpdater__relocateData (inout char *dataLine,
 					  in Target_Bank segmentBank,
 					  in Target_Address segmentAddress,
 					  inout Target_Address *programCounter,
@@ -65,73 +111,77 @@ static void ListingUpdater__relocateData (inout String_Type *dataLine,
 
 static void ListingUpdater__adaptFile (inout File_Type *revisedListingFile,
 				       in String_Type listingFileName,
-				       inout File_Type *listingFile)
-  /** reads all lines of assembler listing in <listingFile> with name
-      <listingFileName> and adjusts the address and data bytes to the
-      absolute values after linking and puts result into
-      <revisedListingFile> */
+				       in char *data, in SizeType size)
+  /** scans all lines of assembler listing with name
+      <listingFileName> given by <size> bytes in <data> and adjusts the
+      address and data bytes to the absolute values after linking and
+      puts result into <revisedListingFile>; the lines are processed
+      in place, only prefixes with numbers are copied for
+      relocation */
 {
-  String_Type emptyPrefix = String_make();
+  String_Type adaptedCodeLine = String_make();
+  char *dataEnd = data + size;
   char formFeed = '\f';
   Boolean isAfterCodeLines = false;
+  char *lineStart = data;
   UINT32 lineNumber = 0;
-  String_Type lineNumberString = String_make();
-  SizeType lineNumberSize = 6;
-  UINT8 prefixLength = 25;
-  String_Type prefix = String_make();
   Target_Address programCounter; /** program counter value for current
 				     line in listing file */
   Target_Address segmentAddress = 0; /** program counter value for current
 					 area segment in listing file */
   Target_Bank segmentBank = 0;
-  String_Type st = String_make();
-  String_Type suffix = String_make();
-  SizeType minimumLength = prefixLength + lineNumberSize + 1;
 
-  String_copyCharArrayAligned(&emptyPrefix, prefixLength, "", ' ', true);
   programCounter = 0;
 
-  for (;;) {
-    SizeType stringLength;
+  while (lineStart < dataEnd) {
+    char *lineEnd = STRING_findCharacterInBlock(lineStart, '\n',
+						dataEnd - lineStart);
+    SizeType lineLength;
 
-    File_readLine(listingFile, &st);
-    stringLength = String_length(st);
+    lineEnd = (lineEnd == NULL ? dataEnd : lineEnd + 1);
+    lineLength = lineEnd - lineStart;
 
-    if (stringLength == 0) {
-      break;
-    }
-
-    if (String_getAt(st, 1) == formFeed) {
+    if (*lineStart == formFeed) {
       isAfterCodeLines = true;
     }
 
     if (isAfterCodeLines) {
-      File_writeString(revisedListingFile, st);
+      File_writeBytes(revisedListingFile, (UINT8 *) lineStart, lineLength);
     } else {
-      Boolean isContinuationLine = (stringLength < minimumLength);
+      Boolean isContinuationLine =
+	(lineLength < ListingUpdater__minimumLength);
       Boolean isOkay = true;
+      char prefix[ListingUpdater__minimumLength + 1];
+      SizeType prefixLength = (isContinuationLine ? lineLength
+			       : ListingUpdater__prefixLength);
+      char *suffix = lineStart + ListingUpdater__minimumLength;
+      SizeType i;
+
+      /* a continuation line for the previous line has no line number
+	 and no suffix */
+      STRING_copyNChars(prefix, lineStart, prefixLength);
+      prefix[prefixLength] = String_terminator;
+      String_clear(&adaptedCodeLine);
 
-      if (isContinuationLine) {
-	/* this is a continuation line for previous line */
-	String_copy(&prefix, st);
-	String_clear(&suffix);
-      } else {
+      if (!isContinuationLine) {
 	lineNumber++;
-	String_getSubstring(&prefix, st, 1, prefixLength);
-	String_getSubstring(&lineNumberString, st, prefixLength + 1,
-			    lineNumberSize);
-	/* skip over prefix, line number and one blank character */
-	String_getSubstring(&suffix, st, minimumLength + 1, SizeType_max);
+      }
+
+      for (i = 0;  i < prefixLength && prefix[i] == ' ';  i++) {
       }
 
       /* process either a line with numbers or scan for an area
 	 declaration */
-      if (String_isEqual(prefix, emptyPrefix)) {
-	ListingUpdater__checkForAreaDecl(&suffix, &segmentBank,
-					 &segmentAddress, &isOkay);
+      if (prefixLength == ListingUpdater__prefixLength
+	  && i == prefixLength) {
+	if (!isContinuationLine) {
+	  ListingUpdater__checkForAreaDecl(suffix, lineEnd - suffix,
+					   &segmentBank, &segmentAddress,
+					   &adaptedCodeLine, &isOkay);
+	}
       } else {
 	/* some analysis of the numbers in this line should be done */
-	ListingUpdater__relocateData(&prefix, segmentBank, segmentAddress,
+	ListingUpdater__relocateData(prefix, segmentBank, segmentAddress,
 				     &programCounter, &isOkay);
       }
 
@@ -141,65 +191,120 @@ static void ListingUpdater__adaptFile (inout File_Type *revisedListingFile,
 		    String_asCharPointer(listingFileName), lineNumber);
       }
 
-      File_writeString(revisedListingFile, prefix);
+      File_writeBytes(revisedListingFile, (UINT8 *) prefix, prefixLength);
 
       if (!isContinuationLine) {
-	File_writeString(revisedListingFile, lineNumberString);
+	File_writeBytes(revisedListingFile,
+			(UINT8 *) lineStart + ListingUpdater__prefixLength,
+			ListingUpdater__lineNumberLength);
 	File_writeChar(revisedListingFile, ' ');
-	File_writeString(revisedListingFile, suffix);
+
+	if (String_length(adaptedCodeLine) > 0) {
+	  File_writeString(revisedListingFile, adaptedCodeLine);
+	} else {
+	  File_writeBytes(revisedListingFile, (UINT8 *) suffix,
+			  lineEnd - suffix);
+	}
       }
     }
+
+    lineStart = lineEnd;
+  }
+
+  String_destroy(&adaptedCodeLine);
+}
+
+/*--------------------*/
+
+static Boolean ListingUpdater__isLetter (in char ch)
+  /** tells whether <ch> may occur in an assembler identifier but not
+      in a hexadecimal number */
+{
+  return ((ch >= 'G' && ch <= 'Z') || (ch >= 'g' && ch <= 'z')
+	  || ch == '_' || ch == '.' || ch == '$');
+}
+
+/*--------------------*/
+
+static Boolean ListingUpdater__isNameCharacter (in char ch)
+  /** tells whether <ch> may occur in an assembler identifier */
+{
+  return (ListingUpdater__isLetter(ch) || CType_isHexDigit(ch));
+}
+
+/*--------------------*/
+
+static char *ListingUpdater__skipWhiteSpace (in char *ptr, in char *end)
+  /** returns the position of the first character in <ptr> up to
+      <end> which is not white space */
+{
+  while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\f')) {
+    ptr++;
   }
 
-  String_destroy(&suffix);
-  String_destroy(&st);
-  String_destroy(&prefix);
-  String_destroy(&lineNumberString);
-  String_destroy(&emptyPrefix);
+  return ptr;
 }
 
 /*--------------------*/
 
-static void ListingUpdater__checkForAreaDecl (inout String_Type *codeLine,
+static void ListingUpdater__checkForAreaDecl (in char *codeLine,
+				      in SizeType length,
 				      inout Target_Bank *segmentBank,
 				      inout Target_Address *segmentAddress,
+				      out String_Type *adaptedCodeLine,
 				      out Boolean *isOkay)
-  /** checks whether <codeLine> contains an AREA declaration and sets
-      <segmentAddress> to its address and <segmentBank> to its bank
-      (by data from the segment lists); <isOkay> tells whether line
-      could be parsed successfully; when area is relocated to another
-      bank, its name is adapted accordingly */
+  /** checks whether <codeLine> with <length> characters contains an
+      AREA declaration and sets <segmentAddress> to its address and
+      <segmentBank> to its bank (by data from the segment lists);
+      <isOkay> tells whether line could be parsed successfully; when
+      area is relocated to another bank, <adaptedCodeLine> is set to a
+      line with the adapted name, otherwise it is left empty */
 {
-  Scanner_TokenList tokenList;
-  Scanner_Token *token;
-  String_Type areaKeyword = String_makeFromCharArray(".area");
-
-  Scanner_makeTokenList(&tokenList, *codeLine);
-  token = List_getElement(tokenList, 1);
-
-  if (token->kind == Scanner_TokenKind_identifier
-      && String_isEqual(token->representation, areaKeyword)) {
+  char *end = codeLine + length;
+  SizeType keywordLength = sizeof(ListingUpdater__areaKeyword) - 1;
+  char *ptr = ListingUpdater__skipWhiteSpace(codeLine, end);
+
+  /* the line must start with the keyword as a complete identifier */
+  if ((SizeType) (end - ptr) >= keywordLength
+      && STRING_compareNChars(ptr, ListingUpdater__areaKeyword,
+			      keywordLength) == 0
+      && (ptr + keywordLength == end
+	  || !ListingUpdater__isNameCharacter(ptr[keywordLength]))) {
     /* this is an area line ==> get area name and find associated
        segment address */
-    token = List_getElement(tokenList, 2);
+    char *nameStart = ListingUpdater__skipWhiteSpace(ptr + keywordLength,
+						     end);
+    Boolean hasLetter = false;
+
+    for (ptr = nameStart;
+	 ptr < end && ListingUpdater__isNameCharacter(*ptr);  ptr++) {
+      hasLetter = (hasLetter || ListingUpdater__isLetter(*ptr));
+    }
 
-    if (token->kind != Scanner_TokenKind_identifier) {
+    /* a name without letters is a number */
+    if (!hasLetter || (*nameStart >= '0' && *nameStart <= '9')) {
       *isOkay = false;
     } else {
       long newSegmentAddress;
+      String_Type originalName = String_make();
       String_Type segmentName = String_make();
 
-      String_copy(&segmentName, token->representation);
+      for (ptr = nameStart;
+	   ptr < end && ListingUpdater__isNameCharacter(*ptr);  ptr++) {
+	String_appendChar(&originalName, *ptr);
+      }
+
+      String_copy(&segmentName, originalName);
       Banking_adaptAreaNameWhenBanked(Module_currentModule(), &segmentName);
 
-      if (!String_isEqual(segmentName, token->representation)) {
+      if (!String_isEqual(segmentName, originalName)) {
 	/* the original area is not used here because of banking
 	   ==> adapt code line */
-	String_copyCharArray(codeLine, "\t");
-	String_append(codeLine, areaKeyword);
-	String_appendCharArray(codeLine, "\t");
-	String_append(codeLine, segmentName);
-	String_appendCharArray(codeLine, "\n");
+	String_copyCharArray(adaptedCodeLine, "\t");
+	String_appendCharArray(adaptedCodeLine, ListingUpdater__areaKeyword);
+	String_appendCharArray(adaptedCodeLine, "\t");
+	String_append(adaptedCodeLine, segmentName);
+	String_appendCharArray(adaptedCodeLine, "\n");
       }
 
       if (Target_info.getBankFromSegmentName == NULL) {
@@ -218,16 +323,59 @@ static void ListingUpdater__checkForAreaDecl (inout String_Type *codeLine,
       }
 
       String_destroy(&segmentName);
+      String_destroy(&originalName);
+    }
+  }
+}
+
+/*--------------------*/
+
+static UINT8 *ListingUpdater__readListing (in String_Type listingFileName,
+					   out SizeType *size,
+					   out Boolean *isMapped)
+  /** returns the contents of the listing file with <listingFileName>
+      and sets <size> to its length; the file is mapped into memory
+      when possible (telling so in <isMapped>), otherwise it is read
+      into a block of memory; when the file cannot be read, NULL is
+      returned */
+{
+  char *procName = "ListingUpdater__readListing";
+  UINT8 *data;
+
+  *isMapped = File_mapForReading(listingFileName, &data, size);
+
+  if (!*isMapped) {
+    File_Type listingFile;
+
+    if (File_open(&listingFile, listingFileName, File_Mode_read)) {
+      SizeType capacity = ListingUpdater__bufferSize;
+      SizeType byteCount;
+
+      data = NEWARRAY(UINT8, capacity);
+      ASSERTION(data != NULL, procName, "out of memory");
+
+      do {
+	if (*size == capacity) {
+	  capacity *= 2;
+	  data = reallocateMemory(data, capacity, __FILE__);
+	  ASSERTION(data != NULL, procName, "out of memory");
+	}
+
+	byteCount = File_readBytes(&listingFile, &data[*size],
+				   capacity - *size);
+	*size += byteCount;
+      } while (byteCount > 0);
+
+      File_close(&listingFile);
     }
   }
 
-  String_destroy(&areaKeyword);
-  List_destroy(&tokenList);
+  return data;
 }
 
 /*--------------------*/
 
-static void ListingUpdater__relocateData (inout String_Type *dataLine,
+static void ListingUpdater__relocateData (inout char *dataLine,
 					  in Target_Bank segmentBank,
 					  in Target_Address segmentAddress,
 					  inout Target_Address *programCounter,
@@ -252,7 +400,7 @@ static void ListingUpdater__relocateData (inout String_Type *dataLine,
   {
     /* parse byte sequences in <dataLine>: the first is an address, the
        rest are code or data bytes */
-    char *ptr = String_asCharPointer(*dataLine);
+    char *ptr = dataLine;
 
     for (;;) {
       while (*ptr == ' ') {
@@ -348,6 +496,64 @@ static void ListingUpdater__setupAreaMap (in String_Type linkFileName)
   }
 }
 
+/*--------------------*/
+
+static void ListingUpdater__updateListing (in ListingUpdater__Job *job)
+  /** writes the revised listing for the listing of <job> */
+{
+  String_Type listingFileName = String_make();
+  UINT8 *data;
+  Boolean isMapped;
+  SizeType size;
+
+  String_copy(&listingFileName, job->fileName);
+  String_appendCharArray(&listingFileName, ".lst");
+  data = ListingUpdater__readListing(listingFileName, &size, &isMapped);
+
+  if (data != NULL) {
+    File_Type revisedListingFile;
+    String_Type revisedListingFileName = String_make();
+
+    String_copy(&revisedListingFileName, job->fileName);
+    String_appendCharArray(&revisedListingFileName, ".rst");
+
+    if (File_open(&revisedListingFile, revisedListingFileName,
+		  File_Mode_write)) {
+      File_setBufferSize(&revisedListingFile, ListingUpdater__bufferSize);
+      Statistics_beginSpan("listing", String_asCharPointer(listingFileName));
+      ListingUpdater__setupAreaMap(job->linkFileName);
+      ListingUpdater__adaptFile(&revisedListingFile, listingFileName,
+				(char *) data, size);
+      File_close(&revisedListingFile);
+      Statistics_endSpan();
+    }
+
+    if (isMapped) {
+      File_unmapFromMemory(&data, size);
+    } else {
+      DESTROY(data);
+    }
+
+    String_destroy(&revisedListingFileName);
+  }
+
+  String_destroy(&listingFileName);
+}
+
+/*--------------------*/
+
+static void ListingUpdater__updateListingsOfWorker (inout Object worker)
+  /** writes the revised listings for all jobs of <worker> */
+{
+  ListingUpdater__Worker *currentWorker = worker;
+  SizeType i;
+
+  for (i = currentWorker->firstIndex;  i < ListingUpdater__jobCount;
+       i += currentWorker->step) {
+    ListingUpdater__updateListing(&ListingUpdater__jobList[i]);
+  }
+}
+
 /*========================================*/
 /*           EXPORTED ROUTINES            */
 /*========================================*/
@@ -358,6 +564,8 @@ static void ListingUpdater__setupAreaMap (in String_Type linkFileName)
 
 void ListingUpdater_initialize (void)
 {
+  ListingUpdater__jobList  = NULL;
+  ListingUpdater__jobCount = 0;
   ListingUpdater__segmentToAddressMap = Map_make(String_typeDescriptor);
 }
 
@@ -375,15 +583,24 @@ void ListingUpdater_finalize (void)
 
 void ListingUpdater_update (in UINT8 base, in StringList_Type linkFileList)
 {
-  String_Type fileName = String_make();
+  char *procName = "ListingUpdater_update";
+  String_Type listingFileName = String_make();
   List_Cursor stringCursor;
+  SizeType i;
 
   ListingUpdater__base = base;
+  ListingUpdater__jobList = NEWARRAY(ListingUpdater__Job,
+				     List_length(linkFileList) + 1);
+  ListingUpdater__jobCount = 0;
+  ASSERTION(ListingUpdater__jobList != NULL, procName, "out of memory");
 
+  /* collect the link files with an assembler listing */
   for (stringCursor = List_resetCursor(linkFileList);
        stringCursor != NULL;
        List_advanceCursor(&stringCursor)) {
-    String_Type listingFileName = String_make();
+    ListingUpdater__Job *job =
+      &ListingUpdater__jobList[ListingUpdater__jobCount];
+    String_Type fileName = String_make();
     String_Type linkFileName = List_getElementAtCursor(stringCursor);
     SizeType dotPosition = String_findCharacterFromEnd(linkFileName, '.');
     SizeType slashPosition = String_findFromEnd(linkFileName,
@@ -399,30 +616,61 @@ void ListingUpdater_update (in UINT8 base, in StringList_Type linkFileList)
     String_copy(&listingFileName, fileName);
     String_appendCharArray(&listingFileName, ".lst");
 
-    if (File_exists(listingFileName)) {
-      File_Type listingFile;
+    if (!File_exists(listingFileName)) {
+      String_destroy(&fileName);
+    } else {
+      job->linkFileName = linkFileName;
+      job->fileName     = fileName;
+      ListingUpdater__jobCount++;
+    }
+  }
 
-      if (File_open(&listingFile, listingFileName, File_Mode_read)) {
-	File_Type revisedListingFile;
-	String_Type revisedListingFileName = String_make();
+  /* the listings are independent, hence they are distributed
+     round-robin onto one process per processor; statistics and trace
+     must stay with the linker process, so they enforce a serial
+     update */
+  {
+    SizeType workerCount = LinkServer_getProcessorCount();
+    ListingUpdater__Worker *workerList;
+    Object *workerObjectList;
 
-	String_copy(&revisedListingFileName, fileName);
-	String_appendCharArray(&revisedListingFileName, ".rst");
+    if (workerCount > ListingUpdater__jobCount) {
+      workerCount = ListingUpdater__jobCount;
+    }
 
-	if (File_open(&revisedListingFile, revisedListingFileName,
-		      File_Mode_write)) {
-	  ListingUpdater__setupAreaMap(linkFileName);
-	  ListingUpdater__adaptFile(&revisedListingFile, listingFileName,
-				    &listingFile);
-	  File_close(&revisedListingFile);
-	}
+    if (workerCount <= 1 || Statistics_isActive() || Statistics_isTraced()) {
+      workerCount = 1;
+    }
 
-	File_close(&listingFile);
-	String_destroy(&revisedListingFileName);
-      }
+    workerList       = NEWARRAY(ListingUpdater__Worker, workerCount);
+    workerObjectList = NEWARRAY(Object, workerCount);
+    ASSERTION(workerList != NULL && workerObjectList != NULL, procName,
+	      "out of memory");
 
+    for (i = 0;  i < workerCount;  i++) {
+      workerList[i].firstIndex = i;
+      workerList[i].step       = workerCount;
+      workerObjectList[i]      = &workerList[i];
     }
 
-    String_destroy(&listingFileName);
+    if (workerCount == 1) {
+      ListingUpdater__updateListingsOfWorker(workerObjectList[0]);
+    } else if (!LinkServer_runConcurrently(
+				    ListingUpdater__updateListingsOfWorker,
+				    workerObjectList, workerCount)) {
+      Error_raise(Error_Criticality_error, "could not update all listings");
+    }
+
+    DESTROY(workerObjectList);
+    DESTROY(workerList);
   }
+
+  for (i = 0;  i < ListingUpdater__jobCount;  i++) {
+    String_destroy(&ListingUpdater__jobList[i].fileName);
+  }
+
+  DESTROY(ListingUpdater__jobList);
+  ListingUpdater__jobList = NULL;
+  ListingUpdater__jobCount = 0;
+  String_destroy(&listingFileName);
 }
@@ -7,6 +7,11 @@
     The code is queried from the Target module and is only available
     at the end of the second linking pass.
 
+    The listings are independent of each other and only read the
+    linked data.  Hence, where the platform supports it, they are
+    distributed onto one forked process per processor.  Each listing
+    is mapped into memory and its lines are processed in place.
+
     Note that the module knows very much about the structure of a
     assembler listing file and is fragile whenever that structure
     changes in the future.
@@ -36,6 +36,9 @@
 # define StdIO_stderr  stderr
 #include <string.h>
 # define STRING_findCharacter strchr
+# define STRING_isEqual(a,b)  (strcmp(a,b) == 0)
+# define STRING_startsWith(a,b) (strncmp(a,b,strlen(b)) == 0)
+# define STRING_length        strlen
 
 /*============================*/
 /* program specific includes  */
@@ -48,7 +51,10 @@
 #include "error.h"
 #include "file.h"
 #include "globdefs.h"
+#include "layoutfile.h"
 #include "library.h"
+#include "linkserver.h"
+#include "linkstate.h"
 #include "list.h"
 #include "listingupdater.h"
 #include "map.h"
@@ -59,9 +65,12 @@
 #include "parser.h"
 #include "scanner.h"
 #include "set.h"
+#include "statistics.h"
 #include "string.h"
 #include "stringlist.h"
 #include "stringtable.h"
+#include "symbol.h"
+#include "symbolindex.h"
 #include "target.h"
 
 /*====================*/
@@ -72,6 +81,16 @@ char *Main__usageHelpText[] = {
   "  -f   file[LNK]               File input",
   "  -p   Prompt and echo of file[LNK] to stdout (default)",
   "  -n   No echo of file[LNK] to stdout",
+  "  -t   Skip link when state in file[LKS] shows unchanged files",
+  "       or only relocate changed object files into the code file",
+  "  -ws  socket  Serve link requests on socket (-k, -l preloaded)",
+  "  -wc  socket  Send link request to server on socket",
+  "  --stats       Report phase times, file transfers and counters",
+  "  --stats=json  Write that report as JSON to file[.json]",
+  "  --trace=file  Write timeline of link phases as trace events to file",
+  "  --heap        Report heap use per module and type at the end",
+  "  --layout      Only write area, region and symbol layout as JSON",
+  "                to file[.layout.json] without code and map files",
   "Usage: [-Options] file [file ...]",
   "Librarys:",
   "  -k	Library path specification, one per -k",
@@ -79,6 +98,12 @@ char *Main__usageHelpText[] = {
   "Relocation:",
   "  -b   area base address = expression",
   "  -g   global symbol = expression",
+  "  -r   Remove segments unreachable from entry points",
+  "  -ob  Place relocatable areas best fit into memory regions",
+  "  -of  Fold identical code segments",
+  "  -oj  Relax absolute jumps into shorter instructions",
+  "  -oo[area]  Overlay local data of code never active at the same time",
+  "             (area defaults to _OVERLAY)",
   "Map format:",
   "  -m   Map output generated as file[MAP]",
   "  -x   Hexadecimal (default)",
@@ -86,10 +111,14 @@ char *Main__usageHelpText[] = {
   "  -q   Octal",
   "Banking:",
   "  -hfile  file specification containing assignments of modules to banks",
+  "  -a   Automatic placement of unassigned modules into banks",
+  "  -ag  Automatic placement minimizing interbank calls",
+  "  -apfile  Automatic placement by call counts in profile file",
   "Output:",
   "  -i   Intel Hex as file[IHX]",
   "  -s   Motorola S19 as file[S19]",
   "  -j   Produce NoICE debug as file[NOI]",
+  "  -vfile  Link variant as file[...] with the options following",
   "List:",
   "  -u	Update listing file(s) with link data as file(s)[.RST]",
   "End:",
@@ -102,14 +131,35 @@ char *Main__usageHelpText[] = {
 #define Main__optionCharacters (Main__extendedOptions Main__singleCharOptions)
   /** platform independent option characters (upper-case) */
 
-#define Main__singleCharOptions "MXDQISUE"
+#define Main__singleCharOptions "MXDQISUER"
   /** platform independent option characters which do not consume the
       rest of the argument */
 
-#define Main__extendedOptions "KLHBG"
+#define Main__extendedOptions "AKLHBGO"
   /** platform independent option characters which consume the rest of
       the argument */
 
+#define Main__defaultOverlayAreaName "_OVERLAY"
+  /** area with the local data overlayed statically when option -oo
+      gives no area name */
+
+#define Main__statisticsOption "--stats"
+  /** option for reporting the link statistics */
+
+#define Main__heapOption "--heap"
+  /** option for reporting the heap use */
+
+#define Main__traceOption "--trace="
+  /** option for writing a trace event file (followed by its name) */
+
+#define Main__layoutOption "--layout"
+  /** option for stopping after the linking of the areas and writing
+      the layout report only */
+
+#define Main__commonOnlyOptions "BEGKLOR"
+  /** option characters which affect the first pass and hence may not
+      be given for a single variant */
+
 /*--------------------*/
 
 static struct {
@@ -122,13 +172,74 @@ static struct {
   Boolean ihxFileIsUsed;
   Boolean sRecordFileIsUsed;
   Boolean listingsAreAugmented;
+  Boolean unreferencedSegmentsAreRemoved;
+  Boolean identicalSegmentsAreFolded;
+  Boolean jumpsAreRelaxed;
+  String_Type overlayAreaName;     /** name of area with local data
+				       overlayed statically (empty when
+				       not overlayed) */
+  Boolean linkStateIsKept;         /** tells that the link state is
+				       kept in a file for incremental
+				       linking */
+  Boolean linkIsSkipped;           /** tells that the results of the
+				       previous link are still valid */
+  Boolean outputIsPatched;         /** tells that only some object
+				       files have changed and the code
+				       files of the previous link are
+				       patched */
+  Boolean statisticsAreReported;   /** tells that link statistics are
+				       reported at the end */
+  Boolean statisticsAreInJSON;     /** tells that the statistics report
+				       goes to a JSON file */
+  Boolean heapIsReported;          /** tells that the heap use is
+				       reported at the end */
+  Boolean layoutIsOnlyWritten;     /** tells that the link stops after
+				       the areas have been linked and
+				       only writes the layout report */
+  StringList_Type rootSymbolNameList;  /** names of symbols given by -g
+					   options */
 } Main__options;
 
+static Boolean Main__isServing = false;
+  /** tells that this process is a link server or handles a request
+      of it */
+
+/*--------------------*/
+
+typedef struct {
+  String_Type name;                /** name of output files for variant
+				       (without extension) */
+  StringList_Type argumentList;    /** common arguments followed by the
+				       options of the variant */
+  Boolean *optionIsHandledList;    /** tells for each argument whether
+				       it has already been handled */
+} Main__Variant;
+  /** a variant of a program linked from the same object files with
+      different options */
+
 
 /*========================================*/
 /*            INTERNAL ROUTINES           */
 /*========================================*/
 
+static Boolean Main__isLinkFileIntroCharacter (in char ch);
+static void Main__processDelayedOptions (in StringList_Type argumentList,
+					 inout Boolean optionIsHandledList[]);
+static void Main__processGlobalSymbolDefinitions (void);
+static void Main__processOptions (in StringList_Type argumentList,
+				  inout Boolean optionIsHandledList[]);
+static void Main__readObjectFiles (void);
+static void Main__removeUnreferencedSegments (void);
+static void Main__separateVariants (inout StringList_Type *argumentList,
+				    out StringList_Type *variantArgumentList);
+static void Main__setBaseAddresses (void);
+static void Main__writeLayout (void);
+static void Main__writeLinkState (in StringList_Type argumentList);
+static void Main__writeOutputFiles (void);
+static void Main__writeStatistics (void);
+
+/*--------------------*/
+
 static void Main__addOptionsToList (in char *fileName, 
 				    inout StringList_Type *stringList,
 				    in Boolean linesAreEchoed)
@@ -172,6 +283,17 @@ static void Main__addOptionsToList (in char *fileName,
 
 /*--------------------*/
 
+static void Main__addRootSymbolName (in String_Type symbolName,
+				     in long value)
+  /** adds <symbolName> to the list of entry symbols for removal of
+      unreferenced segments; <value> is ignored; conforms to
+      <Parser_KeyValueMappingProc> */
+{
+  StringList_append(&Main__options.rootSymbolNameList, symbolName);
+}
+
+/*--------------------*/
+
 static void Main__collectOptions (in int argc, in char *argv[],
 				  inout StringList_Type *argumentList)
   /** scans command line given by <argc> and <argv> for link file
@@ -189,7 +311,30 @@ static void Main__collectOptions (in int argc, in char *argv[],
     char firstCh = thisArgument[0];
     String_Type argument = String_makeFromCharArray(thisArgument);
 
-    if (previousOptionWasFileFlag) {
+    if (STRING_isEqual(thisArgument, Main__statisticsOption)
+	|| STRING_isEqual(thisArgument, Main__statisticsOption "=json")) {
+      /* all letters are used, hence this is a long option */
+      Main__options.statisticsAreReported = true;
+      Main__options.statisticsAreInJSON =
+	(thisArgument[STRING_length(Main__statisticsOption)] == '=');
+      Statistics_setActive(true);
+    } else if (STRING_isEqual(thisArgument, Main__heapOption)) {
+#ifdef ASLINK_HEAP_ACCOUNTING
+      Main__options.heapIsReported = true;
+#else
+      Error_raise(Error_Criticality_warning,
+		  "option %s needs a build with ASLINK_HEAP_ACCOUNTING",
+		  Main__heapOption);
+#endif
+    } else if (STRING_isEqual(thisArgument, Main__layoutOption)) {
+      Main__options.layoutIsOnlyWritten = true;
+      CodeOutput_setActive(false);
+    } else if (STRING_startsWith(thisArgument, Main__traceOption)) {
+      char *fileName = &thisArgument[STRING_length(Main__traceOption)];
+      String_Type traceFileName = String_makeFromCharArray(fileName);
+      Statistics_openTrace(traceFileName);
+      String_destroy(&traceFileName);
+    } else if (previousOptionWasFileFlag) {
       /* an -f option must be directly followed by a filename */
       Main__addOptionsToList(thisArgument, argumentList,
 			     Main__options.linkFilesAreEchoed);
@@ -223,6 +368,11 @@ static void Main__collectOptions (in int argc, in char *argv[],
 	    case 'P':
 	      Main__options.linkFilesAreEchoed = (ch == 'P');
 	      break;
+
+	    case 'T':
+	      Main__options.linkStateIsKept = true;
+	      break;
+
 	    default:
 	      if (j == 1) {
 		StringList_append(argumentList, argument);
@@ -241,6 +391,112 @@ static void Main__collectOptions (in int argc, in char *argv[],
 
 /*--------------------*/
 
+static void Main__completeLink (void)
+  /** places all segments read in the first pass, resolves all symbols
+      and produces all output files in the second pass (or only the
+      layout report in layout mode) */
+{
+  Boolean hasInterbankReferences;
+
+  if (Main__options.unreferencedSegmentsAreRemoved) {
+    /* drop dead code and data before it is placed into banks */
+    Statistics_startPhase("segment removal");
+    Main__removeUnreferencedSegments();
+  }
+
+  Statistics_startPhase("banking");
+  hasInterbankReferences = 
+    Banking_resolveInterbankReferences(&Main__options.linkFileList);
+
+  if (hasInterbankReferences) {
+    /* add banking support object files */
+    Statistics_startPhase("library resolution");
+    Library_resolveUndefinedSymbols();
+  }
+
+  if (Main__options.identicalSegmentsAreFolded) {
+    /* only fold segments after they have been assigned to banks */
+    Statistics_startPhase("segment folding");
+    Area_foldIdenticalSegments();
+  }
+
+  if (String_length(Main__options.overlayAreaName) > 0) {
+    /* the call graph needs the original code of the segments */
+    Statistics_startPhase("data overlay");
+    Area_overlayLocalData(Main__options.overlayAreaName);
+  }
+
+  Statistics_startPhase("area linking");
+  Main__setBaseAddresses();
+
+  if (Main__options.jumpsAreRelaxed) {
+    /* shrink the code before the final location of the areas */
+    Statistics_startPhase("jump relaxation");
+    Area_relaxJumps();
+    Statistics_startPhase("area linking");
+  }
+
+  Area_link();
+  Statistics_startPhase("symbol resolution");
+  Main__processGlobalSymbolDefinitions();
+  Symbol_checkForUndefinedSymbols(&File_stderr);
+
+  if (MapFile_isOpen() || Main__options.layoutIsOnlyWritten) {
+    /* all addresses are final now */
+    Statistics_startPhase("symbol index");
+    SymbolIndex_build();
+  }
+
+  if (Main__options.layoutIsOnlyWritten) {
+    /* neither code nor map files are needed for the layout */
+    Statistics_startPhase("layout file");
+    Main__writeLayout();
+  } else {
+    Main__writeOutputFiles();
+  }
+
+  Statistics_startPhase(NULL);
+}
+
+/*--------------------*/
+
+static void Main__copyCommonArguments (in StringList_Type argumentList,
+				       in String_Type variantName,
+				       out StringList_Type *variantArgumentList)
+  /** copies <argumentList> to <variantArgumentList> where the first
+      link file name (defining the names of the output files) is
+      replaced by <variantName> */
+{
+  Boolean nameIsReplaced = false;
+  List_Cursor cursor;
+
+  List_clear(variantArgumentList);
+
+  for (cursor = List_resetCursor(argumentList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type argument = List_getElementAtCursor(cursor);
+    char firstChar = String_getCharacter(argument, 1);
+
+    if (!nameIsReplaced && Main__isLinkFileIntroCharacter(firstChar)) {
+      StringList_append(variantArgumentList, variantName);
+      nameIsReplaced = true;
+    } else {
+      StringList_append(variantArgumentList, argument);
+    }
+  }
+}
+
+/*--------------------*/
+
+static void Main__getLinkStateFileName (out String_Type *fileName)
+  /** returns name of the link state file in <fileName> */
+{
+  String_copy(fileName, Main__options.mainFileNamePrefix);
+  String_appendCharArray(fileName, ".lks");
+}
+
+/*--------------------*/
+
 static void Main__giveUsageInfo (void)
   /** outputs the linker name and version and a list of valid options
       to the stderr device */
@@ -275,6 +531,137 @@ static Boolean Main__isLinkFileIntroCharacter (in char ch)
 
 /*--------------------*/
 
+static Boolean Main__isVariantOption (in String_Type argument)
+  /** tells whether <argument> is an option starting the options of a
+      variant */
+{
+  char *arg = String_asCharPointer(argument);
+  return (arg[0] == '-' && CType_toupper(arg[1]) == 'V'
+	  && arg[2] != String_terminator);
+}
+
+/*--------------------*/
+
+static void Main__link (void)
+  /** does a two-pass processing of all object and library files and
+      produces all output files */
+{
+  /* -- PASS 1 -- */
+  if (!Main__options.layoutIsOnlyWritten) {
+    MapFile_openAll(Main__options.mainFileNamePrefix);
+  }
+
+  Main__readObjectFiles();
+  Main__completeLink();
+}
+
+/*--------------------*/
+
+static void Main__linkVariant (inout Object variantObject)
+  /** completes the link of the object files read for the variant
+      given by <variantObject> with its options; must be run in a
+      process of its own, because it changes the data shared by all
+      variants; conforms to <LinkServer_SubprocessProc> */
+{
+  Main__Variant *variant = (Main__Variant *) variantObject;
+
+  String_copy(&Main__options.mainFileNamePrefix, variant->name);
+  Main__processOptions(variant->argumentList, variant->optionIsHandledList);
+  Main__processDelayedOptions(variant->argumentList,
+			      variant->optionIsHandledList);
+
+  if (!Main__options.layoutIsOnlyWritten) {
+    MapFile_openAll(Main__options.mainFileNamePrefix);
+  }
+
+  Main__completeLink();
+}
+
+/*--------------------*/
+
+static void Main__linkVariants (in StringList_Type argumentList,
+				in Boolean optionIsHandledList[],
+				in StringList_Type variantArgumentList)
+  /** reads the object files given by <argumentList> once and links
+      a variant for each variant option in <variantArgumentList> with
+      the options following it; <optionIsHandledList> tells which
+      arguments in <argumentList> have already been handled */
+{
+  SizeType commonArgumentCount = List_length(argumentList);
+  List_Cursor cursor = List_resetCursor(variantArgumentList);
+  Main__Variant variant;
+
+  /* -- PASS 1 (common part) -- */
+  Main__readObjectFiles();
+
+  variant.name = String_make();
+  variant.argumentList = StringList_make();
+
+  while (cursor != NULL) {
+    /* the cursor is on the variant option */
+    String_Type argument = List_getElementAtCursor(cursor);
+    char *variantName;
+    SizeType i;
+
+    String_getSubstring(&variant.name, argument, 3,
+			String_length(argument) - 2);
+    variantName = String_asCharPointer(variant.name);
+    Main__copyCommonArguments(argumentList, variant.name,
+			      &variant.argumentList);
+    List_advanceCursor(&cursor);
+
+    while (cursor != NULL
+	   && !Main__isVariantOption(List_getElementAtCursor(cursor))) {
+      char *arg;
+      argument = List_getElementAtCursor(cursor);
+      arg = String_asCharPointer(argument);
+
+      if (arg[0] != '-' 
+	  || STRING_findCharacter(Main__commonOnlyOptions,
+				  CType_toupper(arg[1])) != NULL) {
+	Error_raise(Error_Criticality_warning,
+		    "argument %s not allowed for variant %s ignored",
+		    arg, variantName);
+      } else {
+	StringList_append(&variant.argumentList, argument);
+      }
+
+      List_advanceCursor(&cursor);
+    }
+
+    variant.optionIsHandledList =
+      NEWARRAY(Boolean, List_length(variant.argumentList) + 1);
+
+    for (i = 1;  i <= List_length(variant.argumentList);  i++) {
+      variant.optionIsHandledList[i] =
+	(i <= commonArgumentCount && optionIsHandledList[i]);
+    }
+
+    if (!LinkServer_runInSubprocess(Main__linkVariant, &variant)) {
+      Error_raise(Error_Criticality_error, "link of variant %s failed",
+		  variantName);
+    }
+
+    DESTROY(variant.optionIsHandledList);
+  }
+
+  List_destroy(&variant.argumentList);
+  String_destroy(&variant.name);
+}
+
+/*--------------------*/
+
+static Boolean Main__isServerOption (in char *argument, in char kind)
+  /** tells whether <argument> is the option for a link server (when
+      <kind> is 'S') or for a link client (when <kind> is 'C') */
+{
+  return (STRING_length(argument) == 3 && argument[0] == '-'
+	  && CType_toupper(argument[1]) == 'W'
+	  && CType_toupper(argument[2]) == kind);
+}
+
+/*--------------------*/
+
 static void Main__processGlobalSymbolDefinitions (void)
   /** sets the addresses of several symbols to values from
       <StringTable.globalDefList> */
@@ -288,14 +675,11 @@ static void Main__processGlobalSymbolDefinitions (void)
 
 static void Main__processOptions (in StringList_Type argumentList,
 				  inout Boolean optionIsHandledList[])
-  /** evaluates all command line or file linker directives and updates
-      the appropriate variables */
+  /** evaluates all platform independent command line or file linker
+      directives and updates the appropriate variables */
 {
   SizeType i;
   SizeType length = List_length(argumentList);
-  Boolean isOkay = true;  /* tells that no problematic option has been
-			     found */
-  Parser_Options parserOptions = {10, unknown};
 
   for (i = 1;  i <= length;  i++) {
     Boolean *optionIsHandled = &optionIsHandledList[i];
@@ -330,7 +714,6 @@ static void Main__processOptions (in StringList_Type argumentList,
 	if (ch == String_terminator) {
 	  Error_raise(Error_Criticality_warning,
 		      "plain '-' option on command line ignored");
-	  isOkay = false;
 	} else if (CType_isalpha(ch)) {
 	  ch = (char) CType_toupper(ch);
 	    
@@ -342,12 +725,36 @@ static void Main__processOptions (in StringList_Type argumentList,
 	      String_Type st = String_makeFromCharArray(argPtr);
 	      Boolean libraryIsFound;
 
-	      if (ch == 'B') {
+	      if (ch == 'A') {
+		Banking_PlacementKind placementKind =
+		  Banking_PlacementKind_packing;
+
+		if (String_length(st) == 0) {
+		  /* default placement by size */
+		} else if (CType_toupper(*argPtr) == 'G'
+			   && String_length(st) == 1) {
+		  placementKind = Banking_PlacementKind_callGraph;
+		} else if (CType_toupper(*argPtr) == 'P'
+			   && String_length(st) > 1) {
+		  String_Type profileFileName = String_make();
+		  placementKind = Banking_PlacementKind_profile;
+		  String_getSubstring(&profileFileName, st, 2,
+				      String_length(st) - 1);
+		  Banking_readProfileFile(profileFileName);
+		  String_destroy(&profileFileName);
+		} else {
+		  Error_raise(Error_Criticality_warning,
+			      "unknown placement kind in option %s", arg);
+		}
+
+		Banking_setPlacementKind(placementKind);
+	      } else if (ch == 'B') {
 		Parser_setMappingFromString(st,
 		    (Parser_KeyValueMappingProc) Area_setBaseAddresses);
 	      } else if (ch == 'G') {
 		Parser_setMappingFromString(st,
 		    (Parser_KeyValueMappingProc) Symbol_setAddressForName);
+		Parser_setMappingFromString(st, Main__addRootSymbolName);
 	      } else if (ch == 'H') {
 		Banking_readConfigurationFile(st);
 	      } else if (ch == 'K') {
@@ -360,6 +767,45 @@ static void Main__processOptions (in StringList_Type argumentList,
 			      "couldn't find library '%s'",
 			      String_asCharPointer(st));
 		}
+	      } else if (ch == 'O') {
+		if (CType_toupper(*argPtr) == 'B' && String_length(st) == 1) {
+		  if (Target_info.memoryRegionList == NULL) {
+		    Error_raise(Error_Criticality_warning,
+				"memory regions not defined by platform");
+		  } else {
+		    /* place areas into the gaps of the memory regions */
+		    Area_setBestFitPlacement(true);
+		  }
+		} else if (CType_toupper(*argPtr) == 'O') {
+		  /* track code for the call graph of the static overlay */
+		  if (String_length(st) == 1) {
+		    String_copyCharArray(&Main__options.overlayAreaName,
+					 Main__defaultOverlayAreaName);
+		  } else {
+		    String_getSubstring(&Main__options.overlayAreaName, st,
+					2, String_length(st) - 1);
+		  }
+
+		  Area_setContentTracking(true);
+		} else if (CType_toupper(*argPtr) == 'F'
+			   && String_length(st) == 1) {
+		  /* track code for folding identical segments */
+		  Main__options.identicalSegmentsAreFolded = true;
+		  Area_setContentTracking(true);
+		} else if (CType_toupper(*argPtr) == 'J'
+			   && String_length(st) == 1) {
+		  if (Target_info.relaxJump == NULL) {
+		    Error_raise(Error_Criticality_warning,
+				"jump relaxation not supported by platform");
+		  } else {
+		    /* track code for relaxing jumps */
+		    Main__options.jumpsAreRelaxed = true;
+		    Area_setContentTracking(true);
+		  }
+		} else {
+		  Error_raise(Error_Criticality_warning,
+			      "unknown optimization in option %s", arg);
+		}
 	      } else {
 		Error_raise(Error_Criticality_error,
 			    "unknown character string option %s", arg);
@@ -394,6 +840,10 @@ static void Main__processOptions (in StringList_Type argumentList,
 		String_destroy(&suffix);
 	      } else if (ch == 'Q') {
 		Main__options.radix = 8;
+	      } else if (ch == 'R') {
+		/* track references for removal of unreferenced segments */
+		Main__options.unreferencedSegmentsAreRemoved = true;
+		Area_setReferenceTracking(true);
 	      } else if (ch == 'S') {
 		/* select motorola format as output */
 		Main__options.sRecordFileIsUsed = true;
@@ -411,6 +861,20 @@ static void Main__processOptions (in StringList_Type argumentList,
       }
     }
   }
+}
+
+/*--------------------*/
+
+static void Main__processDelayedOptions (in StringList_Type argumentList,
+					 inout Boolean optionIsHandledList[])
+  /** evaluates the platform specific options, reports all unhandled
+      options in <argumentList> and creates the code output files */
+{
+  SizeType i;
+  SizeType length = List_length(argumentList);
+  Boolean isOkay = true;  /* tells that no problematic option has been
+			     found */
+  Parser_Options parserOptions = {10, unknown};
 
   Target_info.handleCommandLineOptions(Main__options.mainFileNamePrefix,
 				       argumentList, optionIsHandledList);
@@ -451,6 +915,212 @@ static void Main__processOptions (in StringList_Type argumentList,
   }
 }
 
+static void Main__processRequest (in int argc, in char *argv[])
+  /** evaluates the command line arguments given by <argc> and <argv>
+      to determine the linker parameters and does the link; conforms
+      to <LinkServer_RequestProc> */
+{
+  int argumentCount;
+  StringList_Type argumentList = StringList_make();
+  StringList_Type variantArgumentList = StringList_make();
+  Boolean hasVariants;
+  Boolean *optionIsHandledList;
+  LinkState_Status linkStatus;
+
+  /* process the command line options */
+  Main__collectOptions(argc, argv, &argumentList);
+  Statistics_startPhase("options");
+  Main__separateVariants(&argumentList, &variantArgumentList);
+  argumentCount = List_length(argumentList);
+  hasVariants = (List_length(variantArgumentList) > 0);
+
+  if (hasVariants && Main__options.linkStateIsKept) {
+    Error_raise(Error_Criticality_warning,
+		"link state not kept when linking variants");
+    Main__options.linkStateIsKept = false;
+  }
+
+  if (Main__options.layoutIsOnlyWritten && Main__options.linkStateIsKept) {
+    /* the state would tell that the output files are up to date */
+    Error_raise(Error_Criticality_warning,
+		"link state not kept when only writing the layout");
+    Main__options.linkStateIsKept = false;
+  }
+
+  optionIsHandledList = NEWARRAY(Boolean, argumentCount + 1);
+
+  if (optionIsHandledList == NULL) {
+    Error_raise(Error_Criticality_fatalError,
+		"could not allocate argument use list");
+  }
+
+  if (Main__options.linkStateIsKept) {
+    /* record all files read for options and link */
+    File_setUsageTracking(true);
+  }
+
+  Main__processOptions(argumentList, optionIsHandledList);
+
+  if (Main__options.linkStateIsKept) {
+    /* the state file and the files checked are no link inputs */
+    String_Type stateFileName = String_make();
+    Statistics_startPhase("link state");
+    Main__getLinkStateFileName(&stateFileName);
+    File_setUsageTracking(false);
+    linkStatus = LinkState_check(stateFileName, argumentList);
+    File_setUsageTracking(true);
+    Main__options.linkIsSkipped = (linkStatus == LinkState_Status_upToDate);
+    /* text code files cannot be patched in place */
+    Main__options.outputIsPatched =
+      (linkStatus == LinkState_Status_patchable
+       && !Main__options.ihxFileIsUsed && !Main__options.sRecordFileIsUsed);
+    String_destroy(&stateFileName);
+  }
+
+  if (hasVariants) {
+    /* the platform specific and output options are evaluated per
+       variant */
+    Main__linkVariants(argumentList, optionIsHandledList,
+		       variantArgumentList);
+  } else if (!Main__options.linkIsSkipped) {
+    /* output files may only be created when a link is done */
+    Statistics_startPhase("options");
+    CodeOutput_setPatching(Main__options.outputIsPatched);
+    Main__processDelayedOptions(argumentList, optionIsHandledList);
+    Main__link();
+
+    if (Main__options.linkStateIsKept) {
+      Statistics_startPhase("link state");
+      Main__writeLinkState(argumentList);
+    }
+  }
+
+  if (Main__options.statisticsAreReported) {
+    Main__writeStatistics();
+  }
+
+  Statistics_closeTrace();
+
+  if (Main__options.heapIsReported && Main__isServing) {
+    /* a request process ends without finalization */
+    Statistics_writeHeapReport(&File_stderr);
+  }
+
+  DESTROY(optionIsHandledList);
+  List_destroy(&argumentList);
+  List_destroy(&variantArgumentList);
+}
+
+/*--------------------*/
+
+static void Main__readObjectFiles (void)
+  /** reads all object files in a first pass and adds the library
+      modules resolving undefined symbols */
+{
+  Statistics_startPhase("pass 1");
+  Parser_parseObjectFiles(true, Main__options.linkFileList);
+  Statistics_startPhase("library resolution");
+  Library_resolveUndefinedSymbols();
+  Statistics_startPhase(NULL);
+}
+
+/*--------------------*/
+
+static void Main__removeUnreferencedSegments (void)
+  /** removes all segments not reachable from absolute areas or the
+      symbols given by -g options or platform global definitions; the
+      bank switch routines are also kept, because the trampoline calls
+      referencing them are generated afterwards */
+{
+  Parser_setMappingFromList(StringTable_globalDefList,
+			    Main__addRootSymbolName);
+
+  if (Banking_isActive()) {
+    StringList_Type labelNameList = StringList_make();
+    Banking_getJumpLabelNames(&labelNameList);
+    List_concatenate(&Main__options.rootSymbolNameList, labelNameList);
+    List_destroy(&labelNameList);
+  }
+
+  Area_removeUnreferencedSegments(Main__options.rootSymbolNameList);
+  Area_setReferenceTracking(false);
+}
+
+/*--------------------*/
+
+static void Main__serve (in int argc, in char *argv[])
+  /** runs the linker as a link server on the socket given by the
+      second argument in <argv>; the libraries given by -k and -l
+      options in the remaining arguments are indexed in advance and
+      available to all link requests */
+{
+  String_Type socketName = String_makeFromCharArray(argv[2]);
+  int i;
+
+  for (i = 3;  i < argc;  i++) {
+    char *arg = argv[i];
+    char ch = (arg[0] == '-' ? (char) CType_toupper(arg[1]) : ' ');
+
+    if (ch == 'K' || ch == 'L') {
+      String_Type st = String_makeFromCharArray(&arg[2]);
+      Boolean libraryIsFound = true;
+
+      if (ch == 'K') {
+	Library_addDirectory(st);
+      } else {
+	Library_addFilePathName(st, &libraryIsFound);
+      }
+
+      if (!libraryIsFound) {
+	Error_raise(Error_Criticality_warning,
+		    "couldn't find library '%s'", String_asCharPointer(st));
+      }
+
+      String_destroy(&st);
+    } else {
+      Error_raise(Error_Criticality_warning,
+		  "option %s ignored by link server", arg);
+    }
+  }
+
+  Library_buildSymbolIndex();
+  Main__isServing = true;
+  LinkServer_serve(socketName, Main__processRequest);
+  String_destroy(&socketName);
+}
+
+/*--------------------*/
+
+static void Main__separateVariants (inout StringList_Type *argumentList,
+				    out StringList_Type *variantArgumentList)
+  /** moves all arguments in <argumentList> from the first variant
+      option on to <variantArgumentList> */
+{
+  StringList_Type commonArgumentList = StringList_make();
+  Boolean variantIsFound = false;
+  List_Cursor cursor;
+
+  List_clear(variantArgumentList);
+
+  for (cursor = List_resetCursor(*argumentList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    String_Type argument = List_getElementAtCursor(cursor);
+    variantIsFound = (variantIsFound || Main__isVariantOption(argument));
+    StringList_append((variantIsFound
+		       ? variantArgumentList : &commonArgumentList),
+		      argument);
+  }
+
+  List_clear(argumentList);
+
+  for (cursor = List_resetCursor(commonArgumentList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    StringList_append(argumentList, List_getElementAtCursor(cursor));
+  }
+
+  List_destroy(&commonArgumentList);
+}
+
 /*--------------------*/
 
 static void Main__setBaseAddresses (void)
@@ -463,6 +1133,121 @@ static void Main__setBaseAddresses (void)
 
 /*--------------------*/
 
+static void Main__writeLayout (void)
+  /** writes the layout report of the linked areas to
+      file[.layout.json] */
+{
+  String_Type fileName = String_make();
+  File_Type file;
+
+  String_copy(&fileName, Main__options.mainFileNamePrefix);
+  String_appendCharArray(&fileName, ".layout.json");
+
+  if (!File_open(&file, fileName, File_Mode_write)) {
+    Error_raise(Error_Criticality_warning,
+		"could not write layout file %s",
+		String_asCharPointer(fileName));
+  } else {
+    LayoutFile_write(&file);
+    File_close(&file);
+  }
+
+  String_destroy(&fileName);
+}
+
+/*--------------------*/
+
+static void Main__writeLinkState (in StringList_Type argumentList)
+  /** writes the state of a successful link with <argumentList> to
+      file[LKS]; when errors have occured or symbols are undefined the
+      state is not written and the next link is done completely */
+{
+  Symbol_List undefinedSymbolList = List_make(Symbol_typeDescriptor);
+
+  Symbol_getUndefinedSymbolList(&undefinedSymbolList);
+
+  if (!Error_isRaised(Error_Criticality_error)
+      && List_length(undefinedSymbolList) == 0) {
+    String_Type stateFileName = String_make();
+    Main__getLinkStateFileName(&stateFileName);
+    LinkState_write(stateFileName, argumentList);
+    String_destroy(&stateFileName);
+  }
+
+  List_destroy(&undefinedSymbolList);
+}
+
+/*--------------------*/
+
+static void Main__writeOutputFiles (void)
+  /** writes the map files, relocates the code in the second pass
+      into the code output files and updates the listings; when the
+      code files are patched, only the object files with changed code
+      or symbol addresses are relocated if possible */
+{
+  StringList_Type patchFileList = StringList_make();
+
+  Statistics_startPhase("map files");
+  MapFile_writeLinkingData();
+
+  /* -- PASS 2 -- */
+  Statistics_startPhase("pass 2");
+
+  if (Main__options.outputIsPatched
+      && LinkState_preparePatching(Main__options.linkFileList,
+				   &patchFileList)) {
+    /* the layout is unchanged and the library modules are still
+       in the patched code files */
+    Parser_parseObjectFiles(false, patchFileList);
+  } else {
+    Parser_parseObjectFiles(false, Main__options.linkFileList);
+    Statistics_startPhase("library code");
+    Library_addCodeSequences();
+  }
+
+  Statistics_startPhase("code output");
+  CodeOutput_closeStreams();
+  Statistics_startPhase("map files");
+  MapFile_closeAll();
+
+  if (Main__options.listingsAreAugmented) {
+    Statistics_startPhase("listings");
+    ListingUpdater_update(Main__options.radix, Main__options.linkFileList);
+  }
+
+  List_destroy(&patchFileList);
+}
+
+/*--------------------*/
+
+static void Main__writeStatistics (void)
+  /** writes the link statistics either as text to standard error or
+      as a JSON object to file[.json] */
+{
+  if (!Main__options.statisticsAreInJSON) {
+    Statistics_writeReport(&File_stderr, false);
+  } else {
+    String_Type fileName = String_make();
+    File_Type file;
+
+    String_copy(&fileName, Main__options.mainFileNamePrefix);
+    String_appendCharArray(&fileName, ".json");
+
+    if (!File_open(&file, fileName, File_Mode_write)) {
+      Error_raise(Error_Criticality_warning,
+		  "could not write statistics file %s",
+		  String_asCharPointer(fileName));
+    } else {
+      Statistics_writeReport(&file, true);
+      File_close(&file);
+    }
+
+    String_destroy(&fileName);
+  }
+}
+
+/*--------------------*/
+
 static void Main__initialize (void)
   /** initializes all modules */
 {
@@ -476,12 +1261,15 @@ static void Main__initialize (void)
   String_initialize();
   Map_initialize();
   Multimap_initialize();
+  Statistics_initialize();
 
   /* now initialize the linker specific modules */
   Area_initialize();
   Banking_initialize();
   CodeSequence_initialize();
   Library_initialize();
+  LinkServer_initialize();
+  LinkState_initialize();
   ListingUpdater_initialize();
   MapFile_initialize();
   Module_initialize();
@@ -489,6 +1277,7 @@ static void Main__initialize (void)
   Parser_initialize();
   Scanner_initialize();
   StringTable_initialize();
+  SymbolIndex_initialize();
   Target_initialize();
 
   String_copyCharArray(&platformName, "gbz80");
@@ -506,6 +1295,18 @@ static void Main__initialize (void)
   Main__options.ihxFileIsUsed        = false;
   Main__options.sRecordFileIsUsed    = false;
   Main__options.listingsAreAugmented = false;
+  Main__options.unreferencedSegmentsAreRemoved = false;
+  Main__options.identicalSegmentsAreFolded = false;
+  Main__options.jumpsAreRelaxed = false;
+  Main__options.overlayAreaName      = String_make();
+  Main__options.linkStateIsKept = false;
+  Main__options.linkIsSkipped = false;
+  Main__options.outputIsPatched = false;
+  Main__options.statisticsAreReported = false;
+  Main__options.statisticsAreInJSON = false;
+  Main__options.heapIsReported = false;
+  Main__options.layoutIsOnlyWritten = false;
+  Main__options.rootSymbolNameList   = StringList_make();
 
   String_destroy(&platformName);
 }
@@ -516,12 +1317,15 @@ static void Main__finalize (void)
   /** finalizes all modules in reverse order of initialization */
 {
   String_destroy(&Main__options.mainFileNamePrefix);
+  String_destroy(&Main__options.overlayAreaName);
   List_destroy(&Main__options.linkFileList);
+  List_destroy(&Main__options.rootSymbolNameList);
 
   /* first finalize the linker specific modules */
   Target_info.finalize();
   Target_finalize();
   Symbol_finalize();
+  SymbolIndex_finalize();
   StringTable_finalize();
   Scanner_finalize();
   Parser_finalize();
@@ -529,6 +1333,8 @@ static void Main__finalize (void)
   Module_finalize();
   MapFile_finalize();
   ListingUpdater_finalize();
+  LinkState_finalize();
+  LinkServer_finalize();
   Library_finalize();
   CodeSequence_finalize();
   CodeOutput_finalize();
@@ -536,12 +1342,19 @@ static void Main__finalize (void)
   Area_finalize();
 
   /* finally finalize the basic modules */
+  Statistics_finalize();
   Multimap_finalize();
   Map_finalize();
   String_finalize();
   Set_finalize();
   List_finalize();
   Error_finalize();
+
+  if (Main__options.heapIsReported) {
+    /* the blocks for the standard error file are released later */
+    Statistics_writeHeapReport(&File_stderr);
+  }
+
   File_finalize();
 }
 
@@ -561,57 +1374,25 @@ int main (int argc, char *argv[])
 
         - the second pass relocates the code sequences and binds them
           into a load file
+
+      alternatively the linker runs as a link server (option -ws) or
+      sends a link request to such a server (option -wc)
  */
 {
-  int argumentCount;
-  StringList_Type argumentList = StringList_make();
-  Boolean hasInterbankReferences;
-  Boolean *optionIsHandledList;
+  int status = 0;
 
   Main__initialize();
 
-  /* process the command line options */
-  Main__collectOptions(argc, argv, &argumentList);
-  argumentCount = List_length(argumentList);
-
-  optionIsHandledList = NEWARRAY(Boolean, argumentCount + 1);
-
-  if (optionIsHandledList == NULL) {
-    Error_raise(Error_Criticality_fatalError,
-		"could not allocate argument use list");
-  }
-
-  Main__processOptions(argumentList, optionIsHandledList);
-
-  /* do a two-pass processing of all object and library files */
-  /* -- PASS 1 -- */
-  MapFile_openAll(Main__options.mainFileNamePrefix);
-  Parser_parseObjectFiles(true, Main__options.linkFileList);
-  Library_resolveUndefinedSymbols();
-
-  hasInterbankReferences = 
-    Banking_resolveInterbankReferences(&Main__options.linkFileList);
-
-  if (hasInterbankReferences) {
-    /* add banking support object files */
-    Library_resolveUndefinedSymbols();
-  }
-
-  Main__setBaseAddresses();
-  Area_link();
-  Main__processGlobalSymbolDefinitions();
-  Symbol_checkForUndefinedSymbols(&File_stderr);
-  MapFile_writeLinkingData();
-
-  /* -- PASS 2 -- */
-  Parser_parseObjectFiles(false, Main__options.linkFileList);
-  Library_addCodeSequences();
-  CodeOutput_closeStreams();
-  MapFile_closeAll();
-
-  if (Main__options.listingsAreAugmented) {
-    ListingUpdater_update(Main__options.radix, Main__options.linkFileList);
+  if (argc > 2 && Main__isServerOption(argv[1], 'S')) {
+    Main__serve(argc, argv);
+  } else if (argc > 2 && Main__isServerOption(argv[1], 'C')) {
+    String_Type socketName = String_makeFromCharArray(argv[2]);
+    status = LinkServer_sendRequest(socketName, argc - 3, &argv[3]);
+    String_destroy(&socketName);
+  } else {
+    Main__processRequest(argc, argv);
   }
 
   Main__finalize();
+  return status;
 }
@@ -26,7 +26,10 @@ cl %CFLAGS% error.c
 cl %CFLAGS% file.c
 cl %CFLAGS% globdefs.c
 cl %CFLAGS% integermap.c
+cl %CFLAGS% layoutfile.c
 cl %CFLAGS% library.c
+cl %CFLAGS% linkserver.c
+cl %CFLAGS% linkstate.c
 cl %CFLAGS% list.c
 cl %CFLAGS% listingupdater.c
 cl %CFLAGS% main.c
@@ -39,13 +42,15 @@ cl %CFLAGS% platform\gameboy.c
 cl %CFLAGS% parser.c
 cl %CFLAGS% scanner.c
 cl %CFLAGS% set.c
+cl %CFLAGS% statistics.c
 cl %CFLAGS% string.c
 cl %CFLAGS% stringlist.c
 cl %CFLAGS% stringtable.c
 cl %CFLAGS% symbol.c
+cl %CFLAGS% symbolindex.c
 cl %CFLAGS% target.c
 cl %CFLAGS% typedescriptor.c
 
-link /DEBUG main area banking codeoutput codesequence error file globdefs integermap library list listingupdater module map mapfile multimap noicemapfile gameboy parser scanner set string stringlist stringtable symbol target typedescriptor
+link /DEBUG main area banking codeoutput codesequence error file globdefs integermap layoutfile library linkserver linkstate list listingupdater module map mapfile multimap noicemapfile gameboy parser scanner set statistics string stringlist stringtable symbol symbolindex target typedescriptor
 
 REM DEL *.obj
\ No newline at end of file
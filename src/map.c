@@ -13,6 +13,7 @@
 
 #include "globdefs.h"
 #include "list.h"
+#include "statistics.h"
 #include "typedescriptor.h"
 
 /*========================================*/
@@ -60,7 +61,8 @@ static TypeDescriptor_Record Map__entryRecordTDRecord =
     /* .constructionProc = */ Map__makeEntry,
     /* .destructionProc = */ Map__destroyEntry,
     /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Map__entryHasKey };
+    /* .keyValidationProc = */ Map__entryHasKey,
+    /* .name = */ "Map entry" };
 
 static TypeDescriptor_Type Map__entryRecordTypeDescriptor =
   &Map__entryRecordTDRecord;
@@ -95,6 +97,14 @@ static void Map__destroyEntry (inout Object *object)
 			     "Map__destroyEntry", "invalid map entry");
 
   if (precondition) {
+    Map__Entry entry = *object;
+
+    if (entry->key != NULL) {
+      TypeDescriptor_destroyObject(entry->map->keyTypeDescriptor,
+				   &(entry->key));
+    }
+
+    DESTROY(entry);
     *object = NULL;
   }
 }
@@ -106,6 +116,7 @@ static Boolean Map__entryHasKey (in Object object, in Object key)
      <key> as its key */
 {
   Map__Entry entry = Map__attemptConversionToEntry(object);
+  Statistics_count(Statistics_CounterKind_mapProbe, 1);
   return (TypeDescriptor_compareObjects(entry->map->keyTypeDescriptor,
 					key, entry->key));
 }
@@ -233,7 +244,10 @@ Object Map_lookup (in Map_Type map, in Object key)
 
   if (precondition) {
     SizeType hashValue = Map__hashValue(map, key);
-    Object object = List_lookup(map->bucket[hashValue], key);
+    Object object;
+
+    Statistics_count(Statistics_CounterKind_mapLookup, 1);
+    object = List_lookup(map->bucket[hashValue], key);
 
     if (object != NULL) {
       Map__Entry entry = Map__attemptConversionToEntry(object);
@@ -303,9 +317,13 @@ void Map_set (inout Map_Type *map, in Object key, in Object value)
   if (precondition) {
     SizeType hashValue = Map__hashValue(currentMap, key);
     List_Type bucket = currentMap->bucket[hashValue];
-    Object object = List_lookup(bucket, key);
-    Boolean keyIsNew = (object == NULL);
+    Object object;
+    Boolean keyIsNew;
     Map__Entry entry;
+
+    Statistics_count(Statistics_CounterKind_mapLookup, 1);
+    object = List_lookup(bucket, key);
+    keyIsNew = (object == NULL);
  
     if (keyIsNew) {
       Object *entryPtr = List_append(&bucket);
@@ -339,10 +357,7 @@ void Map_deleteKey (inout Map_Type *map, in Object key)
     List_Cursor cursor = List_setCursorToElement(bucket, key);
 
     if (cursor != NULL) {
-      Object object = List_getElementAtCursor(cursor);
-      Map__Entry entry = Map__attemptConversionToEntry(object);
-      TypeDescriptor_destroyObject(currentMap->keyTypeDescriptor,
-				   &(entry->key));
+      /* the key is destroyed together with the entry */
       List_deleteElementAtCursor(cursor);
     }
   }
@@ -18,22 +18,26 @@
 
 #include "globdefs.h"
 #include "area.h"
+#include "banking.h"
 #include "error.h"
 #include "file.h"
 #include "library.h"
+#include "linkserver.h"
 #include "multimap.h"
+#include "statistics.h"
 #include "string.h"
 #include "stringlist.h"
 #include "stringtable.h"
-
-#include <stdlib.h>
-# define StdLib_qsort   qsort
+#include "symbolindex.h"
 
 /*========================================*/
 
 #define MapFile__maxCount 10
   /** at most 10 different map files may be open simultaneously */
 
+#define MapFile__bufferSize 0x40000
+  /** size of the output buffer of each map file */
+
 typedef struct {
   Boolean isInUse;
   File_Type file;
@@ -44,13 +48,6 @@ typedef struct {
       procedures */
 
 
-typedef struct {
-  Symbol_Type symbol;
-  Target_Address address;
-} MapFile__SymbolWithAddress;
-  /** entry for mapping from symbol to associated address */
-
-
 typedef void (*MapFile__DescriptorHandlerProc)(inout MapFile__Descriptor *d);
   /** routine type to perform some operation on an active map file
       descriptor */
@@ -86,26 +83,6 @@ static void MapFile__closeFile (in MapFile__Descriptor *descriptor)
 
 /*--------------------*/
 
-static int MapFile__compareSymbolsByAddress (in MapFile__SymbolWithAddress *a,
-					     in MapFile__SymbolWithAddress *b)
-  /** compares the addresses of two symbol entries and returns -1, 0
-      or +1 for less, equal and greater */
-{
-  int result;
-
-  if (a->address == b->address) {
-    result = 0;
-  } else if (a->address < b->address) {
-    result = -1;
-  } else {
-    result = 1;
-  }
-
-  return result;
-}
-
-/*--------------------*/
-
 static void MapFile__iterateOverActive (
                              in MapFile__DescriptorHandlerProc operation)
 {
@@ -127,7 +104,11 @@ static void MapFile__openFile (in MapFile__Descriptor *descriptor)
   String_Type mapFileName = String_make();
   String_copy(&mapFileName, MapFile__tempString);
   String_append(&mapFileName, descriptor->suffix);
-  File_open(&descriptor->file, mapFileName, File_Mode_write);
+
+  if (File_open(&descriptor->file, mapFileName, File_Mode_write)) {
+    File_setBufferSize(&descriptor->file, MapFile__bufferSize);
+  }
+
   String_destroy(&mapFileName);
 }
 
@@ -186,12 +167,24 @@ static void MapFile__writeMapFileData (in MapFile__Descriptor *descriptor)
     descriptor->routines.symbolTableOutputProc;
 
   if (symbolTableOutputProc != NULL) {
+    Statistics_beginSpan("map file",
+			 String_asCharPointer(descriptor->suffix));
     symbolTableOutputProc(&descriptor->file);
+    Statistics_endSpan();
   }
 }
 
 /*--------------------*/
 
+static void MapFile__writeMapFileDataOfObject (inout Object descriptor)
+  /** puts out symbol table to map file of <descriptor> given as an
+      object; used for running the writers in separate processes */
+{
+  MapFile__writeMapFileData((MapFile__Descriptor *) descriptor);
+}
+
+/*--------------------*/
+
 static void MapFile__writeMessage (in MapFile__Descriptor *descriptor)
 {
   File_writeCharArray(&descriptor->file, "\n?ASlink-Warning-");
@@ -322,24 +315,20 @@ static void MapFile__writeStandardAreaInfo (inout File_Type *file,
   /* output list of symbols */
   /* - - - - - - - - - - - - */
   {
-    Symbol_List areaSymbolList = List_make(Symbol_typeDescriptor);
-    List_Cursor symbolCursor;
+    SizeType entryCount;
+    SymbolIndex_Entry *entryList = SymbolIndex_getAreaEntries(area,
+							      &entryCount);
+    SizeType i;
 
-    MapFile_getSortedAreaSymbolList (area, &areaSymbolList);
     File_writeChar(file, '\n');
     MapFile__writeHeaderLines(file, symbolLinePrefix, " ",
 			      symbolLineColumnCount, symbolLineHeadingList,
 			      symbolLineColumnWidthList);
 
-    for (symbolCursor = List_resetCursor(areaSymbolList);
-	 symbolCursor != NULL;
-	 List_advanceCursor(&symbolCursor)) {
+    for (i = 0;  i < entryCount;  i++) {
       UINT8 columnWidth;
-      Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
-      Target_Address address = Symbol_absoluteAddress(symbol);
-      String_Type symbolName = String_make();
-
-      Symbol_getName(symbol, &symbolName);
+      Target_Address address = entryList[i].address;
+      String_Type symbolName = entryList[i].name;
 
       String_copyCharArray(&currentLine, symbolLinePrefix);
 
@@ -364,9 +353,11 @@ static void MapFile__writeStandardAreaInfo (inout File_Type *file,
       String_appendChar(&currentLine, '\n');
 
       File_writeString(file, currentLine);
-      String_destroy(&symbolName);
     }
   }
+
+  String_destroy(&st);
+  String_destroy(&currentLine);
 }
 
 /*========================================*/
@@ -420,80 +411,6 @@ Boolean MapFile_isOpen (void)
   return (MapFile__isOpen);
 }
 
-/*--------------------*/
-
-void MapFile_getSortedAreaSymbolList (in Area_Type area, 
-				      out Symbol_List *areaSymbolList)
-{
-  UINT16 i;
-  char *procName = "MapFile_getSortedAreaSymbolList";
-  MapFile__SymbolWithAddress *symbolArray;
-  UINT16 symbolCount;
-  Symbol_List tempSymbolList = List_make(Symbol_typeDescriptor);
-
-  /* concatenate all symbols from the segments into
-     <tempSymbolList> */
-  {
-    Symbol_List segmentSymbolList = List_make(Symbol_typeDescriptor);
-    List_Cursor segmentCursor;
-    Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
-
-    Area_getListOfSegments(area, &segmentList);
-
-    for (segmentCursor = List_resetCursor(segmentList);
-	 segmentCursor != NULL;
-	 List_advanceCursor(&segmentCursor)) {
-      Area_Segment segment = List_getElementAtCursor(segmentCursor);
-      Area_getSegmentSymbols(segment, &segmentSymbolList);
-      List_concatenate(&tempSymbolList, segmentSymbolList);
-    }
-
-    List_destroy(&segmentList);
-    List_destroy(&segmentSymbolList);
-  }
-
-  /* store all symbols from <tempSymbolList> in temporary array and
-     sort them in ascending order of addresses */
-  {
-    List_Cursor symbolCursor;
-
-    symbolCount = List_length(tempSymbolList);
-    symbolArray = NEWARRAY(MapFile__SymbolWithAddress, symbolCount);
-    ASSERTION(symbolArray != NULL, procName, "out of memory");
-
-    i = 0;
-
-    for (symbolCursor = List_resetCursor(tempSymbolList);
-	 symbolCursor != NULL;
-	 List_advanceCursor(&symbolCursor)) {
-      Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
-
-      symbolArray[i].symbol = symbol;
-      symbolArray[i].address = Symbol_absoluteAddress(symbol);
-      i++;
-    }
-  
-    StdLib_qsort(symbolArray, symbolCount, sizeof(MapFile__SymbolWithAddress),
-		 MapFile__compareSymbolsByAddress);
-  }
-
-  /* transfer sorted symbols into <areaSymbolList> */
-  {
-    List_clear(areaSymbolList);
-
-    for (i = 0;  i < symbolCount;  i++) {
-      Symbol_Type symbol = symbolArray[i].symbol;
-      Object *objectPtr = List_append(areaSymbolList);
-      *objectPtr = symbol;
-    }
-
-    DESTROY(symbolArray);
-  }
-    
-  List_destroy(&tempSymbolList);
-}
-
-
 /*--------------------*/
 /* CHANGE             */
 /*--------------------*/
@@ -580,7 +497,30 @@ void MapFile_writeSpecialComment (in String_Type comment)
 
 void MapFile_writeLinkingData (void)
 {
-  MapFile__iterateOverActive(MapFile__writeMapFileData);
+  Object descriptorList[MapFile__maxCount];
+  SizeType descriptorCount = 0;
+  UINT8 i;
+
+  for (i = 0;  i < MapFile__maxCount;  i++) {
+    MapFile__Descriptor *descriptor = &MapFile__list[i];
+
+    if (descriptor->isInUse
+	&& descriptor->routines.symbolTableOutputProc != NULL) {
+      descriptorList[descriptorCount++] = descriptor;
+    }
+  }
+
+  /* all writers only read the linked data, hence they may run
+     concurrently in processes of their own each writing its own
+     file; statistics and trace must stay with the linker process,
+     so they enforce serial output */
+  if (descriptorCount <= 1
+      || Statistics_isActive() || Statistics_isTraced()) {
+    MapFile__iterateOverActive(MapFile__writeMapFileData);
+  } else if (!LinkServer_runConcurrently(MapFile__writeMapFileDataOfObject,
+					 descriptorList, descriptorCount)) {
+    Error_raise(Error_Criticality_error, "could not write all map files");
+  }
 }
 
 /*--------------------*/
@@ -775,6 +715,36 @@ void MapFile_generateStandardFile (inout File_Type *file)
     StringList_write(StringTable_globalDefList, file, String_newline);
   }
 
+  /*..................................*/
+  /* output placement of banked code */
+  /*..................................*/
+  Banking_writePlacementReport(file);
+
+  /*.........................*/
+  /* output removed segments */
+  /*.........................*/
+  Area_writeRemovedSegmentReport(file);
+
+  /*........................*/
+  /* output folded segments */
+  /*........................*/
+  Area_writeFoldedSegmentReport(file);
+
+  /*......................*/
+  /* output relaxed jumps */
+  /*......................*/
+  Area_writeRelaxationReport(file);
+
+  /*.........................*/
+  /* output free memory gaps */
+  /*.........................*/
+  Area_writeFreeMemoryReport(file);
+
+  /*.............................*/
+  /* output overlayed local data */
+  /*.............................*/
+  Area_writeStaticOverlayReport(file);
+
   File_writeCharArray(file, "\n\f");
 
   /*..........................*/
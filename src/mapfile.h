@@ -11,6 +11,11 @@
     are also variants possible.  One can be found in the Gameboy
     module, where a map file for the NoGMB emulator is produced.
 
+    The output routines only read the linked data.  Hence, where the
+    platform supports it, the routines of several map files are run
+    concurrently in forked processes each writing its own buffered
+    file.  The files are the same as those written one after another.
+
     Original version by Thomas Tensi, 2008-01
 */
 
@@ -67,14 +72,6 @@ void MapFile_finalize (void);
 Boolean MapFile_isOpen (void);
   /** tells whether map files are open or not */
 
-/*--------------------*/
-
-void MapFile_getSortedAreaSymbolList (in Area_Type area, 
-				      out Symbol_List *areaSymbolList);
-  /** collects all symbols in <area> and returns them in
-      <areaSymbolList> sorted by address; this is merely a convenience
-      routine to be used by mapfile generators */
-
 
 /*--------------------*/
 /* CHANGE             */
@@ -58,7 +58,8 @@ static TypeDescriptor_Record Module__tdRecord =
   { /* .objectSize = */ 0, /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ NULL,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Module__hasNameKey };
+    /* .keyValidationProc = */ Module__hasNameKey,
+    /* .name = */ "Module" };
 
 TypeDescriptor_Type Module_typeDescriptor = &Module__tdRecord;
 
@@ -67,7 +68,8 @@ static TypeDescriptor_Record Module__recordTDRecord =
   { /* .objectSize = */ sizeof(Module__Record), /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ Module__make,
     /* .destructionProc = */ (TypeDescriptor_DestructionProc) Module_destroy,
-    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL };
+    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL,
+    /* .name = */ "Module record" };
 
 static TypeDescriptor_Type Module__recordTypeDescriptor = 
   &Module__recordTDRecord;
@@ -78,7 +80,8 @@ static TypeDescriptor_Record Module__typeByFileNameDRecord =
   { /* .objectSize = */ 0, /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ NULL,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Module__hasFileNameKey };
+    /* .keyValidationProc = */ Module__hasFileNameKey,
+    /* .name = */ "Module by file name" };
 
 static TypeDescriptor_Type Module__typeByFileNameDescriptor =
   &Module__typeByFileNameDRecord;
@@ -235,6 +238,7 @@ void Module_destroy (inout Module_Type *module)
     String_destroy(&currentModule->associatedFileName);
     List_destroy(&currentModule->segmentList);
     List_destroy(&currentModule->symbolList);
+    DESTROY(currentModule);
     *module = NULL;
   }
 }
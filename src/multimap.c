@@ -84,6 +84,9 @@ void Multimap_destroy (inout Multimap_Type *map)
     List_destroy(&value);
     List_advanceCursor(&keyListCursor);
   }
+
+  List_destroy(&keyList);
+  Map_destroy(map);
 }
 
 
@@ -24,6 +24,7 @@
 #include "set.h"
 #include "string.h"
 #include "symbol.h"
+#include "symbolindex.h"
 #include "target.h"
 
 #include <ctype.h>
@@ -45,7 +46,7 @@ static String_Type NoICEMapFile__currentFunction;
 /*========================================*/
 
 static void NoICEMapFile__processSymbol (inout File_Type *mapFile,
-					 in Symbol_Type symbol,
+					 in SymbolIndex_Entry *entry,
 					 in UINT8 areaMemoryPage);
 
 static void NoICEMapFile__writeDefForFile (inout File_Type *mapFile,
@@ -95,40 +96,35 @@ static void NoICEMapFile__processArea (inout File_Type *mapFile,
   /** traverses <area> and writes all appropriate information to NoICE
       map file given by <file> */
 {
-  Symbol_List areaSymbolList = List_make(Symbol_typeDescriptor);
-  List_Cursor symbolCursor;
   UINT8 areaMemoryPage = Area_getMemoryPage(area);
-
-  MapFile_getSortedAreaSymbolList(area, &areaSymbolList);
+  SizeType entryCount;
+  SymbolIndex_Entry *entryList = SymbolIndex_getAreaEntries(area,
+							    &entryCount);
+  SizeType i;
 
   /* write all symbols to map file */
-  for (symbolCursor = List_resetCursor(areaSymbolList);
-       symbolCursor != NULL;
-       List_advanceCursor(&symbolCursor)) {
-    Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
-    NoICEMapFile__processSymbol(mapFile, symbol, areaMemoryPage);
+  for (i = 0;  i < entryCount;  i++) {
+    NoICEMapFile__processSymbol(mapFile, &entryList[i], areaMemoryPage);
   }
 }
 
 /*--------------------*/
 
 static void NoICEMapFile__processSymbol (inout File_Type *mapFile,
-					 in Symbol_Type symbol,
+					 in SymbolIndex_Entry *entry,
 					 in UINT8 areaMemoryPage)
-  /** parses name of <symbol> and writes appropriate information to
-      NoICE map file given by <file>; <areaMemoryPage> gives the
-      memory page of the symbol area */
+  /** parses name of symbol in index <entry> and writes appropriate
+      information to NoICE map file given by <file>; <areaMemoryPage>
+      gives the memory page of the symbol area */
 {
   char *procName = "NoICEMapFile__processSymbol";
 
-  Target_Address address = Symbol_absoluteAddress(symbol);
+  Target_Address address = entry->address;
   SizeType dotPosition;
   Boolean hasError = false;
-  String_Type symbolName = String_make();
+  String_Type symbolName = entry->name;
   SizeType stringLength;
 
-  Symbol_getName(symbol, &symbolName);
-
   stringLength = String_length(symbolName);
   dotPosition = String_findCharacter(symbolName, '.');
 
@@ -231,8 +227,6 @@ static void NoICEMapFile__processSymbol (inout File_Type *mapFile,
 		"bad symbol in %s: %s", procName, 
 		String_asCharPointer(symbolName));
   }
-
-  String_destroy(&symbolName);
 }
 
 /*--------------------*/
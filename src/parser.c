@@ -20,6 +20,7 @@
 #include "module.h"
 #include "scanner.h"
 #include "set.h"
+#include "statistics.h"
 #include "string.h"
 #include "stringlist.h"
 #include "target.h"
@@ -218,6 +219,7 @@ static void Parser__doCodeLineStateTransition (
 {
   static UINT8 addressPartA;
   static UINT8 addressPartB;
+  Boolean codeIsStored = (!isFirstPass || Area_isTrackingContents());
   String_Type representation = String_make();
 
   enum { State_inError = Parser__State_inError,
@@ -233,7 +235,7 @@ static void Parser__doCodeLineStateTransition (
 
   switch (parserState) {
     case State_firstState:
-      if (!isFirstPass) {
+      if (codeIsStored) {
 	Parser__codeSequence.length = 0;
       }
 
@@ -242,7 +244,7 @@ static void Parser__doCodeLineStateTransition (
       break;
 
     case State_atAddressPartA:
-      if (!isFirstPass) {
+      if (codeIsStored) {
 	addressPartA = (UINT8) Parser__evaluateNumber(representation);
       }
 
@@ -250,7 +252,7 @@ static void Parser__doCodeLineStateTransition (
       break;
 
     case State_atAddressPartB:
-      if (!isFirstPass) {
+      if (codeIsStored) {
 	addressPartB = (UINT8) Parser__evaluateNumber(representation);
       }
 
@@ -260,7 +262,7 @@ static void Parser__doCodeLineStateTransition (
 
     case State_atByteSequence:
       if (token.kind == Scanner_TokenKind_newline) {
-	if (!isFirstPass) {
+	if (codeIsStored) {
 	  Target_Address startAddress;
 	  Parser__codeSequence.segment = Area_currentSegment();
 	  startAddress = Parser__makeWord(addressPartA, addressPartB);
@@ -270,7 +272,7 @@ static void Parser__doCodeLineStateTransition (
 	}
     
 	parserState = State_done;
-      } else if (!isFirstPass) {
+      } else if (codeIsStored) {
 	UINT8 length = Parser__codeSequence.length;
 	UINT8 currentByte = (UINT8) Parser__evaluateNumber(representation);
 
@@ -594,6 +596,10 @@ static void Parser__doRelocLineStateTransition (
   static UINT8 previousByte;
   static CodeSequence_Relocation relocation;
   static CodeSequence_RelocationList relocationList;
+  Boolean referencesAreTracked = (isFirstPass
+				  && (Banking_isTrackingReferences()
+				      || Area_isTrackingReferences()
+				      || Area_isTrackingContents()));
 
   String_Type representation = String_make();
 
@@ -610,7 +616,8 @@ static void Parser__doRelocLineStateTransition (
   
   parserState = *state;
 
-  if (!isFirstPass && parserState > State_firstState
+  if ((!isFirstPass || referencesAreTracked)
+      && parserState > State_firstState
       && Set_isElement(Parser__TokenKindSet_number, token.kind)) {
     currentByte = (UINT8) Parser__evaluateNumber(representation);
   }
@@ -642,7 +649,7 @@ static void Parser__doRelocLineStateTransition (
        segment inserted at first position */
       areaIndex++;
 
-      if (!isFirstPass) {
+      if (!isFirstPass || referencesAreTracked) {
 	relocationList.segment = Module_getSegment(Module_currentModule(), 
 						   areaIndex);
       }
@@ -653,11 +660,17 @@ static void Parser__doRelocLineStateTransition (
 
     case State_atByteSequenceA:
       if (token.kind == Scanner_TokenKind_newline) {
-	if (!isFirstPass) {
+	if (!isFirstPass && !Area_segmentIsRemoved(relocationList.segment)) {
 	  /* relocate last code sequence and put it out */
 	  CodeSequence_relocate(&Parser__codeSequence, areaMode, 
 				&relocationList);
 	  CodeOutput_writeLine(Parser__codeSequence);
+	} else if (referencesAreTracked) {
+	  /* collect the unrelocated code for folding segments */
+	  Area_addContentToSegment(&relocationList.segment,
+				   Parser__codeSequence.offsetAddress,
+				   Parser__codeSequence.byteList,
+				   Parser__codeSequence.length);
 	}
     
 	parserState = State_done;
@@ -680,6 +693,31 @@ static void Parser__doRelocLineStateTransition (
 	relocation.value = Parser__makeWord(previousByte, currentByte);
 	relocationList.list[relocationList.count] = relocation;
 	relocationList.count++;
+      } else if (referencesAreTracked) {
+	/* collect reference for the module reference graph and the
+	   segment reachability */
+	Module_Type module = Module_currentModule();
+	UINT16 index = Parser__makeWord(previousByte, currentByte);
+	Object target;
+
+	if (relocation.kind.isSymbol) {
+	  Symbol_Type symbol = Module_getSymbol(module, index + 1);
+
+	  if (Banking_isTrackingReferences()) {
+	    Banking_addSymbolReference(module, symbol);
+	  }
+
+	  Area_addReferenceToSymbol(&relocationList.segment, symbol);
+	  target = symbol;
+	} else {
+	  Area_Segment segment = Module_getSegment(module, index + 2);
+	  Area_addReferenceToSegment(&relocationList.segment, segment);
+	  target = segment;
+	}
+
+	Area_addRelocationToSegment(&relocationList.segment,
+		       Parser__codeSequence.offsetAddress + relocation.index,
+		       CodeSequence_convertToInteger(relocation.kind), target);
       }
 
       parserState = State_atByteSequenceA;
@@ -881,6 +919,7 @@ static char Parser__getFileListCharacter (void)
       /* close current file */
       if (Parser__fileSequence.index > 1) {
          File_close(&Parser__fileSequence.currentFile);
+	 Statistics_endSpan();
       }
 
       if (Parser__fileSequence.index > Parser__fileSequence.count) {
@@ -903,6 +942,7 @@ static char Parser__getFileListCharacter (void)
 		      "could not open link file %s", 
 		      String_asCharPointer(fileName));
 	} else {
+	  Statistics_beginSpan("object file", String_asCharPointer(fileName));
 	  String_copy(&Parser__fileSequence.currentFileName, fileName);
 	  Parser__fileSequence.currentLineIndex = 0;
 	  Parser__fileSequence.lineLength = 1;
@@ -1195,7 +1235,7 @@ void Parser_collectSymbolDefinitions (in String_Type objectFileName,
 	    } else {
 	      char kindChar = String_getCharacter(token.representation, 1);
 
-	      if (kindChar != 'D' && kindChar != 'R'
+	      if ((kindChar != 'D' && kindChar != 'R')
 		  || String_length(token.representation) < 4) {
 		isError = true;
 	      } else if (kindChar == 'D') {
@@ -1275,6 +1315,8 @@ void Parser_parseObjectFiles (in Boolean isFirstPass,
     } else if (String_length(token.representation) > 0) {
       char commandCharacter = String_getCharacter(token.representation, 1);
 
+      Statistics_countRecord(commandCharacter);
+
       switch (commandCharacter) {
         case 'X':
         case 'D':
@@ -22,7 +22,9 @@
 #include "../globdefs.h"
 #include "../list.h"
 #include "../mapfile.h"
+#include "../module.h"
 #include "../symbol.h"
+#include "../symbolindex.h"
 #include "../string.h"
 #include "../stringlist.h"
 #include "../stringtable.h"
@@ -40,7 +42,9 @@
 # define StdLib_malloc  malloc
 #include <string.h>
 # define STRING_boundedCopy strncpy
+# define STRING_memcpy      memcpy
 # define STRING_memset      memset
+# define STRING_strcmp      strcmp
 # define STRING_strlen      strlen
 
 /*========================================*/
@@ -48,6 +52,7 @@
 #define undefined 0xFF
 
 #define Gameboy__patchMagicNumber 0x132411
+#define Gameboy__ownerMagicNumber 0x132412
 
 
 #define Gameboy__defaultCartridgeValue	0xFF
@@ -61,9 +66,34 @@
 #define Gameboy__maxRomAddress 0x7FFFUL
   /** last address in ROM */
 
-#define Gameboy__maxBankCount 256
+#define Gameboy__maxBankCount 512
+  /** maximum number of ROM banks (as supported by an MBC5) */
 #define Gameboy__maxTitleLength 16
 
+#define Gameboy__rstTrampolineOpcode 0xCF
+  /** opcode of "RST 08h" starting a compact trampoline call; the
+      linker puts a jump to the dispatcher at this vector */
+#define Gameboy__tableTrampolineOpcode 0xD7
+  /** opcode of "RST 10h" starting a table trampoline call; the
+      linker puts a jump to the dispatcher at this vector */
+#define Gameboy__maxTableTrampolineCount 256
+  /** maximum number of table trampoline calls (indexed by a byte) */
+
+#define Gameboy__jumpOpcode 0xC3
+  /** opcode of "JP nn" */
+#define Gameboy__relativeJumpOpcode 0x18
+  /** opcode of "JR e" */
+#define Gameboy__callOpcode 0xCD
+  /** opcode of "CALL nn" */
+#define Gameboy__rstOpcode 0xC7
+  /** opcode of "RST 00h"; the other restarts add their vector */
+
+#define Gameboy__bitsPerWord 32
+  /** number of bytes tracked by a single word of an occupancy
+      bitmap */
+#define Gameboy__wordsPerBank (Gameboy__bankSize / Gameboy__bitsPerWord)
+  /** number of words in the occupancy bitmap of a ROM bank */
+
 typedef struct {
   long magicNumber;
   UINT16 address;
@@ -75,15 +105,67 @@ typedef struct {
 typedef Gameboy__PatchRecord *Gameboy__Patch;
 
 
+typedef struct {
+  long magicNumber;
+  UINT32 address;
+  UINT32 length;
+  Module_Type module;
+} Gameboy__OwnerRecord;
+  /** type defining a contiguous range of bytes in the cartridge with
+      <length> bytes starting at cartridge offset <address> which has
+      been written by <module> */
+
+typedef Gameboy__OwnerRecord *Gameboy__Owner;
+
+
+typedef enum {
+  Gameboy__TrampolineKind_jump, Gameboy__TrampolineKind_rst,
+  Gameboy__TrampolineKind_table
+} Gameboy__TrampolineKind;
+  /** variant of the trampoline call code: <jump> loads the target
+      address and jumps to a bank specific switch routine (6 bytes),
+      <rst> is a restart followed by target address and bank (4
+      bytes), <table> is a restart followed by an index into a table
+      of target addresses and banks (2 bytes plus a 3 byte table
+      entry) */
+
+
 static UINT8 *Gameboy__data[Gameboy__maxBankCount];
+  /** pointers to the ROM banks of the cartridge image; either
+      separately allocated or slices of a memory mapped image file */
+
+static UINT8 *Gameboy__mappedImage = NULL;
+  /** start of the memory mapped image file or NULL when the image is
+      kept in allocated banks */
+
+static Boolean Gameboy__imageIsMapped = false;
+  /** tells whether the image file should be memory mapped and
+      filled in place (instead of being written at the end) */
+
+static String_Type Gameboy__imageFileName;
+  /** name of the Gameboy image file */
+
+static UINT32 *Gameboy__occupancy[Gameboy__maxBankCount];
+  /** bitmaps per ROM bank telling which bytes have already been
+      written by some code sequence */
+
+static List_Type Gameboy__ownerList;
+  /** list of cartridge ranges together with the modules having
+      written them (only used for reporting overlaps) */
+
+static UINT32 Gameboy__romByteSum;
+  /** sum of all bytes in the cartridge image modulo 2^32; it is
+      maintained on every write so that the global checksum is
+      available without another pass over the image */
 
 
 /* the following values are configuration data from the command line
    options */
 static char Gameboy__cartridgeTitle[Gameboy__maxTitleLength] = "";
-static UINT8 Gameboy__romBankCount;
-static UINT8 Gameboy__ramBankCount;
+static UINT16 Gameboy__romBankCount;
+static UINT16 Gameboy__ramBankCount;
 static UINT8 Gameboy__cartridgeType;
+static Gameboy__TrampolineKind Gameboy__trampolineKind;
 
 static UINT32 Gameboy__cartridgeSize;
   /** number of ROM bytes in a cartridge (depending on ROM bank
@@ -96,6 +178,11 @@ static String_Type Gameboy__codeAreaPrefix;
   /** prefix identifying all code areas which are targets for
       interbank calls */
 
+static char *Gameboy__otherCodeAreaNameList[] =
+  { "_HOME", "_GSINIT", "_GSFINAL", NULL };
+  /** names of the areas holding only code besides those starting
+      with <Gameboy__codeAreaPrefix> */
+
 /* ---- type descriptors ---- */ 
 static Object Gameboy__makePatch (void);
 
@@ -104,13 +191,72 @@ static TypeDescriptor_Record Gameboy__patchRecordTDRecord =
     /* .assignmentProc = */ NULL, /* .comparisonProc = */ NULL,
     /* .constructionProc = */ Gameboy__makePatch,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ NULL };
+    /* .keyValidationProc = */ NULL, /* .name = */ "Gameboy patch" };
 
 static TypeDescriptor_Type Gameboy__patchRecordTypeDescriptor =
   &Gameboy__patchRecordTDRecord;
   /** variable used for describing the type properties when patch
       records occur in generic types like lists */
 
+static Object Gameboy__makeOwner (void);
+
+static TypeDescriptor_Record Gameboy__ownerRecordTDRecord =
+  { /* .objectSize = */ sizeof(Gameboy__OwnerRecord),
+    /* .assignmentProc = */ NULL, /* .comparisonProc = */ NULL,
+    /* .constructionProc = */ Gameboy__makeOwner,
+    /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
+    /* .keyValidationProc = */ NULL, /* .name = */ "Gameboy owner" };
+
+static TypeDescriptor_Type Gameboy__ownerRecordTypeDescriptor =
+  &Gameboy__ownerRecordTDRecord;
+  /** variable used for describing the type properties when owner
+      records occur in generic types like lists */
+
+
+/* length of all gbz80 instructions by their first byte; zero for
+   opcodes not defined in the gbz80 */
+static UINT8 Gameboy__instructionLengthList[256] = {
+  /*       0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F */
+  /* 0 */  1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1,
+  /* 1 */  2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+  /* 2 */  2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+  /* 3 */  2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+  /* 4 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* 5 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* 6 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* 7 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* 8 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* 9 */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* A */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* B */  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  /* C */  1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1,
+  /* D */  1, 1, 3, 0, 3, 1, 2, 1, 1, 1, 3, 0, 3, 0, 2, 1,
+  /* E */  2, 1, 1, 0, 0, 1, 2, 1, 2, 1, 3, 0, 0, 0, 2, 1,
+  /* F */  2, 1, 1, 1, 0, 1, 2, 1, 2, 1, 3, 1, 0, 0, 2, 1
+};
+
+/* memory regions of the gameboy address space for area placement:
+   fixed and switchable ROM bank, video RAM, switchable cartridge RAM
+   bank, work RAM and high RAM */
+static Target_MemoryRegion Gameboy__memoryRegionList[] = {
+  { "ROM0", 0x0000, 0x4000, false },
+  { "ROMX", 0x4000, 0x4000, true },
+  { "VRAM", 0x8000, 0x2000, false },
+  { "SRAM", 0xA000, 0x2000, true },
+  { "WRAM", 0xC000, 0x2000, false },
+  { "HRAM", 0xFF80, 0x007F, false },
+  { NULL, 0, 0, false }
+};
+
+/* restart and interrupt vectors and the cartridge header: the
+   platform writes title, sizes and checksums into the header */
+static Target_MemoryRegion Gameboy__reservedRegion =
+  { "HEADER", 0x0000, 0x0150, false };
+
+/* restart and interrupt vectors: code reached from there may
+   interrupt any other code */
+static Target_MemoryRegion Gameboy__interruptVectorRegion =
+  { "VECTORS", 0x0000, 0x0068, false };
 
 /* some constants for nogmb map files */
 static String_Type Gameboy__codeAreaSymbolPrefix;
@@ -121,12 +267,13 @@ static String_Type Gameboy__lengthSymbolPrefix;
 /*            INTERNAL ROUTINES           */
 /*========================================*/
 
-static UINT8 Gameboy__getCartridgeByte (UINT16 address);
-static UINT8 Gameboy__ramCountCode (UINT8 value);
-static UINT8 Gameboy__romCountCode (UINT8 value);
+static UINT8 Gameboy__ramCountCode (UINT16 value);
+static UINT8 Gameboy__romCountCode (UINT16 value);
 static void Gameboy__putAreaToMapFile (inout File_Type *file,
 					in Area_Type area);
+static void Gameboy__readImage (void);
 static void Gameboy__setCartridgeByte (in UINT16 address, in UINT8 value);
+static void Gameboy__setTrampolineKind (void);
 static void Gameboy__writeCodeLine (inout File_Type *file,
 				    in CodeOutput_State state,
 				    in Boolean isBigEndian,
@@ -144,23 +291,165 @@ static Gameboy__Patch Gameboy__attemptConversionToPatch (in Object patch)
 
 /*--------------------*/
 
+static Gameboy__Owner Gameboy__attemptConversionToOwner (in Object owner)
+  /** verifies that <owner> is really a pointer to a Gameboy owner
+      record; if not, the program stops with an error message  */
+{
+  return (Gameboy__Owner) attemptConversion("Gameboy__Owner",
+					    owner, Gameboy__ownerMagicNumber);
+}
+
+/*--------------------*/
+
+static void Gameboy__addOwner (in UINT32 address, in UINT32 length,
+			       in Module_Type module)
+  /** records that <length> bytes starting at cartridge offset
+      <address> have been written by <module>; a range directly
+      following the last range of the same module is merged with
+      it */
+{
+  SizeType ownerCount = List_length(Gameboy__ownerList);
+  Gameboy__Owner owner = NULL;
+
+  if (ownerCount > 0) {
+    owner = Gameboy__attemptConversionToOwner(
+			      List_getElement(Gameboy__ownerList, ownerCount));
+
+    if (owner->module != module
+	|| owner->address + owner->length != address) {
+      owner = NULL;
+    }
+  }
+
+  if (owner != NULL) {
+    owner->length += length;
+  } else {
+    Object *objectPtr = List_append(&Gameboy__ownerList);
+    owner = Gameboy__attemptConversionToOwner(*objectPtr);
+    owner->address = address;
+    owner->length  = length;
+    owner->module  = module;
+  }
+}
+
+/*--------------------*/
+
+static UINT32 Gameboy__cartridgeOffset (in Target_Bank romBank,
+					in UINT32 address)
+  /** returns the offset in the cartridge image for <address> in the
+      CPU address space when ROM bank <romBank> is switched in */
+{
+  UINT32 result = address;
+
+  if (romBank > 1) {
+    result += (romBank - 1) * Gameboy__bankSize;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void Gameboy__copyToCartridge (in UINT32 address,
+				      in UINT8 *byteList, in UINT32 length)
+  /** copies <length> bytes from <byteList> to cartridge starting at
+      cartridge offset <address>; the range may span a bank
+      boundary */
+{
+  while (length > 0) {
+    UINT32 bank = address / Gameboy__bankSize;
+    UINT32 relativeAddress = address % Gameboy__bankSize;
+    UINT32 count = Gameboy__bankSize - relativeAddress;
+
+    if (count > length) {
+      count = length;
+    }
+
+    Gameboy__romByteSum -=
+      CodeOutput_byteSum(&Gameboy__data[bank][relativeAddress], count);
+    Gameboy__romByteSum += CodeOutput_byteSum(byteList, count);
+    STRING_memcpy(&Gameboy__data[bank][relativeAddress], byteList, count);
+    address  += count;
+    byteList += count;
+    length   -= count;
+  }
+}
+
+/*--------------------*/
+
+static Module_Type Gameboy__findOwner (in UINT32 address)
+  /** returns the module which has most recently written the byte at
+      cartridge offset <address> or NULL when unknown */
+{
+  List_Cursor ownerCursor;
+  Module_Type result = NULL;
+
+  for (ownerCursor = List_resetCursor(Gameboy__ownerList);
+       ownerCursor != NULL;
+       List_advanceCursor(&ownerCursor)) {
+    Gameboy__Owner owner =
+      Gameboy__attemptConversionToOwner(List_getElementAtCursor(ownerCursor));
+
+    if (owner->address <= address
+	&& address < owner->address + owner->length) {
+      result = owner->module;
+    }
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
 static long Gameboy__getBankFromName (in String_Type st)
-  /* gets the bank from area symbol string <st> */
+  /* gets the bank from area or area symbol string <st> i.e. the
+     decimal number after the last underscore; returns 0 when there
+     is no such number */
 {
-  String_Type numberString = String_make();
-  SizeType pos;
-  long result;
+  SizeType position = String_findCharacterFromEnd(st, '_');
+  long result = 0;
 
-  pos = String_findCharacterFromEnd(st, '_');
-  String_getSubstring(&numberString, st, pos + 1, 2);
-  String_convertToLong(numberString, 10, &result);
-  String_destroy(&numberString);
+  if (position != String_notFound) {
+    char *digits = &String_asCharPointer(st)[position];
+
+    if (CType_isdigit(*digits)) {
+      char *endp;
+      result = StdLib_strtol(digits, &endp, 10);
+    }
+  }
 
   return result;
 }
 
 /*--------------------*/
 
+static void Gameboy__eraseRange (in CodeSequence_Type sequence)
+  /** resets the bytes in the range given by address, bank and length
+      of <sequence> to the default cartridge value; ranges outside of
+      the cartridge ROM are ignored */
+{
+  UINT32 address      = sequence.offsetAddress;
+  Target_Bank romBank = sequence.romBank;
+
+  if (sequence.length > 0 && address <= Gameboy__maxRomAddress
+      && romBank >= 0 && romBank < (Target_Bank) Gameboy__romBankCount
+      && (romBank == 0 || address >= Gameboy__bankStartAddress)) {
+    UINT8 byteList[CodeSequence_maxLength];
+    UINT32 length = sequence.length;
+
+    address = Gameboy__cartridgeOffset(romBank, address);
+
+    if (address + length > Gameboy__cartridgeSize) {
+      length = Gameboy__cartridgeSize - address;
+    }
+
+    STRING_memset(byteList, Gameboy__defaultCartridgeValue, length);
+    Gameboy__copyToCartridge(address, byteList, length);
+  }
+}
+
+/*--------------------*/
+
 static void Gameboy__finalizeData (void)
 {
   UINT16 cartridgeTitleAddress          = 0x0134;
@@ -238,27 +527,20 @@ static void Gameboy__finalizeData (void)
     List_advanceCursor(&patchCursor);
   }
 
-  /* calculate checksum of header and store it in cartridge */
-  checkSum = 0;
-
-  for (pos = cartridgeTitleAddress;  pos < cartridgeHeaderChecksumAddress;
-       pos++) {
-    checkSum += Gameboy__getCartridgeByte(pos);
-  }
-
+  /* calculate checksum of header and store it in cartridge (the
+     header lies completely in bank 0) */
+  checkSum = (UINT16) CodeOutput_byteSum(
+			      &Gameboy__data[0][cartridgeTitleAddress],
+			      cartridgeHeaderChecksumAddress
+			      - cartridgeTitleAddress);
   value = (0xE7 - (UINT8) (checkSum & 0xFF));
   Gameboy__setCartridgeByte(cartridgeHeaderChecksumAddress, value);
 
-  /* calculate global checksum and store it in cartridge */
-  checkSum = 0;
+  /* the global checksum is the sum over all bytes (except for the
+     checksum itself) and has been maintained incrementally */
   Gameboy__setCartridgeByte(cartridgeGlobalChecksumAddress, 0);
   Gameboy__setCartridgeByte(cartridgeGlobalChecksumAddress + 1, 0);
-
-  for (i = 0;  i < Gameboy__romBankCount;  i++) {
-    for (pos = 0;  pos < Gameboy__bankSize;  pos++) {
-      checkSum += Gameboy__data[i][pos];
-    }
-  }
+  checkSum = (UINT16) (Gameboy__romByteSum & 0xFFFF);
 
   value = (UINT8) ((checkSum >> 8) & 0xFF);
   Gameboy__setCartridgeByte(cartridgeGlobalChecksumAddress, value);
@@ -289,32 +571,79 @@ static void Gameboy__generateNoGmbMapFile (inout File_Type *file)
 
 /*--------------------*/
 
-static UINT8 Gameboy__getCartridgeByte (UINT16 address)
-  /** returns the byte value in cartridge at <address> */
-{
-  UINT8 bank = (UINT8) (address / Gameboy__bankSize);
-  UINT16 relativeAddress = address % Gameboy__bankSize;
-  return Gameboy__data[bank][relativeAddress];
-}
-
-/*--------------------*/
-
 static void Gameboy__initializeData (void)
   /** allocates all Gameboy segments and fills them with the default
-      cartridge value */
+      cartridge value; when a memory mapped image is requested, the
+      segments are slices of the mapped image file instead; when the
+      code output is patched in place, the segments get the contents
+      of the existing image file */
 {
-  UINT8 i;
+  UINT16 i;
+  Boolean isMapped = false;
+  Boolean isPatched = CodeOutput_isPatching();
 
   for (i = 0;  i < Gameboy__romBankCount;  i++) {
-    UINT8 *data = StdLib_malloc(Gameboy__bankSize);
+    Gameboy__occupancy[i] = NEWARRAY(UINT32, Gameboy__wordsPerBank);
 
-    if (data == NULL) {
+    if (Gameboy__occupancy[i] == NULL) {
       Error_raise(Error_Criticality_fatalError,
-		  "can't allocate data for bank %d", i);
+		  "can't allocate occupancy bitmap for bank %d", i);
+    }
+  }
+
+  if (Gameboy__imageIsMapped) {
+    isMapped = (isPatched
+		? File_mapForUpdate(Gameboy__imageFileName,
+				    Gameboy__cartridgeSize,
+				    &Gameboy__mappedImage)
+		: File_mapIntoMemory(Gameboy__imageFileName,
+				     Gameboy__cartridgeSize,
+				     &Gameboy__mappedImage));
+
+    if (!isMapped) {
+      Error_raise(Error_Criticality_warning,
+		  "cannot map %s into memory, writing it conventionally",
+		  String_asCharPointer(Gameboy__imageFileName));
+    }
+  }
+
+  Gameboy__romByteSum = Gameboy__cartridgeSize * Gameboy__defaultCartridgeValue;
+
+  if (isMapped) {
+    if (!isPatched) {
+      STRING_memset(Gameboy__mappedImage, Gameboy__defaultCartridgeValue,
+		    Gameboy__cartridgeSize);
+    }
+
+    for (i = 0;  i < Gameboy__romBankCount;  i++) {
+      Gameboy__data[i] = &Gameboy__mappedImage[i * Gameboy__bankSize];
     }
+  } else {
+    for (i = 0;  i < Gameboy__romBankCount;  i++) {
+      UINT8 *data = StdLib_malloc(Gameboy__bankSize);
+
+      if (data == NULL) {
+	Error_raise(Error_Criticality_fatalError,
+		    "can't allocate data for bank %d", i);
+      }
 
-    STRING_memset(data, Gameboy__defaultCartridgeValue, Gameboy__bankSize);
-    Gameboy__data[i] = data;
+      STRING_memset(data, Gameboy__defaultCartridgeValue, Gameboy__bankSize);
+      Gameboy__data[i] = data;
+    }
+
+    if (isPatched) {
+      Gameboy__readImage();
+    }
+  }
+
+  if (isPatched) {
+    /* the checksum is maintained relative to the previous image */
+    Gameboy__romByteSum = 0;
+
+    for (i = 0;  i < Gameboy__romBankCount;  i++) {
+      Gameboy__romByteSum += CodeOutput_byteSum(Gameboy__data[i],
+						Gameboy__bankSize);
+    }
   }
 }
 
@@ -341,6 +670,29 @@ static char *Gameboy__makeAddressBytes (in UINT16 value)
 
 /*--------------------*/
 
+static char *Gameboy__makeByteString (in UINT8 value)
+  /** makes a character string containing the hex representation of
+      <value> */
+{
+  static char result[3];
+
+  StdIO_sprintf(result, "%02X", value);
+  return result;
+}
+
+/*--------------------*/
+
+static Object Gameboy__makeOwner (void)
+  /** private construction of owner record used when a new entry is
+      created in owner record list */
+{
+  Gameboy__Owner owner = NEW(Gameboy__OwnerRecord);
+  owner->magicNumber = Gameboy__ownerMagicNumber;
+  return owner;
+}
+
+/*--------------------*/
+
 static Object Gameboy__makePatch (void)
   /** private construction of patch used when a new entry is
       created in patch record list */
@@ -352,14 +704,72 @@ static Object Gameboy__makePatch (void)
 
 /*--------------------*/
 
+static void Gameboy__markAsOccupied (in UINT32 address, in UINT32 length,
+				     out UINT32 *overlapStart,
+				     out UINT32 *overlapLength)
+  /** marks <length> bytes starting at cartridge offset <address> as
+      occupied in the occupancy bitmaps word by word; returns in
+      <overlapStart> and <overlapLength> the range from the first to
+      the last byte which had already been occupied before
+      (<overlapLength> is zero when there is no overlap) */
+{
+  *overlapStart  = 0;
+  *overlapLength = 0;
+
+  while (length > 0) {
+    UINT32 bank = address / Gameboy__bankSize;
+    UINT32 relativeAddress = address % Gameboy__bankSize;
+    UINT32 *word =
+      &Gameboy__occupancy[bank][relativeAddress / Gameboy__bitsPerWord];
+    UINT8 firstBit = (UINT8) (relativeAddress % Gameboy__bitsPerWord);
+    UINT32 bitCount = Gameboy__bitsPerWord - firstBit;
+    UINT32 mask;
+    UINT32 collision;
+
+    if (bitCount > length) {
+      bitCount = length;
+    }
+
+    mask = (bitCount == Gameboy__bitsPerWord ? 0xFFFFFFFFUL
+	    : ((1UL << bitCount) - 1)) << firstBit;
+    collision = *word & mask;
+    *word |= mask;
+
+    if (collision != 0) {
+      UINT8 lowBit  = firstBit;
+      UINT8 highBit = (UINT8) (firstBit + bitCount - 1);
+
+      while ((collision & (1UL << lowBit)) == 0) {
+	lowBit++;
+      }
+
+      while ((collision & (1UL << highBit)) == 0) {
+	highBit--;
+      }
+
+      if (*overlapLength == 0) {
+	*overlapStart = address + (lowBit - firstBit);
+      }
+
+      *overlapLength = address + (highBit - firstBit) + 1 - *overlapStart;
+    }
+
+    address += bitCount;
+    length  -= bitCount;
+  }
+}
+
+/*--------------------*/
+
 static void Gameboy__putAreaToMapFile (inout File_Type *file,
 				       in Area_Type area)
   /* write the symbols from <area> to map file */
 {
   String_Type areaName = String_make();
-  Symbol_List areaSymbolList = List_make(Symbol_typeDescriptor);
   long currentBank = 0;
-  List_Cursor symbolCursor;
+  SizeType entryCount;
+  SymbolIndex_Entry *entryList;
+  SizeType i;
 
   Area_getName(area, &areaName);
 
@@ -373,17 +783,12 @@ static void Gameboy__putAreaToMapFile (inout File_Type *file,
     currentBank = Gameboy__getBankFromName(areaName);
   }
 
-  MapFile_getSortedAreaSymbolList(area, &areaSymbolList);
+  entryList = SymbolIndex_getAreaEntries(area, &entryCount);
 
   /* write all symbols to map file */
-  for (symbolCursor = List_resetCursor(areaSymbolList);
-       symbolCursor != NULL;
-       List_advanceCursor(&symbolCursor)) {
-    Symbol_Type symbol = List_getElementAtCursor(symbolCursor);
-    String_Type symbolName = String_make();
-    Target_Address address = Symbol_absoluteAddress(symbol);
-
-    Symbol_getName(symbol, &symbolName);
+  for (i = 0;  i < entryCount;  i++) {
+    String_Type symbolName = entryList[i].name;
+    Target_Address address = entryList[i].address;
 
     if (!String_hasPrefix(symbolName, Gameboy__lengthSymbolPrefix)) {
       if (!String_hasPrefix(symbolName, Gameboy__codeAreaSymbolPrefix)) {
@@ -404,17 +809,14 @@ static void Gameboy__putAreaToMapFile (inout File_Type *file,
       File_writeString(file, symbolName);
       File_writeCharArray(file, "\n");
     }
-
-    String_destroy(&symbolName);
   }
 
-  List_destroy(&areaSymbolList);
   String_destroy(&areaName);
 }
 
 /*--------------------*/
 
-static UINT8 Gameboy__ramCountCode (UINT8 value)
+static UINT8 Gameboy__ramCountCode (UINT16 value)
   /** returns the numerical code for the RAM bank count given by
       <value> within a Gameboy cartridge or <undefined>, when this ram
       bank count is bad */
@@ -430,16 +832,41 @@ static UINT8 Gameboy__ramCountCode (UINT8 value)
       result = 3;  break;
     case 16:
       result = 4;  break;
+    case 8:
+      result = 5;  break;
     default:
-      value = undefined;  break;
+      result = undefined;  break;
   }
 
-  return value;
+  return result;
 }
 
 /*--------------------*/
 
-static UINT8 Gameboy__romCountCode (UINT8 value)
+static void Gameboy__readImage (void)
+  /** reads the contents of all ROM banks from the existing image file
+      for patching it; bytes missing in the file keep the default
+      cartridge value */
+{
+  File_Type file;
+
+  if (!File_open(&file, Gameboy__imageFileName, File_Mode_readBinary)) {
+    Error_raise(Error_Criticality_warning, "cannot read %s for patching",
+		String_asCharPointer(Gameboy__imageFileName));
+  } else {
+    UINT16 i;
+
+    for (i = 0;  i < Gameboy__romBankCount;  i++) {
+      File_readBytes(&file, Gameboy__data[i], Gameboy__bankSize);
+    }
+
+    File_close(&file);
+  }
+}
+
+/*--------------------*/
+
+static UINT8 Gameboy__romCountCode (UINT16 value)
   /** returns the numerical code for the ROM bank count given by
       <value> within a Gameboy cartridge or <undefined>, when this rom
       bank count is bad */
@@ -469,7 +896,7 @@ static UINT8 Gameboy__romCountCode (UINT8 value)
       result = undefined;  break;
   }
 
-  return value;
+  return result;
 }
 
 /*--------------------*/
@@ -477,18 +904,21 @@ static UINT8 Gameboy__romCountCode (UINT8 value)
 static void Gameboy__setCartridgeByte (in UINT16 address, in UINT8 value)
   /** sets byte in cartridge at <address> to <value> */
 {
-  UINT8 bank = (UINT8) (address / Gameboy__bankSize);
+  UINT32 bank = address / Gameboy__bankSize;
   UINT16 relativeAddress = address % Gameboy__bankSize;
+  Gameboy__romByteSum += (UINT32) value - Gameboy__data[bank][relativeAddress];
   Gameboy__data[bank][relativeAddress] = value;
 }
 
 /*--------------------*/
 
 static void Gameboy__processCodeSequence (in CodeSequence_Type sequence)
-  /** adds code sequence <sequence> to output */
+  /** adds code sequence <sequence> to output; bytes which have
+      already been written by some other sequence are reported as a
+      single range */
 {
   if (sequence.length > 0) {
-    UINT16 address       = sequence.offsetAddress;
+    UINT32 address      = sequence.offsetAddress;
     Target_Bank romBank = sequence.romBank;
     Boolean hasError = true;
     char errorMessage[255];
@@ -497,7 +927,7 @@ static void Gameboy__processCodeSequence (in CodeSequence_Type sequence)
     if (address > Gameboy__maxRomAddress) {
       StdIO_sprintf(errorMessage, "address overflow (addr %lx > %lx)",
 		    address, Gameboy__maxRomAddress);
-    } else if (romBank >= Gameboy__romBankCount) {
+    } else if (romBank >= (Target_Bank) Gameboy__romBankCount) {
       StdIO_sprintf(errorMessage, "bank overflow (bank %x > last bank %x)",
 		    romBank, Gameboy__romBankCount);
     } else if (romBank > 0 
@@ -511,36 +941,50 @@ static void Gameboy__processCodeSequence (in CodeSequence_Type sequence)
       hasError = false;
     }
 
+    address = Gameboy__cartridgeOffset(romBank, address);
+
+    if (!hasError && address + sequence.length > Gameboy__cartridgeSize) {
+      StdIO_sprintf(errorMessage, "cartridge size overflow (addr %lx >= %lx)",
+		    address + sequence.length - 1, Gameboy__cartridgeSize);
+      hasError = true;
+    }
+
     if (hasError) {
       Error_raise(Error_Criticality_fatalError, errorMessage);
     } else {
-      UINT8 i;
+      Module_Type module = Module_currentModule();
+      UINT32 overlapStart;
+      UINT32 overlapLength;
 
-      if (romBank > 1) {
-	/* adjust address */
-	address += (romBank - 1) * Gameboy__bankSize;
-      }
+      Gameboy__markAsOccupied(address, sequence.length,
+			      &overlapStart, &overlapLength);
 
-      for (i = 0;  i < sequence.length;  i++) {
-	if (address >= Gameboy__cartridgeSize) {
-	  Error_raise(Error_Criticality_fatalError,
-		      "cartridge size overflow (addr %lx >= %lx)",
-		      address, Gameboy__cartridgeSize);
-	} else {
-	  UINT8 oldValue = Gameboy__getCartridgeByte(address);
-	  UINT8 newValue = sequence.byteList[i];
+      if (overlapLength > 0) {
+	UINT32 bank = overlapStart / Gameboy__bankSize;
+	UINT32 bankAddress = overlapStart % Gameboy__bankSize
+	                     + (bank > 0 ? Gameboy__bankStartAddress : 0);
+	Module_Type otherModule = Gameboy__findOwner(overlapStart);
+	String_Type moduleName = String_make();
+	String_Type otherModuleName = String_makeFromCharArray("?");
 
-	  Gameboy__setCartridgeByte(address, newValue);
+	Module_getName(module, &moduleName);
 
-	  if (oldValue != Gameboy__defaultCartridgeValue) {
-	    Error_raise(Error_Criticality_warning,
-			"possibly wrote twice at addr %lx (%02X->%02X)",
-			address, newValue, oldValue);
-	  }
+	if (otherModule != NULL) {
+	  Module_getName(otherModule, &otherModuleName);
 	}
 
-	address++;
+	Error_raise(Error_Criticality_warning,
+		    "wrote twice at bank %lx, addr %lx (%lu bytes): "
+		    "module %s overwrites module %s",
+		    bank, bankAddress, overlapLength,
+		    String_asCharPointer(moduleName),
+		    String_asCharPointer(otherModuleName));
+	String_destroy(&otherModuleName);
+	String_destroy(&moduleName);
       }
+
+      Gameboy__copyToCartridge(address, sequence.byteList, sequence.length);
+      Gameboy__addOwner(address, sequence.length, module);
     }
   }
 }
@@ -550,18 +994,26 @@ static void Gameboy__processCodeSequence (in CodeSequence_Type sequence)
 static void Gameboy__setBaseAddressTable (void)
   /** updates base address table for <romBankCount> and <ramBankCount> */
 {
-  char template[20];
-  UINT8 i;
+  String_Type entry = String_make();
+  UINT16 i;
 
   for (i = 1;  i < Gameboy__romBankCount;  i++) {
-    StdIO_sprintf(template, "_CODE_%d=0x4000", i);
-    StringTable_addCharArray(&StringTable_baseAddressList, template);
+    String_copyCharArray(&entry, "_CODE_");
+    String_appendInteger(&entry, i, 10);
+    String_appendCharArray(&entry, "=0x4000");
+    StringTable_addCharArray(&StringTable_baseAddressList,
+			     String_asCharPointer(entry));
   }
 
   for (i = 0; i < Gameboy__ramBankCount;  i++) {
-    StdIO_sprintf(template, "_DATA_%d=0xA000", i);
-    StringTable_addCharArray(&StringTable_baseAddressList, template);
+    String_copyCharArray(&entry, "_DATA_");
+    String_appendInteger(&entry, i, 10);
+    String_appendCharArray(&entry, "=0xA000");
+    StringTable_addCharArray(&StringTable_baseAddressList,
+			     String_asCharPointer(entry));
   }
+
+  String_destroy(&entry);
 }
 
 /*========================================*/
@@ -572,21 +1024,9 @@ static Target_Bank Gameboy__getBankFromSegmentName (
 					     in String_Type segmentName)
   /** scans <segmentName> whether it contains a ROM bank switch
       information; in the Gameboy those segments have a trailing
-      underscore with a subsequent digit */
+      underscore with a subsequent decimal bank number */
 {
-  INT32 position = String_findCharacterFromEnd(segmentName, '_');
-  Target_Bank romBank = 0;
-
-  if (position != String_notFound  
-      && position + 1 <= (INT32) String_length(segmentName)) {
-    UINT32 digitPosition = position + 1;
-    char digitChar = String_getCharacter(segmentName, digitPosition);
-    if (CType_isdigit(digitChar)) {
-      romBank = digitChar - '0';
-    }
-  }
-
-  return romBank;
+  return (Target_Bank) Gameboy__getBankFromName(segmentName);
 }
 
 /*--------------------*/
@@ -594,7 +1034,48 @@ static Target_Bank Gameboy__getBankFromSegmentName (
 static UINT8 Gameboy__getCodeByte (in Target_Bank bank,
 				   in Target_Address address)
 {
-  return Gameboy__data[bank][address];
+  UINT32 offset = Gameboy__cartridgeOffset(bank, address);
+  return Gameboy__data[offset / Gameboy__bankSize][offset % Gameboy__bankSize];
+}
+
+/*--------------------*/
+
+static UINT8 Gameboy__decodeInstruction (in UINT8 *byteList,
+					 in SizeType count,
+					 out Target_InstructionKind *kind)
+  /** returns the length of the gbz80 instruction at the start of
+      <byteList> (having <count> bytes) and its <kind> for jump
+      relaxation or 0 for an invalid instruction */
+{
+  UINT8 opcode = byteList[0];
+  UINT8 length = Gameboy__instructionLengthList[opcode];
+
+  if (length > count) {
+    length = 0;
+  }
+
+  switch (opcode) {
+    case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA:
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+      /* JP [cc,]nn and CALL [cc,]nn */
+      *kind = Target_InstructionKind_absoluteJump;
+      break;
+
+    case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+      /* JR [cc,]e */
+      *kind = Target_InstructionKind_relativeJump;
+      break;
+
+    case 0xE9:
+      /* JP (HL) */
+      *kind = Target_InstructionKind_computedJump;
+      break;
+
+    default:
+      *kind = Target_InstructionKind_other;
+  }
+
+  return length;
 }
 
 /*--------------------*/
@@ -622,7 +1103,10 @@ static void Gameboy__giveUsageInfo (out String_Type *st)
     "  -yt  MBC type (default: no MBC)\n"
     "  -yn  Name of program (default: name of output file)\n"
     "  -yp# Patch one byte in the output GB file (# is: addr=byte)\n"
-    "  -z   Gameboy image as file[GB]\n";
+    "  -ys# Trampoline call variant (# is: j=jump [default], r=rst,"
+    " t=table)\n"
+    "  -z   Gameboy image as file[GB]\n"
+    "  -zm  Gameboy image as file[GB] filled in place via memory mapping\n";
 
   String_copyCharArray(st, result);
 }
@@ -665,11 +1149,13 @@ static void Gameboy__handleCommandLine (in String_Type mainFileNamePrefix,
 	*optionIsHandled = true;
 
 	if (secondChar == 'Z') {
-	  String_Type outputFileName = String_make();
-	  String_append(&outputFileName, mainFileNamePrefix);
-	  String_appendCharArray(&outputFileName, ".gb");
-	  CodeOutput_create(outputFileName, Gameboy__writeCodeLine);
-	  String_destroy(&outputFileName);
+	  String_copy(&Gameboy__imageFileName, mainFileNamePrefix);
+	  String_appendCharArray(&Gameboy__imageFileName, ".gb");
+	  /* the image file is only mapped (and hence overwritten) when
+	     its code output stream is really created */
+	  Gameboy__imageIsMapped = (CType_toupper(arg[2]) == 'M'
+				    && CodeOutput_isActive());
+	  CodeOutput_create(Gameboy__imageFileName, Gameboy__writeCodeLine);
 	} else if (secondChar == 'J') {
 	  MapFile_ProcDescriptor routines =
 	    { NULL, Gameboy__generateNoGmbMapFile };
@@ -685,15 +1171,19 @@ static void Gameboy__handleCommandLine (in String_Type mainFileNamePrefix,
 	  char optionChar = CType_toupper(arg[2]);
 	  Gameboy__Patch patch;
 	  char *st;
-	  UINT8 value = undefined;
+	  UINT16 value = undefined;
 
 	  if (length > 3) {
-	   value = (UINT8) StdLib_atoi(&arg[3]);
+	   value = (UINT16) StdLib_atoi(&arg[3]);
 	  }
 
 	  switch (optionChar) {
 	    case 'O':
-	      if (Gameboy__romCountCode(value) == undefined) {
+	      if (value > Gameboy__maxBankCount) {
+		Error_raise(Error_Criticality_fatalError,
+			    "too many ROM banks [%d > %d]", value,
+			    Gameboy__maxBankCount);
+	      } else if (Gameboy__romCountCode(value) == undefined) {
 		Error_raise(Error_Criticality_warning,
 			    "unsupported number of ROM banks [%d]", value);
 	      }
@@ -712,7 +1202,7 @@ static void Gameboy__handleCommandLine (in String_Type mainFileNamePrefix,
 	      break;
 
 	    case 'T':
-	      Gameboy__cartridgeType = value;
+	      Gameboy__cartridgeType = (UINT8) value;
 	      break;
 
 	    case 'N':
@@ -735,6 +1225,28 @@ static void Gameboy__handleCommandLine (in String_Type mainFileNamePrefix,
 
 	      break;
 
+	    case 'S':
+	      switch (CType_toupper(arg[3])) {
+		case 'J':
+		  Gameboy__trampolineKind = Gameboy__TrampolineKind_jump;
+		  break;
+
+		case 'R':
+		  Gameboy__trampolineKind = Gameboy__TrampolineKind_rst;
+		  break;
+
+		case 'T':
+		  Gameboy__trampolineKind = Gameboy__TrampolineKind_table;
+		  break;
+
+		default:
+		  Error_raise(Error_Criticality_fatalError,
+			      "unknown trampoline call variant in option %s",
+			      arg);
+	      }
+
+	      break;
+
 	    case 'P':
 	      objectPtr = List_append(&Gameboy__patchList);
 	      patch = Gameboy__attemptConversionToPatch(*objectPtr);
@@ -768,12 +1280,32 @@ static void Gameboy__handleCommandLine (in String_Type mainFileNamePrefix,
     }
   }
 
+  Gameboy__bankingConfiguration.lastCodeBank = Gameboy__romBankCount - 1;
+  Gameboy__setTrampolineKind();
   Gameboy__initializeData();
   Gameboy__setBaseAddressTable();
 }
 
 /*--------------------*/
 
+static Boolean Gameboy__isCodeArea (in String_Type areaName)
+  /** tells whether the area with <areaName> holds only code; this is
+      true for the code areas and the areas of the global and static
+      initialization code generated by SDCC */
+{
+  Boolean isFound = String_hasPrefix(areaName, Gameboy__codeAreaPrefix);
+  char *name = String_asCharPointer(areaName);
+  UINT8 i;
+
+  for (i = 0;  !isFound && Gameboy__otherCodeAreaNameList[i] != NULL;  i++) {
+    isFound = (STRING_strcmp(name, Gameboy__otherCodeAreaNameList[i]) == 0);
+  }
+
+  return isFound;
+}
+
+/*--------------------*/
+
 static void Gameboy__makeBankedCodeAreaName (out String_Type *areaName,
 					     in Target_Bank bank)
   /** constructs a banked code area name <areaName> from <bank>; when
@@ -783,12 +1315,154 @@ static void Gameboy__makeBankedCodeAreaName (out String_Type *areaName,
     String_copy(areaName, Gameboy__bankingConfiguration.nonbankedCodeAreaName);
   } else {
     String_copyCharArray(areaName, "_CODE_");
-    String_appendInteger(areaName, bank, 16);
+    String_appendInteger(areaName, bank, 10);
   }
 }
 
 /*--------------------*/
 
+static void Gameboy__makeDispatcherCode (
+				    in UINT16 startAddress,
+				    in UINT16 referencedAreaIndex,
+				    in UINT16 vectorAreaIndex,
+				    in UINT16 tableSymbolIndex,
+				    in UINT16 *jumpLabelSymbolIndexList,
+				    in Target_Bank lastBank,
+				    out UINT16 *codeSize,
+				    out String_Type *codeSequence)
+  /** constructs the dispatcher of the compact trampoline calls and
+      the jump to it at the restart vector with the parameters as
+      described for <Banking_DispatcherTemplateProc>; the dispatcher
+      loads the target address into BC (like the trampoline call of
+      the jump variant) and jumps via a table of the jump labels to
+      the bank switch routine of the target bank; it changes A, DE
+      and HL */
+{
+  /* the dispatcher for the table variant is done by the following
+     assembler code, the one for the rst variant only pops the
+     address of the bytes following the restart before the common
+     part:
+
+       Banking__tableDispatch:
+		POP  HL       ; address of the index byte
+		LD   L,(HL)
+		LD   H,#0
+		LD   D,H
+		LD   E,L
+		ADD  HL,HL
+		ADD  HL,DE    ; index times three
+		LD   DE,#Banking__trampolineTable
+		ADD  HL,DE    ; address of the table entry
+       common:  LD   C,(HL)
+		INC  HL
+		LD   B,(HL)   ; target address
+		INC  HL
+		LD   L,(HL)   ; target bank
+		LD   H,#0
+		ADD  HL,HL
+		LD   DE,#labels
+		ADD  HL,DE
+		LD   A,(HL+)
+		LD   H,(HL)
+		LD   L,A
+		JP   (HL)
+       labels:  .DW  Banking__switchTo0, Banking__switchTo1, ...
+
+     with "JP Banking__tableDispatch" at the restart vector; the
+     table of jump labels is indexed by the bank and has a zero
+     entry for each bank without trampoline calls */
+
+  Boolean isTable = (Gameboy__trampolineKind == Gameboy__TrampolineKind_table);
+  UINT8 vectorAddress = (UINT8) ((isTable ? Gameboy__tableTrampolineOpcode
+				  : Gameboy__rstTrampolineOpcode)
+				 & ~Gameboy__rstOpcode);
+  UINT16 prefixLength = (isTable ? 12 : 1);
+  UINT16 labelTableAddress = startAddress + prefixLength + 16;
+  Target_Bank bank;
+
+  /* -- T line with prefix and common part */
+  String_copyCharArray(codeSequence, "T ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(startAddress));
+
+  if (isTable) {
+    String_appendCharArray(codeSequence,
+			   " E1 6E 26 00 54 5D 29 19 11 00 00 19");
+  } else {
+    String_appendCharArray(codeSequence, " E1");
+  }
+
+  String_appendCharArray(codeSequence, " 4E 23 46 23 6E 26 00 29 11 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(labelTableAddress));
+  String_appendCharArray(codeSequence, " 19 2A 66 6F E9\n");
+
+  /* -- R line: the trampoline table is referenced by symbol, the
+	table of jump labels by offset in the area */
+  String_appendCharArray(codeSequence, "R ");
+  String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+
+  if (isTable) {
+    String_appendCharArray(codeSequence, " 02 0B ");
+    String_appendCharArray(codeSequence,
+			   Gameboy__makeAddressBytes(tableSymbolIndex));
+  }
+
+  String_appendCharArray(codeSequence, " 00 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeByteString((UINT8) (prefixLength + 11)));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+  String_appendCharArray(codeSequence, "\n");
+
+  /* -- one T and R line for each entry of the jump label table */
+  for (bank = 0;  bank <= lastBank;  bank++) {
+    UINT16 labelSymbolIndex = jumpLabelSymbolIndexList[bank];
+
+    String_appendCharArray(codeSequence, "T ");
+    String_appendCharArray(codeSequence,
+	       Gameboy__makeAddressBytes(labelTableAddress + 2 * bank));
+    String_appendCharArray(codeSequence, " 00 00\nR ");
+    String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+    String_appendCharArray(codeSequence, " ");
+    String_appendCharArray(codeSequence,
+			   Gameboy__makeAddressBytes(referencedAreaIndex));
+
+    if (labelSymbolIndex != Banking_noSymbolIndex) {
+      String_appendCharArray(codeSequence, " 02 02 ");
+      String_appendCharArray(codeSequence,
+			     Gameboy__makeAddressBytes(labelSymbolIndex));
+    }
+
+    String_appendCharArray(codeSequence, "\n");
+  }
+
+  /* -- jump from the restart vector in the absolute area */
+  String_appendCharArray(codeSequence, "T ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(vectorAddress));
+  String_appendCharArray(codeSequence, " C3 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(startAddress));
+  String_appendCharArray(codeSequence, "\nR ");
+  String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(vectorAreaIndex));
+  String_appendCharArray(codeSequence, " 00 03 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+  String_appendCharArray(codeSequence, "\n");
+
+  *codeSize = labelTableAddress + 2 * (lastBank + 1) - startAddress;
+}
+
+/*--------------------*/
+
 static void Gameboy__makeJumpLabelName (out String_Type *labelName,
 					in Target_Bank bank)
     /** constructs the jump label <labelName> (for bank switching
@@ -816,13 +1490,15 @@ static void Gameboy__makeTrampolineCallCode (in UINT16 startAddress,
 					     in UINT16 referencedAreaIndex,
 					     in UINT16 targetSymbolIndex,
 					     in UINT16 jumpLabelSymbolIndex,
+					     in Target_Bank targetBank,
 					     out String_Type *codeSequence)
   /** constructs concrete trampoline call code in the nonbanked code
       area; the start address of the code within the segment is given
       as <startAddress >, the target symbol is given by
       <targetSymbolIndex> in area with index <referencedAreaIndex> and
       the jump label symbol as index <jumpLabelSymbolIndex> also in
-      the same area; the routine returns several code lines in
+      the same area (<targetBank> is encoded in the label); the
+      routine returns several code lines in
       <codeSequence>: a T line with the call and a relocation line
       referencing the target symbol and the bank switch label */
 {
@@ -861,13 +1537,247 @@ static void Gameboy__makeTrampolineCallCode (in UINT16 startAddress,
 
 /*--------------------*/
 
+static void Gameboy__makeRstTrampolineCallCode (
+					in UINT16 startAddress,
+					in UINT16 referencedAreaIndex,
+					in UINT16 targetSymbolIndex,
+					in UINT16 jumpLabelSymbolIndex,
+					in Target_Bank targetBank,
+					out String_Type *codeSequence)
+  /** constructs compact trampoline call code in the nonbanked code
+      area with the same parameters as
+      <Gameboy__makeTrampolineCallCode>; the dispatcher reached via
+      the restart reads target address and bank from the bytes
+      following the restart and does not return there (see
+      <Gameboy__makeDispatcherCode>) */
+{
+  /* a call to routine XYZ in bank 23 is done by the following
+     assembler code:
+       BC_XYZ: RST  0x08
+               .DW  XYZ
+               .DB  23 */
+
+  /* -- T line */
+  String_copyCharArray(codeSequence, "T ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(startAddress));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeByteString(Gameboy__rstTrampolineOpcode));
+  String_appendCharArray(codeSequence, " 00 00 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeByteString((UINT8) targetBank));
+  String_appendCharArray(codeSequence, "\n");
+
+  /* -- R line: kind = sym (2), index = 3, value = targetSymbolIndex */
+  String_appendCharArray(codeSequence, "R ");
+  String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence, 
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+  String_appendCharArray(codeSequence, " 02 03 ");
+  String_appendCharArray(codeSequence, 
+			 Gameboy__makeAddressBytes(targetSymbolIndex));
+  String_appendCharArray(codeSequence, "\n");
+}
+
+/*--------------------*/
+
+static void Gameboy__makeTableTrampolineCallCode (
+					in UINT16 startAddress,
+					in UINT16 referencedAreaIndex,
+					in UINT16 targetSymbolIndex,
+					in UINT16 jumpLabelSymbolIndex,
+					in Target_Bank targetBank,
+					out String_Type *codeSequence)
+  /** constructs table trampoline call code in the nonbanked code
+      area with the same parameters as
+      <Gameboy__makeTrampolineCallCode>; the call only consists of a
+      restart and the index of its entry in the trampoline table */
+{
+  /* a call to routine XYZ having the table entry 42 is done by the
+     following assembler code:
+       BC_XYZ: RST  0x10
+               .DB  42 */
+
+  UINT16 tableIndex = startAddress
+                      / Gameboy__bankingConfiguration.offsetPerTrampolineCall;
+
+  if (tableIndex >= Gameboy__maxTableTrampolineCount) {
+    Error_raise(Error_Criticality_fatalError,
+		"too many table trampoline calls (more than %d)",
+		Gameboy__maxTableTrampolineCount);
+  }
+
+  /* -- T line */
+  String_copyCharArray(codeSequence, "T ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(startAddress));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+		      Gameboy__makeByteString(Gameboy__tableTrampolineOpcode));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeByteString((UINT8) tableIndex));
+  String_appendCharArray(codeSequence, "\n");
+
+  /* -- R line without relocations */
+  String_appendCharArray(codeSequence, "R ");
+  String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence, 
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+  String_appendCharArray(codeSequence, "\n");
+}
+
+/*--------------------*/
+
+static void Gameboy__makeTrampolineTableCode (in UINT16 startAddress,
+					      in UINT16 referencedAreaIndex,
+					      in UINT16 targetSymbolIndex,
+					      in UINT16 jumpLabelSymbolIndex,
+					      in Target_Bank targetBank,
+					      out String_Type *codeSequence)
+  /** constructs the entry of a table trampoline call in the
+      trampoline table at <startAddress> consisting of the target
+      address and the target bank; the other parameters are as in
+      <Gameboy__makeTrampolineCallCode> */
+{
+  /* -- T line */
+  String_copyCharArray(codeSequence, "T ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeAddressBytes(startAddress));
+  String_appendCharArray(codeSequence, " 00 00 ");
+  String_appendCharArray(codeSequence,
+			 Gameboy__makeByteString((UINT8) targetBank));
+  String_appendCharArray(codeSequence, "\n");
+
+  /* -- R line: kind = sym (2), index = 2, value = targetSymbolIndex */
+  String_appendCharArray(codeSequence, "R ");
+  String_appendCharArray(codeSequence, Gameboy__makeAddressBytes(0));
+  String_appendCharArray(codeSequence, " ");
+  String_appendCharArray(codeSequence, 
+			 Gameboy__makeAddressBytes(referencedAreaIndex));
+  String_appendCharArray(codeSequence, " 02 02 ");
+  String_appendCharArray(codeSequence, 
+			 Gameboy__makeAddressBytes(targetSymbolIndex));
+  String_appendCharArray(codeSequence, "\n");
+}
+
+/*--------------------*/
+
+static UINT8 Gameboy__relaxJump (in UINT8 *instruction,
+				 in Boolean distanceIsKnown,
+				 in long distance,
+				 in Boolean addressIsKnown,
+				 in Target_Address address,
+				 out UINT8 *byteList)
+  /** returns a shorter encoding of absolute jump <instruction> in
+      <byteList> and its length (or 0 when there is none): a JP
+      (conditional or not) to a target in the range of a displacement
+      byte becomes a JR (saving one byte and four cycles when taken),
+      an unconditional CALL to a restart vector becomes the RST
+      (saving two bytes and eight cycles) */
+{
+  UINT8 opcode = instruction[0];
+  UINT8 result = 0;
+  /* displacements count from the end of the two byte JR */
+  long displacement = distance - 2;
+
+  if (distanceIsKnown && displacement >= -128 && displacement <= 127) {
+    if (opcode == Gameboy__jumpOpcode) {
+      byteList[0] = Gameboy__relativeJumpOpcode;
+      byteList[1] = (UINT8) displacement;
+      result = 2;
+    } else if (opcode == 0xC2 || opcode == 0xCA
+	       || opcode == 0xD2 || opcode == 0xDA) {
+      /* JP cc,nn and JR cc,e have the same condition bits */
+      byteList[0] = (UINT8) (0x20 | (opcode & 0x18));
+      byteList[1] = (UINT8) displacement;
+      result = 2;
+    }
+  }
+
+  if (opcode == Gameboy__callOpcode && addressIsKnown
+      && (address & ~0x38) == 0) {
+    byteList[0] = (UINT8) (Gameboy__rstOpcode | address);
+    result = 1;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void Gameboy__setTrampolineKind (void)
+  /** sets the trampoline call part of the banking configuration
+      according to the trampoline call variant; the cycles are the
+      clock cycles from the start of the trampoline call until the
+      bank switch routine of the target bank is entered with the
+      target address in BC (the switch routine itself is the same for
+      all variants) */
+{
+  Banking_Configuration *conf = &Gameboy__bankingConfiguration;
+
+  if (Gameboy__trampolineKind != Gameboy__TrampolineKind_jump
+      && Gameboy__romBankCount > 0x100) {
+    /* the compact variants encode the bank in a single byte */
+    Error_raise(Error_Criticality_fatalError,
+		"trampoline call variant %s supports at most 256 ROM banks",
+		(Gameboy__trampolineKind == Gameboy__TrampolineKind_rst
+		 ? "rst" : "table"));
+  }
+
+  conf->makeTrampolineTableCode      = NULL;
+  conf->tableOffsetPerTrampolineCall = 0;
+  conf->makeDispatcherCode           = NULL;
+  conf->dispatcherVectorSize         = 3;
+
+  switch (Gameboy__trampolineKind) {
+    case Gameboy__TrampolineKind_rst:
+      /* RST (16) and JP (16) at the vector, POP HL (12) and the
+	 common part of the dispatcher (100) */
+      conf->trampolineStrategyName  = "rst";
+      conf->makeTrampolineCallCode  = Gameboy__makeRstTrampolineCallCode;
+      conf->makeDispatcherCode      = Gameboy__makeDispatcherCode;
+      conf->offsetPerTrampolineCall = 4;
+      conf->cyclesPerTrampolineCall = 144;
+      String_copyCharArray(&conf->dispatcherName, "Banking__rstDispatch");
+      String_copyCharArray(&conf->dispatcherVectorAreaName, "_RST08");
+      break;
+
+    case Gameboy__TrampolineKind_table:
+      /* RST (16) and JP (16) at the vector, POP HL and the table
+	 entry address (80) and the common part of the dispatcher
+	 (100) */
+      conf->trampolineStrategyName       = "table";
+      conf->makeTrampolineCallCode       = Gameboy__makeTableTrampolineCallCode;
+      conf->makeTrampolineTableCode      = Gameboy__makeTrampolineTableCode;
+      conf->makeDispatcherCode           = Gameboy__makeDispatcherCode;
+      conf->offsetPerTrampolineCall      = 2;
+      conf->tableOffsetPerTrampolineCall = 3;
+      conf->cyclesPerTrampolineCall      = 212;
+      String_copyCharArray(&conf->dispatcherName, "Banking__tableDispatch");
+      String_copyCharArray(&conf->dispatcherVectorAreaName, "_RST10");
+      break;
+
+    default:
+      conf->trampolineStrategyName  = "jump";
+      conf->makeTrampolineCallCode  = Gameboy__makeTrampolineCallCode;
+      conf->offsetPerTrampolineCall = conf->standardOffsetPerTrampolineCall;
+      conf->cyclesPerTrampolineCall = conf->standardCyclesPerTrampolineCall;
+  }
+}
+
+/*--------------------*/
+
 static void Gameboy__writeCodeLine (inout File_Type *file,
 				    in CodeOutput_State state,
 				    in Boolean isBigEndian,
 				    in CodeSequence_Type sequence)
   /** code output routine producing Gameboy executable file format */
 {
-  UINT8 i;
+  UINT16 i;
 
   switch (state) {
     case CodeOutput_State_atBegin:
@@ -879,11 +1789,21 @@ static void Gameboy__writeCodeLine (inout File_Type *file,
       Gameboy__processCodeSequence(sequence);
       break;
 
+    case CodeOutput_State_atErase:
+      Gameboy__eraseRange(sequence);
+      break;
+
     case CodeOutput_State_atEnd:
       Gameboy__finalizeData();
 
-      for (i = 0;  i < Gameboy__romBankCount;  i++) {
-        File_writeBytes(file, Gameboy__data[i], Gameboy__bankSize);
+      if (Gameboy__mappedImage != NULL) {
+	/* the image has been built in place in the mapped file and
+	   the associated stream stays empty */
+	File_unmapFromMemory(&Gameboy__mappedImage, Gameboy__cartridgeSize);
+      } else {
+	for (i = 0;  i < Gameboy__romBankCount;  i++) {
+	  File_writeBytes(file, Gameboy__data[i], Gameboy__bankSize);
+	}
       }
       break;
   }
@@ -899,13 +1819,17 @@ static void Gameboy__initialize (void)
   Gameboy__codeAreaPrefix = String_makeFromCharArray("_CODE");
   Gameboy__lengthSymbolPrefix = String_makeFromCharArray("l__");
   Gameboy__codeAreaSymbolPrefix = String_makeFromCharArray("s__CODE_");
+  Gameboy__imageFileName = String_make();
 
   Gameboy__romBankCount  = 2;
   Gameboy__ramBankCount  = 0;
   Gameboy__cartridgeType = 0;
+  Gameboy__trampolineKind = Gameboy__TrampolineKind_jump;
+  Gameboy__imageIsMapped = false;
   Gameboy__cartridgeSize = Gameboy__romBankCount * Gameboy__bankSize;
 
   Gameboy__patchList = List_make(Gameboy__patchRecordTypeDescriptor);
+  Gameboy__ownerList = List_make(Gameboy__ownerRecordTypeDescriptor);
 
   StringTable_addCharArray(&StringTable_baseAddressList, "_CODE=0x0200");
   StringTable_addCharArray(&StringTable_baseAddressList, "_DATA=0xC0A0");
@@ -919,7 +1843,17 @@ static void Gameboy__initialize (void)
   /* banking configuration */
   conf->genericBankedCodeAreaName = String_makeFromCharArray("_CODE_0");
   conf->nonbankedCodeAreaName     = String_makeFromCharArray("_CODE");
-  conf->offsetPerTrampolineCall   = 6;
+  conf->trampolineTableName       = String_makeFromCharArray(
+						     "Banking__trampolineTable");
+  conf->dispatcherName            = String_make();
+  conf->dispatcherVectorAreaName  = String_make();
+  conf->standardOffsetPerTrampolineCall = 6;
+  conf->standardCyclesPerTrampolineCall = 28;
+    /* LD BC (12) and JP (16) in the call */
+  conf->firstCodeBank             = 1;
+  conf->lastCodeBank              = Gameboy__romBankCount - 1;
+  conf->codeBankSize              = Gameboy__bankSize;
+  conf->nonbankedCodeAreaSize     = Gameboy__bankSize - 0x0200;
 
   conf->ensureAsCallTarget      = Gameboy__ensureAsCallTarget;
     /** checks target symbol for being target of an interbank call */
@@ -929,10 +1863,13 @@ static void Gameboy__initialize (void)
     /** constructs the jump label (for bank switching within a
 	trampoline call) from a bank */
   conf->makeTrampolineCallCode  = Gameboy__makeTrampolineCallCode;
-    /** constructs a concrete trampoline call code */
+    /** constructs a concrete trampoline call code (replaced when
+	another trampoline call variant is selected) */
   conf->makeSurrogateSymbolName = Gameboy__makeSurrogateSymbolName;
     /** constructs a concrete trampoline surrogate symbol name from a
         symbol name */
+
+  Gameboy__setTrampolineKind();
 }
 
 /*--------------------*/
@@ -941,14 +1878,25 @@ static void Gameboy__finalize (void)
   /** cleans up internal data structures */
 {
   Banking_Configuration *conf = &Gameboy__bankingConfiguration;
+  UINT16 i;
+
   String_destroy(&conf->genericBankedCodeAreaName);
   String_destroy(&conf->nonbankedCodeAreaName);
+  String_destroy(&conf->trampolineTableName);
+  String_destroy(&conf->dispatcherName);
+  String_destroy(&conf->dispatcherVectorAreaName);
 
   List_destroy(&Gameboy__patchList);
+  List_destroy(&Gameboy__ownerList);
+
+  for (i = 0;  i < Gameboy__romBankCount;  i++) {
+    DESTROY(Gameboy__occupancy[i]);
+  }
 
   String_destroy(&Gameboy__lengthSymbolPrefix);
   String_destroy(&Gameboy__codeAreaSymbolPrefix);
   String_destroy(&Gameboy__codeAreaPrefix);
+  String_destroy(&Gameboy__imageFileName);
 }
 
 /*========================================*/
@@ -964,5 +1912,11 @@ Target_Type Gameboy_targetInfo = {
   Gameboy__handleCommandLine,        /* handleCommandLineOptions */
   Gameboy__initialize,               /* initialize */
   Gameboy__finalize,                 /* finalize */
-  &Gameboy__bankingConfiguration     /* bankingConfiguration */
+  &Gameboy__bankingConfiguration,    /* bankingConfiguration */
+  Gameboy__decodeInstruction,        /* decodeInstruction */
+  Gameboy__relaxJump,                /* relaxJump */
+  Gameboy__isCodeArea,               /* isCodeArea */
+  Gameboy__memoryRegionList,         /* memoryRegionList */
+  &Gameboy__reservedRegion,          /* reservedRegion */
+  &Gameboy__interruptVectorRegion    /* interruptVectorRegion */
 };
@@ -14,6 +14,7 @@
 # define CType_isLower islower
 # define CType_toUpper toupper
 #include "error.h"
+#include "statistics.h"
 #include "string.h"
 
 /*========================================*/
@@ -73,7 +74,8 @@ static TypeDescriptor_Record Scanner__tokenTypeRecord =
     /* .comparisonProc = */ NULL,
     /* .constructionProc = */ Scanner__makeTokenObject,
     /* .destructionProc = */ Scanner__destroyTokenObject,
-    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL
+    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL,
+    /* .name = */ "Scanner token"
   };
 
 static TypeDescriptor_Type Scanner__tokenTypeDescriptor =
@@ -504,6 +506,8 @@ void Scanner_getNextToken (out Scanner_Token *token)
     }
   }  while (isInWhiteSpace);
 
+  Statistics_count(Statistics_CounterKind_token, 1);
+
   if (Scanner__traceIsOn) {
     if (token->kind != Scanner_TokenKind_newline) {
       File_writeChar(&File_stderr, ' ');
@@ -0,0 +1,863 @@
+/** Statistics module --
+    Implementation of module providing services for collecting
+    statistics about a link.
+
+    NOTE: as a naming convention all file scope names have the module
+    name as a prefix with a single underscore for externally visible
+    names and two underscores for internal names
+*/
+
+#include "statistics.h"
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "error.h"
+#include "file.h"
+#include "list.h"
+#include "string.h"
+#include "typedescriptor.h"
+
+#include <stdio.h>
+# define StdIO_sprintf sprintf
+#include <string.h>
+# define STRING_isEqual(a,b) (strcmp(a,b) == 0)
+#include <time.h>
+# define Time_clock          clock
+# define Time_clocksPerSecond CLOCKS_PER_SEC
+# define Time_now            time
+
+#if defined(unix) || defined(__unix__) || defined(__APPLE__)
+# define Statistics__hasPreciseTime
+#include <sys/time.h>
+# define Time_getTimeOfDay   gettimeofday
+#include <unistd.h>
+# define UniStd_getProcessId getpid
+#endif
+
+/*========================================*/
+
+#define Statistics__counterKindCount 6
+  /** number of values in <Statistics_CounterKind> */
+
+static char *Statistics__counterNameList[Statistics__counterKindCount] = {
+  "tokens", "relocations", "mapLookups", "mapProbes",
+  "allocations", "allocatedBytes"
+};
+  /** names of counters in the JSON report */
+
+static char *Statistics__counterTextList[Statistics__counterKindCount] = {
+  "tokens scanned", "relocations applied", "map lookups",
+  "map key comparisons", "allocations", "bytes allocated"
+};
+  /** names of counters in the text report */
+
+static UINT32 Statistics__counterList[Statistics__counterKindCount];
+  /** current values of all counters */
+
+#define Statistics__recordKindCount 26
+  /** object file records are identified by an upper case letter */
+
+static UINT32 Statistics__recordCountList[Statistics__recordKindCount];
+  /** number of object file records per record kind */
+
+static Boolean Statistics__isActive;
+  /** tells whether phase times and file transfers are recorded */
+
+/*--------------------*/
+
+#define Statistics__maxPhaseCount 32
+  /** maximum number of different phases recorded */
+
+typedef struct {
+  char *name;
+  long wallTime;
+  long cpuTime;
+} Statistics__PhaseRecord;
+  /** type representing a link phase with its accumulated wall clock
+      and processor time in microseconds */
+
+static Statistics__PhaseRecord
+  Statistics__phaseList[Statistics__maxPhaseCount];
+  /** all phases recorded in the order of their first start */
+
+static SizeType Statistics__phaseCount;
+  /** number of entries used in <phaseList> */
+
+static Statistics__PhaseRecord *Statistics__activePhase;
+  /** phase currently running (or NULL when none is running) */
+
+static long Statistics__phaseWallStartTime;
+static long Statistics__phaseCpuStartTime;
+  /** times when the active phase has been started */
+
+static long Statistics__startSecond;
+  /** second of initialization of this module; all wall clock times
+      are relative to that */
+
+/*--------------------*/
+
+static File_Type Statistics__traceFile;
+  /** file for trace events (or NULL when no trace is written) */
+
+static SizeType Statistics__openSpanCount;
+  /** number of spans begun and not yet ended in the trace file */
+
+static Boolean Statistics__phaseIsTraced;
+  /** tells whether the active phase is an open span in the trace */
+
+static long Statistics__traceProcessId;
+  /** identification of process owning the open spans */
+
+/*--------------------*/
+
+#define Statistics__maxTallyCount 48
+  /** maximum number of different modules or types accounted for heap
+      blocks; further ones are accounted to the last entry */
+
+typedef struct {
+  char *name;
+  UINT32 allocationCount;
+  UINT32 blockCount;
+  UINT32 byteCount;
+  UINT32 peakByteCount;
+} Statistics__TallyRecord;
+  /** type representing the heap use of a module or type: the number
+      of allocations, the blocks and bytes currently allocated and the
+      peak of allocated bytes */
+
+static Statistics__TallyRecord
+  Statistics__ownerTallyList[Statistics__maxTallyCount];
+static SizeType Statistics__ownerTallyCount = 1;
+static Statistics__TallyRecord
+  Statistics__typeTallyList[Statistics__maxTallyCount];
+static SizeType Statistics__typeTallyCount = 1;
+  /** heap use per owning module and per type where the first entry
+      is for blocks without module or type; those lists are set up
+      statically, because the first allocations happen before the
+      initialization of this module */
+
+static Statistics__TallyRecord Statistics__heapTally =
+  { "all blocks", 0, 0, 0, 0 };
+  /** heap use of all blocks */
+
+static char *Statistics__allocationTypeName;
+  /** type name for blocks allocated currently (or NULL) */
+
+/*--------------------*/
+
+typedef struct {
+  String_Type name;
+  Boolean isForWriting;
+  UINT32 byteCount;
+  UINT32 lineCount;
+} Statistics__FileRecord;
+  /** type representing the transfers from or to a file */
+
+typedef Statistics__FileRecord *Statistics__File;
+
+static void Statistics__destroyFile (inout Object *object);
+static Object Statistics__makeFile (void);
+
+static TypeDescriptor_Record Statistics__fileRecordTDRecord =
+  { /* .objectSize = */ sizeof(Statistics__FileRecord),
+    /* .assignmentProc = */ NULL, /* .comparisonProc = */ NULL,
+    /* .constructionProc = */ Statistics__makeFile,
+    /* .destructionProc = */ Statistics__destroyFile,
+    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ NULL,
+    /* .name = */ "Statistics file" };
+
+static TypeDescriptor_Type Statistics__fileRecordTypeDescriptor =
+  &Statistics__fileRecordTDRecord;
+  /** variable used for describing the type properties when file
+      records occur in generic types like lists */
+
+static List_Type Statistics__fileList;
+  /** all files transferred in the order of their first transfer */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static void Statistics__destroyFile (inout Object *object)
+  /** destroys file record given by <object> */
+{
+  Statistics__File file = *object;
+  String_destroy(&file->name);
+  DESTROY(file);
+  *object = NULL;
+}
+
+/*--------------------*/
+
+static void Statistics__addToTally (inout Statistics__TallyRecord *tally,
+				    in SizeType size,
+				    in Boolean isAllocation)
+  /** accounts the allocation (when <isAllocation> is set) or release
+      of a block with <size> bytes in <tally> */
+{
+  if (!isAllocation) {
+    tally->blockCount--;
+    tally->byteCount -= (UINT32) size;
+  } else {
+    tally->allocationCount++;
+    tally->blockCount++;
+    tally->byteCount += (UINT32) size;
+
+    if (tally->byteCount > tally->peakByteCount) {
+      tally->peakByteCount = tally->byteCount;
+    }
+  }
+}
+
+/*--------------------*/
+
+static UINT16 Statistics__findTally (inout Statistics__TallyRecord *list,
+				     inout SizeType *count, in char *name)
+  /** returns index of tally with <name> in <list> with <count>
+      entries and adds a tally when none is found; a NULL <name> is
+      mapped onto the first entry */
+{
+  UINT16 result = 0;
+  SizeType i;
+
+  if (name != NULL) {
+    for (i = 1;  result == 0 && i < *count;  i++) {
+      if (list[i].name == name) {
+	result = (UINT16) i;
+      }
+    }
+
+    /* the same name may occur at different addresses */
+    for (i = 1;  result == 0 && i < *count;  i++) {
+      if (STRING_isEqual(list[i].name, name)) {
+	result = (UINT16) i;
+      }
+    }
+
+    if (result == 0) {
+      if (*count < Statistics__maxTallyCount) {
+	list[*count].name = name;
+	(*count)++;
+      }
+
+      result = (UINT16) (*count - 1);
+    }
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void Statistics__getTimes (out long *wallTime, out long *cpuTime)
+  /** returns the current wall clock time and the processor time used
+      so far by the linker in microseconds */
+{
+#ifdef Statistics__hasPreciseTime
+  struct timeval now;
+  Time_getTimeOfDay(&now, NULL);
+  *wallTime = (((long) now.tv_sec - Statistics__startSecond) * 1000000L
+	       + (long) now.tv_usec);
+#else
+  *wallTime = ((long) Time_now(NULL) - Statistics__startSecond) * 1000000L;
+#endif
+
+  *cpuTime = (long) ((double) Time_clock() * 1000000.0
+		     / Time_clocksPerSecond);
+}
+
+/*--------------------*/
+
+static long Statistics__getProcessId (void)
+  /** returns the identification of the current process */
+{
+#ifdef Statistics__hasPreciseTime
+  return (long) UniStd_getProcessId();
+#else
+  return 1;
+#endif
+}
+
+/*--------------------*/
+
+static void Statistics__adoptTrace (void)
+  /** makes the current process the owner of the trace; a process
+      forked during the link must not end the spans of its parent,
+      hence it starts without open spans */
+{
+  long processId = Statistics__getProcessId();
+
+  if (processId != Statistics__traceProcessId) {
+    Statistics__traceProcessId = processId;
+    Statistics__openSpanCount = 0;
+    Statistics__phaseIsTraced = false;
+  }
+}
+
+/*--------------------*/
+
+static Object Statistics__makeFile (void)
+  /** creates a new file record and returns it as object */
+{
+  Statistics__File file = NEW(Statistics__FileRecord);
+  file->name         = String_make();
+  file->isForWriting = false;
+  file->byteCount    = 0;
+  file->lineCount    = 0;
+  return file;
+}
+
+/*--------------------*/
+
+static void Statistics__writeJSONString (inout File_Type *file,
+					 in char *st)
+  /** writes <st> as a quoted JSON string to <file> */
+{
+  File_writeChar(file, '"');
+
+  for (;  *st != String_terminator;  st++) {
+    if (*st == '"' || *st == '\\') {
+      File_writeChar(file, '\\');
+    }
+
+    File_writeChar(file, *st);
+  }
+
+  File_writeChar(file, '"');
+}
+
+/*--------------------*/
+
+static void Statistics__writeJSONReport (inout File_Type *file)
+  /** writes the statistics collected as a JSON object to <file> */
+{
+  UINT32 lookupCount =
+    Statistics__counterList[Statistics_CounterKind_mapLookup];
+  UINT32 probeCount =
+    Statistics__counterList[Statistics_CounterKind_mapProbe];
+  char buffer[100];
+  char *separator = "";
+  List_Cursor cursor;
+  SizeType i;
+
+  File_writeCharArray(file, "{\n  \"phases\": [");
+
+  for (i = 0;  i < Statistics__phaseCount;  i++) {
+    Statistics__PhaseRecord *phase = &Statistics__phaseList[i];
+    File_writeCharArray(file, separator);
+    File_writeCharArray(file, "\n    { \"name\": ");
+    Statistics__writeJSONString(file, phase->name);
+    StdIO_sprintf(buffer, ", \"wallMicroseconds\": %ld,"
+		  " \"cpuMicroseconds\": %ld }",
+		  phase->wallTime, phase->cpuTime);
+    File_writeCharArray(file, buffer);
+    separator = ",";
+  }
+
+  File_writeCharArray(file, "\n  ],\n  \"files\": [");
+  separator = "";
+
+  for (cursor = List_resetCursor(Statistics__fileList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Statistics__File transfer = List_getElementAtCursor(cursor);
+    File_writeCharArray(file, separator);
+    File_writeCharArray(file, "\n    { \"name\": ");
+    Statistics__writeJSONString(file, String_asCharPointer(transfer->name));
+    StdIO_sprintf(buffer, ", \"direction\": \"%s\","
+		  " \"bytes\": %lu, \"lines\": %lu }",
+		  (transfer->isForWriting ? "output" : "input"),
+		  transfer->byteCount, transfer->lineCount);
+    File_writeCharArray(file, buffer);
+    separator = ",";
+  }
+
+  File_writeCharArray(file, "\n  ],\n  \"counters\": {");
+  separator = "";
+
+  for (i = 0;  i < Statistics__counterKindCount;  i++) {
+    StdIO_sprintf(buffer, "%s\n    \"%s\": %lu", separator,
+		  Statistics__counterNameList[i], Statistics__counterList[i]);
+    File_writeCharArray(file, buffer);
+    separator = ",";
+  }
+
+  StdIO_sprintf(buffer, ",\n    \"averageProbeLength\": %.2f",
+		(lookupCount == 0 ? 0.0
+		 : (double) probeCount / (double) lookupCount));
+  File_writeCharArray(file, buffer);
+  File_writeCharArray(file, "\n  },\n  \"records\": {");
+  separator = "";
+
+  for (i = 0;  i < Statistics__recordKindCount;  i++) {
+    if (Statistics__recordCountList[i] > 0) {
+      StdIO_sprintf(buffer, "%s \"%c\": %lu", separator, (char) ('A' + i),
+		    Statistics__recordCountList[i]);
+      File_writeCharArray(file, buffer);
+      separator = ",";
+    }
+  }
+
+  File_writeCharArray(file, " }\n}\n");
+}
+
+/*--------------------*/
+
+static void Statistics__writeTraceEvent (in char eventKind,
+					 in char *category, in char *name)
+  /** writes a trace event of <eventKind> ('B' for begin or 'E' for
+      end of a span) with <category> and <name> to the trace file;
+      <category> and <name> are only used for the begin of a span */
+{
+  File_Type *file = &Statistics__traceFile;
+  long processId = Statistics__getProcessId();
+  long wallTime;
+  long cpuTime;
+  char buffer[100];
+
+  Statistics__getTimes(&wallTime, &cpuTime);
+  File_writeCharArray(file, ",\n{ ");
+
+  if (eventKind == 'B') {
+    File_writeCharArray(file, "\"name\": ");
+    Statistics__writeJSONString(file, name);
+    File_writeCharArray(file, ", \"cat\": ");
+    Statistics__writeJSONString(file, category);
+    File_writeCharArray(file, ", ");
+  }
+
+  /* there is only one thread per process, hence the thread
+     identification is that of the process */
+  StdIO_sprintf(buffer, "\"ph\": \"%c\", \"ts\": %ld, \"pid\": %ld,"
+		" \"tid\": %ld }", eventKind, wallTime, processId, processId);
+  File_writeCharArray(file, buffer);
+}
+
+/*--------------------*/
+
+static void Statistics__writeTallyList (inout File_Type *file,
+					in char *heading,
+					in Statistics__TallyRecord *list,
+					in SizeType count,
+					in Boolean namesAreFileNames)
+  /** writes all tallies in <list> with <count> entries used to <file>
+      under <heading>; when <namesAreFileNames> is set, the names are
+      source file names and only their base names are shown */
+{
+  char buffer[120];
+  SizeType i;
+
+  StdIO_sprintf(buffer, "\n%-24s %11s %12s %11s %11s\n", heading,
+		"Allocations", "Peak Bytes", "Live Blocks", "Live Bytes");
+  File_writeCharArray(file, buffer);
+
+  for (i = 0;  i < count;  i++) {
+    Statistics__TallyRecord *tally = &list[i];
+
+    if (tally->allocationCount > 0) {
+      char *name = tally->name;
+      int nameLength;
+
+      if (name == NULL) {
+	name = "(none)";
+      } else if (namesAreFileNames) {
+	char *ptr;
+
+	for (ptr = name;  *ptr != String_terminator;  ptr++) {
+	  if (*ptr == '/' || *ptr == '\\') {
+	    name = ptr + 1;
+	  }
+	}
+      }
+
+      for (nameLength = 0;
+	   name[nameLength] != String_terminator && nameLength < 24
+	     && !(namesAreFileNames && name[nameLength] == '.');
+	   nameLength++) {
+      }
+
+      StdIO_sprintf(buffer, "%-24.*s %11lu %12lu %11lu %11lu\n",
+		    nameLength, name, tally->allocationCount,
+		    tally->peakByteCount, tally->blockCount,
+		    tally->byteCount);
+      File_writeCharArray(file, buffer);
+    }
+  }
+}
+
+/*--------------------*/
+
+static void Statistics__writeTextReport (inout File_Type *file)
+  /** writes the statistics collected as text to <file> */
+{
+  UINT32 lookupCount =
+    Statistics__counterList[Statistics_CounterKind_mapLookup];
+  UINT32 probeCount =
+    Statistics__counterList[Statistics_CounterKind_mapProbe];
+  long totalWallTime = 0;
+  long totalCpuTime = 0;
+  char buffer[100];
+  List_Cursor cursor;
+  SizeType i;
+
+  File_writeCharArray(file, "\nLink Statistics\n\n");
+  File_writeCharArray(file,
+		      "Phase                      Wall [ms]    CPU [ms]\n");
+
+  for (i = 0;  i < Statistics__phaseCount;  i++) {
+    Statistics__PhaseRecord *phase = &Statistics__phaseList[i];
+    StdIO_sprintf(buffer, "%-24s %11.3f %11.3f\n", phase->name,
+		  phase->wallTime / 1000.0, phase->cpuTime / 1000.0);
+    File_writeCharArray(file, buffer);
+    totalWallTime += phase->wallTime;
+    totalCpuTime  += phase->cpuTime;
+  }
+
+  StdIO_sprintf(buffer, "%-24s %11.3f %11.3f\n", "total",
+		totalWallTime / 1000.0, totalCpuTime / 1000.0);
+  File_writeCharArray(file, buffer);
+
+  File_writeCharArray(file, "\n     Bytes      Lines  File\n");
+
+  for (cursor = List_resetCursor(Statistics__fileList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Statistics__File transfer = List_getElementAtCursor(cursor);
+    StdIO_sprintf(buffer, "%10lu %10lu  %c ", transfer->byteCount,
+		  transfer->lineCount, (transfer->isForWriting ? '>' : '<'));
+    File_writeCharArray(file, buffer);
+    File_writeString(file, transfer->name);
+    File_writeChar(file, '\n');
+  }
+
+  File_writeCharArray(file, "\nCounters\n");
+
+  for (i = 0;  i < Statistics__counterKindCount;  i++) {
+    StdIO_sprintf(buffer, "%-24s %10lu\n", Statistics__counterTextList[i],
+		  Statistics__counterList[i]);
+    File_writeCharArray(file, buffer);
+  }
+
+  StdIO_sprintf(buffer, "%-24s %10.2f\n", "average probe length",
+		(lookupCount == 0 ? 0.0
+		 : (double) probeCount / (double) lookupCount));
+  File_writeCharArray(file, buffer);
+  File_writeCharArray(file, "\nRecords\n");
+
+  for (i = 0;  i < Statistics__recordKindCount;  i++) {
+    if (Statistics__recordCountList[i] > 0) {
+      StdIO_sprintf(buffer, "%c %10lu\n", (char) ('A' + i),
+		    Statistics__recordCountList[i]);
+      File_writeCharArray(file, buffer);
+    }
+  }
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void Statistics_initialize (void)
+{
+  SizeType i;
+
+  for (i = 0;  i < Statistics__counterKindCount;  i++) {
+    Statistics__counterList[i] = 0;
+  }
+
+  for (i = 0;  i < Statistics__recordKindCount;  i++) {
+    Statistics__recordCountList[i] = 0;
+  }
+
+  Statistics__isActive    = false;
+  Statistics__phaseCount  = 0;
+  Statistics__activePhase = NULL;
+  Statistics__startSecond = (long) Time_now(NULL);
+  Statistics__fileList    = List_make(Statistics__fileRecordTypeDescriptor);
+  Statistics__traceFile   = NULL;
+  Statistics__openSpanCount = 0;
+  Statistics__phaseIsTraced = false;
+  Statistics__traceProcessId = 0;
+  Statistics__allocationTypeName = NULL;
+}
+
+/*--------------------*/
+
+void Statistics_finalize (void)
+{
+  Statistics_closeTrace();
+  List_destroy(&Statistics__fileList);
+}
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+UINT32 Statistics_getCount (in Statistics_CounterKind kind)
+{
+  return Statistics__counterList[kind];
+}
+
+/*--------------------*/
+
+Boolean Statistics_isActive (void)
+{
+  return Statistics__isActive;
+}
+
+/*--------------------*/
+
+Boolean Statistics_isTraced (void)
+{
+  return (Statistics__traceFile != NULL);
+}
+
+/*--------------------*/
+
+void Statistics_writeHeapReport (inout File_Type *file)
+{
+  File_writeCharArray(file, "\nHeap Use\n");
+  Statistics__writeTallyList(file, "Total", &Statistics__heapTally, 1,
+			     false);
+  Statistics__writeTallyList(file, "Module",
+			     Statistics__ownerTallyList,
+			     Statistics__ownerTallyCount, true);
+  Statistics__writeTallyList(file, "Type", Statistics__typeTallyList,
+			     Statistics__typeTallyCount, false);
+}
+
+/*--------------------*/
+
+void Statistics_writeReport (inout File_Type *file, in Boolean isInJSON)
+{
+  Statistics_startPhase(NULL);
+
+  if (isInJSON) {
+    Statistics__writeJSONReport(file);
+  } else {
+    Statistics__writeTextReport(file);
+  }
+}
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void Statistics_beginSpan (in char *category, in char *name)
+{
+  if (Statistics__traceFile != NULL) {
+    Statistics__adoptTrace();
+    Statistics__writeTraceEvent('B', category, name);
+    Statistics__openSpanCount++;
+  }
+}
+
+/*--------------------*/
+
+void Statistics_closeTrace (void)
+{
+  if (Statistics__traceFile != NULL) {
+    while (Statistics__openSpanCount > 0) {
+      Statistics_endSpan();
+    }
+
+    Statistics__phaseIsTraced = false;
+    File_writeCharArray(&Statistics__traceFile, "\n]\n");
+    File_close(&Statistics__traceFile);
+    Statistics__traceFile = NULL;
+  }
+}
+
+/*--------------------*/
+
+void Statistics_count (in Statistics_CounterKind kind, in UINT32 amount)
+{
+  Statistics__counterList[kind] += amount;
+}
+
+/*--------------------*/
+
+void Statistics_countRecord (in char recordKind)
+{
+  if (recordKind >= 'A' && recordKind <= 'Z') {
+    Statistics__recordCountList[recordKind - 'A']++;
+  }
+}
+
+/*--------------------*/
+
+void Statistics_endSpan (void)
+{
+  if (Statistics__traceFile != NULL) {
+    Statistics__adoptTrace();
+  }
+
+  if (Statistics__traceFile != NULL && Statistics__openSpanCount > 0) {
+    Statistics__writeTraceEvent('E', NULL, NULL);
+    Statistics__openSpanCount--;
+  }
+}
+
+/*--------------------*/
+
+void Statistics_openTrace (in String_Type fileName)
+{
+  Statistics_closeTrace();
+
+  if (!File_open(&Statistics__traceFile, fileName, File_Mode_write)) {
+    Error_raise(Error_Criticality_warning, "could not write trace file %s",
+		String_asCharPointer(fileName));
+    Statistics__traceFile = NULL;
+  } else {
+    /* all events are preceded by a comma, hence the array starts
+       with an event naming the process */
+    char buffer[100];
+    long processId = Statistics__getProcessId();
+
+    Statistics__traceProcessId = processId;
+    StdIO_sprintf(buffer, "[\n{ \"name\": \"process_name\", \"ph\": \"M\","
+		  " \"pid\": %ld, \"tid\": %ld,", processId, processId);
+    File_writeCharArray(&Statistics__traceFile, buffer);
+    File_writeCharArray(&Statistics__traceFile,
+			" \"args\": { \"name\": \"aslink\" } }");
+  }
+}
+
+/*--------------------*/
+
+void Statistics_recordAllocation (in char *ownerName, in SizeType size,
+				   out Statistics_AllocationTag *tag)
+{
+  tag->size = size;
+  tag->ownerIndex = Statistics__findTally(Statistics__ownerTallyList,
+					  &Statistics__ownerTallyCount,
+					  ownerName);
+  tag->typeIndex = Statistics__findTally(Statistics__typeTallyList,
+					 &Statistics__typeTallyCount,
+					 Statistics__allocationTypeName);
+  Statistics__addToTally(&Statistics__heapTally, size, true);
+  Statistics__addToTally(&Statistics__ownerTallyList[tag->ownerIndex],
+			 size, true);
+  Statistics__addToTally(&Statistics__typeTallyList[tag->typeIndex],
+			 size, true);
+  Statistics_count(Statistics_CounterKind_allocation, 1);
+  Statistics_count(Statistics_CounterKind_allocatedByte, (UINT32) size);
+}
+
+/*--------------------*/
+
+void Statistics_recordFileTransfer (in String_Type fileName,
+				    in Boolean isForWriting,
+				    in UINT32 byteCount, in UINT32 lineCount)
+{
+  if (Statistics__isActive) {
+    Statistics__File transfer = NULL;
+    List_Cursor cursor;
+
+    for (cursor = List_resetCursor(Statistics__fileList);
+	 cursor != NULL && transfer == NULL;  List_advanceCursor(&cursor)) {
+      Statistics__File otherTransfer = List_getElementAtCursor(cursor);
+
+      if (otherTransfer->isForWriting == isForWriting
+	  && String_isEqual(otherTransfer->name, fileName)) {
+	transfer = otherTransfer;
+      }
+    }
+
+    if (transfer == NULL) {
+      transfer = *List_append(&Statistics__fileList);
+      String_copy(&transfer->name, fileName);
+      transfer->isForWriting = isForWriting;
+    }
+
+    transfer->byteCount += byteCount;
+    transfer->lineCount += lineCount;
+  }
+}
+
+/*--------------------*/
+
+void Statistics_recordRelease (in Statistics_AllocationTag *tag)
+{
+  Statistics__addToTally(&Statistics__heapTally, tag->size, false);
+  Statistics__addToTally(&Statistics__ownerTallyList[tag->ownerIndex],
+			 tag->size, false);
+  Statistics__addToTally(&Statistics__typeTallyList[tag->typeIndex],
+			 tag->size, false);
+}
+
+/*--------------------*/
+
+void Statistics_setActive (in Boolean isActive)
+{
+  Statistics__isActive = isActive;
+}
+
+/*--------------------*/
+
+char *Statistics_setAllocationType (in char *typeName)
+{
+  char *previousTypeName = Statistics__allocationTypeName;
+  Statistics__allocationTypeName = typeName;
+  return previousTypeName;
+}
+
+/*--------------------*/
+
+void Statistics_startPhase (in char *phaseName)
+{
+  if (Statistics__traceFile != NULL) {
+    Statistics__adoptTrace();
+  }
+
+  if (Statistics__phaseIsTraced) {
+    Statistics_endSpan();
+    Statistics__phaseIsTraced = false;
+  }
+
+  if (phaseName != NULL && Statistics__traceFile != NULL) {
+    Statistics_beginSpan("phase", phaseName);
+    Statistics__phaseIsTraced = true;
+  }
+
+  if (Statistics__isActive) {
+    long wallTime;
+    long cpuTime;
+
+    Statistics__getTimes(&wallTime, &cpuTime);
+
+    if (Statistics__activePhase != NULL) {
+      Statistics__activePhase->wallTime +=
+	wallTime - Statistics__phaseWallStartTime;
+      Statistics__activePhase->cpuTime +=
+	cpuTime - Statistics__phaseCpuStartTime;
+      Statistics__activePhase = NULL;
+    }
+
+    if (phaseName != NULL) {
+      SizeType i;
+
+      /* a phase occuring several times accumulates its times */
+      for (i = 0;  i < Statistics__phaseCount;  i++) {
+	if (STRING_isEqual(Statistics__phaseList[i].name, phaseName)) {
+	  Statistics__activePhase = &Statistics__phaseList[i];
+	}
+      }
+
+      if (Statistics__activePhase == NULL
+	  && Statistics__phaseCount < Statistics__maxPhaseCount) {
+	Statistics__activePhase =
+	  &Statistics__phaseList[Statistics__phaseCount++];
+	Statistics__activePhase->name     = phaseName;
+	Statistics__activePhase->wallTime = 0;
+	Statistics__activePhase->cpuTime  = 0;
+      }
+
+      Statistics__phaseWallStartTime = wallTime;
+      Statistics__phaseCpuStartTime  = cpuTime;
+    }
+  }
+}
@@ -0,0 +1,182 @@
+/** Statistics module --
+    This module provides services for collecting statistics about a
+    link: the wall clock and processor time of its phases, the bytes
+    and lines transferred per file and counters for frequent events
+    (like scanned tokens, object file records by type, relocations,
+    map lookups and allocations).
+
+    The counters are always maintained, because incrementing them is
+    cheap.  Phase times and file transfers are only recorded when the
+    statistics are active.  At the end of a link a report can be
+    written either as text or as a JSON object.
+
+    Additionally a timeline of the link can be written to a trace file
+    in the trace event format of Chrome and Perfetto.  It contains a
+    span for each phase and nested spans for work on single files.
+    Each span carries the process and thread identification, hence
+    the spans of forked processes can be told apart.  When no trace
+    file is open, the span routines return immediately.
+
+    Finally, when built with ASLINK_HEAP_ACCOUNTING, the module
+    accounts all heap blocks by the module allocating them and by the
+    type descriptor of the object being constructed.  For each of
+    those it tracks the number of
+    allocations, the blocks and bytes currently allocated and the peak
+    of allocated bytes.  A heap report after the finalization of all
+    other modules shows their peak memory use and the blocks never
+    released.
+*/
+
+#ifndef __STATISTICS_H
+#define __STATISTICS_H
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "file.h"
+#include "string.h"
+
+/*========================================*/
+
+typedef enum {
+  Statistics_CounterKind_token,
+  Statistics_CounterKind_relocation,
+  Statistics_CounterKind_mapLookup,
+  Statistics_CounterKind_mapProbe,
+  Statistics_CounterKind_allocation,
+  Statistics_CounterKind_allocatedByte
+} Statistics_CounterKind;
+  /** kinds of events counted: scanned tokens, relocations applied,
+      map lookups, key comparisons within those lookups, allocations
+      and bytes allocated */
+
+typedef struct {
+  SizeType size;
+  UINT16 ownerIndex;
+  UINT16 typeIndex;
+} Statistics_AllocationTag;
+  /** accounting information kept with each heap block: its size and
+      internal identifications of its owning module and type */
+
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void Statistics_initialize (void);
+  /** sets up internal data structures for this module */
+
+/*--------------------*/
+
+void Statistics_finalize (void);
+  /** cleans up internal data structures for this module */
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+UINT32 Statistics_getCount (in Statistics_CounterKind kind);
+  /** returns the current value of the counter for events of <kind> */
+
+/*--------------------*/
+
+Boolean Statistics_isActive (void);
+  /** tells whether phase times and file transfers are recorded */
+
+/*--------------------*/
+
+Boolean Statistics_isTraced (void);
+  /** tells whether a trace file is open */
+
+/*--------------------*/
+
+void Statistics_writeHeapReport (inout File_Type *file);
+  /** writes a report of the heap use per module and per type to
+      <file> with the peak of allocated bytes and all blocks not yet
+      released */
+
+/*--------------------*/
+
+void Statistics_writeReport (inout File_Type *file, in Boolean isInJSON);
+  /** writes a report of all statistics collected to <file> either as
+      text or - when <isInJSON> is set - as a JSON object; an active
+      phase is ended before */
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void Statistics_beginSpan (in char *category, in char *name);
+  /** starts a span in the trace file for work of <category> called
+      <name> nested in the span currently open */
+
+/*--------------------*/
+
+void Statistics_closeTrace (void);
+  /** ends all spans and closes the trace file (if open) */
+
+/*--------------------*/
+
+void Statistics_count (in Statistics_CounterKind kind, in UINT32 amount);
+  /** adds <amount> to counter for events of <kind> */
+
+/*--------------------*/
+
+void Statistics_countRecord (in char recordKind);
+  /** increments counter for object file records with <recordKind> */
+
+/*--------------------*/
+
+void Statistics_endSpan (void);
+  /** ends the innermost span open in the trace file */
+
+/*--------------------*/
+
+void Statistics_openTrace (in String_Type fileName);
+  /** opens trace file with <fileName>; all phases and spans started
+      afterwards are written to that file */
+
+/*--------------------*/
+
+void Statistics_recordAllocation (in char *ownerName, in SizeType size,
+				   out Statistics_AllocationTag *tag);
+  /** accounts a heap block with <size> bytes to the module with
+      source file <ownerName> and to the current allocation type and
+      sets <tag> for the block; this may happen before the
+      initialization of this module */
+
+/*--------------------*/
+
+void Statistics_recordFileTransfer (in String_Type fileName,
+				    in Boolean isForWriting,
+				    in UINT32 byteCount, in UINT32 lineCount);
+  /** adds <byteCount> bytes and <lineCount> lines read from or - when
+      <isForWriting> is set - written to file with <fileName>;
+      transfers for the same file are accumulated */
+
+/*--------------------*/
+
+void Statistics_recordRelease (in Statistics_AllocationTag *tag);
+  /** accounts the release of the heap block with <tag> */
+
+/*--------------------*/
+
+void Statistics_setActive (in Boolean isActive);
+  /** sets whether phase times and file transfers are recorded */
+
+/*--------------------*/
+
+char *Statistics_setAllocationType (in char *typeName);
+  /** sets the type of all blocks allocated afterwards to <typeName>
+      (NULL for blocks without a type) and returns the previous type
+      name */
+
+/*--------------------*/
+
+void Statistics_startPhase (in char *phaseName);
+  /** ends the active phase and starts a new phase with <phaseName>;
+      when <phaseName> is NULL, no new phase is started; phases are
+      also written as spans to the trace file */
+
+#endif /* __STATISTICS_H */
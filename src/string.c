@@ -12,8 +12,6 @@
 #include <ctype.h>
 #  define CType_toupper   toupper
 #include <stdlib.h>
-#  define StdLib_malloc   malloc
-#  define StdLib_realloc  realloc
 #  define StdLib_strtol   strtol
 #include <string.h>
 #  define STRING_strchr   strchr
@@ -53,7 +51,8 @@ static TypeDescriptor_Record String__tdRecord =
     /* .constructionProc = */ (TypeDescriptor_ConstructionProc) String_make,
     /* .destructionProc = */ (TypeDescriptor_DestructionProc) String_destroy,
     /* .hashCodeProc = */ (TypeDescriptor_HashCodeProc) String_hashCode,
-    /* .keyValidationProc = */(TypeDescriptor_KeyValidationProc) String_isEqual
+    /* .keyValidationProc = */(TypeDescriptor_KeyValidationProc) String_isEqual,
+    /* .name = */ "String"
   };
 
 TypeDescriptor_Type String_typeDescriptor = &String__tdRecord;
@@ -134,7 +133,8 @@ static void String__ensureCapacity (inout String_Type st,
        slack to be prepared for some later extension */
     count += 10;
     st->capacity = count;
-    st->characterList = StdLib_realloc(st->characterList, count + 1);
+    st->characterList = reallocateMemory(st->characterList, count + 1,
+					 __FILE__);
 
     if (st->characterList == NULL) {
       Error_raise(Error_Criticality_fatalError,
@@ -191,7 +191,7 @@ void String_finalize (void)
 String_Type String_allocate (in SizeType capacity)
 {
   Boolean isOkay = true;
-  String_Type st = StdLib_malloc(sizeof(String__Record));
+  String_Type st = NEW(String__Record);
 
   if (st == NULL) {
     isOkay = false;
@@ -200,7 +200,7 @@ String_Type String_allocate (in SizeType capacity)
     st->capacity = capacity;
     /* allocate space for <capacity> significant characters plus a
        String_terminator */
-    st->characterList = StdLib_malloc(capacity + 1);
+    st->characterList = allocateMemory(capacity + 1, false, __FILE__);
 
     if (st->characterList == NULL) {
       isOkay = false;
@@ -74,7 +74,7 @@ static TypeDescriptor_Record Symbol__tdRecord =
   { /* .objectSize = */ 0, /* .assignmentProc = */ NULL,
     /* .comparisonProc = */ NULL, /* .constructionProc = */ NULL,
     /* .destructionProc = */ NULL, /* .hashCodeProc = */ NULL,
-    /* .keyValidationProc = */ Symbol__hasKey };
+    /* .keyValidationProc = */ Symbol__hasKey, /* .name = */ "Symbol" };
 
 TypeDescriptor_Type Symbol_typeDescriptor = &Symbol__tdRecord;
 
@@ -83,7 +83,8 @@ static TypeDescriptor_Record Symbol__recordTDRecord =
     /* .comparisonProc = */ NULL, 
     /* .constructionProc = */ (TypeDescriptor_ConstructionProc) Symbol__make,
     /* .destructionProc = */ (TypeDescriptor_DestructionProc) Symbol_destroy,
-    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ Symbol__hasKey };
+    /* .hashCodeProc = */ NULL, /* .keyValidationProc = */ Symbol__hasKey,
+    /* .name = */ "Symbol record" };
 
 static TypeDescriptor_Type Symbol__recordTypeDescriptor = 
   &Symbol__recordTDRecord;
@@ -320,6 +321,7 @@ void Symbol_destroy (inout Symbol_Type *symbol)
   if (precondition) {
     currentSymbol->magicNumber = 0;
     String_destroy(&currentSymbol->name);
+    DESTROY(currentSymbol);
   }
 
   *symbol = NULL;
@@ -413,6 +415,20 @@ void Symbol_setAddressForName (in String_Type symbolName,
   }
 }
 
+/*--------------------*/
+
+void Symbol_setRelativeAddress (inout Symbol_Type *symbol,
+				in Target_Address address)
+{
+  char *procName = "Symbol_setRelativeAddress";
+  Symbol_Type currentSymbol = *symbol;
+  Boolean precondition = Symbol__checkValidityPRE(currentSymbol, procName);
+
+  if (precondition) {
+    currentSymbol->startAddress = address;
+  }
+}
+
 
 /*--------------------*/
 /* MEASUREMENT        */
@@ -442,6 +458,21 @@ Target_Address Symbol_absoluteAddress (in Symbol_Type symbol)
   return result;
 }
 
+/*--------------------*/
+
+Target_Address Symbol_relativeAddress (in Symbol_Type symbol)
+{
+  char *procName = "Symbol_relativeAddress";
+  Boolean precondition = Symbol__checkValidityPRE(symbol, procName);
+  Target_Address result = 0;
+
+  if (precondition) {
+    result = symbol->startAddress;
+  }
+
+  return result;
+}
+
 
 /*--------------------*/
 /* TRANSFORMATION     */
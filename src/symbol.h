@@ -117,6 +117,13 @@ void Symbol_setAddressForName (in String_Type symbolName,
 			       in Target_Address address);
   /** sets address of existing symbol with <symbolName> to <address> */
 
+/*--------------------*/
+
+void Symbol_setRelativeAddress (inout Symbol_Type *symbol,
+				in Target_Address address);
+  /** sets address of <symbol> relative to its defining segment to
+      <address> */
+
 
 /*--------------------*/
 /* MEASUREMENT        */
@@ -131,6 +138,11 @@ Target_Address Symbol_absoluteAddress (in Symbol_Type symbol);
   /** returns absolute address of <symbol> (by adding the segment base
       address) */
 
+/*--------------------*/
+
+Target_Address Symbol_relativeAddress (in Symbol_Type symbol);
+  /** returns address of <symbol> relative to its defining segment */
+
 
 /*--------------------*/
 /* TRANSFORMATION     */
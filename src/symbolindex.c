@@ -0,0 +1,316 @@
+/** SymbolIndex module --
+    Implementation of module providing a read-only index of all
+    symbols defined in segments sorted by area and address and by
+    name.
+
+    NOTE: as a naming convention all file scope names have the module
+    name as a prefix with a single underscore for externally visible
+    names and two underscores for internal names
+*/
+
+#include "symbolindex.h"
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "area.h"
+#include "error.h"
+#include "integermap.h"
+#include "list.h"
+#include "map.h"
+#include "string.h"
+#include "symbol.h"
+#include "typedescriptor.h"
+
+#include <stdlib.h>
+# define StdLib_qsort   qsort
+#include <string.h>
+# define STRING_compare strcmp
+
+/*========================================*/
+
+typedef struct {
+  Area_Type area;
+  SizeType firstIndex;
+  SizeType count;
+} SymbolIndex__AreaRange;
+  /** range of entries belonging to an area */
+
+
+typedef struct {
+  Target_Address address;
+  SizeType position;
+} SymbolIndex__SortItem;
+  /** item for sorting the entries of an area by address where
+      <position> is the index of the entry in collection order */
+
+
+static SymbolIndex_Entry *SymbolIndex__entryList;
+  /** all entries grouped by area and sorted by address within each
+      area */
+
+static SymbolIndex_Entry **SymbolIndex__entryByNameList;
+  /** references to all entries sorted by name */
+
+static SizeType SymbolIndex__entryCount;
+  /** number of entries in both lists */
+
+static SymbolIndex__AreaRange *SymbolIndex__areaRangeList;
+  /** ranges of entries for all areas in the order of the area
+      list */
+
+static IntegerMap_Type SymbolIndex__areaToRangeIndexMap;
+  /** map from an area to the index of its entry range */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static void SymbolIndex__clear (void)
+  /** removes all entries and area ranges from the index */
+{
+  SizeType i;
+
+  for (i = 0;  i < SymbolIndex__entryCount;  i++) {
+    String_destroy(&SymbolIndex__entryList[i].name);
+  }
+
+  if (SymbolIndex__entryList != NULL) {
+    DESTROY(SymbolIndex__entryList);
+    DESTROY(SymbolIndex__entryByNameList);
+  }
+
+  if (SymbolIndex__areaRangeList != NULL) {
+    DESTROY(SymbolIndex__areaRangeList);
+  }
+
+  SymbolIndex__entryList       = NULL;
+  SymbolIndex__entryByNameList = NULL;
+  SymbolIndex__entryCount      = 0;
+  SymbolIndex__areaRangeList   = NULL;
+  Map_clear(&SymbolIndex__areaToRangeIndexMap);
+}
+
+/*--------------------*/
+
+static int SymbolIndex__compareByAddress (in const void *a,
+					  in const void *b)
+  /** compares the sort items <a> and <b> by their addresses and
+      returns -1, 0 or +1 for less, equal and greater; items with
+      equal addresses keep their order of collection */
+{
+  const SymbolIndex__SortItem *itemA = a;
+  const SymbolIndex__SortItem *itemB = b;
+  int result;
+
+  if (itemA->address != itemB->address) {
+    result = (itemA->address < itemB->address ? -1 : 1);
+  } else if (itemA->position != itemB->position) {
+    result = (itemA->position < itemB->position ? -1 : 1);
+  } else {
+    result = 0;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static int SymbolIndex__compareByName (in const void *a, in const void *b)
+  /** compares the entries referenced by <a> and <b> by their names
+      and returns -1, 0 or +1 for less, equal and greater; entries
+      with equal names are ordered by their position in the entry
+      list */
+{
+  const SymbolIndex_Entry *entryA = *((SymbolIndex_Entry * const *) a);
+  const SymbolIndex_Entry *entryB = *((SymbolIndex_Entry * const *) b);
+  int result = STRING_compare(String_asCharPointer(entryA->name),
+			      String_asCharPointer(entryB->name));
+
+  if (result == 0 && entryA != entryB) {
+    result = (entryA < entryB ? -1 : 1);
+  }
+
+  return (result < 0 ? -1 : result > 0 ? 1 : 0);
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void SymbolIndex_initialize (void)
+{
+  SymbolIndex__entryList       = NULL;
+  SymbolIndex__entryByNameList = NULL;
+  SymbolIndex__entryCount      = 0;
+  SymbolIndex__areaRangeList   = NULL;
+  SymbolIndex__areaToRangeIndexMap =
+    Map_make(TypeDescriptor_plainDataTypeDescriptor);
+}
+
+/*--------------------*/
+
+void SymbolIndex_finalize (void)
+{
+  SymbolIndex__clear();
+  Map_destroy(&SymbolIndex__areaToRangeIndexMap);
+}
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+SymbolIndex_Entry *SymbolIndex_getAreaEntries (in Area_Type area,
+					       out SizeType *count)
+{
+  long rangeIndex = IntegerMap_lookup(SymbolIndex__areaToRangeIndexMap,
+				      area);
+  SymbolIndex_Entry *result = NULL;
+
+  *count = 0;
+
+  if (rangeIndex != IntegerMap_notFound) {
+    SymbolIndex__AreaRange *range = &SymbolIndex__areaRangeList[rangeIndex];
+    *count = range->count;
+    result = &SymbolIndex__entryList[range->firstIndex];
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+SymbolIndex_Entry **SymbolIndex_getEntriesByName (out SizeType *count)
+{
+  *count = SymbolIndex__entryCount;
+  return SymbolIndex__entryByNameList;
+}
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void SymbolIndex_build (void)
+{
+  char *procName = "SymbolIndex_build";
+  Area_List areaList = List_make(Area_typeDescriptor);
+  Symbol_List symbolList = List_make(Symbol_typeDescriptor);
+  SizeType areaCount;
+  SizeType areaIndex;
+  List_Cursor cursor;
+  SymbolIndex__SortItem *sortItemList;
+  Symbol_Type *symbolArray;
+  SizeType i;
+
+  SymbolIndex__clear();
+  Area_getList(&areaList);
+  areaCount = List_length(areaList);
+  SymbolIndex__areaRangeList = NEWARRAY(SymbolIndex__AreaRange,
+					areaCount + 1);
+  ASSERTION(SymbolIndex__areaRangeList != NULL, procName, "out of memory");
+
+  /* collect the symbols of all segments area by area; the symbols
+     of folded segments are kept, because they still denote code at
+     the address of the replacing segment */
+  {
+    Symbol_List segmentSymbolList = List_make(Symbol_typeDescriptor);
+    Area_SegmentList segmentList = List_make(Area_segmentTypeDescriptor);
+    Area_SegmentList foldedSegmentList =
+      List_make(Area_segmentTypeDescriptor);
+
+    areaIndex = 0;
+
+    for (cursor = List_resetCursor(areaList);  cursor != NULL;
+	 List_advanceCursor(&cursor)) {
+      Area_Type area = List_getElementAtCursor(cursor);
+      SymbolIndex__AreaRange *range = &SymbolIndex__areaRangeList[areaIndex];
+      List_Cursor segmentCursor;
+
+      range->area       = area;
+      range->firstIndex = List_length(symbolList);
+      Area_getListOfSegments(area, &segmentList);
+      Area_getListOfFoldedSegments(area, &foldedSegmentList);
+      List_concatenate(&segmentList, foldedSegmentList);
+
+      for (segmentCursor = List_resetCursor(segmentList);
+	   segmentCursor != NULL;
+	   List_advanceCursor(&segmentCursor)) {
+	Area_Segment segment = List_getElementAtCursor(segmentCursor);
+	Area_getSegmentSymbols(segment, &segmentSymbolList);
+	List_concatenate(&symbolList, segmentSymbolList);
+      }
+
+      range->count = List_length(symbolList) - range->firstIndex;
+      IntegerMap_set(&SymbolIndex__areaToRangeIndexMap, area,
+		     (long) areaIndex);
+      areaIndex++;
+    }
+
+    List_destroy(&foldedSegmentList);
+    List_destroy(&segmentList);
+    List_destroy(&segmentSymbolList);
+  }
+
+  /* sort the symbols of each area by address */
+  SymbolIndex__entryCount = List_length(symbolList);
+  symbolArray  = NEWARRAY(Symbol_Type, SymbolIndex__entryCount + 1);
+  sortItemList = NEWARRAY(SymbolIndex__SortItem,
+			  SymbolIndex__entryCount + 1);
+  ASSERTION(symbolArray != NULL && sortItemList != NULL, procName,
+	    "out of memory");
+  i = 0;
+
+  for (cursor = List_resetCursor(symbolList);  cursor != NULL;
+       List_advanceCursor(&cursor)) {
+    Symbol_Type symbol = List_getElementAtCursor(cursor);
+    symbolArray[i] = symbol;
+    sortItemList[i].address  = Symbol_absoluteAddress(symbol);
+    sortItemList[i].position = i;
+    i++;
+  }
+
+  for (areaIndex = 0;  areaIndex < areaCount;  areaIndex++) {
+    SymbolIndex__AreaRange *range = &SymbolIndex__areaRangeList[areaIndex];
+
+    if (range->count > 1) {
+      StdLib_qsort(&sortItemList[range->firstIndex], range->count,
+		   sizeof(SymbolIndex__SortItem),
+		   SymbolIndex__compareByAddress);
+    }
+  }
+
+  /* fill the entries in sorted order and the references for the
+     name order */
+  SymbolIndex__entryList = NEWARRAY(SymbolIndex_Entry,
+				    SymbolIndex__entryCount + 1);
+  SymbolIndex__entryByNameList = NEWARRAY(SymbolIndex_Entry *,
+					  SymbolIndex__entryCount + 1);
+  ASSERTION(SymbolIndex__entryList != NULL
+	    && SymbolIndex__entryByNameList != NULL, procName,
+	    "out of memory");
+
+  for (i = 0;  i < SymbolIndex__entryCount;  i++) {
+    SymbolIndex_Entry *entry = &SymbolIndex__entryList[i];
+    Symbol_Type symbol = symbolArray[sortItemList[i].position];
+
+    entry->symbol  = symbol;
+    entry->address = sortItemList[i].address;
+    entry->name    = String_make();
+    Symbol_getName(symbol, &entry->name);
+    SymbolIndex__entryByNameList[i] = entry;
+  }
+
+  if (SymbolIndex__entryCount > 1) {
+    StdLib_qsort(SymbolIndex__entryByNameList, SymbolIndex__entryCount,
+		 sizeof(SymbolIndex_Entry *), SymbolIndex__compareByName);
+  }
+
+  DESTROY(sortItemList);
+  DESTROY(symbolArray);
+  List_destroy(&symbolList);
+  List_destroy(&areaList);
+}
@@ -0,0 +1,77 @@
+/** SymbolIndex module --
+    This module provides a read-only index of all symbols defined in
+    segments.  It is built once after the areas have been linked and
+    all addresses are final; afterwards all map file generators
+    iterate it directly instead of collecting and sorting the symbols
+    of each area on their own.
+
+    The index consists of flat arrays of entries with the symbol, its
+    name and its absolute address.  One array is grouped by area (in
+    the order of the area list) and sorted by address within each
+    area; symbols with equal addresses keep the order of their
+    segments.  Since each bank has areas of its own, the area ranges
+    also give the symbols per bank.  A second array refers to the same
+    entries sorted by name.
+*/
+
+#ifndef __SYMBOLINDEX_H
+#define __SYMBOLINDEX_H
+
+/*========================================*/
+
+#include "globdefs.h"
+#include "area.h"
+#include "string.h"
+#include "symbol.h"
+#include "target.h"
+
+/*========================================*/
+
+typedef struct {
+  Symbol_Type symbol;
+  String_Type name;
+  Target_Address address;
+} SymbolIndex_Entry;
+  /** an entry in the symbol index with a symbol, its name and its
+      absolute address */
+
+/*========================================*/
+
+/*--------------------*/
+/* MODULE SETUP/CLOSE */
+/*--------------------*/
+
+void SymbolIndex_initialize (void);
+  /** sets up internal data structures for this module */
+
+/*--------------------*/
+
+void SymbolIndex_finalize (void);
+  /** cleans up internal data structures for this module */
+
+/*--------------------*/
+/* ACCESS             */
+/*--------------------*/
+
+SymbolIndex_Entry *SymbolIndex_getAreaEntries (in Area_Type area,
+					       out SizeType *count);
+  /** returns the entries of all symbols in <area> sorted by address
+      and sets <count> to their number; when <area> has no symbols or
+      is unknown to the index, <count> is zero */
+
+/*--------------------*/
+
+SymbolIndex_Entry **SymbolIndex_getEntriesByName (out SizeType *count);
+  /** returns references to all entries sorted by symbol name (and by
+      address for equal names) and sets <count> to their number */
+
+/*--------------------*/
+/* CHANGE             */
+/*--------------------*/
+
+void SymbolIndex_build (void);
+  /** (re)builds the index from all symbols in the segments of all
+      areas; must be called after <Area_link> and whenever addresses
+      have changed */
+
+#endif /* __SYMBOLINDEX_H */
@@ -27,6 +27,11 @@ typedef int Target_Bank;
   /** bank number type */
 
 
+typedef Boolean (*Target_AreaKindQueryProc)(in String_Type areaName);
+  /** type for routines telling whether the area with <areaName> only
+      holds code (and hence may be decoded as instructions) */
+
+
 typedef Target_Bank (*Target_BankAnalysisProc) (in String_Type segmentName);
   /** type for routines parsing the current segment with <segmentName>
       of emitted code for ROM bank switching */
@@ -50,6 +55,56 @@ typedef void (*Target_CommandLineHandleProc)(in String_Type mainFileNamePrefix,
       extension */
 
 
+typedef enum {
+  Target_InstructionKind_other,
+  Target_InstructionKind_absoluteJump,
+  Target_InstructionKind_relativeJump,
+  Target_InstructionKind_computedJump
+} Target_InstructionKind;
+  /** classification of instructions for the relaxation of jumps:
+      an absolute jump (or call) has a single byte opcode followed by
+      the target address word, a relative jump has a single byte
+      opcode followed by a displacement byte counting from the end of
+      the instruction, a computed jump takes its target from a
+      register (e.g. for indexing a jump table with entries of fixed
+      size) */
+
+
+typedef UINT8 (*Target_InstructionDecodingProc)(in UINT8 *byteList,
+					in SizeType count,
+					out Target_InstructionKind *kind);
+  /** type for routines returning the length of the instruction at the
+      start of <byteList> (having <count> bytes) and its <kind>; when
+      the bytes do not form a valid instruction, 0 is returned */
+
+
+typedef UINT8 (*Target_JumpRelaxationProc)(in UINT8 *instruction,
+					   in Boolean distanceIsKnown,
+					   in long distance,
+					   in Boolean addressIsKnown,
+					   in Target_Address address,
+					   out UINT8 *byteList);
+  /** type for routines putting a shorter encoding of the absolute
+      jump <instruction> into <byteList> and returning its length
+      (or 0 when there is none); when <distanceIsKnown> the jump
+      target is <distance> bytes away from the start of the
+      instruction, when <addressIsKnown> it is at absolute
+      <address> */
+
+
+typedef struct {
+  char *name;
+  UINT32 startAddress;
+  UINT32 size;
+  Boolean isBanked;
+} Target_MemoryRegion;
+  /** a region of the target address space areas may be placed into
+      with its <name>, its first address <startAddress> and its
+      length <size> in bytes; when <isBanked> there is a separate
+      instance of the region for each bank given by the bank number
+      of the area names */
+
+
 typedef void (*Target_UsageInfoProc)(out String_Type *st);
   /** type for routines returning a string with an indented line list
       (separated by newlines) with platform specific options as a
@@ -74,14 +129,27 @@ typedef struct {
   Target_InitializationProc initialize;
   Target_FinalizationProc finalize;
   Banking_Configuration *bankingConfiguration;
+  Target_InstructionDecodingProc decodeInstruction;
+  Target_JumpRelaxationProc relaxJump;
+  Target_AreaKindQueryProc isCodeArea;
+  Target_MemoryRegion *memoryRegionList;
+  Target_MemoryRegion *reservedRegion;
+  Target_MemoryRegion *interruptVectorRegion;
 } Target_Type;
 /** type to tell several properties of target platform like
     endianness, case sensitivity of names, banking configuration,
     callback routines for rom bank switching, querying for bytes in
     the emitted code, command line option parsing, giving usage
-    information for target specific options and setting up and tearing
-    down the platform specific data; each of those routines may be
-    NULL when it is not used in this target platform */
+    information for target specific options, setting up and tearing
+    down the platform specific data, decoding and shortening
+    instructions for jump relaxation and telling the areas holding
+    only code (the only ones relaxed) and the list of memory regions
+    (terminated by an entry with a NULL name) for placing areas, the
+    range of an unbanked region written by the platform itself (and
+    hence never used for placing areas) and the region with the
+    interrupt (and restart) vectors for the static overlay of local
+    data; each of those routines and regions
+    may be NULL when it is not used in this target platform */
 
 
 extern Target_Type Target_info;
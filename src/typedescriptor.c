@@ -11,14 +11,12 @@
 
 #include "globdefs.h"
 #include "error.h"
+#include "statistics.h"
 
 #include <string.h>
 # define STRING_memcmp memcmp
 # define STRING_memcpy memcpy
 
-#include <stdlib.h>
-# define Stdlib_malloc malloc
-
 /*========================================*/
 
 static SizeType TypeDescriptor__directHashProc (in Object object);
@@ -28,7 +26,7 @@ static TypeDescriptor_Record TypeDescriptor_dtDescriptorRecord =
     /* .comparisonProc = */ NULL, /* .constructionProc = */ NULL,
     /* .destructionProc = */ NULL,
     /* .hashCodeProc = */ TypeDescriptor__directHashProc,
-    /* .keyValidationProc = */ NULL };
+    /* .keyValidationProc = */ NULL, /* .name = */ "plain data" };
 
 
 TypeDescriptor_Type TypeDescriptor_plainDataTypeDescriptor =
@@ -174,20 +172,27 @@ Object TypeDescriptor_makeObject (in TypeDescriptor_Type typeDescriptor)
   TypeDescriptor_ConstructionProc constructionProc = NULL;
   Object object;
   SizeType objectSize = 0;
+  char *typeName = NULL;
+  char *previousTypeName;
 
   if (typeDescriptor != TypeDescriptor_default) {
     constructionProc = typeDescriptor->constructionProc;
     objectSize       = typeDescriptor->objectSize;
+    typeName         = typeDescriptor->name;
   }
+
+  /* all blocks allocated for the object are accounted to its type */
+  previousTypeName = Statistics_setAllocationType(typeName);
   
   if (constructionProc != NULL) {
     object = constructionProc();
   } else if (objectSize > 0) {
-    object = Stdlib_malloc(objectSize);
+    object = allocateMemory(objectSize, false, __FILE__);
   } else {
     object = NULL;
   }
 
+  Statistics_setAllocationType(previousTypeName);
   return object;
 }
 
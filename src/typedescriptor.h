@@ -63,12 +63,14 @@ typedef struct {
   TypeDescriptor_DestructionProc destructionProc;
   TypeDescriptor_HashCodeProc hashCodeProc;
   TypeDescriptor_KeyValidationProc keyValidationProc;
+  char *name;
 } TypeDescriptor_Record;
   /** type defining the central characteristics of some type: its
       size, routines for assignment, construction, destruction,
-      comparison and key validation; when a routine is NULL, the
-      corresponding bitwise operations are used as a default (e.g. a
-      memmove for assignment) */
+      comparison and key validation and its name; when a routine is
+      NULL, the corresponding bitwise operations are used as a default
+      (e.g. a memmove for assignment); the name identifies the type in
+      the heap statistics */
 
 
 typedef TypeDescriptor_Record *TypeDescriptor_Type;
@@ -0,0 +1,65 @@
+## checks that a link keeping its state (-t) patches the Gameboy image
+## in place when only the code of an object file has changed and that
+## the result is the same as that of a complete link
+##
+## usage: cmake -DASLINK=<linker> -DSOURCE_DIR=<dir> -DWORK_DIR=<dir>
+##              -P incrementallink.cmake
+
+set( objectFiles jumptable.rel shortjump.rel initdata.rel )
+
+file( REMOVE_RECURSE ${WORK_DIR} )
+file( MAKE_DIRECTORY ${WORK_DIR}/patched ${WORK_DIR}/complete )
+
+foreach( objectFile ${objectFiles} )
+	file( COPY ${SOURCE_DIR}/${objectFile}
+	      DESTINATION ${WORK_DIR}/patched )
+endforeach()
+
+function( link directory )
+	execute_process(
+		COMMAND ${ASLINK} -n ${ARGN} -z prog ${objectFiles}
+		WORKING_DIRECTORY ${WORK_DIR}/${directory}
+		RESULT_VARIABLE result
+	)
+
+	if( NOT result EQUAL 0 )
+		message( FATAL_ERROR "link in ${directory} failed with ${result}" )
+	endif()
+endfunction()
+
+## replaces <oldText> by <newText> in object file <objectFile> of the
+## patched link
+function( changeObjectFile objectFile oldText newText )
+	file( READ ${WORK_DIR}/patched/${objectFile} contents )
+	string( REPLACE "${oldText}" "${newText}" contents "${contents}" )
+	file( WRITE ${WORK_DIR}/patched/${objectFile} "${contents}" )
+endfunction()
+
+## links the current object files completely and compares the image
+## with the patched one
+function( compareWithCompleteLink )
+	foreach( objectFile ${objectFiles} )
+		file( COPY ${WORK_DIR}/patched/${objectFile}
+		      DESTINATION ${WORK_DIR}/complete )
+	endforeach()
+
+	link( complete )
+	file( READ ${WORK_DIR}/patched/prog.gb patchedImage HEX )
+	file( READ ${WORK_DIR}/complete/prog.gb completeImage HEX )
+
+	if( NOT patchedImage STREQUAL completeImage )
+		message( FATAL_ERROR "patched image differs from complete link" )
+	endif()
+endfunction()
+
+link( patched -t )
+
+## RET at the end of the short jump becomes RET NZ
+changeObjectFile( shortjump.rel "00 00 C9" "00 00 C0" )
+link( patched -t )
+compareWithCompleteLink()
+
+## the initial data is changed while the code stays the same
+changeObjectFile( initdata.rel "CD 08 00 07" "CD 09 00 07" )
+link( patched -t )
+compareWithCompleteLink()
@@ -0,0 +1,34 @@
+## checks that jump relaxation (-oj) keeps the entries of a jump table
+## indexed by JP (HL), leaves data areas alone and still shortens an
+## ordinary jump
+##
+## usage: cmake -DASLINK=<linker> -DSOURCE_DIR=<dir> -DWORK_DIR=<dir>
+##              -P jumprelaxation.cmake
+
+file( REMOVE_RECURSE ${WORK_DIR} )
+file( MAKE_DIRECTORY ${WORK_DIR} )
+file( COPY ${SOURCE_DIR}/jumptable.rel ${SOURCE_DIR}/shortjump.rel
+      ${SOURCE_DIR}/initdata.rel
+      DESTINATION ${WORK_DIR} )
+
+execute_process(
+	COMMAND ${ASLINK} -n -oj -z jumps jumptable.rel shortjump.rel
+		initdata.rel
+	WORKING_DIRECTORY ${WORK_DIR}
+	RESULT_VARIABLE result
+)
+
+if( NOT result EQUAL 0 )
+	message( FATAL_ERROR "link failed with ${result}" )
+endif()
+
+## _CODE starts at 0x200: the jump table E9 C3 07 02 C3 08 02 C9 C9 is
+## unchanged, the following JP 0x020D becomes JR +1; the initial data
+## CD 08 00 07 in _INITIALIZER right behind it is not taken for a
+## CALL 0x0008
+file( READ ${WORK_DIR}/jumps.gb code OFFSET 512 LIMIT 17 HEX )
+set( expectedCode "e9c30702c30802c9c9180100c9cd080007" )
+
+if( NOT code STREQUAL expectedCode )
+	message( FATAL_ERROR "code is ${code} instead of ${expectedCode}" )
+endif()
@@ -0,0 +1,705 @@
+/** ContainerBench tool --
+    Measures the generic container and string modules of the linker
+    (<Map>, <IntegerMap>, <Multimap>, <List>, <String> and
+    <TypeDescriptor>) with the access patterns of a link: string keys
+    shaped like symbol names, plain data keys and lists of pointers.
+
+    Each benchmark is run for several sizes of its container and
+    reports the processor time and the number of heap allocations per
+    operation; the allocations are taken from the event counters of
+    the statistics module.  Operations whose cost grows with the
+    container size (like lookups) are done on a sample of at most
+    <ContainerBench__maxSampleCount> keys spread over the container.
+    Every benchmark is repeated until a minimum time has elapsed for a
+    stable measurement; once a benchmark exceeds a time limit for some
+    size, larger sizes are skipped for it.
+
+    Finally the distribution of <String_hashCode> for the keys is
+    shown for the bucket count of the map module and a larger one.
+
+    Usage:  containerbench [size ...]   (default: 1000 ... 1000000)
+*/
+
+#include "../src/globdefs.h"
+#include "../src/error.h"
+#include "../src/file.h"
+#include "../src/integermap.h"
+#include "../src/list.h"
+#include "../src/map.h"
+#include "../src/multimap.h"
+#include "../src/statistics.h"
+#include "../src/string.h"
+#include "../src/typedescriptor.h"
+
+#include <stdio.h>
+# define StdIO_printf  printf
+# define StdIO_sprintf sprintf
+#include <stdlib.h>
+# define StdLib_atol   atol
+#include <time.h>
+# define Time_clock    clock
+# define Time_ticksPerSecond CLOCKS_PER_SEC
+
+/*========================================*/
+
+#define ContainerBench__maxSampleCount 10000
+  /** maximum number of operations of a benchmark where each single
+      operation depends on the container size */
+
+#define ContainerBench__minimumTime 0.2
+  /** minimum processor time in seconds accumulated for a benchmark
+      and size by repeating it */
+
+#define ContainerBench__timeLimit 10.0
+  /** processor time in seconds for a single run of a benchmark
+      (including the setup of its container) beyond which larger
+      sizes are skipped */
+
+#define ContainerBench__mapBucketCount 64
+  /** number of buckets in a map (as defined in the map module) */
+
+#define ContainerBench__largeBucketCount 4096
+  /** larger bucket count for judging the hash code distribution */
+
+#define ContainerBench__functionsPerModule 8
+  /** number of function symbols per module in the generated symbol
+      names */
+
+/*--------------------*/
+
+typedef void (*ContainerBench__BenchmarkProc)(in SizeType size);
+  /** routine doing a benchmark for a container with <size> elements
+      using the first <size> entries of <ContainerBench__keyList> as
+      keys where needed; it brackets
+      the measured operations by <startMeasurement> and
+      <stopMeasurement> */
+
+typedef struct {
+  char *name;
+  ContainerBench__BenchmarkProc proc;
+} ContainerBench__Benchmark;
+  /** a benchmark with its name and routine */
+
+/*--------------------*/
+
+static struct {
+  clock_t startTime;
+  UINT32 startAllocationCount;
+  double time;
+  double allocationCount;
+  double operationCount;
+} ContainerBench__measurement;
+  /** accumulated processor time, allocations and operations for the
+      current benchmark and the start values of the running
+      measurement */
+
+static Object ContainerBench__sink;
+  /** destination of results which must not be optimized away */
+
+static String_Type *ContainerBench__keyList;
+  /** symbol names used as keys by the benchmarks */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static SizeType ContainerBench__sampleCount (in SizeType size)
+  /** returns the number of sample operations for a container with
+      <size> elements */
+{
+  return (size < ContainerBench__maxSampleCount
+	  ? size : ContainerBench__maxSampleCount);
+}
+
+/*--------------------*/
+
+static SizeType ContainerBench__sampleIndex (in SizeType size,
+					     in SizeType i)
+  /** returns the element index of the <i>-th sample spread evenly
+      over a container with <size> elements */
+{
+  return i * (size / ContainerBench__sampleCount(size));
+}
+
+/*--------------------*/
+
+static void ContainerBench__startMeasurement (void)
+  /** starts measuring the processor time and allocations */
+{
+  ContainerBench__measurement.startAllocationCount =
+    Statistics_getCount(Statistics_CounterKind_allocation);
+  ContainerBench__measurement.startTime = Time_clock();
+}
+
+/*--------------------*/
+
+static void ContainerBench__stopMeasurement (in SizeType operationCount)
+  /** stops measuring and accounts <operationCount> operations with
+      the time and allocations since the start */
+{
+  clock_t endTime = Time_clock();
+  UINT32 allocationCount =
+    Statistics_getCount(Statistics_CounterKind_allocation);
+
+  ContainerBench__measurement.time +=
+    ((double) (endTime - ContainerBench__measurement.startTime)
+     / (double) Time_ticksPerSecond);
+  ContainerBench__measurement.allocationCount +=
+    (double) (allocationCount
+	      - ContainerBench__measurement.startAllocationCount);
+  ContainerBench__measurement.operationCount += (double) operationCount;
+}
+
+/*--------------------*/
+/* KEY GENERATION     */
+/*--------------------*/
+
+static void ContainerBench__makeKey (out String_Type *key,
+				     in char *prefix, in SizeType i)
+  /** sets <key> to a symbol name for the <i>-th function with
+      <prefix> */
+{
+  char buffer[40];
+  StdIO_sprintf(buffer, "%s%lu_%lu", prefix,
+		(unsigned long) (i / ContainerBench__functionsPerModule),
+		(unsigned long) (i % ContainerBench__functionsPerModule));
+  String_copyCharArray(key, buffer);
+}
+
+/*--------------------*/
+
+static String_Type *ContainerBench__makeKeyList (in SizeType size)
+  /** returns a list of <size> distinct symbol names */
+{
+  String_Type *keyList = NEWARRAY(String_Type, size);
+  SizeType i;
+
+  for (i = 0;  i < size;  i++) {
+    keyList[i] = String_make();
+    ContainerBench__makeKey(&keyList[i], "_f", i);
+  }
+
+  return keyList;
+}
+
+/*--------------------*/
+
+static void ContainerBench__destroyKeyList (inout String_Type **keyList,
+					    in SizeType size)
+  /** destroys <keyList> with <size> symbol names */
+{
+  SizeType i;
+
+  for (i = 0;  i < size;  i++) {
+    String_destroy(&(*keyList)[i]);
+  }
+
+  DESTROY(*keyList);
+}
+
+/*--------------------*/
+
+static Map_Type ContainerBench__makeFilledMap (in String_Type *keyList,
+					       in SizeType size)
+  /** returns a map from the first <size> keys in <keyList> to
+      themselves */
+{
+  Map_Type map = Map_make(String_typeDescriptor);
+  SizeType i;
+
+  for (i = 0;  i < size;  i++) {
+    Map_set(&map, keyList[i], keyList[i]);
+  }
+
+  return map;
+}
+
+/*--------------------*/
+
+static List_Type ContainerBench__makeFilledList (in SizeType size)
+  /** returns a list of <size> plain pointers */
+{
+  List_Type list = List_make(TypeDescriptor_default);
+  SizeType i;
+
+  for (i = 0;  i < size;  i++) {
+    Object *objectPtr = List_append(&list);
+    *objectPtr = (Object) (i + 1);
+  }
+
+  return list;
+}
+
+/*--------------------*/
+/* BENCHMARKS         */
+/*--------------------*/
+
+static void ContainerBench__integerMapLookup (in SizeType size)
+  /** looks up samples in an integer map with plain data keys */
+{
+  IntegerMap_Type map = Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  SizeType sampleCount = ContainerBench__sampleCount(size);
+  long sum = 0;
+  SizeType i;
+
+  for (i = 0;  i < size;  i++) {
+    IntegerMap_set(&map, (Object) (i + 1), (long) i);
+  }
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < sampleCount;  i++) {
+    Object key = (Object) (ContainerBench__sampleIndex(size, i) + 1);
+    sum += IntegerMap_lookup(map, key);
+  }
+
+  ContainerBench__stopMeasurement(sampleCount);
+  ContainerBench__sink = (Object) sum;
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__integerMapSet (in SizeType size)
+  /** fills an integer map with plain data keys */
+{
+  IntegerMap_Type map = Map_make(TypeDescriptor_plainDataTypeDescriptor);
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < size;  i++) {
+    IntegerMap_set(&map, (Object) (i + 1), (long) i);
+  }
+
+  ContainerBench__stopMeasurement(size);
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__listAppend (in SizeType size)
+  /** appends plain pointers to a list */
+{
+  List_Type list;
+
+  ContainerBench__startMeasurement();
+  list = ContainerBench__makeFilledList(size);
+  ContainerBench__stopMeasurement(size);
+  List_destroy(&list);
+}
+
+/*--------------------*/
+
+static void ContainerBench__listConcatenate (in SizeType size)
+  /** concatenates a list of plain pointers to another list; an
+      operation is the transfer of one element */
+{
+  List_Type list = ContainerBench__makeFilledList(size / 2);
+  List_Type otherList = ContainerBench__makeFilledList(size - size / 2);
+
+  ContainerBench__startMeasurement();
+  List_concatenate(&list, otherList);
+  ContainerBench__stopMeasurement(size - size / 2);
+  List_destroy(&otherList);
+  List_destroy(&list);
+}
+
+/*--------------------*/
+
+static void ContainerBench__listGetElement (in SizeType size)
+  /** accesses samples of a list of plain pointers by their index */
+{
+  List_Type list = ContainerBench__makeFilledList(size);
+  SizeType sampleCount = ContainerBench__sampleCount(size);
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < sampleCount;  i++) {
+    SizeType index = ContainerBench__sampleIndex(size, i) + 1;
+    ContainerBench__sink = List_getElement(list, index);
+  }
+
+  ContainerBench__stopMeasurement(sampleCount);
+  List_destroy(&list);
+}
+
+/*--------------------*/
+
+static void ContainerBench__mapDeleteKey (in SizeType size)
+  /** deletes samples from a map with string keys */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  Map_Type map = ContainerBench__makeFilledMap(keyList, size);
+  SizeType sampleCount = ContainerBench__sampleCount(size);
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < sampleCount;  i++) {
+    Map_deleteKey(&map, keyList[ContainerBench__sampleIndex(size, i)]);
+  }
+
+  ContainerBench__stopMeasurement(sampleCount);
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__mapLookupHit (in SizeType size)
+  /** looks up samples of existing keys in a map with string keys */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  Map_Type map = ContainerBench__makeFilledMap(keyList, size);
+  SizeType sampleCount = ContainerBench__sampleCount(size);
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < sampleCount;  i++) {
+    ContainerBench__sink =
+      Map_lookup(map, keyList[ContainerBench__sampleIndex(size, i)]);
+  }
+
+  ContainerBench__stopMeasurement(sampleCount);
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__mapLookupMiss (in SizeType size)
+  /** looks up keys not contained in a map with string keys */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  Map_Type map = ContainerBench__makeFilledMap(keyList, size);
+  SizeType sampleCount = ContainerBench__sampleCount(size);
+  String_Type *missingKeyList = NEWARRAY(String_Type, sampleCount);
+  SizeType i;
+
+  for (i = 0;  i < sampleCount;  i++) {
+    missingKeyList[i] = String_make();
+    ContainerBench__makeKey(&missingKeyList[i], "_g",
+			    ContainerBench__sampleIndex(size, i));
+  }
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < sampleCount;  i++) {
+    ContainerBench__sink = Map_lookup(map, missingKeyList[i]);
+  }
+
+  ContainerBench__stopMeasurement(sampleCount);
+  ContainerBench__destroyKeyList(&missingKeyList, sampleCount);
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__mapSet (in SizeType size)
+  /** fills a map with string keys */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  Map_Type map;
+
+  ContainerBench__startMeasurement();
+  map = ContainerBench__makeFilledMap(keyList, size);
+  ContainerBench__stopMeasurement(size);
+  Map_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__multimapAdd (in SizeType size)
+  /** adds values to a multimap with string keys where each key gets
+      the values of a module */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  Multimap_Type map = Multimap_make(String_typeDescriptor);
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < size;  i++) {
+    String_Type key = keyList[i / ContainerBench__functionsPerModule];
+    Multimap_add(&map, key, keyList[i]);
+  }
+
+  ContainerBench__stopMeasurement(size);
+  Multimap_destroy(&map);
+}
+
+/*--------------------*/
+
+static void ContainerBench__stringAppendChar (in SizeType size)
+  /** appends characters one by one to a string */
+{
+  String_Type st = String_make();
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < size;  i++) {
+    String_appendChar(&st, (char) ('a' + i % 26));
+  }
+
+  ContainerBench__stopMeasurement(size);
+  String_destroy(&st);
+}
+
+/*--------------------*/
+
+static void ContainerBench__stringHashCode (in SizeType size)
+  /** calculates the hash codes of symbol names */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  SizeType sum = 0;
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < size;  i++) {
+    sum += String_hashCode(keyList[i]);
+  }
+
+  ContainerBench__stopMeasurement(size);
+  ContainerBench__sink = (Object) sum;
+}
+
+/*--------------------*/
+
+static void ContainerBench__typeDescriptorCompare (in SizeType size)
+  /** compares strings via the type descriptor dispatch */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  SizeType count = 0;
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 1;  i < size;  i++) {
+    count += TypeDescriptor_compareObjects(String_typeDescriptor,
+					   keyList[i - 1], keyList[i]);
+  }
+
+  ContainerBench__stopMeasurement(size - 1);
+  ContainerBench__sink = (Object) count;
+}
+
+/*--------------------*/
+
+static void ContainerBench__typeDescriptorDirect (in SizeType size)
+  /** compares strings directly for judging the dispatch overhead */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  SizeType count = 0;
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 1;  i < size;  i++) {
+    count += String_isEqual(keyList[i - 1], keyList[i]);
+  }
+
+  ContainerBench__stopMeasurement(size - 1);
+  ContainerBench__sink = (Object) count;
+}
+
+/*--------------------*/
+
+static void ContainerBench__typeDescriptorMake (in SizeType size)
+  /** constructs, assigns and destroys strings via the type
+      descriptor dispatch */
+{
+  String_Type *keyList = ContainerBench__keyList;
+  SizeType i;
+
+  ContainerBench__startMeasurement();
+
+  for (i = 0;  i < size;  i++) {
+    Object object = TypeDescriptor_makeObject(String_typeDescriptor);
+    TypeDescriptor_assignObject(String_typeDescriptor, &object, keyList[i]);
+    TypeDescriptor_destroyObject(String_typeDescriptor, &object);
+  }
+
+  ContainerBench__stopMeasurement(size);
+}
+
+/*--------------------*/
+
+static ContainerBench__Benchmark ContainerBench__benchmarkList[] = {
+  { "Map_set",                 ContainerBench__mapSet },
+  { "Map_lookup (hit)",        ContainerBench__mapLookupHit },
+  { "Map_lookup (miss)",       ContainerBench__mapLookupMiss },
+  { "Map_deleteKey",           ContainerBench__mapDeleteKey },
+  { "IntegerMap_set",          ContainerBench__integerMapSet },
+  { "IntegerMap_lookup",       ContainerBench__integerMapLookup },
+  { "Multimap_add",            ContainerBench__multimapAdd },
+  { "List_append",             ContainerBench__listAppend },
+  { "List_concatenate",        ContainerBench__listConcatenate },
+  { "List_getElement",         ContainerBench__listGetElement },
+  { "String_appendChar",       ContainerBench__stringAppendChar },
+  { "String_hashCode",         ContainerBench__stringHashCode },
+  { "String_isEqual",          ContainerBench__typeDescriptorDirect },
+  { "TypeDescriptor_compare",  ContainerBench__typeDescriptorCompare },
+  { "TypeDescriptor_make",     ContainerBench__typeDescriptorMake },
+  { NULL, NULL }
+};
+  /** all benchmarks in the order of reporting */
+
+/*--------------------*/
+/* REPORTING          */
+/*--------------------*/
+
+static void ContainerBench__reportHashDistribution (in String_Type *keyList,
+						   in SizeType size,
+						   in SizeType bucketCount)
+  /** reports the distribution of the hash codes of the first <size>
+      keys in <keyList> over <bucketCount> buckets: the fullest bucket
+      and the chi-square statistic relative to its expectation */
+{
+  SizeType *countList = NEWARRAY(SizeType, bucketCount);
+  double expectedCount = (double) size / (double) bucketCount;
+  double chiSquare = 0.0;
+  SizeType maximumCount = 0;
+  SizeType i;
+
+  for (i = 0;  i < bucketCount;  i++) {
+    countList[i] = 0;
+  }
+
+  for (i = 0;  i < size;  i++) {
+    countList[String_hashCode(keyList[i]) % bucketCount]++;
+  }
+
+  for (i = 0;  i < bucketCount;  i++) {
+    double difference = (double) countList[i] - expectedCount;
+    chiSquare += difference * difference / expectedCount;
+    maximumCount = (countList[i] > maximumCount
+		    ? countList[i] : maximumCount);
+  }
+
+  /* for a uniform distribution chi-square is close to bucketCount - 1 */
+  StdIO_printf("%-24s %8lu %8lu %10.1f %10lu %10.2f\n",
+	       "String_hashCode", (unsigned long) size,
+	       (unsigned long) bucketCount, expectedCount,
+	       (unsigned long) maximumCount,
+	       chiSquare / (double) (bucketCount - 1));
+  DESTROY(countList);
+}
+
+/*--------------------*/
+
+static void ContainerBench__runBenchmark (
+			     in ContainerBench__Benchmark *benchmark,
+			     in SizeType *sizeList, in SizeType sizeCount)
+  /** runs <benchmark> for all <sizeCount> sizes in <sizeList> and
+      reports the results */
+{
+  Boolean isSkipped = false;
+  SizeType i;
+
+  for (i = 0;  i < sizeCount;  i++) {
+    SizeType size = sizeList[i];
+
+    if (isSkipped) {
+      StdIO_printf("%-24s %8lu   skipped (time limit)\n", benchmark->name,
+		   (unsigned long) size);
+    } else {
+      clock_t startTime = Time_clock();
+      double singleRunTime;
+
+      ContainerBench__measurement.time = 0.0;
+      ContainerBench__measurement.allocationCount = 0.0;
+      ContainerBench__measurement.operationCount = 0.0;
+      benchmark->proc(size);
+      singleRunTime = ((double) (Time_clock() - startTime)
+		       / (double) Time_ticksPerSecond);
+      isSkipped = (singleRunTime > ContainerBench__timeLimit);
+
+      while (ContainerBench__measurement.time < ContainerBench__minimumTime) {
+	benchmark->proc(size);
+      }
+
+      StdIO_printf("%-24s %8lu %10.1f %10.3f %10.3f\n", benchmark->name,
+		   (unsigned long) size,
+		   (ContainerBench__measurement.time * 1.0E9
+		    / ContainerBench__measurement.operationCount),
+		   (ContainerBench__measurement.allocationCount
+		    / ContainerBench__measurement.operationCount),
+		   singleRunTime);
+    }
+  }
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+int main (int argc, char *argv[])
+{
+  SizeType defaultSizeList[] = { 1000, 10000, 100000, 1000000 };
+  SizeType *sizeList = defaultSizeList;
+  SizeType sizeCount = 4;
+  SizeType maximumSize = 0;
+  SizeType i;
+
+  File_initialize();
+  Error_initialize();
+  List_initialize();
+  String_initialize();
+  Map_initialize();
+  Multimap_initialize();
+  Statistics_initialize();
+
+  if (argc > 1) {
+    sizeList = NEWARRAY(SizeType, argc - 1);
+    sizeCount = (SizeType) argc - 1;
+
+    for (i = 0;  i < sizeCount;  i++) {
+      long size = StdLib_atol(argv[i + 1]);
+      sizeList[i] = (size < 2 ? 2 : (SizeType) size);
+    }
+  }
+
+  for (i = 0;  i < sizeCount;  i++) {
+    maximumSize = (sizeList[i] > maximumSize ? sizeList[i] : maximumSize);
+  }
+
+  ContainerBench__keyList = ContainerBench__makeKeyList(maximumSize);
+
+  StdIO_printf("%-24s %8s %10s %10s %10s\n", "benchmark", "size",
+	       "ns/op", "allocs/op", "run [s]");
+
+  for (i = 0;  ContainerBench__benchmarkList[i].name != NULL;  i++) {
+    ContainerBench__runBenchmark(&ContainerBench__benchmarkList[i],
+				 sizeList, sizeCount);
+  }
+
+  StdIO_printf("\n%-24s %8s %8s %10s %10s %10s\n", "hash distribution",
+	       "keys", "buckets", "expected", "maximum", "chi2/df");
+
+  for (i = 0;  i < sizeCount;  i++) {
+    ContainerBench__reportHashDistribution(ContainerBench__keyList,
+					   sizeList[i],
+					   ContainerBench__mapBucketCount);
+    ContainerBench__reportHashDistribution(ContainerBench__keyList,
+					   sizeList[i],
+					   ContainerBench__largeBucketCount);
+  }
+
+  ContainerBench__destroyKeyList(&ContainerBench__keyList, maximumSize);
+
+  if (sizeList != defaultSizeList) {
+    DESTROY(sizeList);
+  }
+
+  Statistics_finalize();
+  Multimap_finalize();
+  Map_finalize();
+  String_finalize();
+  List_finalize();
+  Error_finalize();
+  File_finalize();
+  return 0;
+}
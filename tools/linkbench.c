@@ -0,0 +1,319 @@
+/** LinkBench tool --
+    Runs an end-to-end benchmark of the linker on synthetic projects
+    of increasing size.
+
+    For each scale given on the command line a project with that
+    number of modules is generated by the <relgen> tool into a
+    subdirectory <mN> of the work directory and linked there with map
+    file, Intel hex and gameboy image output.  A tenth of the modules
+    is put into a library.  For each link the wall clock time, the
+    processor time, the peak resident memory of the linker process
+    and a hash over all its output files are reported in a table.
+    The hash allows to check that an optimization of the linker does
+    not change its results.
+
+    The linker output is kept in file <link.log> of each project
+    directory.  The tool is POSIX only, because it has to measure a
+    child process.
+
+    Usage:  linkbench relgen aslink workdirectory scale ...
+*/
+
+#include <stdio.h>
+# define StdIO_fclose  fclose
+# define StdIO_fflush  fflush
+# define StdIO_fopen   fopen
+# define StdIO_fprintf fprintf
+# define StdIO_fread   fread
+# define StdIO_sprintf sprintf
+# define StdIO_stderr  stderr
+# define StdIO_stdout  stdout
+#include <stdlib.h>
+# define StdLib_atol   atol
+# define StdLib_exit   exit
+#include <fcntl.h>
+# define FCntl_open    open
+#include <sys/resource.h>
+# define Resource_getUsage getrusage
+#include <sys/stat.h>
+# define Stat_makeDirectory mkdir
+#include <sys/time.h>
+# define Time_getTimeOfDay gettimeofday
+#include <sys/wait.h>
+# define Wait_exitStatus   WEXITSTATUS
+# define Wait_hasExited    WIFEXITED
+# define Wait_waitForProcess waitpid
+#include <unistd.h>
+# define UniStd_changeDirectory chdir
+# define UniStd_duplicate       dup2
+# define UniStd_execute         execv
+# define UniStd_fork            fork
+
+/*========================================*/
+
+typedef int Boolean;
+#define false 0
+#define true 1
+
+#define in
+#define inout
+#define out
+  /** formal parameter modes (purely for documentation) */
+
+/*--------------------*/
+
+#define LinkBench__pathSize 1024
+  /** size of buffers for path names */
+
+#define LinkBench__libraryFraction 10
+  /** one out of this number of modules is put into the library */
+
+static char *LinkBench__outputSuffixList[] = { "ihx", "gb", "map", NULL };
+  /** suffixes of all linker output files included in the hash */
+
+/*--------------------*/
+
+typedef struct {
+  Boolean isOkay;
+  double wallTime;
+  double processorTime;
+  long peakMemory;
+} LinkBench__Measurement;
+  /** result of a process run: its success, its elapsed and processor
+      time in seconds and its maximum resident set size in kilobytes */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static void LinkBench__fail (in char *message, in char *argument)
+  /** reports <message> with <argument> and stops the program */
+{
+  StdIO_fprintf(StdIO_stderr, "linkbench: %s %s\n", message, argument);
+  StdLib_exit(1);
+}
+
+/*--------------------*/
+
+static double LinkBench__seconds (in struct timeval *time)
+  /** returns <time> in seconds */
+{
+  return (double) time->tv_sec + (double) time->tv_usec / 1.0E6;
+}
+
+/*--------------------*/
+
+static double LinkBench__currentTime (void)
+  /** returns the wall clock time in seconds */
+{
+  struct timeval now;
+  Time_getTimeOfDay(&now, NULL);
+  return LinkBench__seconds(&now);
+}
+
+/*--------------------*/
+
+static unsigned long LinkBench__hashFile (in unsigned long hash,
+					  in char *fileName)
+  /** combines <hash> with the contents of file <fileName> by the
+      32 bit FNV-1a hash; a missing file leaves <hash> unchanged */
+{
+  FILE *file = StdIO_fopen(fileName, "rb");
+
+  if (file != NULL) {
+    unsigned char buffer[4096];
+    size_t byteCount;
+
+    do {
+      size_t i;
+      byteCount = StdIO_fread(buffer, 1, sizeof(buffer), file);
+
+      for (i = 0;  i < byteCount;  i++) {
+	hash = ((hash ^ buffer[i]) * 16777619UL) & 0xFFFFFFFFUL;
+      }
+    } while (byteCount > 0);
+
+    StdIO_fclose(file);
+  }
+
+  return hash;
+}
+
+/*--------------------*/
+
+static void LinkBench__run (in char *directory, in char *logFileName,
+			    in char *argv[],
+			    out LinkBench__Measurement *measurement)
+  /** runs program with arguments <argv> in <directory> with standard
+      output and error going to <logFileName> (when not NULL) and
+      waits for its termination; returns its times and peak memory in
+      <measurement> */
+{
+  double startTime = LinkBench__currentTime();
+  struct rusage previousUsage;
+  int processId;
+
+  /* the usage of the child is the difference of the accumulated
+     usage of all children waited for */
+  Resource_getUsage(RUSAGE_CHILDREN, &previousUsage);
+
+  /* buffered output would otherwise be written again by the child */
+  StdIO_fflush(StdIO_stdout);
+  processId = UniStd_fork();
+
+  measurement->isOkay = false;
+
+  if (processId == 0) {
+    Boolean isOkay = (directory == NULL
+		      || UniStd_changeDirectory(directory) == 0);
+
+    if (isOkay && logFileName != NULL) {
+      int logFile = FCntl_open(logFileName, O_WRONLY | O_CREAT | O_TRUNC,
+			       0644);
+      isOkay = (logFile >= 0);
+
+      if (isOkay) {
+	UniStd_duplicate(logFile, 1);
+	UniStd_duplicate(logFile, 2);
+      }
+    }
+
+    if (isOkay) {
+      UniStd_execute(argv[0], argv);
+    }
+
+    StdLib_exit(127);
+  } else if (processId > 0) {
+    struct rusage usage;
+    int status;
+
+    if (Wait_waitForProcess(processId, &status, 0) == processId) {
+      Resource_getUsage(RUSAGE_CHILDREN, &usage);
+      measurement->isOkay = (Wait_hasExited(status)
+			     && Wait_exitStatus(status) == 0);
+      measurement->wallTime = LinkBench__currentTime() - startTime;
+      measurement->processorTime =
+	(LinkBench__seconds(&usage.ru_utime)
+	 + LinkBench__seconds(&usage.ru_stime)
+	 - LinkBench__seconds(&previousUsage.ru_utime)
+	 - LinkBench__seconds(&previousUsage.ru_stime));
+      /* the peak is the maximum over all children, but the
+	 generator always needs much less memory than the link;
+	 Linux reports kilobytes, Darwin bytes */
+#ifdef __APPLE__
+      measurement->peakMemory = usage.ru_maxrss / 1024;
+#else
+      measurement->peakMemory = usage.ru_maxrss;
+#endif
+    }
+  }
+}
+
+/*--------------------*/
+
+static Boolean LinkBench__benchmarkScale (in char *relgenPath,
+					  in char *aslinkPath,
+					  in char *workDirectory,
+					  in long moduleCount)
+  /** generates a project with <moduleCount> modules in
+      <workDirectory> by <relgenPath>, links it by <aslinkPath> and
+      reports the measurements as a table row; returns whether both
+      steps succeeded */
+{
+  char directory[LinkBench__pathSize];
+  char path[LinkBench__pathSize];
+  char moduleOption[30];
+  char libraryOption[30];
+  char *relgenArgv[5];
+  char *aslinkArgv[8];
+  LinkBench__Measurement measurement;
+  unsigned long hash = 2166136261UL;
+  int i;
+
+  StdIO_sprintf(directory, "%.900s/m%ld", workDirectory, moduleCount);
+  StdIO_sprintf(moduleOption, "-m%ld", moduleCount);
+  StdIO_sprintf(libraryOption, "-l%ld",
+		moduleCount / LinkBench__libraryFraction);
+  Stat_makeDirectory(directory, 0755);
+
+  /* the linker writes its stub file for interbank calls to a fixed
+     relative path */
+  StdIO_sprintf(path, "%.900s/c:", directory);
+  Stat_makeDirectory(path, 0755);
+  StdIO_sprintf(path, "%.900s/c:/tmp", directory);
+  Stat_makeDirectory(path, 0755);
+
+  relgenArgv[0] = relgenPath;
+  relgenArgv[1] = moduleOption;
+  relgenArgv[2] = libraryOption;
+  relgenArgv[3] = directory;
+  relgenArgv[4] = NULL;
+  StdIO_sprintf(path, "%.900s/relgen.log", directory);
+  LinkBench__run(NULL, path, relgenArgv, &measurement);
+
+  if (!measurement.isOkay) {
+    StdIO_fprintf(StdIO_stderr, "linkbench: generation failed, see %s\n",
+		  path);
+  } else {
+    aslinkArgv[0] = aslinkPath;
+    aslinkArgv[1] = "-n";
+    aslinkArgv[2] = "-m";
+    aslinkArgv[3] = "-i";
+    aslinkArgv[4] = "-z";
+    aslinkArgv[5] = "-f";
+    aslinkArgv[6] = "project.lnk";
+    aslinkArgv[7] = NULL;
+    LinkBench__run(directory, "link.log", aslinkArgv, &measurement);
+
+    for (i = 0;  LinkBench__outputSuffixList[i] != NULL;  i++) {
+      StdIO_sprintf(path, "%.900s/project.%s", directory,
+		    LinkBench__outputSuffixList[i]);
+      hash = LinkBench__hashFile(hash, path);
+    }
+
+    StdIO_fprintf(StdIO_stdout, "%8ld %10.3f %10.3f %10ld   %08lX%s\n",
+		  moduleCount, measurement.wallTime,
+		  measurement.processorTime, measurement.peakMemory, hash,
+		  (measurement.isOkay ? "" : "   FAILED"));
+
+    if (!measurement.isOkay) {
+      StdIO_fprintf(StdIO_stderr, "linkbench: link failed, see %s/%s\n",
+		    directory, "link.log");
+    }
+  }
+
+  return measurement.isOkay;
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+int main (int argc, char *argv[])
+{
+  Boolean isOkay = true;
+  int i;
+
+  if (argc < 5) {
+    LinkBench__fail("usage: linkbench relgen aslink workdirectory"
+		    " scale ...", "");
+  }
+
+  Stat_makeDirectory(argv[3], 0755);
+  StdIO_fprintf(StdIO_stdout, "%8s %10s %10s %10s   %s\n",
+		"modules", "wall [s]", "cpu [s]", "peak [KB]", "output hash");
+
+  for (i = 4;  i < argc;  i++) {
+    long moduleCount = StdLib_atol(argv[i]);
+
+    if (moduleCount < 1) {
+      LinkBench__fail("invalid scale", argv[i]);
+    }
+
+    isOkay = (LinkBench__benchmarkScale(argv[1], argv[2], argv[3],
+					moduleCount)
+	      && isOkay);
+  }
+
+  return (isOkay ? 0 : 1);
+}
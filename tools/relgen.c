@@ -0,0 +1,561 @@
+/** RelGen tool --
+    Generates a synthetic project of object files in the SDCC object
+    file format for the gameboy for benchmarking the linker.
+
+    The project consists of a startup file <crt.rel>, module object
+    files <mNNNNN.rel>, an optional library <bench.lib> with its
+    members <mNNNNN.o> and a link file <project.lnk> with all options
+    and file names needed for the link.  Each module defines some
+    functions calling functions of other modules and some modules
+    define data referenced by their neighbours.  The first modules are
+    put into the unbanked area _CODE up to a size limit, all others
+    into the banked area _CODE_0 for automatic placement by the
+    linker.
+
+    Callees are mostly modules in the vicinity of the caller and
+    sometimes unbanked modules; this resembles the locality of real
+    programs and keeps the number of interbank calls reasonable.  The
+    generation is deterministic for a given set of parameters.
+
+    Usage:  relgen [-mN] [-sN] [-tN] [-fN] [-uN] [-lN] [-rN] directory
+
+      -m  number of modules (default: 10)
+      -s  functions per module (default: 4)
+      -t  code lines (T records) per function (default: 4)
+      -f  calls to other modules per function (default: 2)
+      -u  maximum code size in unbanked area (default: 2048)
+      -l  number of modules put into the library (default: 0)
+      -r  seed of the random generator (default: 1)
+*/
+
+#include <stdio.h>
+# define StdIO_fclose  fclose
+# define StdIO_fopen   fopen
+# define StdIO_fprintf fprintf
+# define StdIO_sprintf sprintf
+# define StdIO_stderr  stderr
+# define StdIO_stdout  stdout
+#include <stdlib.h>
+# define StdLib_atol   atol
+# define StdLib_calloc calloc
+# define StdLib_exit   exit
+# define StdLib_free   free
+
+/*========================================*/
+
+typedef int Boolean;
+#define false 0
+#define true 1
+
+#define in
+#define inout
+#define out
+  /** formal parameter modes (purely for documentation) */
+
+/*--------------------*/
+
+#define RelGen__bytesPerLine 10
+  /** maximum number of code bytes in a T record */
+
+#define RelGen__maxCallCount 16
+  /** maximum number of calls to other modules per function */
+
+#define RelGen__neighbourhoodSize 8
+  /** maximum distance between modules of a caller and a callee in
+      the vicinity */
+
+#define RelGen__dataModuleDistance 4
+  /** every module with an index divisible by this defines data */
+
+#define RelGen__bankSize 16384
+  /** size of a ROM bank in bytes */
+
+#define RelGen__switchRoutineSize 7
+  /** size of a bank switch routine in the startup file in bytes */
+
+/*--------------------*/
+
+static struct {
+  long moduleCount;
+  long functionCount;
+  long lineCount;
+  long callCount;
+  long unbankedSize;
+  long libraryModuleCount;
+  unsigned long seed;
+  char *directory;
+} RelGen__options;
+  /** parameters of the generation given on the command line */
+
+static unsigned long RelGen__randomState;
+  /** state of the pseudo random generator */
+
+/*--------------------*/
+
+typedef struct {
+  long moduleIndex;
+  long functionIndex;
+} RelGen__Callee;
+  /** function called given by the indices of its module and of the
+      function within that module */
+
+/*========================================*/
+/*            INTERNAL ROUTINES           */
+/*========================================*/
+
+static void RelGen__fail (in char *message, in char *argument)
+  /** reports <message> with <argument> and stops the program */
+{
+  StdIO_fprintf(StdIO_stderr, "relgen: %s %s\n", message, argument);
+  StdLib_exit(1);
+}
+
+/*--------------------*/
+
+static long RelGen__functionSize (void)
+  /** returns the size of a function in bytes: its code lines are
+      full except for the return instruction in the last line */
+{
+  long size = RelGen__options.lineCount * RelGen__bytesPerLine;
+  long minimumSize = 3 * RelGen__options.callCount + 3 + 1;
+  return (size < minimumSize ? minimumSize : size);
+}
+
+/*--------------------*/
+
+static long RelGen__moduleSize (void)
+  /** returns the size of the code of a module in bytes */
+{
+  return RelGen__options.functionCount * RelGen__functionSize();
+}
+
+/*--------------------*/
+
+static long RelGen__random (in long limit)
+  /** returns a pseudo random number between 0 and <limit> - 1 */
+{
+  RelGen__randomState = ((RelGen__randomState * 1103515245UL + 12345UL)
+			 & 0xFFFFFFFFUL);
+  return (long) ((RelGen__randomState >> 8) % (unsigned long) limit);
+}
+
+/*--------------------*/
+
+static long RelGen__unbankedModuleCount (void)
+  /** returns the number of modules in the unbanked code area */
+{
+  long count = RelGen__options.unbankedSize / RelGen__moduleSize();
+  count = (count < 1 ? 1 : count);
+  return (count > RelGen__options.moduleCount
+	  ? RelGen__options.moduleCount : count);
+}
+
+/*--------------------*/
+
+static FILE *RelGen__openFile (in char *name)
+  /** opens file <name> in the project directory for writing; stops
+      the program on failure */
+{
+  char path[1024];
+  FILE *file;
+
+  StdIO_sprintf(path, "%.1000s/%s", RelGen__options.directory, name);
+  file = StdIO_fopen(path, "w");
+
+  if (file == NULL) {
+    RelGen__fail("cannot write", path);
+  }
+
+  return file;
+}
+
+/*--------------------*/
+
+static void RelGen__chooseCallees (in long moduleIndex,
+				   out RelGen__Callee *calleeList)
+  /** fills <calleeList> with the functions called by a function in
+      module with <moduleIndex>; callees are in neighbouring modules
+      or - with a probability of one quarter - in unbanked modules */
+{
+  long moduleCount = RelGen__options.moduleCount;
+  long unbankedCount = RelGen__unbankedModuleCount();
+  long i;
+
+  for (i = 0;  i < RelGen__options.callCount;  i++) {
+    long calleeModule = moduleIndex;
+
+    while (moduleCount > 1 && calleeModule == moduleIndex) {
+      if (RelGen__random(4) == 0) {
+	calleeModule = RelGen__random(unbankedCount);
+      } else {
+	calleeModule = (moduleIndex
+			+ RelGen__random(2 * RelGen__neighbourhoodSize + 1)
+			- RelGen__neighbourhoodSize);
+	calleeModule = (calleeModule < 0 ? 0
+			: calleeModule >= moduleCount ? moduleCount - 1
+			: calleeModule);
+      }
+    }
+
+    calleeList[i].moduleIndex   = calleeModule;
+    calleeList[i].functionIndex =
+      RelGen__random(RelGen__options.functionCount);
+  }
+}
+
+/*--------------------*/
+
+static long RelGen__findReference (inout long *referenceList,
+				   inout long *referenceCount,
+				   in long key)
+  /** returns index of <key> in <referenceList> with <referenceCount>
+      entries; when not found, it is appended */
+{
+  long i;
+
+  for (i = 0;  i < *referenceCount && referenceList[i] != key;  i++) {
+  }
+
+  if (i == *referenceCount) {
+    referenceList[(*referenceCount)++] = key;
+  }
+
+  return i;
+}
+
+/*--------------------*/
+
+static void RelGen__writeSymbolName (inout FILE *file, in long key)
+  /** writes name of symbol with <key> to <file>: a negative key
+      denotes the data of module -key - 1, otherwise it is a function
+      with module and function index combined */
+{
+  if (key < 0) {
+    StdIO_fprintf(file, "_v%ld", -key - 1);
+  } else {
+    StdIO_fprintf(file, "_f%ld_%ld", key / RelGen__options.functionCount,
+		  key % RelGen__options.functionCount);
+  }
+}
+
+/*--------------------*/
+
+static void RelGen__writeModule (in long moduleIndex, in char *fileName)
+  /** writes object file <fileName> for module with <moduleIndex> */
+{
+  long functionCount = RelGen__options.functionCount;
+  long callCount = RelGen__options.callCount;
+  long functionSize = RelGen__functionSize();
+  long dataModule = moduleIndex - moduleIndex % RelGen__dataModuleDistance;
+  Boolean hasData = (dataModule == moduleIndex);
+  Boolean isBanked = (moduleIndex >= RelGen__unbankedModuleCount());
+  long maxReferenceCount = functionCount * callCount + 1;
+  long *referenceList = StdLib_calloc(maxReferenceCount, sizeof(long));
+  RelGen__Callee *calleeList =
+    StdLib_calloc(functionCount * callCount + 1, sizeof(RelGen__Callee));
+  long referenceCount = 0;
+  long definitionCount = functionCount + (moduleIndex == 0 ? 1 : 0);
+  long firstDefinition;
+  long f;
+  long i;
+  FILE *file;
+
+  if (referenceList == NULL || calleeList == NULL) {
+    RelGen__fail("out of memory for", fileName);
+  }
+
+  /* collect all external symbols referenced */
+  for (f = 0;  f < functionCount;  f++) {
+    RelGen__chooseCallees(moduleIndex, &calleeList[f * callCount]);
+
+    for (i = 0;  i < callCount;  i++) {
+      RelGen__Callee *callee = &calleeList[f * callCount + i];
+      RelGen__findReference(referenceList, &referenceCount,
+			    (callee->moduleIndex * functionCount
+			     + callee->functionIndex));
+    }
+  }
+
+  if (!hasData) {
+    RelGen__findReference(referenceList, &referenceCount, -dataModule - 1);
+  }
+
+  /* the references come first; the absolute symbol is only defined
+     by the startup file to avoid multiple definitions */
+  firstDefinition = referenceCount;
+  file = RelGen__openFile(fileName);
+  StdIO_fprintf(file, "X\nH %d areas %ld global symbols\nM m%05ld\n",
+		(hasData ? 2 : 1),
+		firstDefinition + definitionCount + (hasData ? 1 : 0),
+		moduleIndex);
+
+  for (i = 0;  i < referenceCount;  i++) {
+    StdIO_fprintf(file, "S ");
+    RelGen__writeSymbolName(file, referenceList[i]);
+    StdIO_fprintf(file, " Ref0000\n");
+  }
+
+  StdIO_fprintf(file, "A %s size %lX flags 0\n",
+		(isBanked ? "_CODE_0" : "_CODE"),
+		functionCount * functionSize);
+
+  for (f = 0;  f < functionCount;  f++) {
+    StdIO_fprintf(file, "S _f%ld_%ld Def%04lX\n", moduleIndex, f,
+		  f * functionSize);
+  }
+
+  if (moduleIndex == 0) {
+    StdIO_fprintf(file, "S _main Def0000\n");
+  }
+
+  if (hasData) {
+    StdIO_fprintf(file, "A _DATA size 2 flags 0\nS _v%ld Def0000\n",
+		  moduleIndex);
+  }
+
+  /* each function consists of its calls, a load of the data address,
+     filler bytes and a return */
+  for (f = 0;  f < functionCount;  f++) {
+    long offset = 0;
+
+    while (offset < functionSize) {
+      long lineStart = f * functionSize + offset;
+      long relocationCount = 0;
+      long relocationList[RelGen__bytesPerLine][3];
+      int byteCount = 0;
+
+      StdIO_fprintf(file, "T %02lX %02lX", lineStart & 0xFF,
+		    (lineStart >> 8) & 0xFF);
+
+      while (offset < functionSize && byteCount < RelGen__bytesPerLine) {
+	long call = offset / 3;
+
+	if (call < callCount && byteCount + 3 <= RelGen__bytesPerLine) {
+	  RelGen__Callee *callee = &calleeList[f * callCount + call];
+	  long key = (callee->moduleIndex * functionCount
+		      + callee->functionIndex);
+
+	  StdIO_fprintf(file, " CD 00 00");
+	  relocationList[relocationCount][0] = 2;
+	  relocationList[relocationCount][1] = byteCount + 3;
+	  relocationList[relocationCount][2] =
+	    RelGen__findReference(referenceList, &referenceCount, key);
+	  relocationCount++;
+	  byteCount += 3;
+	  offset += 3;
+	} else if (call == callCount && offset % 3 == 0
+		   && byteCount + 3 <= RelGen__bytesPerLine) {
+	  StdIO_fprintf(file, " 21 00 00");
+	  relocationList[relocationCount][0] = (hasData ? 0 : 2);
+	  relocationList[relocationCount][1] = byteCount + 3;
+	  relocationList[relocationCount][2] =
+	    (hasData ? 1
+	     : RelGen__findReference(referenceList, &referenceCount,
+				     -dataModule - 1));
+	  relocationCount++;
+	  byteCount += 3;
+	  offset += 3;
+	} else if (offset < 3 * (callCount + 1)) {
+	  /* an instruction does not fit into this line */
+	  break;
+	} else {
+	  StdIO_fprintf(file, (offset == functionSize - 1 ? " C9" : " 00"));
+	  byteCount++;
+	  offset++;
+	}
+      }
+
+      StdIO_fprintf(file, "\nR 00 00 00 00");
+
+      for (i = 0;  i < relocationCount;  i++) {
+	StdIO_fprintf(file, " %02lX %02lX %02lX %02lX",
+		      relocationList[i][0], relocationList[i][1],
+		      relocationList[i][2] & 0xFF,
+		      (relocationList[i][2] >> 8) & 0xFF);
+      }
+
+      StdIO_fprintf(file, "\n");
+    }
+  }
+
+  StdIO_fclose(file);
+  StdLib_free(calleeList);
+  StdLib_free(referenceList);
+}
+
+/*--------------------*/
+
+static void RelGen__writeStartup (in long romBankCount)
+  /** writes the startup object file with the cartridge entry jumping
+      to <_main> and - for <romBankCount> greater than two - the bank
+      switch routines called by the interbank trampolines of the
+      linker */
+{
+  FILE *file = RelGen__openFile("crt.rel");
+  long switchCount = (romBankCount > 2 ? romBankCount - 1 : 0);
+  long bank;
+
+  StdIO_fprintf(file,
+		"X\nH 3 areas %ld global symbols\nM crt\n"
+		"S .__.ABS. Def0000\nS _main Ref0000\n"
+		"A _HEADER size 3 flags 8\nA _GSINIT size 1 flags 0\n"
+		"A _CODE size %lX flags 0\n",
+		2 + switchCount, RelGen__switchRoutineSize * switchCount);
+
+  for (bank = 1;  bank <= switchCount;  bank++) {
+    StdIO_fprintf(file, "S Banking__switchTo%lX Def%04lX\n",
+		  bank, RelGen__switchRoutineSize * (bank - 1));
+  }
+
+  StdIO_fprintf(file,
+		"T 00 01 C3 00 00\nR 00 00 00 00 02 03 01 00\n"
+		"T 00 00 C9\nR 00 00 01 00\n");
+
+  /* ld a,bank; ld (2000h),a; push bc; ret */
+  for (bank = 1;  bank <= switchCount;  bank++) {
+    long start = RelGen__switchRoutineSize * (bank - 1);
+    StdIO_fprintf(file, "T %02lX %02lX 3E %02lX EA 00 20 C5 C9\n"
+		  "R 00 00 02 00\n",
+		  start & 0xFF, (start >> 8) & 0xFF, bank & 0xFF);
+  }
+
+  StdIO_fclose(file);
+}
+
+/*--------------------*/
+
+static long RelGen__romBankCount (void)
+  /** returns the number of ROM banks for the project: the banked
+      code plus a quarter for the trampolines and the fragmentation
+      rounded up to a power of two with at least four banks */
+{
+  long bankedCount = (RelGen__options.moduleCount
+		      - RelGen__unbankedModuleCount());
+  long bankedSize = bankedCount * RelGen__moduleSize();
+  long neededCount = 1 + (bankedSize + bankedSize / 4) / RelGen__bankSize + 1;
+  long result = 4;
+
+  while (result < neededCount) {
+    result *= 2;
+  }
+
+  return result;
+}
+
+/*--------------------*/
+
+static void RelGen__writeProject (void)
+  /** writes all object files, the library and the link file */
+{
+  long moduleCount = RelGen__options.moduleCount;
+  long libraryStart = moduleCount - RelGen__options.libraryModuleCount;
+  Boolean isBanked = (RelGen__unbankedModuleCount() < moduleCount);
+  FILE *linkFile = RelGen__openFile("project.lnk");
+  FILE *libraryFile = NULL;
+  char fileName[30];
+  long i;
+
+  RelGen__writeStartup(isBanked ? RelGen__romBankCount() : 2);
+
+  if (libraryStart < moduleCount) {
+    libraryFile = RelGen__openFile("bench.lib");
+    StdIO_fprintf(linkFile, "-k.\n-lbench\n");
+  }
+
+  if (isBanked) {
+    StdIO_fprintf(linkFile, "-a\n-yo%ld\n-yt25\n", RelGen__romBankCount());
+  }
+
+  StdIO_fprintf(linkFile, "project\ncrt.rel\n");
+
+  for (i = 0;  i < moduleCount;  i++) {
+    Boolean isInLibrary = (i >= libraryStart && i > 0);
+
+    StdIO_sprintf(fileName, "m%05ld.%s", i, (isInLibrary ? "o" : "rel"));
+    RelGen__writeModule(i, fileName);
+
+    if (isInLibrary) {
+      StdIO_fprintf(libraryFile, "m%05ld\n", i);
+    } else {
+      StdIO_fprintf(linkFile, "%s\n", fileName);
+    }
+  }
+
+  StdIO_fclose(linkFile);
+
+  if (libraryFile != NULL) {
+    StdIO_fclose(libraryFile);
+  }
+
+  StdIO_fprintf(StdIO_stdout, "%ld modules (%ld unbanked, %ld in library),"
+		" %ld bytes of code, %ld ROM banks\n",
+		moduleCount, RelGen__unbankedModuleCount(),
+		moduleCount - (libraryStart > 0 ? libraryStart : 1),
+		moduleCount * RelGen__moduleSize(),
+		(isBanked ? RelGen__romBankCount() : 2));
+}
+
+/*--------------------*/
+
+static void RelGen__processOptions (in int argc, in char *argv[])
+  /** sets the generation parameters from the command line given by
+      <argc> and <argv> */
+{
+  int i;
+
+  RelGen__options.moduleCount        = 10;
+  RelGen__options.functionCount      = 4;
+  RelGen__options.lineCount          = 4;
+  RelGen__options.callCount          = 2;
+  RelGen__options.unbankedSize       = 2048;
+  RelGen__options.libraryModuleCount = 0;
+  RelGen__options.seed               = 1;
+  RelGen__options.directory          = NULL;
+
+  for (i = 1;  i < argc;  i++) {
+    char *arg = argv[i];
+
+    if (arg[0] != '-') {
+      RelGen__options.directory = arg;
+    } else {
+      long value = StdLib_atol(&arg[2]);
+
+      switch (arg[1]) {
+        case 'm':  RelGen__options.moduleCount = value;         break;
+        case 's':  RelGen__options.functionCount = value;       break;
+        case 't':  RelGen__options.lineCount = value;           break;
+        case 'f':  RelGen__options.callCount = value;           break;
+        case 'u':  RelGen__options.unbankedSize = value;        break;
+        case 'l':  RelGen__options.libraryModuleCount = value;  break;
+        case 'r':  RelGen__options.seed = (unsigned long) value; break;
+        default:   RelGen__fail("unknown option", arg);
+      }
+    }
+  }
+
+  if (RelGen__options.directory == NULL) {
+    RelGen__fail("usage: relgen [-mN] [-sN] [-tN] [-fN] [-uN] [-lN]"
+		 " [-rN] directory", "");
+  } else if (RelGen__options.moduleCount < 1
+	     || RelGen__options.moduleCount > 99999
+	     || RelGen__options.functionCount < 1
+	     || RelGen__options.lineCount < 1
+	     || RelGen__options.callCount < 0
+	     || RelGen__options.callCount > RelGen__maxCallCount
+	     || RelGen__options.libraryModuleCount < 0) {
+    RelGen__fail("parameter out of range", "");
+  }
+
+  RelGen__randomState = RelGen__options.seed;
+}
+
+/*========================================*/
+/*            EXPORTED ROUTINES           */
+/*========================================*/
+
+int main (int argc, char *argv[])
+{
+  RelGen__processOptions(argc, argv);
+  RelGen__writeProject();
+  return 0;
+}